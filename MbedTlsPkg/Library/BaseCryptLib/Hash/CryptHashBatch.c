@@ -0,0 +1,190 @@
+/** @file
+  Hash many independent messages in one call.
+
+  Variable store entries, TCG event log entries and per-page image hashes
+  are many short messages, each hashed with its own HashAll () call. The
+  batch functions hand the messages to DispatchItemsToAp () in groups of
+  HASH_BATCH_GROUP. The MbedTLS instances have no MP dispatch, so the groups
+  run in turn on the calling processor, through the same code as
+  Sha256HashAll () and Sha384HashAll ().
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+#include <CryptHashBatch.h>
+
+//
+// Messages claimed at once by a processor.
+//
+#define HASH_BATCH_GROUP  16
+
+/**
+  Hash function applied to each message of a batch.
+
+  @param[in]   Data       Message.
+  @param[in]   DataSize   Size of the message in bytes.
+  @param[out]  HashValue  Receives the digest.
+
+  @retval  TRUE   HashValue holds the digest.
+  @retval  FALSE  The digest could not be computed.
+**/
+typedef
+BOOLEAN
+(EFIAPI *HASH_BATCH_HASH_ALL)(
+  IN  CONST VOID  *Data,
+  IN  UINTN       DataSize,
+  OUT UINT8       *HashValue
+  );
+
+typedef struct {
+  HASH_BATCH_HASH_ALL    HashAll;
+  CONST VOID             **Messages;
+  CONST UINTN            *Sizes;
+  UINT8                  **Digests;
+  UINTN                  Count;
+} HASH_BATCH;
+
+/**
+  Hash one group of messages of a batch.
+
+  @param[in]  Context  The HASH_BATCH.
+  @param[in]  Index    Index of the group to hash.
+**/
+STATIC
+VOID
+EFIAPI
+HashBatchGroup (
+  IN VOID   *Context,
+  IN UINTN  Index
+  )
+{
+  HASH_BATCH  *Batch;
+  UINTN       Message;
+  UINTN       End;
+
+  Batch   = (HASH_BATCH *)Context;
+  Message = Index * HASH_BATCH_GROUP;
+  End     = MIN (Message + HASH_BATCH_GROUP, Batch->Count);
+
+  //
+  // The inputs were checked up front, so the hash cannot fail.
+  //
+  for ( ; Message < End; Message++) {
+    Batch->HashAll (Batch->Messages[Message], Batch->Sizes[Message], Batch->Digests[Message]);
+  }
+}
+
+/**
+  Check the inputs of a batch and hash its messages.
+
+  @param[in]   HashAll   Hash function for one message.
+  @param[in]   Messages  Array of Count message pointers.
+  @param[in]   Sizes     Array of the message sizes in bytes.
+  @param[out]  Digests   Array of Count digest buffers.
+  @param[in]   Count     Number of messages.
+
+  @retval  TRUE   All digests were computed.
+  @retval  FALSE  An input was invalid. No digest was computed.
+**/
+STATIC
+BOOLEAN
+HashBatch (
+  IN  HASH_BATCH_HASH_ALL  HashAll,
+  IN  CONST VOID           **Messages,
+  IN  CONST UINTN          *Sizes,
+  OUT UINT8                **Digests,
+  IN  UINTN                Count
+  )
+{
+  HASH_BATCH  Batch;
+  UINTN       Index;
+
+  if (Count == 0) {
+    return TRUE;
+  }
+
+  if ((Messages == NULL) || (Sizes == NULL) || (Digests == NULL)) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    if ((Digests[Index] == NULL) || ((Messages[Index] == NULL) && (Sizes[Index] != 0))) {
+      return FALSE;
+    }
+  }
+
+  Batch.HashAll  = HashAll;
+  Batch.Messages = Messages;
+  Batch.Sizes    = Sizes;
+  Batch.Digests  = Digests;
+  Batch.Count    = Count;
+
+  DispatchItemsToAp (HashBatchGroup, &Batch, (Count + HASH_BATCH_GROUP - 1) / HASH_BATCH_GROUP);
+
+  return TRUE;
+}
+
+/**
+  Computes the SHA-256 digests of several independent messages.
+
+  Each digest is the same as Sha256HashAll () computes for the message.
+
+  If Count is not 0 and Messages, Sizes or Digests is NULL, then return
+  FALSE.
+
+  @param[in]   Messages  Array of Count pointers to the messages. An entry
+                         may be NULL if its size is 0.
+  @param[in]   Sizes     Array of the message sizes in bytes.
+  @param[out]  Digests   Array of Count buffers, each receiving a 32-byte
+                         SHA-256 digest.
+  @param[in]   Count     Number of messages.
+
+  @retval TRUE   All digests were computed.
+  @retval FALSE  An input was invalid. No digest was computed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashAllBatch (
+  IN  CONST VOID   **Messages,
+  IN  CONST UINTN  *Sizes,
+  OUT UINT8        **Digests,
+  IN  UINTN        Count
+  )
+{
+  return HashBatch (Sha256HashAll, Messages, Sizes, Digests, Count);
+}
+
+/**
+  Computes the SHA-384 digests of several independent messages.
+
+  Each digest is the same as Sha384HashAll () computes for the message.
+
+  If Count is not 0 and Messages, Sizes or Digests is NULL, then return
+  FALSE.
+
+  @param[in]   Messages  Array of Count pointers to the messages. An entry
+                         may be NULL if its size is 0.
+  @param[in]   Sizes     Array of the message sizes in bytes.
+  @param[out]  Digests   Array of Count buffers, each receiving a 48-byte
+                         SHA-384 digest.
+  @param[in]   Count     Number of messages.
+
+  @retval TRUE   All digests were computed.
+  @retval FALSE  An input was invalid. No digest was computed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha384HashAllBatch (
+  IN  CONST VOID   **Messages,
+  IN  CONST UINTN  *Sizes,
+  OUT UINT8        **Digests,
+  IN  UINTN        Count
+  )
+{
+  return HashBatch (Sha384HashAll, Messages, Sizes, Digests, Count);
+}
@@ -0,0 +1,40 @@
+/** @file
+  GetCryptoProviderCpuFeatures () for the MbedTLS-based BaseCryptLib.
+
+  MbedTLS picks its accelerated code paths when it is built, through
+  mbedtls_config.h, and keeps no capability words that could be reported
+  or overridden. The function therefore reports no features, so a caller
+  that compares providers sees the same interface on both.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseMemoryLib.h>
+#include <CryptCpuFeatures.h>
+
+/**
+  Reports the CPU features the crypto provider selects its accelerated code
+  paths from.
+
+  @param[out]  Features  Cleared.
+
+  @retval  EFI_INVALID_PARAMETER  Features is NULL.
+  @retval  EFI_UNSUPPORTED        MbedTLS has no run-time CPU feature
+                                  selection to report.
+**/
+EFI_STATUS
+EFIAPI
+GetCryptoProviderCpuFeatures (
+  OUT CRYPT_CPU_FEATURES  *Features
+  )
+{
+  if (Features == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  ZeroMem (Features, sizeof (*Features));
+  return EFI_UNSUPPORTED;
+}
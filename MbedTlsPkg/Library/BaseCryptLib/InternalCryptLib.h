@@ -71,4 +71,37 @@ WrapPkcs7Data (
   OUT UINTN        *WrapDataSize
   );
 
+/**
+  Work item procedure for DispatchItemsToAp ().
+
+  @param[in]  Context  Context passed to DispatchItemsToAp ().
+  @param[in]  Index    Index of the item to process.
+**/
+typedef
+VOID
+(EFIAPI *CRYPT_ITEM_PROCEDURE)(
+  IN VOID   *Context,
+  IN UINTN  Index
+  );
+
+/**
+  Run Procedure once for each of ItemCount independent items and return
+  when all of them are done.
+
+  This backend has no MP dispatch, so all items run on the calling
+  processor (see CryptDispatchItemsBsp.c). Procedure must still not rely on
+  that, so that callers behave the same with the OpenSSL backend.
+
+  @param[in]  Procedure  Procedure to run for each item.
+  @param[in]  Context    Context passed to Procedure.
+  @param[in]  ItemCount  Number of items.
+**/
+VOID
+EFIAPI
+DispatchItemsToAp (
+  IN CRYPT_ITEM_PROCEDURE  Procedure,
+  IN VOID                  *Context,
+  IN UINTN                 ItemCount
+  );
+
 #endif
@@ -10,6 +10,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "InternalCryptLib.h"
 #include <mbedtls/hkdf.h>
+#include <mbedtls/md.h>
+#include <CryptHkdfCtx.h>  // MU_CHANGE
 
 /**
   Derive HMAC-based Extract-and-Expand Key Derivation Function (HKDF).
@@ -370,3 +372,262 @@ HkdfSha384Expand (
 {
   return HkdfMdExpand (MBEDTLS_MD_SHA384, Prk, PrkSize, Info, InfoSize, Out, OutSize);
 }
+
+///
+/// HKDF-Expand context: an HMAC keyed with the PRK. mbedtls_md_hmac_reset ()
+/// restarts it from the saved inner pad without rehashing the PRK.
+///
+typedef struct {
+  mbedtls_md_context_t    Md;
+  UINTN                   HashSize;
+} HKDF_EXPAND_CTX;
+
+/**
+  Allocate an HKDF-Expand context and key its HMAC with the PRK.
+
+  @param[in]   MdType           Message Digest Type.
+  @param[in]   Prk              Pointer to the pseudorandom key.
+  @param[in]   PrkSize          Key size in bytes.
+
+  @return  Pointer to the HKDF-Expand context, or NULL on failure.
+
+**/
+STATIC
+VOID *
+HkdfMdExpandCtxNew (
+  IN   mbedtls_md_type_t  MdType,
+  IN   CONST UINT8        *Prk,
+  IN   UINTN              PrkSize
+  )
+{
+  HKDF_EXPAND_CTX          *Ctx;
+  const mbedtls_md_info_t  *md;
+
+  if ((Prk == NULL) || (PrkSize == 0) || (PrkSize > INT_MAX)) {
+    return NULL;
+  }
+
+  md = mbedtls_md_info_from_type (MdType);
+  ASSERT (md != NULL);
+
+  Ctx = AllocateZeroPool (sizeof (HKDF_EXPAND_CTX));
+  if (Ctx == NULL) {
+    return NULL;
+  }
+
+  mbedtls_md_init (&Ctx->Md);
+  Ctx->HashSize = mbedtls_md_get_size (md);
+
+  if ((mbedtls_md_setup (&Ctx->Md, md, 1) != 0) ||
+      (mbedtls_md_hmac_starts (&Ctx->Md, Prk, PrkSize) != 0))
+  {
+    mbedtls_md_free (&Ctx->Md);
+    FreePool (Ctx);
+    return NULL;
+  }
+
+  return Ctx;
+}
+
+/**
+  Allocate an HKDF-Expand context for SHA256 and key it with a PRK.
+
+  HMAC is keyed once here. Each HkdfExpandCtx () call then starts from the
+  saved inner and outer pad state instead of hashing the PRK again, which is
+  cheaper when a key schedule derives several secrets from one PRK.
+
+  @param[in]   Prk              Pointer to the pseudorandom key.
+  @param[in]   PrkSize          Key size in bytes.
+
+  @return  Pointer to the HKDF-Expand context, or NULL on failure. Free it
+           with HkdfExpandCtxFree ().
+
+**/
+VOID *
+EFIAPI
+HkdfSha256ExpandCtxNew (
+  IN   CONST UINT8  *Prk,
+  IN   UINTN        PrkSize
+  )
+{
+  return HkdfMdExpandCtxNew (MBEDTLS_MD_SHA256, Prk, PrkSize);
+}
+
+/**
+  Allocate an HKDF-Expand context for SHA384 and key it with a PRK.
+
+  HMAC is keyed once here. Each HkdfExpandCtx () call then starts from the
+  saved inner and outer pad state instead of hashing the PRK again, which is
+  cheaper when a key schedule derives several secrets from one PRK.
+
+  @param[in]   Prk              Pointer to the pseudorandom key.
+  @param[in]   PrkSize          Key size in bytes.
+
+  @return  Pointer to the HKDF-Expand context, or NULL on failure. Free it
+           with HkdfExpandCtxFree ().
+
+**/
+VOID *
+EFIAPI
+HkdfSha384ExpandCtxNew (
+  IN   CONST UINT8  *Prk,
+  IN   UINTN        PrkSize
+  )
+{
+  return HkdfMdExpandCtxNew (MBEDTLS_MD_SHA384, Prk, PrkSize);
+}
+
+/**
+  Derive HMAC-based Expand Key Derivation Function (HKDF) output from the PRK
+  held by an HKDF-Expand context.
+
+  The context can be used for any number of calls.
+
+  @param[in]   HkdfCtx          Context from HkdfSha256ExpandCtxNew () or
+                                HkdfSha384ExpandCtxNew ().
+  @param[in]   Info             Pointer to the application specific info. May
+                                be NULL if InfoSize is 0.
+  @param[in]   InfoSize         Info size in bytes.
+  @param[out]  Out              Pointer to buffer to receive hkdf value.
+  @param[in]   OutSize          Size of hkdf bytes to generate. At most 255
+                                times the digest size.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+
+**/
+BOOLEAN
+EFIAPI
+HkdfExpandCtx (
+  IN   VOID         *HkdfCtx,
+  IN   CONST UINT8  *Info,
+  IN   UINTN        InfoSize,
+  OUT  UINT8        *Out,
+  IN   UINTN        OutSize
+  )
+{
+  HKDF_EXPAND_CTX  *Ctx;
+  UINT8            Block[SHA384_DIGEST_SIZE];
+  UINT8            Counter;
+  UINTN            Done;
+  UINTN            Length;
+  INT32            Ret;
+
+  Ctx = (HKDF_EXPAND_CTX *)HkdfCtx;
+  if ((Ctx == NULL) || (Out == NULL) || ((Info == NULL) && (InfoSize != 0))) {
+    return FALSE;
+  }
+
+  if ((OutSize == 0) || (OutSize > 255 * Ctx->HashSize)) {
+    return FALSE;
+  }
+
+  //
+  // T(i) = HMAC (PRK, T(i-1) || Info || i), with T(0) empty (RFC 5869).
+  //
+  Ret = 0;
+  for (Done = 0, Counter = 1; (Ret == 0) && (Done < OutSize); Counter++) {
+    Ret = mbedtls_md_hmac_reset (&Ctx->Md);
+    if ((Ret == 0) && (Counter > 1)) {
+      Ret = mbedtls_md_hmac_update (&Ctx->Md, Block, Ctx->HashSize);
+    }
+
+    if ((Ret == 0) && (InfoSize != 0)) {
+      Ret = mbedtls_md_hmac_update (&Ctx->Md, Info, InfoSize);
+    }
+
+    if (Ret == 0) {
+      Ret = mbedtls_md_hmac_update (&Ctx->Md, &Counter, 1);
+    }
+
+    if (Ret == 0) {
+      Ret = mbedtls_md_hmac_finish (&Ctx->Md, Block);
+    }
+
+    if (Ret == 0) {
+      Length = MIN (OutSize - Done, Ctx->HashSize);
+      CopyMem (Out + Done, Block, Length);
+      Done += Length;
+    }
+  }
+
+  //
+  // Never hand back a partial key stream.
+  //
+  if (Ret != 0) {
+    ZeroMem (Out, OutSize);
+  }
+
+  ZeroMem (Block, sizeof (Block));
+  return Ret == 0;
+}
+
+/**
+  Derive several HKDF-Expand outputs, one per label, from the PRK held by an
+  HKDF-Expand context.
+
+  Entry Index of each array describes one output, as for HkdfExpandCtx ().
+  Outputs are derived in order and processing stops at the first failure.
+
+  @param[in]   HkdfCtx          Context from HkdfSha256ExpandCtxNew () or
+                                HkdfSha384ExpandCtxNew ().
+  @param[in]   Info             Array of LabelCount info pointers.
+  @param[in]   InfoSize         Array of LabelCount info sizes in bytes.
+  @param[out]  Out              Array of LabelCount output buffers.
+  @param[in]   OutSize          Array of LabelCount output sizes in bytes.
+  @param[in]   LabelCount       Number of outputs to derive.
+
+  @retval TRUE   All outputs generated successfully.
+  @retval FALSE  Invalid parameter, or an output could not be generated.
+
+**/
+BOOLEAN
+EFIAPI
+HkdfExpandCtxBatch (
+  IN   VOID         *HkdfCtx,
+  IN   CONST UINT8  **Info,
+  IN   CONST UINTN  *InfoSize,
+  OUT  UINT8        **Out,
+  IN   CONST UINTN  *OutSize,
+  IN   UINTN        LabelCount
+  )
+{
+  UINTN  Index;
+
+  if ((HkdfCtx == NULL) || (LabelCount == 0) ||
+      (Info == NULL) || (InfoSize == NULL) || (Out == NULL) || (OutSize == NULL))
+  {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < LabelCount; Index++) {
+    if (!HkdfExpandCtx (HkdfCtx, Info[Index], InfoSize[Index], Out[Index], OutSize[Index])) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Release an HKDF-Expand context. The keyed HMAC state is cleared.
+
+  @param[in]  HkdfCtx  Context to release. May be NULL.
+
+**/
+VOID
+EFIAPI
+HkdfExpandCtxFree (
+  IN  VOID  *HkdfCtx
+  )
+{
+  HKDF_EXPAND_CTX  *Ctx;
+
+  Ctx = (HKDF_EXPAND_CTX *)HkdfCtx;
+  if (Ctx == NULL) {
+    return;
+  }
+
+  mbedtls_md_free (&Ctx->Md);
+  FreePool (Ctx);
+}
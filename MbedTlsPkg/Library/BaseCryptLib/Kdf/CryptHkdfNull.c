@@ -8,6 +8,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include <Library/BaseCryptLib.h>
 #include <Library/DebugLib.h>
+#include <CryptHkdfCtx.h>  // MU_CHANGE
 
 /**
   Derive key data using HMAC-SHA256 based KDF.
@@ -190,3 +191,135 @@ HkdfSha384Expand (
   ASSERT (FALSE);
   return FALSE;
 }
+
+/**
+  Allocate an HKDF-Expand context for SHA256 and key it with a PRK.
+
+  HMAC is keyed once here. Each HkdfExpandCtx () call then starts from the
+  saved inner and outer pad state instead of hashing the PRK again, which is
+  cheaper when a key schedule derives several secrets from one PRK.
+
+  @param[in]   Prk              Pointer to the pseudorandom key.
+  @param[in]   PrkSize          Key size in bytes.
+
+  @return  Pointer to the HKDF-Expand context, or NULL on failure. Free it
+           with HkdfExpandCtxFree ().
+
+**/
+VOID *
+EFIAPI
+HkdfSha256ExpandCtxNew (
+  IN   CONST UINT8  *Prk,
+  IN   UINTN        PrkSize
+  )
+{
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Allocate an HKDF-Expand context for SHA384 and key it with a PRK.
+
+  HMAC is keyed once here. Each HkdfExpandCtx () call then starts from the
+  saved inner and outer pad state instead of hashing the PRK again, which is
+  cheaper when a key schedule derives several secrets from one PRK.
+
+  @param[in]   Prk              Pointer to the pseudorandom key.
+  @param[in]   PrkSize          Key size in bytes.
+
+  @return  Pointer to the HKDF-Expand context, or NULL on failure. Free it
+           with HkdfExpandCtxFree ().
+
+**/
+VOID *
+EFIAPI
+HkdfSha384ExpandCtxNew (
+  IN   CONST UINT8  *Prk,
+  IN   UINTN        PrkSize
+  )
+{
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Derive HMAC-based Expand Key Derivation Function (HKDF) output from the PRK
+  held by an HKDF-Expand context.
+
+  The context can be used for any number of calls.
+
+  @param[in]   HkdfCtx          Context from HkdfSha256ExpandCtxNew () or
+                                HkdfSha384ExpandCtxNew ().
+  @param[in]   Info             Pointer to the application specific info. May
+                                be NULL if InfoSize is 0.
+  @param[in]   InfoSize         Info size in bytes.
+  @param[out]  Out              Pointer to buffer to receive hkdf value.
+  @param[in]   OutSize          Size of hkdf bytes to generate. At most 255
+                                times the digest size.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+
+**/
+BOOLEAN
+EFIAPI
+HkdfExpandCtx (
+  IN   VOID         *HkdfCtx,
+  IN   CONST UINT8  *Info,
+  IN   UINTN        InfoSize,
+  OUT  UINT8        *Out,
+  IN   UINTN        OutSize
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+/**
+  Derive several HKDF-Expand outputs, one per label, from the PRK held by an
+  HKDF-Expand context.
+
+  Entry Index of each array describes one output, as for HkdfExpandCtx ().
+  Outputs are derived in order and processing stops at the first failure.
+
+  @param[in]   HkdfCtx          Context from HkdfSha256ExpandCtxNew () or
+                                HkdfSha384ExpandCtxNew ().
+  @param[in]   Info             Array of LabelCount info pointers.
+  @param[in]   InfoSize         Array of LabelCount info sizes in bytes.
+  @param[out]  Out              Array of LabelCount output buffers.
+  @param[in]   OutSize          Array of LabelCount output sizes in bytes.
+  @param[in]   LabelCount       Number of outputs to derive.
+
+  @retval TRUE   All outputs generated successfully.
+  @retval FALSE  Invalid parameter, or an output could not be generated.
+
+**/
+BOOLEAN
+EFIAPI
+HkdfExpandCtxBatch (
+  IN   VOID         *HkdfCtx,
+  IN   CONST UINT8  **Info,
+  IN   CONST UINTN  *InfoSize,
+  OUT  UINT8        **Out,
+  IN   CONST UINTN  *OutSize,
+  IN   UINTN        LabelCount
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+/**
+  Release an HKDF-Expand context. The keyed HMAC state is cleared.
+
+  @param[in]  HkdfCtx  Context to release. May be NULL.
+
+**/
+VOID
+EFIAPI
+HkdfExpandCtxFree (
+  IN  VOID  *HkdfCtx
+  )
+{
+  ASSERT (FALSE);
+}
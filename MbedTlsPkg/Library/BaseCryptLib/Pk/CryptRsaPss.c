@@ -3,6 +3,7 @@
 
   This file implements following APIs which provide basic capabilities for RSA:
   1) RsaPssVerify
+  2) RsaPssVerifyDigest
 
 Copyright (c) 2023, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
@@ -13,6 +14,96 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <mbedtls/rsa.h>
 #include <mbedtls/sha256.h>
 #include <mbedtls/sha512.h>
+#include <CryptSigVerify.h>  // MU_CHANGE
+
+/**
+  Verifies the RSA signature with RSASSA-PSS signature scheme defined in RFC 8017,
+  over a message digest computed by the caller.
+
+  This is RsaPssVerify () for callers that hash the message themselves, e.g.
+  incrementally while reading it. The digest algorithm is selected by
+  HashSize, and the mask generation function uses the same algorithm.
+  Salt length should be equal to digest length.
+
+  @param[in]  RsaContext      Pointer to RSA context for signature verification.
+  @param[in]  MessageHash     Pointer to octet message hash to be checked.
+  @param[in]  HashSize        Size of the message hash in bytes: 32, 48 or 64.
+  @param[in]  Signature       Pointer to RSASSA-PSS signature to be verified.
+  @param[in]  SigSize         Size of signature in bytes.
+  @param[in]  SaltLen         Salt length for PSS encoding.
+
+  @retval  TRUE   Valid signature encoded in RSASSA-PSS.
+  @retval  FALSE  Invalid signature or invalid RSA context.
+
+**/
+BOOLEAN
+EFIAPI
+RsaPssVerifyDigest (
+  IN  VOID         *RsaContext,
+  IN  CONST UINT8  *MessageHash,
+  IN  UINTN        HashSize,
+  IN  CONST UINT8  *Signature,
+  IN  UINTN        SigSize,
+  IN  UINT16       SaltLen
+  )
+{
+  INT32                Ret;
+  mbedtls_md_type_t    MdAlg;
+  mbedtls_rsa_context  *RsaKey;
+
+  if ((RsaContext == NULL) || (MessageHash == NULL)) {
+    return FALSE;
+  }
+
+  if (SaltLen != HashSize) {
+    return FALSE;
+  }
+
+  if ((Signature == NULL) || (SigSize == 0) || (SigSize > INT_MAX)) {
+    return FALSE;
+  }
+
+  switch (HashSize) {
+    case SHA256_DIGEST_SIZE:
+      MdAlg = MBEDTLS_MD_SHA256;
+      break;
+
+    case SHA384_DIGEST_SIZE:
+      MdAlg = MBEDTLS_MD_SHA384;
+      break;
+
+    case SHA512_DIGEST_SIZE:
+      MdAlg = MBEDTLS_MD_SHA512;
+      break;
+
+    default:
+      return FALSE;
+  }
+
+  RsaKey = (mbedtls_rsa_context *)RsaContext;
+  if (mbedtls_rsa_complete (RsaKey) != 0) {
+    return FALSE;
+  }
+
+  if (mbedtls_rsa_get_len (RsaKey) != SigSize) {
+    return FALSE;
+  }
+
+  mbedtls_rsa_set_padding (RsaKey, MBEDTLS_RSA_PKCS_V21, MdAlg);
+
+  Ret = mbedtls_rsa_rsassa_pss_verify (
+          RsaKey,
+          MdAlg,
+          (UINT32)HashSize,
+          MessageHash,
+          Signature
+          );
+  if (Ret != 0) {
+    return FALSE;
+  }
+
+  return TRUE;
+}
 
 /**
   Verifies the RSA signature with RSASSA-PSS signature scheme defined in RFC 8017.
@@ -44,10 +135,7 @@ RsaPssVerify (
   IN  UINT16       SaltLen
   )
 {
-  INT32                Ret;
-  mbedtls_md_type_t    MdAlg;
-  UINT8                HashValue[SHA512_DIGEST_SIZE];
-  mbedtls_rsa_context  *RsaKey;
+  UINT8  HashValue[SHA512_DIGEST_SIZE];
 
   if (RsaContext == NULL) {
     return FALSE;
@@ -65,16 +153,8 @@ RsaPssVerify (
     return FALSE;
   }
 
-  RsaKey = (mbedtls_rsa_context *)RsaContext;
-  if (mbedtls_rsa_complete (RsaKey) != 0) {
-    return FALSE;
-  }
-
-  ZeroMem (HashValue, DigestLen);
-
   switch (DigestLen) {
     case SHA256_DIGEST_SIZE:
-      MdAlg = MBEDTLS_MD_SHA256;
       if (mbedtls_sha256 (Message, MsgSize, HashValue, FALSE) != 0) {
         return FALSE;
       }
@@ -82,7 +162,6 @@ RsaPssVerify (
       break;
 
     case SHA384_DIGEST_SIZE:
-      MdAlg = MBEDTLS_MD_SHA384;
       if (mbedtls_sha512 (Message, MsgSize, HashValue, TRUE) != 0) {
         return FALSE;
       }
@@ -90,7 +169,6 @@ RsaPssVerify (
       break;
 
     case SHA512_DIGEST_SIZE:
-      MdAlg = MBEDTLS_MD_SHA512;
       if (mbedtls_sha512 (Message, MsgSize, HashValue, FALSE) != 0) {
         return FALSE;
       }
@@ -101,22 +179,5 @@ RsaPssVerify (
       return FALSE;
   }
 
-  if (mbedtls_rsa_get_len (RsaContext) != SigSize) {
-    return FALSE;
-  }
-
-  mbedtls_rsa_set_padding (RsaContext, MBEDTLS_RSA_PKCS_V21, MdAlg);
-
-  Ret = mbedtls_rsa_rsassa_pss_verify (
-          RsaContext,
-          MdAlg,
-          (UINT32)DigestLen,
-          HashValue,
-          Signature
-          );
-  if (Ret != 0) {
-    return FALSE;
-  }
-
-  return TRUE;
+  return RsaPssVerifyDigest (RsaContext, HashValue, DigestLen, Signature, SigSize, SaltLen);
 }
@@ -3,6 +3,7 @@
 
   This file does not provide real capabilities for following APIs in RSA handling:
   1) RsaPssVerify
+  2) RsaPssVerifyDigest
 
 Copyright (c) 2023, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
@@ -10,6 +11,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 
 #include "InternalCryptLib.h"
+#include <CryptSigVerify.h>  // MU_CHANGE
 
 /**
   Verifies the RSA signature with RSASSA-PSS signature scheme defined in RFC 8017.
@@ -44,3 +46,38 @@ RsaPssVerify (
   ASSERT (FALSE);
   return FALSE;
 }
+
+/**
+  Verifies the RSA signature with RSASSA-PSS signature scheme defined in RFC 8017,
+  over a message digest computed by the caller.
+
+  This is RsaPssVerify () for callers that hash the message themselves, e.g.
+  incrementally while reading it. The digest algorithm is selected by
+  HashSize, and the mask generation function uses the same algorithm.
+  Salt length should be equal to digest length.
+
+  @param[in]  RsaContext      Pointer to RSA context for signature verification.
+  @param[in]  MessageHash     Pointer to octet message hash to be checked.
+  @param[in]  HashSize        Size of the message hash in bytes: 32, 48 or 64.
+  @param[in]  Signature       Pointer to RSASSA-PSS signature to be verified.
+  @param[in]  SigSize         Size of signature in bytes.
+  @param[in]  SaltLen         Salt length for PSS encoding.
+
+  @retval  TRUE   Valid signature encoded in RSASSA-PSS.
+  @retval  FALSE  Invalid signature or invalid RSA context.
+
+**/
+BOOLEAN
+EFIAPI
+RsaPssVerifyDigest (
+  IN  VOID         *RsaContext,
+  IN  CONST UINT8  *MessageHash,
+  IN  UINTN        HashSize,
+  IN  CONST UINT8  *Signature,
+  IN  UINTN        SigSize,
+  IN  UINT16       SaltLen
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
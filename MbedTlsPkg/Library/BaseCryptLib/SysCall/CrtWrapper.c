@@ -44,7 +44,7 @@ strchr (
   int         ch
   )
 {
-  return ScanMem8 (str, AsciiStrSize (str), (char)ch);
+  return CrtStrChr (str, (CHAR8)ch); // MU_CHANGE
 }
 
 char *
@@ -74,7 +74,7 @@ strcmp (
   const char  *s2
   )
 {
-  return (int)AsciiStrCmp (s1, s2);
+  return (int)CrtStrCmp (s1, s2); // MU_CHANGE
 }
 
 /**strpbrk function. **/
@@ -84,15 +84,5 @@ strpbrk (
   const char  *accept
   )
 {
-  int  i;
-
-  for ( ; *s != '\0'; s++) {
-    for (i = 0; accept[i] != '\0'; i++) {
-      if (*s == accept[i]) {
-        return (char *)s;
-      }
-    }
-  }
-
-  return NULL;
+  return CrtStrPbrk (s, accept); // MU_CHANGE
 }
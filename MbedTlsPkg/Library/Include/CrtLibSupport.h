@@ -439,6 +439,88 @@ memcpy (
   size_t      n
   );
 
+// MU_CHANGE [BEGIN]
+//
+// Word-at-a-time string routines, see SysCall/CrtString.c.
+//
+UINTN
+EFIAPI
+CrtStrnLen (
+  IN CONST CHAR8  *String,
+  IN UINTN        MaxLength
+  );
+
+INTN
+EFIAPI
+CrtStrnCmp (
+  IN CONST CHAR8  *First,
+  IN CONST CHAR8  *Second,
+  IN UINTN        Length
+  );
+
+INTN
+EFIAPI
+CrtStrCmp (
+  IN CONST CHAR8  *First,
+  IN CONST CHAR8  *Second
+  );
+
+CHAR8 *
+EFIAPI
+CrtStrChr (
+  IN CONST CHAR8  *String,
+  IN CHAR8        Char
+  );
+
+CHAR8 *
+EFIAPI
+CrtStrRChr (
+  IN CONST CHAR8  *String,
+  IN CHAR8        Char
+  );
+
+UINTN
+EFIAPI
+CrtStrSpn (
+  IN CONST CHAR8  *String,
+  IN CONST CHAR8  *Accept
+  );
+
+UINTN
+EFIAPI
+CrtStrCspn (
+  IN CONST CHAR8  *String,
+  IN CONST CHAR8  *Reject
+  );
+
+CHAR8 *
+EFIAPI
+CrtStrPbrk (
+  IN CONST CHAR8  *String,
+  IN CONST CHAR8  *Accept
+  );
+
+//
+// Introsort behind qsort(), see SysCall/CrtSort.c.
+//
+typedef
+int
+(*CRT_SORT_COMPARE)(
+  CONST VOID  *Element1,
+  CONST VOID  *Element2
+  );
+
+VOID
+EFIAPI
+CrtQuickSort (
+  IN OUT VOID              *Base,
+  IN     UINTN             Count,
+  IN     UINTN             Width,
+  IN     CRT_SORT_COMPARE  Compare
+  );
+
+// MU_CHANGE [END]
+
 //
 // Macros that directly map functions to BaseLib, BaseMemoryLib, and DebugLib functions
 //
@@ -446,8 +528,8 @@ memcpy (
 #define memchr(buf, ch, count)            ScanMem8(buf,(UINTN)(count),(UINT8)ch)
 #define memcmp(buf1, buf2, count)         (int)(CompareMem(buf1,buf2,(UINTN)(count)))
 #define memmove(dest, source, count)      CopyMem(dest,source,(UINTN)(count))
-#define strlen(str)                       (size_t)(AsciiStrnLenS(str,MAX_STRING_SIZE))
-#define strncmp(string1, string2, count)  (int)(AsciiStrnCmp(string1,string2,(UINTN)(count)))
+#define strlen(str)                       (size_t)(CrtStrnLen(str,MAX_STRING_SIZE))          // MU_CHANGE
+#define strncmp(string1, string2, count)  (int)(CrtStrnCmp(string1,string2,(UINTN)(count))) // MU_CHANGE
 #define strcasecmp(str1, str2)            (int)AsciiStriCmp(str1,str2)
 #define strstr(s1, s2)                    AsciiStrStr(s1,s2)
 #define sprintf(buf, ...)                 AsciiSPrint(buf,MAX_STRING_SIZE,__VA_ARGS__)
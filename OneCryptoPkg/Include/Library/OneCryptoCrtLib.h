@@ -83,6 +83,29 @@ OneCryptoFreePool (
   IN VOID  *Buffer
   );
 
+/**
+  Resizes a buffer allocated by OneCryptoAllocatePool.
+
+  The buffer is grown in place when the loader reports enough usable space
+  in the block, or handed to the loader's ReallocatePool when it provides
+  one. Otherwise a new zeroed buffer is allocated, the old contents copied
+  and OldBuffer freed. Bytes past OldSize are zeroed in every case.
+
+  @param[in]  OldSize    The size, in bytes, of OldBuffer.
+  @param[in]  NewSize    The size, in bytes, of the buffer to return.
+  @param[in]  OldBuffer  The buffer to resize. If NULL, a new buffer is allocated.
+
+  @retval  NULL    Allocation failed. OldBuffer is left untouched.
+  @retval  Others  A pointer to the resized buffer.
+**/
+VOID *
+EFIAPI
+OneCryptoReallocatePool (
+  IN UINTN  OldSize,
+  IN UINTN  NewSize,
+  IN VOID   *OldBuffer  OPTIONAL
+  );
+
 /**
   Get the current time from the platform.
 
@@ -133,6 +156,34 @@ OneCryptoMicroSecondDelay (
   IN UINTN  MicroSeconds
   );
 
+/**
+  Retrieves the current value of the platform performance counter.
+
+  @return     The current value of the performance counter, or 0 if the loader
+              did not provide one.
+**/
+UINT64
+EFIAPI
+OneCryptoGetPerformanceCounter (
+  VOID
+  );
+
+/**
+  Retrieves the frequency and range of the platform performance counter.
+
+  @param[out]  StartValue  Optional pointer to the counter start value.
+  @param[out]  EndValue    Optional pointer to the counter end value.
+
+  @return     The frequency in Hz, or 0 if the loader did not provide a
+              performance counter.
+**/
+UINT64
+EFIAPI
+OneCryptoGetPerformanceCounterProperties (
+  OUT UINT64  *StartValue  OPTIONAL,
+  OUT UINT64  *EndValue    OPTIONAL
+  );
+
 /**
   Print debug messages.
 
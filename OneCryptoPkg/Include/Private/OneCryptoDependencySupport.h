@@ -21,7 +21,7 @@
 // Major.Minor versioning scheme matching OneCryptoProtocol
 //
 #define ONE_CRYPTO_DEPENDENCIES_VERSION_MAJOR  1
-#define ONE_CRYPTO_DEPENDENCIES_VERSION_MINOR  0
+#define ONE_CRYPTO_DEPENDENCIES_VERSION_MINOR  2
 
 //
 // The names of the exported functions.
@@ -134,6 +134,69 @@ typedef UINTN (EFIAPI *MICRO_SECOND_DELAY)(
   IN UINTN  MicroSeconds
   );
 
+/**
+  Function pointer type for reading the performance counter.
+
+  Returns the current value of a free running performance counter. This is used
+  to measure the cost of crypto initialization and operations.
+
+  @return     The current value of the free running performance counter.
+**/
+typedef UINT64 (EFIAPI *GET_PERFORMANCE_COUNTER)(
+  VOID
+  );
+
+/**
+  Function pointer type for reading the performance counter properties.
+
+  @param[out]  StartValue  Optional pointer to the value the performance counter
+                           starts with when it rolls over.
+  @param[out]  EndValue    Optional pointer to the value the performance counter
+                           ends with before it rolls over.
+
+  @return     The frequency of the performance counter in Hz. Zero if no
+              performance counter is available.
+**/
+typedef UINT64 (EFIAPI *GET_PERFORMANCE_COUNTER_PROPERTIES)(
+  OUT UINT64  *StartValue  OPTIONAL,
+  OUT UINT64  *EndValue    OPTIONAL
+  );
+
+/**
+  Function pointer type for resizing a pool buffer.
+
+  Optional. Providers whose pool can grow or shrink a buffer in place should
+  do so and return OldBuffer; otherwise the call behaves like allocate, copy
+  the smaller of OldSize and NewSize bytes, and free OldBuffer. As with
+  MemoryAllocationLib ReallocatePool (), bytes past OldSize are zeroed.
+
+  @param[in]  OldSize    The size, in bytes, of OldBuffer.
+  @param[in]  NewSize    The size, in bytes, of the buffer to return.
+  @param[in]  OldBuffer  The buffer to resize. If NULL, a new buffer is allocated.
+
+  @retval NULL    Allocation failed. OldBuffer is left untouched.
+  @retval Other   Pointer to the resized buffer.
+**/
+typedef VOID *(EFIAPI *REALLOCATE_POOL)(
+  IN UINTN  OldSize,
+  IN UINTN  NewSize,
+  IN VOID   *OldBuffer  OPTIONAL
+  );
+
+/**
+  Function pointer type for querying the usable size of a pool buffer.
+
+  Optional. Pools usually round requests up; reporting the real size of the
+  block lets OneCrypto grow a buffer in place without calling the provider.
+
+  @param[in]  Buffer  A buffer returned by ALLOCATE_POOL or REALLOCATE_POOL.
+
+  @return     The number of bytes usable at Buffer, or 0 if unknown.
+**/
+typedef UINTN (EFIAPI *GET_POOL_USABLE_SIZE)(
+  IN VOID  *Buffer
+  );
+
 /**
   Structure to hold function pointers for shared crypto dependencies.
 
@@ -148,15 +211,25 @@ typedef struct  _ONE_CRYPTO_DEPENDENCIES {
   // Major - Breaking change to this structure
   // Minor - Functions added to the end of this structure
   //
-  UINT16                  Major;                ///< Version Major
-  UINT16                  Minor;                ///< Version Minor
-  UINT32                  Reserved;             ///< Padding for 8-byte alignment
-  ALLOCATE_POOL           AllocatePool;         ///< Memory allocation function
-  FREE_POOL               FreePool;             ///< Memory deallocation function
-  GET_TIME                GetTime;              ///< System time retrieval function
-  DEBUG_PRINT             DebugPrint;           ///< Debug message output function
-  GET_RANDOM_NUMBER_64    GetRandomNumber64;    ///< 64-bit random number generation function
-  MICRO_SECOND_DELAY      MicroSecondDelay;     ///< Microsecond delay function
+  UINT16                                Major;                           ///< Version Major
+  UINT16                                Minor;                           ///< Version Minor
+  UINT32                                Reserved;                        ///< Padding for 8-byte alignment
+  ALLOCATE_POOL                         AllocatePool;                    ///< Memory allocation function
+  FREE_POOL                             FreePool;                        ///< Memory deallocation function
+  GET_TIME                              GetTime;                         ///< System time retrieval function
+  DEBUG_PRINT                           DebugPrint;                      ///< Debug message output function
+  GET_RANDOM_NUMBER_64                  GetRandomNumber64;               ///< 64-bit random number generation function
+  MICRO_SECOND_DELAY                    MicroSecondDelay;                ///< Microsecond delay function
+  //
+  // Minor version 1
+  //
+  GET_PERFORMANCE_COUNTER               GetPerformanceCounter;           ///< Performance counter read function
+  GET_PERFORMANCE_COUNTER_PROPERTIES    GetPerformanceCounterProperties; ///< Performance counter frequency function
+  //
+  // Minor version 2
+  //
+  REALLOCATE_POOL                       ReallocatePool;                  ///< Optional in-place capable pool resize function
+  GET_POOL_USABLE_SIZE                  GetPoolUsableSize;               ///< Optional pool block size query function
 } ONE_CRYPTO_DEPENDENCIES;
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -62,6 +62,37 @@ FreePool (
   OneCryptoFreePool (Buffer);
 }
 
+/**
+  Reallocates a buffer of type EfiBootServicesData.
+
+  Allocates and zeros the number bytes specified by NewSize from memory of type
+  EfiBootServicesData. If OldBuffer is not NULL, then the smaller of OldSize and NewSize bytes are
+  copied from OldBuffer to the newly allocated buffer, and OldBuffer is freed. A pointer to the
+  newly allocated buffer is returned. If NewSize is 0, then a valid buffer of 0 size is returned.
+  If there is not enough memory remaining to satisfy the request, then NULL is returned.
+
+  OldBuffer is grown in place instead when the loader's pool allows it; see
+  OneCryptoReallocatePool ().
+
+  @param[in]  OldSize    The size, in bytes, of OldBuffer.
+  @param[in]  NewSize    The size, in bytes, of the buffer to reallocate.
+  @param[in]  OldBuffer  The buffer to copy to the allocated buffer. This is an optional
+                         parameter that may be NULL.
+
+  @retval NULL   Allocation failed.
+  @retval Other  A pointer to the allocated buffer.
+**/
+VOID *
+EFIAPI
+ReallocatePool (
+  IN UINTN  OldSize,
+  IN UINTN  NewSize,
+  IN VOID   *OldBuffer  OPTIONAL
+  )
+{
+  return OneCryptoReallocatePool (OldSize, NewSize, OldBuffer);
+}
+
 //
 // Stub functions that are not used by Crypto providers today
 //
@@ -240,38 +271,6 @@ AllocateReservedCopyPool (
   return NULL;
 }
 
-/**
-  Reallocates a buffer of type EfiBootServicesData.
-
-  Allocates and zeros the number bytes specified by NewSize from memory of type
-  EfiBootServicesData. If OldBuffer is not NULL, then the smaller of OldSize and NewSize bytes are
-  copied from OldBuffer to the newly allocated buffer, and OldBuffer is freed. A pointer to the
-  newly allocated buffer is returned. If NewSize is 0, then a valid buffer of 0 size is returned.
-  If there is not enough memory remaining to satisfy the request, then NULL is returned.
-
-  If the allocation of the new buffer is successful and the smaller of NewSize and OldSize is
-  greater than (MAX_ADDRESS - OldBuffer + 1), then ASSERT().
-
-  @param[in]  OldSize    The size, in bytes, of OldBuffer.
-  @param[in]  NewSize    The size, in bytes, of the buffer to reallocate.
-  @param[in]  OldBuffer  The buffer to copy to the allocated buffer. This is an optional
-                         parameter that may be NULL.
-
-  @retval NULL   Allocation failed.
-  @retval Other  A pointer to the allocated buffer.
-**/
-VOID *
-EFIAPI
-ReallocatePool (
-  IN UINTN  OldSize,
-  IN UINTN  NewSize,
-  IN VOID   *OldBuffer  OPTIONAL
-  )
-{
-  ASSERT (FALSE);
-  return NULL;
-}
-
 /**
   Reallocates a buffer of type EfiRuntimeServicesData.
 
@@ -121,6 +121,59 @@ OneCryptoFreePool (
   mCryptoDependencies->FreePool (Buffer);
 }
 
+/**
+  Resizes a buffer allocated by OneCryptoAllocatePool.
+
+  The buffer is grown in place when the loader reports enough usable space
+  in the block, or handed to the loader's ReallocatePool when it provides
+  one. Otherwise a new zeroed buffer is allocated, the old contents copied
+  and OldBuffer freed. Bytes past OldSize are zeroed in every case.
+
+  @param[in]  OldSize    The size, in bytes, of OldBuffer.
+  @param[in]  NewSize    The size, in bytes, of the buffer to return.
+  @param[in]  OldBuffer  The buffer to resize. If NULL, a new buffer is allocated.
+
+  @retval  NULL    Allocation failed. OldBuffer is left untouched.
+  @retval  Others  A pointer to the resized buffer.
+**/
+VOID *
+EFIAPI
+OneCryptoReallocatePool (
+  IN UINTN  OldSize,
+  IN UINTN  NewSize,
+  IN VOID   *OldBuffer  OPTIONAL
+  )
+{
+  VOID  *NewBuffer;
+
+  if ((OldBuffer != NULL) && (mCryptoDependencies != NULL) && (mCryptoDependencies->Minor >= 2)) {
+    //
+    // Pools round requests up, so the block may already be large enough.
+    //
+    if ((mCryptoDependencies->GetPoolUsableSize != NULL) &&
+        (NewSize <= mCryptoDependencies->GetPoolUsableSize (OldBuffer)))
+    {
+      if (NewSize > OldSize) {
+        ZeroMem ((UINT8 *)OldBuffer + OldSize, NewSize - OldSize);
+      }
+
+      return OldBuffer;
+    }
+
+    if (mCryptoDependencies->ReallocatePool != NULL) {
+      return mCryptoDependencies->ReallocatePool (OldSize, NewSize, OldBuffer);
+    }
+  }
+
+  NewBuffer = OneCryptoAllocateZeroPool (NewSize);
+  if ((NewBuffer != NULL) && (OldBuffer != NULL)) {
+    CopyMem (NewBuffer, OldBuffer, MIN (OldSize, NewSize));
+    OneCryptoFreePool (OldBuffer);
+  }
+
+  return NewBuffer;
+}
+
 /**
   Retrieves the current time and date information, and the time-keeping capabilities of the hardware platform.
 
@@ -196,6 +249,65 @@ OneCryptoMicroSecondDelay (
   return mCryptoDependencies->MicroSecondDelay (MicroSeconds);
 }
 
+/**
+  Retrieves the current value of the platform performance counter.
+
+  The performance counter hooks were added in minor version 1 of the
+  dependency structure, so older loaders are treated as having no counter.
+
+  @return     The current value of the performance counter, or 0 if the loader
+              did not provide one.
+**/
+UINT64
+EFIAPI
+OneCryptoGetPerformanceCounter (
+  VOID
+  )
+{
+  if ((mCryptoDependencies == NULL) ||
+      (mCryptoDependencies->Minor < 1) ||
+      (mCryptoDependencies->GetPerformanceCounter == NULL))
+  {
+    return 0;
+  }
+
+  return mCryptoDependencies->GetPerformanceCounter ();
+}
+
+/**
+  Retrieves the frequency and range of the platform performance counter.
+
+  @param[out]  StartValue  Optional pointer to the counter start value.
+  @param[out]  EndValue    Optional pointer to the counter end value.
+
+  @return     The frequency in Hz, or 0 if the loader did not provide a
+              performance counter.
+**/
+UINT64
+EFIAPI
+OneCryptoGetPerformanceCounterProperties (
+  OUT UINT64  *StartValue  OPTIONAL,
+  OUT UINT64  *EndValue    OPTIONAL
+  )
+{
+  if ((mCryptoDependencies == NULL) ||
+      (mCryptoDependencies->Minor < 1) ||
+      (mCryptoDependencies->GetPerformanceCounterProperties == NULL))
+  {
+    if (StartValue != NULL) {
+      *StartValue = 0;
+    }
+
+    if (EndValue != NULL) {
+      *EndValue = 0;
+    }
+
+    return 0;
+  }
+
+  return mCryptoDependencies->GetPerformanceCounterProperties (StartValue, EndValue);
+}
+
 /**
   Prints a debug message to the debug output device if the specified error level is enabled.
 
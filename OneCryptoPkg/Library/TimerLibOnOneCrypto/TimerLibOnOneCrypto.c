@@ -2,7 +2,7 @@
   Timer Library implementation for OneCrypto.
 
   This library provides TimerLib implementation for OneCrypto that calls into
-  OneCryptoCrtLib's MicroSecondDelay function pointer.
+  OneCryptoCrtLib's MicroSecondDelay and performance counter function pointers.
 
   Copyright (c) Microsoft Corporation.
   SPDX-License-Identifier: BSD-2-Clause-Patent
@@ -51,7 +51,7 @@ NanoSecondDelay (
 /**
   Retrieves the current value of a 64-bit free running performance counter.
 
-  This is a stub implementation that returns 0.
+  Returns 0 if the loader did not provide a performance counter.
 
   @return     The current value of the free running performance counter.
 
@@ -62,14 +62,14 @@ GetPerformanceCounter (
   VOID
   )
 {
-  return 0;
+  return OneCryptoGetPerformanceCounter ();
 }
 
 /**
   Retrieves the 64-bit frequency in Hz and the range of performance counter
   values.
 
-  This is a stub implementation.
+  Returns 0 if the loader did not provide a performance counter.
 
   @param[out]  StartValue  The value the performance counter starts with when
                            it rolls over.
@@ -86,21 +86,13 @@ GetPerformanceCounterProperties (
   OUT      UINT64  *EndValue     OPTIONAL
   )
 {
-  if (StartValue != NULL) {
-    *StartValue = 0;
-  }
-
-  if (EndValue != NULL) {
-    *EndValue = 0;
-  }
-
-  return 0;
+  return OneCryptoGetPerformanceCounterProperties (StartValue, EndValue);
 }
 
 /**
   Converts elapsed ticks of performance counter to time in nanoseconds.
 
-  This is a stub implementation that returns 0.
+  Returns 0 if the loader did not provide a performance counter.
 
   @param[in]  Ticks     The number of elapsed ticks of the performance counter.
 
@@ -113,5 +105,32 @@ GetTimeInNanoSecond (
   IN      UINT64  Ticks
   )
 {
-  return 0;
+  UINT64  Frequency;
+  UINT64  NanoSeconds;
+  UINT64  Remainder;
+  INTN    Shift;
+
+  Frequency = GetPerformanceCounterProperties (NULL, NULL);
+  if (Frequency == 0) {
+    return 0;
+  }
+
+  //
+  //          Ticks
+  // Time = --------- x 1,000,000,000
+  //        Frequency
+  //
+  NanoSeconds = MultU64x32 (DivU64x64Remainder (Ticks, Frequency, &Remainder), 1000000000u);
+
+  //
+  // Ensure (Remainder * 1,000,000,000) will not overflow 64-bit.
+  // Since 2^29 < 1,000,000,000 = 0x3B9ACA00 < 2^30, Remainder should < 2^(64-30) = 2^34,
+  // i.e. highest bit set in Remainder should <= 33.
+  //
+  Shift       = MAX (0, HighBitSet64 (Remainder) - 33);
+  Remainder   = RShiftU64 (Remainder, (UINTN)Shift);
+  Frequency   = RShiftU64 (Frequency, (UINTN)Shift);
+  NanoSeconds += DivU64x64Remainder (MultU64x32 (Remainder, 1000000000u), Frequency, NULL);
+
+  return NanoSeconds;
 }
@@ -8,6 +8,7 @@
 **/
 
 #include <Library/DebugLib.h>
+#include <Library/PcdLib.h>
 #include <Library/OneCryptoCrtLib.h>
 #include <Library/BaseCryptLib.h>
 #include <Library/TlsLib.h>
@@ -29,7 +30,9 @@ ONE_CRYPTO_CONSTRUCTOR_PROTOCOL  *mProtocolInstance = NULL;
   Initialize crypto functionality.
 
   This function populates the crypto protocol structure with function pointers
-  from BaseCryptLib implementations.
+  from BaseCryptLib implementations. The OpensslPkg extensions declared in
+  OpensslPkg/Include have no protocol members and are not published; see
+  "Functions Outside the Protocol" in Docs/Architecture.md.
 
   @param[in] CryptoProtocol  Pointer to crypto protocol structure to initialize.
 **/
@@ -406,6 +409,15 @@ NoSetupCryptoEntry (
   //
   CryptoInit (*Crypto);
 
+  //
+  // Optionally route the first call into each subsystem through a gate that
+  // times it. Nothing is deferred: the subsystems are set up as before, the
+  // gates only record how long the first use takes.
+  //
+  if (FeaturePcdGet (PcdOneCryptoMeasureSubsystemInit)) {
+    OneCryptoInstallMeasureGates (*Crypto);
+  }
+
   return EFI_SUCCESS;
 }
 
@@ -419,6 +431,8 @@ NoSetupCryptoEntry (
   When OneCrypto loads DXE binaries, the build system's normal library constructor
   mechanism does not run. Therefore, this entry point explicitly calls BaseCryptInit()
   to initialize the OpenSSL library before delegating to NoSetupCryptoEntry.
+  The dependencies are installed first so the cost of BaseCryptInit() can be
+  measured and reported.
 
   Architecture Overview:
   ----------------------
@@ -458,10 +472,21 @@ CryptoEntry (
 {
   EFI_STATUS  Status;
 
+  //
+  // Install the dependencies so the setup below can use the performance counter
+  // and debug output
+  //
+  if (Depends != NULL) {
+    Status = OneCryptoCrtSetup (Depends);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
   //
   // Perform crypto setup
   //
-  Status = BaseCryptInit ();
+  Status = OneCryptoCoreInit ();
   if (EFI_ERROR (Status)) {
     return Status;
   }
@@ -42,4 +42,39 @@ NoSetupCryptoEntry (
   OUT UINT32                  *CryptoSize
   );
 
+//
+// Subsystems whose first use is timed when PcdOneCryptoMeasureSubsystemInit is TRUE
+//
+typedef enum {
+  OneCryptoSubsystemCore,
+  OneCryptoSubsystemTls,
+  OneCryptoSubsystemEc,
+  OneCryptoSubsystemDh,
+  OneCryptoSubsystemX509,
+  OneCryptoSubsystemMax
+} ONE_CRYPTO_SUBSYSTEM;
+
+/**
+  Run the core crypto setup (BaseCryptInit) and record its cost.
+
+  @retval EFI_SUCCESS  The core setup completed or had already completed.
+  @retval other        Error from BaseCryptInit.
+**/
+EFI_STATUS
+OneCryptoCoreInit (
+  VOID
+  );
+
+/**
+  Replace subsystem entry points in the protocol with their measuring gates.
+
+  Must be called after CryptoInit has populated the protocol.
+
+  @param[in,out] CryptoProtocol  Pointer to the crypto protocol structure.
+**/
+VOID
+OneCryptoInstallMeasureGates (
+  IN OUT ONE_CRYPTO_PROTOCOL  *CryptoProtocol
+  );
+
 #endif // ONE_CRYPTO_BIN_H_
@@ -0,0 +1,422 @@
+/** @file
+  Subsystem bring-up measurement for OneCryptoBin.
+
+  When PcdOneCryptoMeasureSubsystemInit is TRUE, the entry points that bring
+  up a heavyweight subsystem (TLS, EC, DH and X509 store verification) are
+  replaced with gates that time the first successful call and report it with
+  DEBUG_INFO. Later calls forward to the BaseCryptLib/TlsLib implementation
+  after a flag check.
+
+  This is instrumentation, not deferral. BaseCryptInit still runs in
+  CryptoEntry, and OpenSSL fetches provider algorithms on first use whether
+  or not the gates are installed. The only setup the gates move is
+  TlsInitialize, which runs on the first TLS call instead of when the
+  consumer calls it. The reported times show which part of the boot pays for
+  which part of crypto bring-up.
+
+  Copyright (C) Microsoft Corporation
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <Library/DebugLib.h>
+#include <Library/TimerLib.h>
+#include <Library/BaseCryptLib.h>
+#include <Library/TlsLib.h>
+#include <Protocol/OneCrypto.h>
+#include <CryptElapsedTime.h>
+#include "OneCryptoBin.h"
+
+//
+// Per-subsystem initialization state
+//
+typedef struct {
+  CONST CHAR8    *Name;
+  BOOLEAN        Initialized;
+  UINT64         InitNanoSeconds;
+} ONE_CRYPTO_SUBSYSTEM_STATE;
+
+STATIC ONE_CRYPTO_SUBSYSTEM_STATE  mSubsystemState[OneCryptoSubsystemMax] = {
+  { "Core", FALSE, 0 },
+  { "TLS",  FALSE, 0 },
+  { "EC",   FALSE, 0 },
+  { "DH",   FALSE, 0 },
+  { "X509", FALSE, 0 },
+};
+
+/**
+  Check whether a subsystem still needs its first-use setup.
+
+  @param[in]  Subsystem   The subsystem to check.
+  @param[out] StartTicks  Receives the performance counter when setup is pending.
+
+  @retval TRUE   The subsystem has not been initialized yet.
+  @retval FALSE  The subsystem is already initialized.
+**/
+STATIC
+BOOLEAN
+SubsystemInitPending (
+  IN  ONE_CRYPTO_SUBSYSTEM  Subsystem,
+  OUT UINT64                *StartTicks
+  )
+{
+  if (mSubsystemState[Subsystem].Initialized) {
+    return FALSE;
+  }
+
+  *StartTicks = GetPerformanceCounter ();
+  return TRUE;
+}
+
+/**
+  Mark a subsystem initialized and report its setup cost.
+
+  @param[in]  Subsystem   The subsystem that finished initializing.
+  @param[in]  StartTicks  Performance counter value when setup began.
+**/
+STATIC
+VOID
+SubsystemInitComplete (
+  IN ONE_CRYPTO_SUBSYSTEM  Subsystem,
+  IN UINT64                StartTicks
+  )
+{
+  mSubsystemState[Subsystem].Initialized     = TRUE;
+  mSubsystemState[Subsystem].InitNanoSeconds = CryptElapsedNanoSeconds (StartTicks, GetPerformanceCounter ());
+
+  DEBUG ((
+    DEBUG_INFO,
+    "OneCryptoBin: %a subsystem initialized in %lu ns\n",
+    mSubsystemState[Subsystem].Name,
+    mSubsystemState[Subsystem].InitNanoSeconds
+    ));
+}
+
+/**
+  Run the core crypto setup (BaseCryptInit) and record its cost.
+
+  @retval EFI_SUCCESS  The core setup completed or had already completed.
+  @retval other        Error from BaseCryptInit.
+**/
+EFI_STATUS
+OneCryptoCoreInit (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  UINT64      StartTicks;
+
+  if (!SubsystemInitPending (OneCryptoSubsystemCore, &StartTicks)) {
+    return EFI_SUCCESS;
+  }
+
+  Status = BaseCryptInit ();
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  SubsystemInitComplete (OneCryptoSubsystemCore, StartTicks);
+  return EFI_SUCCESS;
+}
+
+// ========================================================================================================
+// TLS gates
+// ========================================================================================================
+
+/**
+  Initialize the TLS subsystem on first use.
+
+  @retval TRUE   The TLS subsystem is ready.
+  @retval FALSE  TlsInitialize failed.
+**/
+STATIC
+BOOLEAN
+EnsureTlsSubsystem (
+  VOID
+  )
+{
+  UINT64  StartTicks;
+
+  if (!SubsystemInitPending (OneCryptoSubsystemTls, &StartTicks)) {
+    return TRUE;
+  }
+
+  if (!TlsInitialize ()) {
+    return FALSE;
+  }
+
+  SubsystemInitComplete (OneCryptoSubsystemTls, StartTicks);
+  return TRUE;
+}
+
+/**
+  Measuring gate for TlsInitialize.
+
+  @retval TRUE   The OpenSSL TLS library has been initialized.
+  @retval FALSE  Failed to initialize the OpenSSL TLS library.
+**/
+STATIC
+BOOLEAN
+EFIAPI
+MeasuredTlsInitialize (
+  VOID
+  )
+{
+  return EnsureTlsSubsystem ();
+}
+
+/**
+  Measuring gate for TlsCtxNew.
+
+  @param[in]  MajorVer    Major Version of TLS/SSL Protocol.
+  @param[in]  MinorVer    Minor Version of TLS/SSL Protocol.
+
+  @return  Pointer to an allocated SSL_CTX object, or NULL on failure.
+**/
+STATIC
+VOID *
+EFIAPI
+MeasuredTlsCtxNew (
+  IN UINT8  MajorVer,
+  IN UINT8  MinorVer
+  )
+{
+  if (!EnsureTlsSubsystem ()) {
+    return NULL;
+  }
+
+  return TlsCtxNew (MajorVer, MinorVer);
+}
+
+// ========================================================================================================
+// EC / DH gates
+// ========================================================================================================
+
+/**
+  Measuring gate for EcGroupInit.
+
+  @param[in]  CryptoNid   Identifying number for the ECC curve.
+
+  @return  Pointer to new EC group, or NULL on failure.
+**/
+STATIC
+VOID *
+EFIAPI
+MeasuredEcGroupInit (
+  IN UINTN  CryptoNid
+  )
+{
+  VOID    *EcGroup;
+  UINT64  StartTicks;
+
+  if (!SubsystemInitPending (OneCryptoSubsystemEc, &StartTicks)) {
+    return EcGroupInit (CryptoNid);
+  }
+
+  EcGroup = EcGroupInit (CryptoNid);
+  if (EcGroup != NULL) {
+    SubsystemInitComplete (OneCryptoSubsystemEc, StartTicks);
+  }
+
+  return EcGroup;
+}
+
+/**
+  Measuring gate for EcNewByNid.
+
+  @param[in]  Nid   Cipher NID.
+
+  @return  Pointer to the EC context, or NULL on failure.
+**/
+STATIC
+VOID *
+EFIAPI
+MeasuredEcNewByNid (
+  IN UINTN  Nid
+  )
+{
+  VOID    *EcContext;
+  UINT64  StartTicks;
+
+  if (!SubsystemInitPending (OneCryptoSubsystemEc, &StartTicks)) {
+    return EcNewByNid (Nid);
+  }
+
+  EcContext = EcNewByNid (Nid);
+  if (EcContext != NULL) {
+    SubsystemInitComplete (OneCryptoSubsystemEc, StartTicks);
+  }
+
+  return EcContext;
+}
+
+/**
+  Measuring gate for DhNew.
+
+  @return  Pointer to the DH context, or NULL on failure.
+**/
+STATIC
+VOID *
+EFIAPI
+MeasuredDhNew (
+  VOID
+  )
+{
+  VOID    *DhContext;
+  UINT64  StartTicks;
+
+  if (!SubsystemInitPending (OneCryptoSubsystemDh, &StartTicks)) {
+    return DhNew ();
+  }
+
+  DhContext = DhNew ();
+  if (DhContext != NULL) {
+    SubsystemInitComplete (OneCryptoSubsystemDh, StartTicks);
+  }
+
+  return DhContext;
+}
+
+// ========================================================================================================
+// X509 store gates
+// ========================================================================================================
+
+/**
+  Measuring gate for X509VerifyCert.
+
+  @param[in]  Cert         Pointer to the DER-encoded X509 certificate to be verified.
+  @param[in]  CertSize     Size of the X509 certificate in bytes.
+  @param[in]  CACert       Pointer to the DER-encoded trusted CA certificate.
+  @param[in]  CACertSize   Size of the CA Certificate in bytes.
+
+  @retval  TRUE   The certificate was issued by the trusted CA.
+  @retval  FALSE  Invalid certificate or the certificate was not issued by the given
+                  trusted CA.
+**/
+STATIC
+BOOLEAN
+EFIAPI
+MeasuredX509VerifyCert (
+  IN  CONST UINT8  *Cert,
+  IN  UINTN        CertSize,
+  IN  CONST UINT8  *CACert,
+  IN  UINTN        CACertSize
+  )
+{
+  BOOLEAN  Result;
+  UINT64   StartTicks;
+
+  if (!SubsystemInitPending (OneCryptoSubsystemX509, &StartTicks)) {
+    return X509VerifyCert (Cert, CertSize, CACert, CACertSize);
+  }
+
+  Result = X509VerifyCert (Cert, CertSize, CACert, CACertSize);
+  if (Result) {
+    SubsystemInitComplete (OneCryptoSubsystemX509, StartTicks);
+  }
+  return Result;
+}
+
+/**
+  Measuring gate for Pkcs7Verify.
+
+  @param[in]  P7Data       Pointer to the PKCS#7 message to verify.
+  @param[in]  P7Length     Length of the PKCS#7 message in bytes.
+  @param[in]  TrustedCert  Pointer to a trusted/root certificate encoded in DER.
+  @param[in]  CertLength   Length of the trusted certificate in bytes.
+  @param[in]  InData       Pointer to the content to be verified.
+  @param[in]  DataLength   Length of InData in bytes.
+
+  @retval  TRUE  The specified PKCS#7 signed data is valid.
+  @retval  FALSE Invalid PKCS#7 signed data.
+**/
+STATIC
+BOOLEAN
+EFIAPI
+MeasuredPkcs7Verify (
+  IN  CONST UINT8  *P7Data,
+  IN  UINTN        P7Length,
+  IN  CONST UINT8  *TrustedCert,
+  IN  UINTN        CertLength,
+  IN  CONST UINT8  *InData,
+  IN  UINTN        DataLength
+  )
+{
+  BOOLEAN  Result;
+  UINT64   StartTicks;
+
+  if (!SubsystemInitPending (OneCryptoSubsystemX509, &StartTicks)) {
+    return Pkcs7Verify (P7Data, P7Length, TrustedCert, CertLength, InData, DataLength);
+  }
+
+  Result = Pkcs7Verify (P7Data, P7Length, TrustedCert, CertLength, InData, DataLength);
+  if (Result) {
+    SubsystemInitComplete (OneCryptoSubsystemX509, StartTicks);
+  }
+  return Result;
+}
+
+/**
+  Measuring gate for AuthenticodeVerify.
+
+  @param[in]  AuthData     Pointer to the Authenticode Signature retrieved from signed
+                           PE/COFF image to be verified.
+  @param[in]  DataSize     Size of the Authenticode Signature in bytes.
+  @param[in]  TrustedCert  Pointer to a trusted/root certificate encoded in DER.
+  @param[in]  CertSize     Size of the trusted certificate in bytes.
+  @param[in]  ImageHash    Pointer to the original image file hash value.
+  @param[in]  HashSize     Size of Image hash value in bytes.
+
+  @retval  TRUE   The specified Authenticode Signature is valid.
+  @retval  FALSE  Invalid Authenticode Signature.
+**/
+STATIC
+BOOLEAN
+EFIAPI
+MeasuredAuthenticodeVerify (
+  IN  CONST UINT8  *AuthData,
+  IN  UINTN        DataSize,
+  IN  CONST UINT8  *TrustedCert,
+  IN  UINTN        CertSize,
+  IN  CONST UINT8  *ImageHash,
+  IN  UINTN        HashSize
+  )
+{
+  BOOLEAN  Result;
+  UINT64   StartTicks;
+
+  if (!SubsystemInitPending (OneCryptoSubsystemX509, &StartTicks)) {
+    return AuthenticodeVerify (AuthData, DataSize, TrustedCert, CertSize, ImageHash, HashSize);
+  }
+
+  Result = AuthenticodeVerify (AuthData, DataSize, TrustedCert, CertSize, ImageHash, HashSize);
+  if (Result) {
+    SubsystemInitComplete (OneCryptoSubsystemX509, StartTicks);
+  }
+  return Result;
+}
+
+/**
+  Replace subsystem entry points in the protocol with their measuring gates.
+
+  Must be called after CryptoInit has populated the protocol.
+
+  @param[in,out] CryptoProtocol  Pointer to the crypto protocol structure.
+**/
+VOID
+OneCryptoInstallMeasureGates (
+  IN OUT ONE_CRYPTO_PROTOCOL  *CryptoProtocol
+  )
+{
+  if (CryptoProtocol == NULL) {
+    return;
+  }
+
+  CryptoProtocol->TlsInitialize      = MeasuredTlsInitialize;
+  CryptoProtocol->TlsCtxNew          = MeasuredTlsCtxNew;
+  CryptoProtocol->EcGroupInit        = MeasuredEcGroupInit;
+  CryptoProtocol->EcNewByNid         = MeasuredEcNewByNid;
+  CryptoProtocol->DhNew              = MeasuredDhNew;
+  CryptoProtocol->X509VerifyCert     = MeasuredX509VerifyCert;
+  CryptoProtocol->Pkcs7Verify        = MeasuredPkcs7Verify;
+  CryptoProtocol->AuthenticodeVerify = MeasuredAuthenticodeVerify;
+}
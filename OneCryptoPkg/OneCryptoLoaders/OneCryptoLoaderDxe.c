@@ -20,6 +20,7 @@
 #include <Library/DxeServicesLib.h>
 #include <Library/DebugLib.h>
 #include <Library/RngLib.h>
+#include <Library/TimerLib.h>
 #include <Library/PeCoffGetEntryPointLib.h>
 #include <Library/PeCoffExtendedLib.h>
 #include <Library/PeCoffLib.h>
@@ -27,6 +28,7 @@
 #include <Protocol/OneCrypto.h>
 #include <Protocol/LoadedImage.h>
 #include <Private/OneCryptoDependencySupport.h>
+#include <CryptElapsedTime.h>
 #include <Guid/OneCryptoFileGuid.h>
 
 #define EFI_SECTION_PE32  0x10
@@ -137,6 +139,17 @@ InstallSharedDependencies (
   // gBS->Stall is only being provided to be consistent with upstream
   //
   OneCryptoDepends->MicroSecondDelay = gBS->Stall;
+  //
+  // Performance counter is used by OneCrypto to measure initialization cost
+  //
+  OneCryptoDepends->GetPerformanceCounter           = GetPerformanceCounter;
+  OneCryptoDepends->GetPerformanceCounterProperties = GetPerformanceCounterProperties;
+  //
+  // Boot services and MM pools cannot resize a block in place or report its
+  // real size, so OneCrypto falls back to allocate and copy.
+  //
+  OneCryptoDepends->ReallocatePool    = NULL;
+  OneCryptoDepends->GetPoolUsableSize = NULL;
 }
 
 /**
@@ -267,9 +280,13 @@ DxeEntryPoint (
   CRYPTO_ENTRY               Entry;
   EFI_LOADED_IMAGE_PROTOCOL  *LoadedImage;
   EFI_HANDLE                 LoadedImageHandle;
+  UINT64                     StartTicks;
+  UINT64                     LoadedTicks;
+  UINT64                     EntryTicks;
 
   LoadedImageHandle = NULL;
   LoadedImage       = NULL;
+  StartTicks        = GetPerformanceCounter ();
 
   //
   // This must match the INF for OneCryptoBin
@@ -338,6 +355,8 @@ DxeEntryPoint (
     goto Exit;
   }
 
+  LoadedTicks = GetPerformanceCounter ();
+
   //
   // With the loaded image, we can locate the exported crypto entry function
   //
@@ -383,7 +402,14 @@ DxeEntryPoint (
     goto Exit;
   }
 
+  EntryTicks = GetPerformanceCounter ();
   DEBUG ((DEBUG_INFO, "OneCryptoLoaderDxe: Crypto entry completed successfully\n"));
+  DEBUG ((
+    DEBUG_INFO,
+    "OneCryptoLoaderDxe: Startup cost: load %lu ns, crypto entry %lu ns\n",
+    CryptElapsedNanoSeconds (StartTicks, LoadedTicks),
+    CryptElapsedNanoSeconds (LoadedTicks, EntryTicks)
+    ));
   Status = SystemTable->BootServices->InstallMultipleProtocolInterfaces (
                                         &ImageHandle,
                                         &gOneCryptoProtocolGuid,
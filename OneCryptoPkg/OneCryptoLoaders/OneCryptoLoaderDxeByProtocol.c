@@ -22,6 +22,7 @@
 #include <Library/DxeServicesLib.h>
 #include <Library/SafeIntLib.h>
 #include <Library/RngLib.h>
+#include <Library/TimerLib.h>
 #include <Protocol/Rng.h>
 
 #include <Protocol/OneCrypto.h>
@@ -140,6 +141,17 @@ InstallSharedDependencies (
   // gBS->Stall is only being provided to be consistent with upstream
   //
   OneCryptoDepends->MicroSecondDelay = gBS->Stall;
+  //
+  // Performance counter is used by OneCrypto to measure initialization cost
+  //
+  OneCryptoDepends->GetPerformanceCounter           = GetPerformanceCounter;
+  OneCryptoDepends->GetPerformanceCounterProperties = GetPerformanceCounterProperties;
+  //
+  // Boot services and MM pools cannot resize a block in place or report its
+  // real size, so OneCrypto falls back to allocate and copy.
+  //
+  OneCryptoDepends->ReallocatePool    = NULL;
+  OneCryptoDepends->GetPoolUsableSize = NULL;
 }
 
 /**
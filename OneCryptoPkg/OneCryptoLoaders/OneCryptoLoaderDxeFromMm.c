@@ -27,6 +27,7 @@
 #include <Library/PeCoffGetEntryPointLib.h>
 #include <Library/PeCoffLib.h>
 #include <Library/RngLib.h>
+#include <Library/TimerLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
 
@@ -101,15 +102,19 @@ InstallSharedDependencies (
   OUT ONE_CRYPTO_DEPENDENCIES  *OneCryptoDepends
   )
 {
-  OneCryptoDepends->Major             = ONE_CRYPTO_DEPENDENCIES_VERSION_MAJOR;
-  OneCryptoDepends->Minor             = ONE_CRYPTO_DEPENDENCIES_VERSION_MINOR;
-  OneCryptoDepends->Reserved          = 0;
-  OneCryptoDepends->AllocatePool      = AllocatePool;
-  OneCryptoDepends->FreePool          = FreePool;
-  OneCryptoDepends->DebugPrint        = DebugPrint;
-  OneCryptoDepends->GetTime           = gRT->GetTime;
-  OneCryptoDepends->GetRandomNumber64 = LazyPlatformGetRandomNumber64;
-  OneCryptoDepends->MicroSecondDelay  = gBS->Stall;
+  OneCryptoDepends->Major                           = ONE_CRYPTO_DEPENDENCIES_VERSION_MAJOR;
+  OneCryptoDepends->Minor                           = ONE_CRYPTO_DEPENDENCIES_VERSION_MINOR;
+  OneCryptoDepends->Reserved                        = 0;
+  OneCryptoDepends->AllocatePool                    = AllocatePool;
+  OneCryptoDepends->FreePool                        = FreePool;
+  OneCryptoDepends->DebugPrint                      = DebugPrint;
+  OneCryptoDepends->GetTime                         = gRT->GetTime;
+  OneCryptoDepends->GetRandomNumber64               = LazyPlatformGetRandomNumber64;
+  OneCryptoDepends->MicroSecondDelay                = gBS->Stall;
+  OneCryptoDepends->GetPerformanceCounter           = GetPerformanceCounter;
+  OneCryptoDepends->GetPerformanceCounterProperties = GetPerformanceCounterProperties;
+  OneCryptoDepends->ReallocatePool                  = NULL;
+  OneCryptoDepends->GetPoolUsableSize               = NULL;
 }
 
 /**
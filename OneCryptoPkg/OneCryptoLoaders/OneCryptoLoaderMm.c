@@ -21,12 +21,14 @@
 #include <Library/BaseMemoryLib.h>
 #include <Library/SafeIntLib.h>
 #include <Library/RngLib.h>
+#include <Library/TimerLib.h>
 #include <Library/HobLib.h>
 #include <Protocol/Rng.h>
 #include <Library/FvLib.h>
 
 #include <Protocol/OneCrypto.h>
 #include <Private/OneCryptoDependencySupport.h>
+#include <CryptElapsedTime.h>
 
 //
 // The dependencies of the shared library, must live as long
@@ -174,6 +176,17 @@ InstallSharedDependencies (
   // Use stub for MicroSecondDelay - not needed in MM environment
   //
   OneCryptoDepends->MicroSecondDelay = StubMicroSecondDelay;
+  //
+  // Performance counter is used by OneCrypto to measure initialization cost
+  //
+  OneCryptoDepends->GetPerformanceCounter           = GetPerformanceCounter;
+  OneCryptoDepends->GetPerformanceCounterProperties = GetPerformanceCounterProperties;
+  //
+  // Boot services and MM pools cannot resize a block in place or report its
+  // real size, so OneCrypto falls back to allocate and copy.
+  //
+  OneCryptoDepends->ReallocatePool    = NULL;
+  OneCryptoDepends->GetPoolUsableSize = NULL;
 }
 
 /**
@@ -200,6 +213,7 @@ MmEntry (
   ONE_CRYPTO_CONSTRUCTOR_PROTOCOL  *ConstructorProtocol;
   EFI_HANDLE                       ProtocolHandle = NULL;
   UINT32                           CryptoSize     = 0;
+  UINT64                           StartTicks;
 
   //
   // Locate the private protocol that provides the constructor
@@ -269,7 +283,8 @@ MmEntry (
   //
   // Call library constructor to initialize the protocol
   //
-  Status = ConstructorProtocol->Entry (mOneCryptoDepends, &OneCryptoProtocol, &CryptoSize);
+  StartTicks = GetPerformanceCounter ();
+  Status     = ConstructorProtocol->Entry (mOneCryptoDepends, &OneCryptoProtocol, &CryptoSize);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "OneCryptoLoaderMm: Failed to call LibConstructor: %r\n", Status));
     FreePool (OneCryptoProtocol);
@@ -278,6 +293,11 @@ MmEntry (
   }
 
   DEBUG ((DEBUG_INFO, "OneCrypto Protocol CryptoEntry called successfully.\n"));
+  DEBUG ((
+    DEBUG_INFO,
+    "OneCryptoLoaderMm: Startup cost: crypto entry %lu ns\n",
+    CryptElapsedNanoSeconds (StartTicks, GetPerformanceCounter ())
+    ));
 
   DEBUG ((DEBUG_INFO, "Installing OneCrypto Protocol...\n"));
   Status = MmSystemTable->MmInstallProtocolInterface (
@@ -0,0 +1,1159 @@
+/** @file
+  Host-based micro-benchmark for the BaseCryptLib primitives, including the
+  OpensslPkg extensions declared in OpensslPkg/Include.
+
+  The same application is built against the OpenSSL and MbedTLS backends by
+  their host test DSCs. Every case runs a fixed number of iterations and one
+  CSV row per case is written to stdout (or to the file given with -o):
+
+    label,name,size,iterations,status,ns_per_op,ops_per_sec,cycles_per_byte,allocs_per_op
+
+  Cases a backend does not implement report status "unsupported". Two result
+  files can be compared with --compare to flag regressions.
+
+  Usage:
+    BaseCryptLibBenchmarkHost [--label Name] [-o File]
+    BaseCryptLibBenchmarkHost --compare Baseline.csv Current.csv [--threshold Percent]
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseCryptLibBenchmark.h"
+#include <Library/MemoryAllocationLib.h>
+
+#if defined (_MSC_VER)
+  #include <intrin.h>
+#else
+  #include <x86intrin.h>
+#endif
+
+#define HMAC_KEY_SIZE       32
+#define HKDF_OUTPUT_SIZE    64
+#define RSA_PSS_SALT_SIZE   32
+#define EC_PUBLIC_KEY_SIZE  64
+#define PBKDF2_ITERATIONS   1000
+#define PBKDF2_SALT_SIZE    16
+#define PKCS7_VIEW_MAX_CERTS  4
+
+/**
+  Fills a buffer with the deterministic pattern the test vectors were
+  generated from.
+
+  @param[out]  Buffer  Buffer to fill.
+  @param[in]   Size    Size of Buffer in bytes.
+**/
+VOID
+BenchmarkFillPattern (
+  OUT UINT8  *Buffer,
+  IN  UINTN  Size
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Size; Index++) {
+    Buffer[Index] = (UINT8)(Index * 7 + 3);
+  }
+}
+
+/**
+  Returns a monotonic wall clock timestamp in nanoseconds.
+**/
+STATIC
+UINT64
+BenchmarkNanoSeconds (
+  VOID
+  )
+{
+  struct timespec  Now;
+
+  timespec_get (&Now, TIME_UTC);
+  return (UINT64)Now.tv_sec * 1000000000ULL + (UINT64)Now.tv_nsec;
+}
+
+//
+// Hash primitives.
+//
+
+STATIC
+BOOLEAN
+RunSha1 (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return Sha1HashAll (Context->Message, Case->Size, Context->Digest);
+}
+
+STATIC
+BOOLEAN
+RunSha256 (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return Sha256HashAll (Context->Message, Case->Size, Context->Digest);
+}
+
+STATIC
+BOOLEAN
+RunSha384 (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return Sha384HashAll (Context->Message, Case->Size, Context->Digest);
+}
+
+STATIC
+BOOLEAN
+RunSha512 (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return Sha512HashAll (Context->Message, Case->Size, Context->Digest);
+}
+
+STATIC
+BOOLEAN
+RunSm3 (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return Sm3HashAll (Context->Message, Case->Size, Context->Digest);
+}
+
+//
+// Tree hash cases use 4 KB leaves. The update case re-hashes one changed
+// leaf of a Case->Size tree built by its setup in Output.
+//
+
+STATIC
+BOOLEAN
+RunSha256Tree (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return Sha256TreeHashAll (Context->Message, Case->Size, SIZE_4KB, Context->Digest);
+}
+
+STATIC
+BOOLEAN
+SetupSha256TreeUpdate (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  UINTN  ContextSize;
+
+  ContextSize = Sha256TreeGetContextSize (Case->Size, SIZE_4KB);
+  if ((ContextSize == 0) || (ContextSize > BENCHMARK_MAX_MESSAGE_SIZE)) {
+    return FALSE;
+  }
+
+  return Sha256TreeInit (Context->Output, ContextSize, Context->Message, Case->Size, SIZE_4KB);
+}
+
+STATIC
+BOOLEAN
+RunSha256TreeUpdate (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return Sha256TreeUpdate (Context->Output, Context->Message, Case->Size / 2, 64) &&
+         Sha256TreeGetRoot (Context->Output, Context->Digest);
+}
+
+STATIC
+BOOLEAN
+SetupSha256HashCache (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  UINTN  CacheSize;
+
+  CacheSize = Sha256HashCacheGetContextSize (Case->Size, SIZE_4KB);
+  if ((CacheSize == 0) || (CacheSize > BENCHMARK_MAX_MESSAGE_SIZE)) {
+    return FALSE;
+  }
+
+  return Sha256HashCacheInit (Context->Output, CacheSize, Context->Message, Case->Size, SIZE_4KB);
+}
+
+STATIC
+BOOLEAN
+RunSha256HashCacheRefresh (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return Sha256HashCacheMarkDirty (Context->Output, Case->Size / 2, 64) &&
+         Sha256HashCacheRefresh (Context->Output, Context->Digest);
+}
+
+//
+// Batch hash cases hash BENCHMARK_BATCH_COUNT messages per operation. Size
+// is the total of the batch, so cycles_per_byte compares directly with the
+// single-message rows, and each message is Size / BENCHMARK_BATCH_COUNT
+// bytes. The -serial rows hash the same messages one HashAll () call at a
+// time.
+//
+
+STATIC
+BOOLEAN
+SetupHashBatch (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  UINTN  MessageSize;
+  UINTN  Index;
+
+  MessageSize = Case->Size / BENCHMARK_BATCH_COUNT;
+  for (Index = 0; Index < BENCHMARK_BATCH_COUNT; Index++) {
+    Context->BatchMessages[Index] = Context->Message + Index * MessageSize;
+    Context->BatchSizes[Index]    = MessageSize;
+    Context->BatchDigests[Index]  = Context->Output + Index * SHA512_DIGEST_SIZE;
+  }
+
+  return TRUE;
+}
+
+STATIC
+BOOLEAN
+RunSha256Batch (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return Sha256HashAllBatch (Context->BatchMessages, Context->BatchSizes, Context->BatchDigests, BENCHMARK_BATCH_COUNT);
+}
+
+STATIC
+BOOLEAN
+RunSha256BatchSerial (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < BENCHMARK_BATCH_COUNT; Index++) {
+    if (!Sha256HashAll (Context->BatchMessages[Index], Context->BatchSizes[Index], Context->BatchDigests[Index])) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+STATIC
+BOOLEAN
+RunSha384Batch (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return Sha384HashAllBatch (Context->BatchMessages, Context->BatchSizes, Context->BatchDigests, BENCHMARK_BATCH_COUNT);
+}
+
+STATIC
+BOOLEAN
+RunSha384BatchSerial (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < BENCHMARK_BATCH_COUNT; Index++) {
+    if (!Sha384HashAll (Context->BatchMessages[Index], Context->BatchSizes[Index], Context->BatchDigests[Index])) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+//
+// MAC and KDF primitives.
+//
+
+STATIC
+BOOLEAN
+RunHmacSha256 (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return HmacSha256All (Context->Message, Case->Size, Context->Key, HMAC_KEY_SIZE, Context->Digest);
+}
+
+STATIC
+BOOLEAN
+RunHmacSha384 (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return HmacSha384All (Context->Message, Case->Size, Context->Key, HMAC_KEY_SIZE, Context->Digest);
+}
+
+STATIC
+BOOLEAN
+RunHkdfSha256 (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return HkdfSha256ExtractAndExpand (
+           Context->Key,
+           sizeof (Context->Key),
+           Context->Iv,
+           sizeof (Context->Iv),
+           Context->Message,
+           Case->Size,
+           Context->Output,
+           HKDF_OUTPUT_SIZE
+           );
+}
+
+//
+// PBKDF2 cases derive Case->Size bytes; sizes above one digest exercise
+// several output blocks per derivation.
+//
+STATIC
+BOOLEAN
+RunPbkdf2Sha256 (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return Pkcs5HashPassword (
+           sizeof (Context->Key),
+           (CONST CHAR8 *)Context->Key,
+           PBKDF2_SALT_SIZE,
+           Context->Message,
+           PBKDF2_ITERATIONS,
+           SHA256_DIGEST_SIZE,
+           Case->Size,
+           Context->Output
+           );
+}
+
+STATIC
+BOOLEAN
+RunPbkdf2Sha512 (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return Pkcs5HashPassword (
+           sizeof (Context->Key),
+           (CONST CHAR8 *)Context->Key,
+           PBKDF2_SALT_SIZE,
+           Context->Message,
+           PBKDF2_ITERATIONS,
+           SHA512_DIGEST_SIZE,
+           Case->Size,
+           Context->Output
+           );
+}
+
+//
+// Symmetric ciphers.
+//
+
+STATIC
+BOOLEAN
+SetupAes (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  if (Context->AesContext == NULL) {
+    Context->AesContext = malloc (AesGetContextSize ());
+    if (Context->AesContext == NULL) {
+      return FALSE;
+    }
+  }
+
+  return AesInit (Context->AesContext, Context->Key, 256);
+}
+
+STATIC
+BOOLEAN
+RunAesCbcEncrypt (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return AesCbcEncrypt (Context->AesContext, Context->Message, Case->Size, Context->Iv, Context->Output);
+}
+
+STATIC
+BOOLEAN
+RunAesCbcDecrypt (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return AesCbcDecrypt (Context->AesContext, Context->Message, Case->Size, Context->Iv, Context->Output);
+}
+
+STATIC
+BOOLEAN
+RunAesGcmEncrypt (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  UINTN  OutputSize;
+
+  OutputSize = Case->Size;
+  return AeadAesGcmEncrypt (
+           Context->Key,
+           sizeof (Context->Key),
+           Context->Iv,
+           12,
+           NULL,
+           0,
+           Context->Message,
+           Case->Size,
+           Context->Tag,
+           sizeof (Context->Tag),
+           Context->Output,
+           &OutputSize
+           );
+}
+
+STATIC
+BOOLEAN
+SetupAesGcmDecrypt (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  //
+  // Produce a ciphertext and tag for this size in Output. Decryption reads it
+  // back into Message, which holds the same plaintext once decrypted.
+  //
+  return RunAesGcmEncrypt (Context, Case);
+}
+
+STATIC
+BOOLEAN
+RunAesGcmDecrypt (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  UINTN  OutputSize;
+
+  OutputSize = Case->Size;
+  return AeadAesGcmDecrypt (
+           Context->Key,
+           sizeof (Context->Key),
+           Context->Iv,
+           12,
+           NULL,
+           0,
+           Context->Output,
+           Case->Size,
+           Context->Tag,
+           sizeof (Context->Tag),
+           Context->Message,
+           &OutputSize
+           );
+}
+
+//
+// RSA.
+//
+
+STATIC
+BOOLEAN
+SetupRsaKeys (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  if ((Context->RsaPrivateKey == NULL) &&
+      !RsaGetPrivateKeyFromPem ((CONST UINT8 *)mBenchmarkSignerKeyPem, mBenchmarkSignerKeyPemSize, NULL, &Context->RsaPrivateKey))
+  {
+    return FALSE;
+  }
+
+  if ((Context->RsaPublicKey == NULL) &&
+      !RsaGetPublicKeyFromX509 (mBenchmarkSignerCert, mBenchmarkSignerCertSize, &Context->RsaPublicKey))
+  {
+    return FALSE;
+  }
+
+  return Sha256HashAll (Context->Message, SIZE_1KB, Context->Digest);
+}
+
+STATIC
+BOOLEAN
+RunRsaPkcs1Sign (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  Context->SignatureSize = sizeof (Context->Signature);
+  return RsaPkcs1Sign (
+           Context->RsaPrivateKey,
+           Context->Digest,
+           SHA256_DIGEST_SIZE,
+           Context->Signature,
+           &Context->SignatureSize
+           );
+}
+
+STATIC
+BOOLEAN
+SetupRsaPkcs1Verify (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return SetupRsaKeys (Context, Case) && RunRsaPkcs1Sign (Context, Case);
+}
+
+STATIC
+BOOLEAN
+RunRsaPkcs1Verify (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return RsaPkcs1Verify (
+           Context->RsaPublicKey,
+           Context->Digest,
+           SHA256_DIGEST_SIZE,
+           Context->Signature,
+           Context->SignatureSize
+           );
+}
+
+STATIC
+BOOLEAN
+RunRsaPssSign (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  Context->SignatureSize = sizeof (Context->Signature);
+  return RsaPssSign (
+           Context->RsaPrivateKey,
+           Context->Message,
+           SIZE_1KB,
+           SHA256_DIGEST_SIZE,
+           RSA_PSS_SALT_SIZE,
+           Context->Signature,
+           &Context->SignatureSize
+           );
+}
+
+STATIC
+BOOLEAN
+SetupRsaPssVerify (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return SetupRsaKeys (Context, Case) && RunRsaPssSign (Context, Case);
+}
+
+STATIC
+BOOLEAN
+RunRsaPssVerify (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return RsaPssVerify (
+           Context->RsaPublicKey,
+           Context->Message,
+           SIZE_1KB,
+           Context->Signature,
+           Context->SignatureSize,
+           SHA256_DIGEST_SIZE,
+           RSA_PSS_SALT_SIZE
+           );
+}
+
+//
+// ECDSA.
+//
+
+STATIC
+BOOLEAN
+SetupEcKey (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  UINT8  PublicKey[EC_PUBLIC_KEY_SIZE];
+  UINTN  PublicKeySize;
+
+  if (Context->EcKey == NULL) {
+    Context->EcKey = EcNewByNid (CRYPTO_NID_SECP256R1);
+    if (Context->EcKey == NULL) {
+      return FALSE;
+    }
+
+    PublicKeySize = sizeof (PublicKey);
+    if (!EcGenerateKey (Context->EcKey, PublicKey, &PublicKeySize)) {
+      return FALSE;
+    }
+  }
+
+  return Sha256HashAll (Context->Message, SIZE_1KB, Context->Digest);
+}
+
+STATIC
+BOOLEAN
+RunEcDsaSign (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  Context->SignatureSize = sizeof (Context->Signature);
+  return EcDsaSign (
+           Context->EcKey,
+           CRYPTO_NID_SHA256,
+           Context->Digest,
+           SHA256_DIGEST_SIZE,
+           Context->Signature,
+           &Context->SignatureSize
+           );
+}
+
+STATIC
+BOOLEAN
+SetupEcDsaVerify (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return SetupEcKey (Context, Case) && RunEcDsaSign (Context, Case);
+}
+
+STATIC
+BOOLEAN
+RunEcDsaVerify (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return EcDsaVerify (
+           Context->EcKey,
+           CRYPTO_NID_SHA256,
+           Context->Digest,
+           SHA256_DIGEST_SIZE,
+           Context->Signature,
+           Context->SignatureSize
+           );
+}
+
+//
+// Certificates and signed data.
+//
+
+STATIC
+BOOLEAN
+RunX509Construct (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  UINT8  *Cert;
+
+  Cert = NULL;
+  if (!X509ConstructCertificate (mBenchmarkSignerCert, mBenchmarkSignerCertSize, &Cert)) {
+    return FALSE;
+  }
+
+  X509Free (Cert);
+  return TRUE;
+}
+
+STATIC
+BOOLEAN
+RunX509GetCommonName (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  CHAR8  CommonName[64];
+  UINTN  CommonNameSize;
+
+  CommonNameSize = sizeof (CommonName);
+  return X509GetCommonName (mBenchmarkSignerCert, mBenchmarkSignerCertSize, CommonName, &CommonNameSize) == RETURN_SUCCESS;
+}
+
+STATIC
+BOOLEAN
+RunPkcs7Verify (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return Pkcs7Verify (
+           mBenchmarkPkcs7Signature,
+           mBenchmarkPkcs7SignatureSize,
+           mBenchmarkSignerCert,
+           mBenchmarkSignerCertSize,
+           Context->Message,
+           BENCHMARK_PKCS7_PAYLOAD_SIZE
+           );
+}
+
+STATIC
+BOOLEAN
+RunAuthenticodeVerify (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  return AuthenticodeVerify (
+           mBenchmarkAuthenticode,
+           mBenchmarkAuthenticodeSize,
+           mBenchmarkSignerCert,
+           mBenchmarkSignerCertSize,
+           mBenchmarkImageHash,
+           mBenchmarkImageHashSize
+           );
+}
+
+//
+// PKCS#7 content and signer extraction, copying versus zero-copy views.
+//
+
+STATIC
+UINTN
+BenchmarkDerHeaderSize (
+  IN UINTN  Length
+  )
+{
+  return (Length < 0x80) ? 2 : (Length < 0x100) ? 3 : (Length < 0x10000) ? 4 : 5;
+}
+
+STATIC
+UINT8 *
+BenchmarkDerWriteHeader (
+  OUT UINT8  *Buffer,
+  IN  UINT8  Tag,
+  IN  UINTN  Length
+  )
+{
+  UINTN  Octets;
+
+  Octets    = BenchmarkDerHeaderSize (Length) - 2;
+  *Buffer++ = Tag;
+  if (Octets == 0) {
+    *Buffer++ = (UINT8)Length;
+    return Buffer;
+  }
+
+  *Buffer++ = (UINT8)(0x80 | Octets);
+  while (Octets-- > 0) {
+    *Buffer++ = (UINT8)(Length >> (8 * Octets));
+  }
+
+  return Buffer;
+}
+
+/**
+  Builds a signer-less (degenerate) PKCS#7 SignedData in Context->Output
+  that carries Case->Size bytes of Context->Message as attached content.
+  Content extraction does not look at the signers, so this stands in for a
+  signed capsule of any size without a large test vector.
+**/
+STATIC
+BOOLEAN
+SetupPkcs7Attached (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  STATIC CONST UINT8  DataOid[]        = { 0x06, 0x09, 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x01 };
+  STATIC CONST UINT8  SignedDataOid[]  = { 0x06, 0x09, 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x02 };
+  STATIC CONST UINT8  VersionAndAlgs[] = { 0x02, 0x01, 0x01, 0x31, 0x00 };
+  STATIC CONST UINT8  NoSignerInfos[]  = { 0x31, 0x00 };
+  UINTN               Octets;
+  UINTN               Content;
+  UINTN               InnerInfo;
+  UINTN               SignedData;
+  UINTN               Wrapped;
+  UINTN               OuterInfo;
+  UINT8               *Buffer;
+
+  Octets     = BenchmarkDerHeaderSize (Case->Size) + Case->Size;
+  Content    = BenchmarkDerHeaderSize (Octets) + Octets;
+  InnerInfo  = sizeof (DataOid) + Content;
+  SignedData = sizeof (VersionAndAlgs) + BenchmarkDerHeaderSize (InnerInfo) + InnerInfo + sizeof (NoSignerInfos);
+  Wrapped    = BenchmarkDerHeaderSize (SignedData) + SignedData;
+  OuterInfo  = sizeof (SignedDataOid) + BenchmarkDerHeaderSize (Wrapped) + Wrapped;
+
+  Context->Pkcs7Size = BenchmarkDerHeaderSize (OuterInfo) + OuterInfo;
+  if (Context->Pkcs7Size > BENCHMARK_MAX_MESSAGE_SIZE) {
+    return FALSE;
+  }
+
+  Buffer = BenchmarkDerWriteHeader (Context->Output, 0x30, OuterInfo);
+  CopyMem (Buffer, SignedDataOid, sizeof (SignedDataOid));
+  Buffer = BenchmarkDerWriteHeader (Buffer + sizeof (SignedDataOid), 0xA0, Wrapped);
+  Buffer = BenchmarkDerWriteHeader (Buffer, 0x30, SignedData);
+  CopyMem (Buffer, VersionAndAlgs, sizeof (VersionAndAlgs));
+  Buffer = BenchmarkDerWriteHeader (Buffer + sizeof (VersionAndAlgs), 0x30, InnerInfo);
+  CopyMem (Buffer, DataOid, sizeof (DataOid));
+  Buffer = BenchmarkDerWriteHeader (Buffer + sizeof (DataOid), 0xA0, Octets);
+  Buffer = BenchmarkDerWriteHeader (Buffer, 0x04, Case->Size);
+  CopyMem (Buffer, Context->Message, Case->Size);
+  CopyMem (Buffer + Case->Size, NoSignerInfos, sizeof (NoSignerInfos));
+  return TRUE;
+}
+
+STATIC
+BOOLEAN
+RunPkcs7GetAttachedContent (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  VOID   *Content;
+  UINTN  ContentSize;
+
+  if (!Pkcs7GetAttachedContent (Context->Output, Context->Pkcs7Size, &Content, &ContentSize)) {
+    return FALSE;
+  }
+
+  FreePool (Content);
+  return ContentSize == Case->Size;
+}
+
+STATIC
+BOOLEAN
+RunPkcs7GetAttachedContentView (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  UINTN  ContentOffset;
+  UINTN  ContentSize;
+
+  return Pkcs7GetAttachedContentView (Context->Output, Context->Pkcs7Size, &ContentOffset, &ContentSize) &&
+         ContentSize == Case->Size;
+}
+
+STATIC
+BOOLEAN
+RunPkcs7GetSigners (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  UINT8  *CertStack;
+  UINTN  StackLength;
+  UINT8  *TrustedCert;
+  UINTN  CertLength;
+
+  if (!Pkcs7GetSigners (mBenchmarkPkcs7Signature, mBenchmarkPkcs7SignatureSize, &CertStack, &StackLength, &TrustedCert, &CertLength)) {
+    return FALSE;
+  }
+
+  Pkcs7FreeSigners (CertStack);
+  Pkcs7FreeSigners (TrustedCert);
+  return TRUE;
+}
+
+STATIC
+BOOLEAN
+RunPkcs7GetSignersView (
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  UINTN  CertOffset[PKCS7_VIEW_MAX_CERTS];
+  UINTN  CertSize[PKCS7_VIEW_MAX_CERTS];
+  UINTN  CertCount;
+
+  CertCount = PKCS7_VIEW_MAX_CERTS;
+  return Pkcs7GetSignersView (mBenchmarkPkcs7Signature, mBenchmarkPkcs7SignatureSize, CertOffset, CertSize, &CertCount);
+}
+
+//
+// Iteration counts are fixed so that results from different runs and
+// backends are directly comparable.
+//
+#define BULK_CASES(Name, Setup, Run)       \
+  { Name, 64,         200000, Setup, Run }, \
+  { Name, SIZE_1KB,   50000,  Setup, Run }, \
+  { Name, SIZE_16KB,  4000,   Setup, Run }, \
+  { Name, SIZE_1MB,   64,     Setup, Run }
+
+//
+// Per-call overhead of the digest layer for short inputs.
+//
+#define SMALL_CASES(Name, Setup, Run)       \
+  { Name, 32,         500000, Setup, Run }, \
+  { Name, 256,        200000, Setup, Run }, \
+  { Name, SIZE_4KB,   50000,  Setup, Run }
+
+#define BATCH_CASES(Name, Run)                                          \
+  { Name, BENCHMARK_BATCH_COUNT * 64,       20000, SetupHashBatch, Run }, \
+  { Name, BENCHMARK_BATCH_COUNT * 256,      5000,  SetupHashBatch, Run }, \
+  { Name, BENCHMARK_BATCH_COUNT * SIZE_1KB, 1000,  SetupHashBatch, Run }, \
+  { Name, BENCHMARK_BATCH_COUNT * SIZE_4KB, 250,   SetupHashBatch, Run }
+
+STATIC CONST BENCHMARK_CASE  mBenchmarkCases[] = {
+  BULK_CASES ("sha1",            NULL,               RunSha1),
+  BULK_CASES ("sha256",          NULL,               RunSha256),
+  BULK_CASES ("sha384",          NULL,               RunSha384),
+  BULK_CASES ("sha512",          NULL,               RunSha512),
+  BULK_CASES ("sm3",             NULL,               RunSm3),
+  BULK_CASES ("sha256-tree",     NULL,               RunSha256Tree),
+  { "sha256-tree-update",     SIZE_64KB,  200000, SetupSha256TreeUpdate, RunSha256TreeUpdate },
+  { "sha256-tree-update",     SIZE_1MB,   200000, SetupSha256TreeUpdate, RunSha256TreeUpdate },
+  { "sha256-cache-refresh",   SIZE_64KB,  200000, SetupSha256HashCache, RunSha256HashCacheRefresh },
+  { "sha256-cache-refresh",   SIZE_1MB,   200000, SetupSha256HashCache, RunSha256HashCacheRefresh },
+  BATCH_CASES ("sha256-batch",        RunSha256Batch),
+  BATCH_CASES ("sha256-batch-serial", RunSha256BatchSerial),
+  BATCH_CASES ("sha384-batch",        RunSha384Batch),
+  BATCH_CASES ("sha384-batch-serial", RunSha384BatchSerial),
+  BULK_CASES ("hmac-sha256",     NULL,               RunHmacSha256),
+  BULK_CASES ("hmac-sha384",     NULL,               RunHmacSha384),
+  BULK_CASES ("aes256-cbc-enc",  SetupAes,           RunAesCbcEncrypt),
+  BULK_CASES ("aes256-cbc-dec",  SetupAes,           RunAesCbcDecrypt),
+  BULK_CASES ("aes256-gcm-enc",  NULL,               RunAesGcmEncrypt),
+  BULK_CASES ("aes256-gcm-dec",  SetupAesGcmDecrypt, RunAesGcmDecrypt),
+  SMALL_CASES ("hmac-sha256",    NULL,               RunHmacSha256),
+  SMALL_CASES ("hmac-sha384",    NULL,               RunHmacSha384),
+  SMALL_CASES ("hkdf-sha256",    NULL,               RunHkdfSha256),
+  { "hkdf-sha256",            64,         50000, NULL,                RunHkdfSha256                  },
+  { "pbkdf2-sha256",          32,         500,   NULL,                RunPbkdf2Sha256                },
+  { "pbkdf2-sha256",          128,        200,   NULL,                RunPbkdf2Sha256                },
+  { "pbkdf2-sha512",          64,         500,   NULL,                RunPbkdf2Sha512                },
+  { "rsa2048-pkcs1-sign",     0,          200,   SetupRsaKeys,        RunRsaPkcs1Sign                },
+  { "rsa2048-pkcs1-verify",   0,          5000,  SetupRsaPkcs1Verify, RunRsaPkcs1Verify              },
+  { "rsa2048-pss-sign",       0,          200,   SetupRsaKeys,        RunRsaPssSign                  },
+  { "rsa2048-pss-verify",     0,          5000,  SetupRsaPssVerify,   RunRsaPssVerify                },
+  { "ecdsa-p256-sign",        0,          2000,  SetupEcKey,          RunEcDsaSign                   },
+  { "ecdsa-p256-verify",      0,          2000,  SetupEcDsaVerify,    RunEcDsaVerify                 },
+  { "x509-construct",         0,          20000, NULL,                RunX509Construct               },
+  { "x509-get-common-name",   0,          20000, NULL,                RunX509GetCommonName           },
+  { "pkcs7-verify",           0,          2000,  NULL,                RunPkcs7Verify                 },
+  { "authenticode-verify",    0,          2000,  NULL,                RunAuthenticodeVerify          },
+  { "pkcs7-get-content",      SIZE_1KB,   20000, SetupPkcs7Attached,  RunPkcs7GetAttachedContent     },
+  { "pkcs7-get-content",      SIZE_64KB,  2000,  SetupPkcs7Attached,  RunPkcs7GetAttachedContent     },
+  { "pkcs7-get-content",      SIZE_512KB, 200,   SetupPkcs7Attached,  RunPkcs7GetAttachedContent     },
+  { "pkcs7-get-content-view", SIZE_1KB,   20000, SetupPkcs7Attached,  RunPkcs7GetAttachedContentView },
+  { "pkcs7-get-content-view", SIZE_64KB,  2000,  SetupPkcs7Attached,  RunPkcs7GetAttachedContentView },
+  { "pkcs7-get-content-view", SIZE_512KB, 200,   SetupPkcs7Attached,  RunPkcs7GetAttachedContentView },
+  { "pkcs7-get-signers",      0,          20000, NULL,                RunPkcs7GetSigners             },
+  { "pkcs7-get-signers-view", 0,          20000, NULL,                RunPkcs7GetSignersView         },
+};
+
+/**
+  Runs one benchmark case and writes its result row.
+
+  @param[in]      Output   Stream receiving the CSV row.
+  @param[in]      Label    Label identifying the backend/build under test.
+  @param[in,out]  Context  Shared benchmark state.
+  @param[in]      Case     The case to run.
+
+  @retval  TRUE   The case ran, or was reported as unsupported.
+  @retval  FALSE  The primitive failed part way through the timed loop.
+**/
+STATIC
+BOOLEAN
+RunBenchmarkCase (
+  IN     FILE                  *Output,
+  IN     CONST CHAR8           *Label,
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  )
+{
+  UINTN   Index;
+  UINT64  StartTime;
+  UINT64  EndTime;
+  UINT64  StartCycles;
+  UINT64  EndCycles;
+  INT64   StartAllocations;
+  INT64   EndAllocations;
+  double  NsPerOp;
+  double  CyclesPerByte;
+  double  AllocsPerOp;
+
+  //
+  // A failing setup or warm-up call means the backend does not implement the
+  // primitive (Null instances return FALSE/NULL).
+  //
+  if (((Case->Setup != NULL) && !Case->Setup (Context, Case)) || !Case->Run (Context, Case)) {
+    fprintf (Output, "%s,%s,%u,0,unsupported,0,0,0,0\n", Label, Case->Name, (unsigned)Case->Size);
+    return TRUE;
+  }
+
+  StartAllocations = BenchmarkAllocationCount ();
+  StartTime        = BenchmarkNanoSeconds ();
+  StartCycles      = __rdtsc ();
+  for (Index = 0; Index < Case->Iterations; Index++) {
+    if (!Case->Run (Context, Case)) {
+      fprintf (Output, "%s,%s,%u,%u,failed,0,0,0,0\n", Label, Case->Name, (unsigned)Case->Size, (unsigned)Index);
+      return FALSE;
+    }
+  }
+
+  EndCycles      = __rdtsc ();
+  EndTime        = BenchmarkNanoSeconds ();
+  EndAllocations = BenchmarkAllocationCount ();
+
+  NsPerOp       = (double)(EndTime - StartTime) / (double)Case->Iterations;
+  CyclesPerByte = 0;
+  if (Case->Size != 0) {
+    CyclesPerByte = (double)(EndCycles - StartCycles) / ((double)Case->Iterations * (double)Case->Size);
+  }
+
+  AllocsPerOp = -1;
+  if (StartAllocations >= 0) {
+    AllocsPerOp = (double)(EndAllocations - StartAllocations) / (double)Case->Iterations;
+  }
+
+  fprintf (
+    Output,
+    "%s,%s,%u,%u,ok,%.1f,%.1f,%.3f,%.2f\n",
+    Label,
+    Case->Name,
+    (unsigned)Case->Size,
+    (unsigned)Case->Iterations,
+    NsPerOp,
+    (NsPerOp > 0) ? 1e9 / NsPerOp : 0,
+    CyclesPerByte,
+    AllocsPerOp
+    );
+  fflush (Output);
+  return TRUE;
+}
+
+/**
+  Prints the command line usage.
+
+  @param[in]  Program  Name the application was invoked with.
+**/
+STATIC
+VOID
+PrintUsage (
+  IN CONST CHAR8  *Program
+  )
+{
+  fprintf (stderr, "Usage:\n");
+  fprintf (stderr, "  %s [--label Name] [-o File]\n", Program);
+  fprintf (stderr, "  %s --compare Baseline.csv Current.csv [--threshold Percent]\n", Program);
+}
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  BENCHMARK_CONTEXT  Context;
+  CONST CHAR8        *Label;
+  CONST CHAR8        *OutputPath;
+  CONST CHAR8        *BaselinePath;
+  CONST CHAR8        *CurrentPath;
+  UINTN              Threshold;
+  FILE               *Output;
+  UINTN              Index;
+  BOOLEAN            Passed;
+
+  Label        = "default";
+  OutputPath   = NULL;
+  BaselinePath = NULL;
+  CurrentPath  = NULL;
+  Threshold    = BENCHMARK_DEFAULT_THRESHOLD;
+
+  for (Index = 1; Index < (UINTN)argc; Index++) {
+    if ((strcmp (argv[Index], "--label") == 0) && (Index + 1 < (UINTN)argc)) {
+      Label = argv[++Index];
+    } else if ((strcmp (argv[Index], "-o") == 0) && (Index + 1 < (UINTN)argc)) {
+      OutputPath = argv[++Index];
+    } else if ((strcmp (argv[Index], "--compare") == 0) && (Index + 2 < (UINTN)argc)) {
+      BaselinePath = argv[++Index];
+      CurrentPath  = argv[++Index];
+    } else if ((strcmp (argv[Index], "--threshold") == 0) && (Index + 1 < (UINTN)argc)) {
+      Threshold = (UINTN)strtoul (argv[++Index], NULL, 10);
+    } else {
+      PrintUsage (argv[0]);
+      return 2;
+    }
+  }
+
+  if (BaselinePath != NULL) {
+    return BenchmarkCompare (BaselinePath, CurrentPath, Threshold);
+  }
+
+  Output = stdout;
+  if (OutputPath != NULL) {
+    Output = fopen (OutputPath, "w");
+    if (Output == NULL) {
+      fprintf (stderr, "Cannot open %s\n", OutputPath);
+      return 2;
+    }
+  }
+
+  memset (&Context, 0, sizeof (Context));
+  Context.Message = malloc (BENCHMARK_MAX_MESSAGE_SIZE);
+  Context.Output  = malloc (BENCHMARK_MAX_MESSAGE_SIZE);
+  if ((Context.Message == NULL) || (Context.Output == NULL)) {
+    fprintf (stderr, "Out of memory\n");
+    return 2;
+  }
+
+  BenchmarkFillPattern (Context.Message, BENCHMARK_MAX_MESSAGE_SIZE);
+  BenchmarkFillPattern (Context.Key, sizeof (Context.Key));
+  BenchmarkFillPattern (Context.Iv, sizeof (Context.Iv));
+
+  //
+  // The first query installs the allocation hook where one is needed.
+  //
+  BenchmarkAllocationCount ();
+
+  fprintf (Output, "%s\n", BENCHMARK_CSV_HEADER);
+  Passed = TRUE;
+  for (Index = 0; Index < ARRAY_SIZE (mBenchmarkCases); Index++) {
+    if (!RunBenchmarkCase (Output, Label, &Context, &mBenchmarkCases[Index])) {
+      Passed = FALSE;
+    }
+  }
+
+  if (Context.RsaPrivateKey != NULL) {
+    RsaFree (Context.RsaPrivateKey);
+  }
+
+  if (Context.RsaPublicKey != NULL) {
+    RsaFree (Context.RsaPublicKey);
+  }
+
+  if (Context.EcKey != NULL) {
+    EcFree (Context.EcKey);
+  }
+
+  free (Context.AesContext);
+  free (Context.Message);
+  free (Context.Output);
+
+  if (Output != stdout) {
+    fclose (Output);
+  }
+
+  return Passed ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+/** @file
+  Internal definitions for the BaseCryptLib host benchmark.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef BASE_CRYPT_LIB_BENCHMARK_H_
+#define BASE_CRYPT_LIB_BENCHMARK_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <Uefi.h>
+#include <Library/BaseCryptLib.h>
+#include <CryptHashBatch.h>
+#include <CryptHashCache.h>
+#include <CryptHashTree.h>
+#include <CryptPkcs7View.h>
+
+//
+// Largest message size exercised by the bulk (hash/cipher) benchmarks.
+//
+#define BENCHMARK_MAX_MESSAGE_SIZE  SIZE_1MB
+
+//
+// Messages hashed per call by the batch hash benchmarks.
+//
+#define BENCHMARK_BATCH_COUNT  64
+
+//
+// Size of the pattern payload covered by mBenchmarkPkcs7Signature.
+//
+#define BENCHMARK_PKCS7_PAYLOAD_SIZE  SIZE_1KB
+
+//
+// Column header of the machine-readable output. BenchmarkCompare () relies on
+// the column order.
+//
+#define BENCHMARK_CSV_HEADER \
+  "label,name,size,iterations,status,ns_per_op,ops_per_sec,cycles_per_byte,allocs_per_op"
+
+//
+// Default regression threshold of the compare mode, in percent.
+//
+#define BENCHMARK_DEFAULT_THRESHOLD  10
+
+//
+// State shared by all benchmark cases. Buffers are allocated once up front so
+// the timed loops only measure the primitive under test.
+//
+typedef struct {
+  UINT8    *Message;
+  UINT8    *Output;
+  UINT8    Digest[SHA512_DIGEST_SIZE];
+  UINT8    Key[32];
+  UINT8    Iv[16];
+  UINT8    Tag[16];
+  VOID     *AesContext;
+  VOID     *RsaPrivateKey;
+  VOID     *RsaPublicKey;
+  VOID     *EcKey;
+  UINT8    Signature[512];
+  UINTN    SignatureSize;
+  //
+  // Size of the attached PKCS#7 SignedData built in Output by the
+  // pkcs7-get-content setup.
+  //
+  UINTN    Pkcs7Size;
+  //
+  // Messages and digest buffers of the batch hash cases, carved from
+  // Message and Output by their setup.
+  //
+  CONST VOID    *BatchMessages[BENCHMARK_BATCH_COUNT];
+  UINTN         BatchSizes[BENCHMARK_BATCH_COUNT];
+  UINT8         *BatchDigests[BENCHMARK_BATCH_COUNT];
+} BENCHMARK_CONTEXT;
+
+typedef struct _BENCHMARK_CASE BENCHMARK_CASE;
+
+/**
+  Runs one iteration of a benchmark case.
+
+  @param[in,out]  Context  Shared benchmark state.
+  @param[in]      Case     The case being run.
+
+  @retval  TRUE   The primitive succeeded.
+  @retval  FALSE  The primitive failed or is not supported by this backend.
+**/
+typedef
+BOOLEAN
+(*BENCHMARK_RUN)(
+  IN OUT BENCHMARK_CONTEXT     *Context,
+  IN     CONST BENCHMARK_CASE  *Case
+  );
+
+struct _BENCHMARK_CASE {
+  CONST CHAR8      *Name;
+  //
+  // Bytes processed per operation, or 0 for fixed-size operations such as
+  // signature verification.
+  //
+  UINTN            Size;
+  UINTN            Iterations;
+  BENCHMARK_RUN    Setup;
+  BENCHMARK_RUN    Run;
+};
+
+//
+// Test vectors, see BenchmarkVectors.c.
+//
+extern CONST UINT8  mBenchmarkSignerCert[];
+extern CONST UINTN  mBenchmarkSignerCertSize;
+extern CONST CHAR8  mBenchmarkSignerKeyPem[];
+extern CONST UINTN  mBenchmarkSignerKeyPemSize;
+extern CONST UINT8  mBenchmarkPkcs7Signature[];
+extern CONST UINTN  mBenchmarkPkcs7SignatureSize;
+extern CONST UINT8  mBenchmarkAuthenticode[];
+extern CONST UINTN  mBenchmarkAuthenticodeSize;
+extern CONST UINT8  mBenchmarkImageHash[];
+extern CONST UINTN  mBenchmarkImageHashSize;
+
+/**
+  Fills a buffer with the deterministic pattern the test vectors were
+  generated from.
+
+  @param[out]  Buffer  Buffer to fill.
+  @param[in]   Size    Size of Buffer in bytes.
+**/
+VOID
+BenchmarkFillPattern (
+  OUT UINT8  *Buffer,
+  IN  UINTN  Size
+  );
+
+/**
+  Returns the number of heap allocations made by the process so far.
+
+  @retval  The allocation count, or -1 if allocation counting is not
+           available in this host environment.
+**/
+INT64
+BenchmarkAllocationCount (
+  VOID
+  );
+
+/**
+  Compares two benchmark result files and reports regressions.
+
+  @param[in]  BaselinePath  Results of the reference run.
+  @param[in]  CurrentPath   Results of the run under test.
+  @param[in]  Threshold     Allowed slowdown in percent before a case is
+                            reported as a regression.
+
+  @retval  0  No regressions were found.
+  @retval  1  At least one case regressed.
+  @retval  2  A result file could not be read.
+**/
+int
+BenchmarkCompare (
+  IN CONST CHAR8  *BaselinePath,
+  IN CONST CHAR8  *CurrentPath,
+  IN UINTN        Threshold
+  );
+
+#endif // BASE_CRYPT_LIB_BENCHMARK_H_
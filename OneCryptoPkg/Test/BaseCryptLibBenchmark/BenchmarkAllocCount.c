@@ -0,0 +1,126 @@
+/** @file
+  Heap allocation counting for the BaseCryptLib host benchmark.
+
+  Both backends allocate through the C runtime on the host (OpenSSL via
+  CRYPTO_malloc and MbedTLS via its platform calloc), so counting at the C
+  runtime boundary covers every allocation a primitive makes. On glibc the
+  allocator entry points are interposed and forwarded to the __libc_*
+  implementations; with the MSVC debug runtime an allocation hook is used.
+  Other environments report allocation counts as unavailable.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseCryptLibBenchmark.h"
+
+#if defined (__GLIBC__) && !defined (__SANITIZE_ADDRESS__)
+
+extern void *
+__libc_malloc (
+  size_t  Size
+  );
+
+extern void *
+__libc_calloc (
+  size_t  Count,
+  size_t  Size
+  );
+
+extern void *
+__libc_realloc (
+  void    *Ptr,
+  size_t  Size
+  );
+
+STATIC volatile INT64  mAllocationCount = 0;
+
+void *
+malloc (
+  size_t  Size
+  )
+{
+  mAllocationCount++;
+  return __libc_malloc (Size);
+}
+
+void *
+calloc (
+  size_t  Count,
+  size_t  Size
+  )
+{
+  mAllocationCount++;
+  return __libc_calloc (Count, Size);
+}
+
+void *
+realloc (
+  void    *Ptr,
+  size_t  Size
+  )
+{
+  mAllocationCount++;
+  return __libc_realloc (Ptr, Size);
+}
+
+INT64
+BenchmarkAllocationCount (
+  VOID
+  )
+{
+  return mAllocationCount;
+}
+
+#elif defined (_MSC_VER) && defined (_DEBUG)
+
+  #include <crtdbg.h>
+
+STATIC volatile INT64  mAllocationCount = 0;
+STATIC BOOLEAN         mHookInstalled   = FALSE;
+
+STATIC
+int
+__cdecl
+BenchmarkAllocHook (
+  int                  AllocType,
+  void                 *UserData,
+  size_t               Size,
+  int                  BlockType,
+  long                 RequestNumber,
+  const unsigned char  *FileName,
+  int                  LineNumber
+  )
+{
+  if ((AllocType == _HOOK_ALLOC) || (AllocType == _HOOK_REALLOC)) {
+    mAllocationCount++;
+  }
+
+  return TRUE;
+}
+
+INT64
+BenchmarkAllocationCount (
+  VOID
+  )
+{
+  if (!mHookInstalled) {
+    _CrtSetAllocHook (BenchmarkAllocHook);
+    mHookInstalled = TRUE;
+  }
+
+  return mAllocationCount;
+}
+
+#else
+
+INT64
+BenchmarkAllocationCount (
+  VOID
+  )
+{
+  return -1;
+}
+
+#endif
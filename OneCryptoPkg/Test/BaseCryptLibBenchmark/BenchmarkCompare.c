@@ -0,0 +1,186 @@
+/** @file
+  Compare mode of the BaseCryptLib host benchmark.
+
+  Reads two result files produced by the benchmark and reports, per case,
+  the change in time per operation and allocations per operation. A case
+  regresses when it became slower than the threshold allows, allocates more
+  per operation, or stopped being supported.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseCryptLibBenchmark.h"
+
+#define BENCHMARK_MAX_RESULTS  256
+#define BENCHMARK_MAX_LINE     512
+
+typedef struct {
+  CHAR8     Name[64];
+  UINTN     Size;
+  BOOLEAN   Supported;
+  double    NsPerOp;
+  double    AllocsPerOp;
+} BENCHMARK_RESULT;
+
+/**
+  Loads the rows of a benchmark result file.
+
+  @param[in]   Path     Result file to read.
+  @param[out]  Results  Array receiving the parsed rows.
+  @param[out]  Count    Number of rows parsed.
+
+  @retval  TRUE   The file was read.
+  @retval  FALSE  The file could not be opened or has no header.
+**/
+STATIC
+BOOLEAN
+LoadResults (
+  IN  CONST CHAR8       *Path,
+  OUT BENCHMARK_RESULT  *Results,
+  OUT UINTN             *Count
+  )
+{
+  FILE              *File;
+  CHAR8             Line[BENCHMARK_MAX_LINE];
+  CHAR8             Status[16];
+  unsigned          Size;
+  unsigned          Iterations;
+  double            OpsPerSec;
+  double            CyclesPerByte;
+  BENCHMARK_RESULT  *Result;
+
+  *Count = 0;
+  File   = fopen (Path, "r");
+  if (File == NULL) {
+    fprintf (stderr, "Cannot open %s\n", Path);
+    return FALSE;
+  }
+
+  if ((fgets (Line, sizeof (Line), File) == NULL) ||
+      (strncmp (Line, BENCHMARK_CSV_HEADER, strlen (BENCHMARK_CSV_HEADER)) != 0))
+  {
+    fprintf (stderr, "%s is not a benchmark result file\n", Path);
+    fclose (File);
+    return FALSE;
+  }
+
+  while ((*Count < BENCHMARK_MAX_RESULTS) && (fgets (Line, sizeof (Line), File) != NULL)) {
+    Result = &Results[*Count];
+    if (sscanf (
+          Line,
+          "%*[^,],%63[^,],%u,%u,%15[^,],%lf,%lf,%lf,%lf",
+          Result->Name,
+          &Size,
+          &Iterations,
+          Status,
+          &Result->NsPerOp,
+          &OpsPerSec,
+          &CyclesPerByte,
+          &Result->AllocsPerOp
+          ) != 8)
+    {
+      continue;
+    }
+
+    Result->Size      = Size;
+    Result->Supported = (BOOLEAN)(strcmp (Status, "ok") == 0);
+    (*Count)++;
+  }
+
+  fclose (File);
+  return TRUE;
+}
+
+/**
+  Compares two benchmark result files and reports regressions.
+
+  @param[in]  BaselinePath  Results of the reference run.
+  @param[in]  CurrentPath   Results of the run under test.
+  @param[in]  Threshold     Allowed slowdown in percent before a case is
+                            reported as a regression.
+
+  @retval  0  No regressions were found.
+  @retval  1  At least one case regressed.
+  @retval  2  A result file could not be read.
+**/
+int
+BenchmarkCompare (
+  IN CONST CHAR8  *BaselinePath,
+  IN CONST CHAR8  *CurrentPath,
+  IN UINTN        Threshold
+  )
+{
+  STATIC BENCHMARK_RESULT  Baseline[BENCHMARK_MAX_RESULTS];
+  STATIC BENCHMARK_RESULT  Current[BENCHMARK_MAX_RESULTS];
+  UINTN                    BaselineCount;
+  UINTN                    CurrentCount;
+  UINTN                    Index;
+  UINTN                    Match;
+  BENCHMARK_RESULT         *Old;
+  BENCHMARK_RESULT         *New;
+  double                   Change;
+  CONST CHAR8              *Verdict;
+  UINTN                    Regressions;
+
+  if (!LoadResults (BaselinePath, Baseline, &BaselineCount) ||
+      !LoadResults (CurrentPath, Current, &CurrentCount))
+  {
+    return 2;
+  }
+
+  printf ("name,size,baseline_ns_per_op,current_ns_per_op,change_percent,baseline_allocs_per_op,current_allocs_per_op,verdict\n");
+
+  Regressions = 0;
+  for (Index = 0; Index < BaselineCount; Index++) {
+    Old = &Baseline[Index];
+    New = NULL;
+    for (Match = 0; Match < CurrentCount; Match++) {
+      if ((Current[Match].Size == Old->Size) && (strcmp (Current[Match].Name, Old->Name) == 0)) {
+        New = &Current[Match];
+        break;
+      }
+    }
+
+    if ((New == NULL) || !Old->Supported) {
+      continue;
+    }
+
+    Change = 0;
+    if (New->Supported && (Old->NsPerOp > 0)) {
+      Change = (New->NsPerOp - Old->NsPerOp) * 100.0 / Old->NsPerOp;
+    }
+
+    if (!New->Supported) {
+      Verdict = "REGRESSION (no longer supported)";
+    } else if (Change > (double)Threshold) {
+      Verdict = "REGRESSION (slower)";
+    } else if ((Old->AllocsPerOp >= 0) && (New->AllocsPerOp > Old->AllocsPerOp)) {
+      Verdict = "REGRESSION (more allocations)";
+    } else if (Change < -(double)Threshold) {
+      Verdict = "improved";
+    } else {
+      Verdict = "ok";
+    }
+
+    if (strncmp (Verdict, "REGRESSION", 10) == 0) {
+      Regressions++;
+    }
+
+    printf (
+      "%s,%u,%.1f,%.1f,%+.1f,%.2f,%.2f,%s\n",
+      Old->Name,
+      (unsigned)Old->Size,
+      Old->NsPerOp,
+      New->NsPerOp,
+      Change,
+      Old->AllocsPerOp,
+      New->AllocsPerOp,
+      Verdict
+      );
+  }
+
+  fprintf (stderr, "%u regression(s) above %u%% threshold\n", (unsigned)Regressions, (unsigned)Threshold);
+  return (Regressions == 0) ? 0 : 1;
+}
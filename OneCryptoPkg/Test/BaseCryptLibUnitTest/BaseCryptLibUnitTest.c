@@ -0,0 +1,78 @@
+/** @file
+  Host-based unit tests for the BaseCryptLib additions of this repository.
+
+  The suites check results against published vectors where they exist:
+  PBKDF2 against RFC 6070 and RFC 7914, and the SHA-256 tree against the
+  Merkle tree hash and audit paths of RFC 9162. The hash cache is checked
+  against a full tree hash of the same region after each refresh.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseCryptLibUnitTest.h"
+
+#define UNIT_TEST_NAME     "BaseCryptLib Extension Unit Tests"
+#define UNIT_TEST_VERSION  "1.0"
+
+/**
+  Initializes and runs the unit tests.
+
+  @retval  EFI_SUCCESS           All test suites ran.
+  @retval  EFI_OUT_OF_RESOURCES  A test suite could not be allocated.
+**/
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  Status = RegisterPbkdf2Tests (Framework);
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  Status = RegisterSha256TreeTests (Framework);
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  Status = RegisterHashCacheTests (Framework);
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  Status = RunAllTestSuites (Framework);
+
+Done:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UefiTestMain ();
+}
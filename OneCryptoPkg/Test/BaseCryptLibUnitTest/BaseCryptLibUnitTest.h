@@ -0,0 +1,61 @@
+/** @file
+  Internal definitions for the BaseCryptLib host unit tests.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef BASE_CRYPT_LIB_UNIT_TEST_H_
+#define BASE_CRYPT_LIB_UNIT_TEST_H_
+
+#include <Uefi.h>
+#include <Library/BaseCryptLib.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+#include <CryptHashCache.h>
+#include <CryptHashTree.h>
+
+/**
+  Adds the PBKDF2 test suite to the framework.
+
+  @param[in]  Framework  The unit test framework.
+
+  @retval  EFI_SUCCESS           The suite was added.
+  @retval  EFI_OUT_OF_RESOURCES  The suite could not be allocated.
+**/
+EFI_STATUS
+RegisterPbkdf2Tests (
+  IN UNIT_TEST_FRAMEWORK_HANDLE  Framework
+  );
+
+/**
+  Adds the SHA-256 tree test suite to the framework.
+
+  @param[in]  Framework  The unit test framework.
+
+  @retval  EFI_SUCCESS           The suite was added.
+  @retval  EFI_OUT_OF_RESOURCES  The suite could not be allocated.
+**/
+EFI_STATUS
+RegisterSha256TreeTests (
+  IN UNIT_TEST_FRAMEWORK_HANDLE  Framework
+  );
+
+/**
+  Adds the hash cache test suite to the framework.
+
+  @param[in]  Framework  The unit test framework.
+
+  @retval  EFI_SUCCESS           The suite was added.
+  @retval  EFI_OUT_OF_RESOURCES  The suite could not be allocated.
+**/
+EFI_STATUS
+RegisterHashCacheTests (
+  IN UNIT_TEST_FRAMEWORK_HANDLE  Framework
+  );
+
+#endif
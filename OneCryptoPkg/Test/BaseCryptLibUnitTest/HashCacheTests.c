@@ -0,0 +1,323 @@
+/** @file
+  Hash cache tests.
+
+  After every refresh the root must equal Sha256TreeHashAll () over the whole
+  region, whose results are checked against RFC 9162 in Sha256TreeTests.c.
+  The region ends in a short block and spans several words of the dirty map,
+  and the changes cover both the small refreshes hashed on the calling
+  processor and the large ones handed to DispatchItemsToAp ().
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseCryptLibUnitTest.h"
+
+#define CACHE_TEST_BLOCK_SIZE  512
+
+//
+// 513 blocks, the last one 100 bytes.
+//
+#define CACHE_TEST_REGION_SIZE  (SIZE_256KB + 100)
+
+//
+// Rounds of random writes, and the most writes and bytes per write in a
+// round.
+//
+#define CACHE_TEST_ROUNDS          64
+#define CACHE_TEST_MAX_WRITES      8
+#define CACHE_TEST_MAX_WRITE_SIZE  SIZE_2KB
+
+typedef struct {
+  UINT8    *Region;
+  VOID     *Cache;
+  UINT32   Seed;
+} CACHE_TEST_CONTEXT;
+
+STATIC CACHE_TEST_CONTEXT  mCacheTest;
+
+/**
+  Returns the next value of a linear congruential generator, so that the
+  random writes are the same on every run.
+
+  @return  A pseudo-random 32-bit value.
+**/
+STATIC
+UINT32
+CacheTestRandom (
+  VOID
+  )
+{
+  mCacheTest.Seed = mCacheTest.Seed * 1103515245 + 12345;
+  return mCacheTest.Seed;
+}
+
+/**
+  Fills the region with a pattern and starts tracking it.
+
+  @param[in]  Context  Unused.
+
+  @retval  UNIT_TEST_PASSED                      The cache is ready.
+  @retval  UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The cache could not be set
+                                                 up.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+CacheTestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  CacheSize;
+  UINTN  Index;
+
+  mCacheTest.Seed   = 1;
+  mCacheTest.Region = AllocatePool (CACHE_TEST_REGION_SIZE);
+  CacheSize         = Sha256HashCacheGetContextSize (CACHE_TEST_REGION_SIZE, CACHE_TEST_BLOCK_SIZE);
+  mCacheTest.Cache  = (CacheSize == 0) ? NULL : AllocatePool (CacheSize);
+  if ((mCacheTest.Region == NULL) || (mCacheTest.Cache == NULL)) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  for (Index = 0; Index < CACHE_TEST_REGION_SIZE; Index++) {
+    mCacheTest.Region[Index] = (UINT8)(Index * 7 + (Index >> 8));
+  }
+
+  if (!Sha256HashCacheInit (mCacheTest.Cache, CacheSize, mCacheTest.Region, CACHE_TEST_REGION_SIZE, CACHE_TEST_BLOCK_SIZE)) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Frees the region and the cache.
+
+  @param[in]  Context  Unused.
+**/
+VOID
+EFIAPI
+CacheTestCleanup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  if (mCacheTest.Region != NULL) {
+    FreePool (mCacheTest.Region);
+  }
+
+  if (mCacheTest.Cache != NULL) {
+    FreePool (mCacheTest.Cache);
+  }
+
+  ZeroMem (&mCacheTest, sizeof (mCacheTest));
+}
+
+/**
+  Changes a byte range of the region and marks it dirty.
+
+  @param[in]  Offset  Offset of the first byte to change.
+  @param[in]  Length  Number of bytes to change.
+
+  @retval  TRUE   The range is marked.
+  @retval  FALSE  Sha256HashCacheMarkDirty () failed.
+**/
+STATIC
+BOOLEAN
+CacheTestWrite (
+  IN UINTN  Offset,
+  IN UINTN  Length
+  )
+{
+  UINTN  Index;
+
+  for (Index = Offset; Index < Offset + Length; Index++) {
+    mCacheTest.Region[Index] ^= (UINT8)(CacheTestRandom () >> 24) | 1;
+  }
+
+  return Sha256HashCacheMarkDirty (mCacheTest.Cache, Offset, Length);
+}
+
+/**
+  Checks that a refresh returns the tree hash of the whole region.
+
+  @retval  UNIT_TEST_PASSED             The roots match.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  An assertion failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+CacheTestCheckRoot (
+  VOID
+  )
+{
+  UINT8  Root[SHA256_DIGEST_SIZE];
+  UINT8  Expected[SHA256_DIGEST_SIZE];
+
+  UT_ASSERT_TRUE (Sha256HashCacheRefresh (mCacheTest.Cache, Root));
+  UT_ASSERT_TRUE (Sha256TreeHashAll (mCacheTest.Region, CACHE_TEST_REGION_SIZE, CACHE_TEST_BLOCK_SIZE, Expected));
+  UT_ASSERT_MEM_EQUAL (Root, Expected, SHA256_DIGEST_SIZE);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A fresh cache has the tree hash of the region, and marking bytes that did
+  not change keeps it.
+
+  @param[in]  Context  Unused.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestCacheInitialRoot (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UNIT_TEST_STATUS  Status;
+
+  Status = CacheTestCheckRoot ();
+  if (Status != UNIT_TEST_PASSED) {
+    return Status;
+  }
+
+  UT_ASSERT_TRUE (Sha256HashCacheMarkDirty (mCacheTest.Cache, 1000, 5000));
+  UT_ASSERT_TRUE (Sha256HashCacheMarkDirty (mCacheTest.Cache, 0, CACHE_TEST_REGION_SIZE));
+  return CacheTestCheckRoot ();
+}
+
+/**
+  Small changes at block and dirty map word boundaries and in the short last
+  block are picked up, and block digests are only returned once refreshed.
+
+  @param[in]  Context  Unused.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestCacheRefreshSmall (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UNIT_TEST_STATUS  Status;
+  UINT8             Leaf[1 + CACHE_TEST_BLOCK_SIZE];
+  UINT8             Digest[SHA256_DIGEST_SIZE];
+  UINT8             Expected[SHA256_DIGEST_SIZE];
+  UINTN             Offset;
+
+  UT_ASSERT_TRUE (CacheTestWrite (0, 1));
+  UT_ASSERT_TRUE (CacheTestWrite (CACHE_TEST_BLOCK_SIZE - 1, 2));
+  UT_ASSERT_TRUE (CacheTestWrite (63 * CACHE_TEST_BLOCK_SIZE + 10, CACHE_TEST_BLOCK_SIZE));
+  UT_ASSERT_TRUE (CacheTestWrite (200 * CACHE_TEST_BLOCK_SIZE, 3 * CACHE_TEST_BLOCK_SIZE));
+  UT_ASSERT_TRUE (CacheTestWrite (CACHE_TEST_REGION_SIZE - 1, 1));
+
+  UT_ASSERT_FALSE (Sha256HashCacheGetBlockDigest (mCacheTest.Cache, 64 * CACHE_TEST_BLOCK_SIZE, Digest));
+  UT_ASSERT_TRUE (Sha256HashCacheGetBlockDigest (mCacheTest.Cache, 100 * CACHE_TEST_BLOCK_SIZE, Digest));
+
+  Status = CacheTestCheckRoot ();
+  if (Status != UNIT_TEST_PASSED) {
+    return Status;
+  }
+
+  //
+  // The cached digest of a refreshed block is its leaf hash.
+  //
+  Offset  = 64 * CACHE_TEST_BLOCK_SIZE;
+  Leaf[0] = 0x00;
+  CopyMem (Leaf + 1, mCacheTest.Region + Offset, CACHE_TEST_BLOCK_SIZE);
+  UT_ASSERT_TRUE (Sha256HashAll (Leaf, sizeof (Leaf), Expected));
+  UT_ASSERT_TRUE (Sha256HashCacheGetBlockDigest (mCacheTest.Cache, Offset + 7, Digest));
+  UT_ASSERT_MEM_EQUAL (Digest, Expected, SHA256_DIGEST_SIZE);
+
+  UT_ASSERT_FALSE (Sha256HashCacheMarkDirty (mCacheTest.Cache, CACHE_TEST_REGION_SIZE - 1, 2));
+  UT_ASSERT_FALSE (Sha256HashCacheGetBlockDigest (mCacheTest.Cache, CACHE_TEST_REGION_SIZE, Digest));
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A change large enough to be shared with the APs is picked up.
+
+  @param[in]  Context  Unused.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestCacheRefreshLarge (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UT_ASSERT_TRUE (CacheTestWrite (SIZE_4KB + 1, SIZE_128KB));
+  return CacheTestCheckRoot ();
+}
+
+/**
+  Rounds of random writes, some marked before they are made, are picked up.
+
+  @param[in]  Context  Unused.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestCacheRefreshRandom (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UNIT_TEST_STATUS  Status;
+  UINTN             Round;
+  UINTN             Writes;
+  UINTN             Offset;
+  UINTN             Length;
+
+  for (Round = 0; Round < CACHE_TEST_ROUNDS; Round++) {
+    for (Writes = CacheTestRandom () % CACHE_TEST_MAX_WRITES + 1; Writes > 0; Writes--) {
+      Offset = CacheTestRandom () % CACHE_TEST_REGION_SIZE;
+      Length = MIN (CacheTestRandom () % CACHE_TEST_MAX_WRITE_SIZE + 1, CACHE_TEST_REGION_SIZE - Offset);
+      if ((Writes & 1) != 0) {
+        UT_ASSERT_TRUE (CacheTestWrite (Offset, Length));
+      } else {
+        UT_ASSERT_TRUE (Sha256HashCacheMarkDirty (mCacheTest.Cache, Offset, Length));
+        mCacheTest.Region[Offset + Length - 1] ^= 0x5A;
+      }
+    }
+
+    Status = CacheTestCheckRoot ();
+    if (Status != UNIT_TEST_PASSED) {
+      return Status;
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Adds the hash cache test suite to the framework.
+
+  @param[in]  Framework  The unit test framework.
+
+  @retval  EFI_SUCCESS           The suite was added.
+  @retval  EFI_OUT_OF_RESOURCES  The suite could not be allocated.
+**/
+EFI_STATUS
+RegisterHashCacheTests (
+  IN UNIT_TEST_FRAMEWORK_HANDLE  Framework
+  )
+{
+  EFI_STATUS              Status;
+  UNIT_TEST_SUITE_HANDLE  Suite;
+
+  Status = CreateUnitTestSuite (&Suite, Framework, "SHA-256 Hash Cache", "BaseCryptLib.HashCache", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  AddTestCase (Suite, "Initial root matches a full hash", "HashCache.InitialRoot", TestCacheInitialRoot, CacheTestSetup, CacheTestCleanup, NULL);
+  AddTestCase (Suite, "Small changes are refreshed", "HashCache.RefreshSmall", TestCacheRefreshSmall, CacheTestSetup, CacheTestCleanup, NULL);
+  AddTestCase (Suite, "Large changes are refreshed", "HashCache.RefreshLarge", TestCacheRefreshLarge, CacheTestSetup, CacheTestCleanup, NULL);
+  AddTestCase (Suite, "Random changes are refreshed", "HashCache.RefreshRandom", TestCacheRefreshRandom, CacheTestSetup, CacheTestCleanup, NULL);
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,354 @@
+/** @file
+  PBKDF2 known-answer tests.
+
+  The SHA-1 vectors are those of RFC 6070 and the SHA-256 vectors of RFC 7914
+  section 11. They run through OpenSSL and through the precomputed pad state
+  path of the SHA-2 digests respectively. The remaining vectors were computed
+  with an independent PBKDF2 implementation and cover a password longer than
+  the hash block, an output that does not fill the last lane group, and the
+  SHA-384 and SHA-512 paths.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseCryptLibUnitTest.h"
+
+//
+// Largest derived key of the vectors below.
+//
+#define PBKDF2_MAX_KEY_SIZE  160
+
+#define LONG_PASSWORD \
+  "passwordPASSWORDpassword" "passwordPASSWORDpassword" "passwordPASSWORDpassword"
+
+typedef struct {
+  CONST CHAR8    *Description;
+  CONST CHAR8    *ClassName;
+  CONST CHAR8    *Password;
+  UINTN          PasswordLength;
+  CONST CHAR8    *Salt;
+  UINTN          SaltLength;
+  UINTN          IterationCount;
+  UINTN          DigestSize;
+  CONST UINT8    *DerivedKey;
+  UINTN          DerivedKeySize;
+} PBKDF2_VECTOR;
+
+//
+// RFC 6070, c = 1.
+//
+STATIC CONST UINT8  mRfc6070C1[] = {
+  0x0C, 0x60, 0xC8, 0x0F, 0x96, 0x1F, 0x0E, 0x71, 0xF3, 0xA9, 0xB5, 0x24, 0xAF, 0x60, 0x12, 0x06,
+  0x2F, 0xE0, 0x37, 0xA6,
+};
+
+//
+// RFC 6070, c = 2.
+//
+STATIC CONST UINT8  mRfc6070C2[] = {
+  0xEA, 0x6C, 0x01, 0x4D, 0xC7, 0x2D, 0x6F, 0x8C, 0xCD, 0x1E, 0xD9, 0x2A, 0xCE, 0x1D, 0x41, 0xF0,
+  0xD8, 0xDE, 0x89, 0x57,
+};
+
+//
+// RFC 6070, c = 4096.
+//
+STATIC CONST UINT8  mRfc6070C4096[] = {
+  0x4B, 0x00, 0x79, 0x01, 0xB7, 0x65, 0x48, 0x9A, 0xBE, 0xAD, 0x49, 0xD9, 0x26, 0xF7, 0x21, 0xD0,
+  0x65, 0xA4, 0x29, 0xC1,
+};
+
+//
+// RFC 6070, long password and salt.
+//
+STATIC CONST UINT8  mRfc6070Long[] = {
+  0x3D, 0x2E, 0xEC, 0x4F, 0xE4, 0x1C, 0x84, 0x9B, 0x80, 0xC8, 0xD8, 0x36, 0x62, 0xC0, 0xE4, 0x4A,
+  0x8B, 0x29, 0x1A, 0x96, 0x4C, 0xF2, 0xF0, 0x70, 0x38,
+};
+
+//
+// RFC 6070, embedded NUL.
+//
+STATIC CONST UINT8  mRfc6070Nul[] = {
+  0x56, 0xFA, 0x6A, 0xA7, 0x55, 0x48, 0x09, 0x9D, 0xCC, 0x37, 0xD7, 0xF0, 0x34, 0x25, 0xE0, 0xC3,
+};
+
+//
+// RFC 7914 section 11, c = 1.
+//
+STATIC CONST UINT8  mRfc7914C1[] = {
+  0x55, 0xAC, 0x04, 0x6E, 0x56, 0xE3, 0x08, 0x9F, 0xEC, 0x16, 0x91, 0xC2, 0x25, 0x44, 0xB6, 0x05,
+  0xF9, 0x41, 0x85, 0x21, 0x6D, 0xDE, 0x04, 0x65, 0xE6, 0x8B, 0x9D, 0x57, 0xC2, 0x0D, 0xAC, 0xBC,
+  0x49, 0xCA, 0x9C, 0xCC, 0xF1, 0x79, 0xB6, 0x45, 0x99, 0x16, 0x64, 0xB3, 0x9D, 0x77, 0xEF, 0x31,
+  0x7C, 0x71, 0xB8, 0x45, 0xB1, 0xE3, 0x0B, 0xD5, 0x09, 0x11, 0x20, 0x41, 0xD3, 0xA1, 0x97, 0x83,
+};
+
+//
+// RFC 7914 section 11, c = 80000.
+//
+STATIC CONST UINT8  mRfc7914C80000[] = {
+  0x4D, 0xDC, 0xD8, 0xF6, 0x0B, 0x98, 0xBE, 0x21, 0x83, 0x0C, 0xEE, 0x5E, 0xF2, 0x27, 0x01, 0xF9,
+  0x64, 0x1A, 0x44, 0x18, 0xD0, 0x4C, 0x04, 0x14, 0xAE, 0xFF, 0x08, 0x87, 0x6B, 0x34, 0xAB, 0x56,
+  0xA1, 0xD4, 0x25, 0xA1, 0x22, 0x58, 0x33, 0x54, 0x9A, 0xDB, 0x84, 0x1B, 0x51, 0xC9, 0xB3, 0x17,
+  0x6A, 0x27, 0x2B, 0xDE, 0xBB, 0xA1, 0xD0, 0x78, 0x47, 0x8F, 0x62, 0xB3, 0x97, 0xF3, 0x3C, 0x8D,
+};
+
+//
+// SHA-256, password longer than a block, output not a whole number of lanes.
+//
+STATIC CONST UINT8  mSha256LongPassword[] = {
+  0xF2, 0xE4, 0x42, 0x20, 0x4C, 0xAF, 0x1B, 0x26, 0x38, 0x13, 0x73, 0x9E, 0x26, 0xAB, 0x9F, 0x3A,
+  0x67, 0x78, 0xE5, 0x84, 0x6A, 0x61, 0x42, 0x3E, 0x96, 0x4B, 0x01, 0x77, 0xF7, 0xB7, 0xE0, 0xE6,
+  0x9B, 0xD0, 0xD6, 0x73, 0xDC, 0xF3, 0x8A, 0x69, 0x19, 0x6C, 0xEF, 0x56, 0x61, 0xA4, 0x8E, 0xE2,
+  0x49, 0x1A, 0x0D, 0xBF, 0x0E, 0x68, 0x1B, 0x15, 0xED, 0xA3, 0xC3, 0x18, 0x03, 0x5A, 0xF3, 0xA3,
+  0xCA, 0xFC, 0x94, 0xE3, 0x94, 0x32, 0x74, 0x28, 0xAB, 0xF9, 0x39, 0x8D, 0xC3, 0xD2, 0xC4, 0x0E,
+  0x39, 0x16, 0x36, 0xD4, 0x08, 0x52, 0x32, 0xCF, 0x4C, 0x2F, 0x25, 0x2C, 0x37, 0xE2, 0x71, 0x01,
+  0x3D, 0x8E, 0x0A, 0xEF, 0x38, 0xCA, 0xB4, 0xC8, 0x32, 0xD1, 0x4D, 0x5C, 0xB9, 0x6A, 0x84, 0x6A,
+  0x13, 0xDE, 0xB9, 0x99, 0x8F, 0x8A, 0x08, 0xCB, 0xF0, 0xB3, 0x4E, 0x74, 0xEA, 0xD8, 0xD1, 0x06,
+  0x59, 0xDC, 0xE7, 0x52, 0x6E, 0xA7, 0x53, 0x55, 0xCA, 0x9F, 0x2E, 0xAE, 0x27, 0x41, 0xD0, 0x48,
+  0x5F, 0xD7, 0x01, 0x54, 0xA9, 0xEC,
+};
+
+//
+// SHA-384, c = 2.
+//
+STATIC CONST UINT8  mSha384C2[] = {
+  0x54, 0xF7, 0x75, 0xC6, 0xD7, 0x90, 0xF2, 0x19, 0x30, 0x45, 0x91, 0x62, 0xFC, 0x53, 0x5D, 0xBF,
+  0x04, 0xA9, 0x39, 0x18, 0x51, 0x27, 0x01, 0x6A, 0x04, 0x17, 0x6A, 0x07, 0x30, 0xC6, 0xF1, 0xF4,
+  0xFB, 0x48, 0x83, 0x2A, 0xD1, 0x26, 0x1B, 0xAA, 0xDD, 0x2C, 0xED, 0xD5, 0x08, 0x14, 0xB1, 0xC8,
+};
+
+//
+// SHA-512, c = 1.
+//
+STATIC CONST UINT8  mSha512C1[] = {
+  0x86, 0x7F, 0x70, 0xCF, 0x1A, 0xDE, 0x02, 0xCF, 0xF3, 0x75, 0x25, 0x99, 0xA3, 0xA5, 0x3D, 0xC4,
+  0xAF, 0x34, 0xC7, 0xA6, 0x69, 0x81, 0x5A, 0xE5, 0xD5, 0x13, 0x55, 0x4E, 0x1C, 0x8C, 0xF2, 0x52,
+  0xC0, 0x2D, 0x47, 0x0A, 0x28, 0x5A, 0x05, 0x01, 0xBA, 0xD9, 0x99, 0xBF, 0xE9, 0x43, 0xC0, 0x8F,
+  0x05, 0x02, 0x35, 0xD7, 0xD6, 0x8B, 0x1D, 0xA5, 0x5E, 0x63, 0xF7, 0x3B, 0x60, 0xA5, 0x7F, 0xCE,
+};
+
+STATIC CONST PBKDF2_VECTOR  mPbkdf2Vectors[] = {
+  {
+    "RFC 6070, c = 1",
+    "Pbkdf2.Rfc6070.C1",
+    "password",
+    sizeof ("password") - 1,
+    "salt",
+    sizeof ("salt") - 1,
+    1,
+    SHA1_DIGEST_SIZE,
+    mRfc6070C1,
+    sizeof (mRfc6070C1)
+  },
+  {
+    "RFC 6070, c = 2",
+    "Pbkdf2.Rfc6070.C2",
+    "password",
+    sizeof ("password") - 1,
+    "salt",
+    sizeof ("salt") - 1,
+    2,
+    SHA1_DIGEST_SIZE,
+    mRfc6070C2,
+    sizeof (mRfc6070C2)
+  },
+  {
+    "RFC 6070, c = 4096",
+    "Pbkdf2.Rfc6070.C4096",
+    "password",
+    sizeof ("password") - 1,
+    "salt",
+    sizeof ("salt") - 1,
+    4096,
+    SHA1_DIGEST_SIZE,
+    mRfc6070C4096,
+    sizeof (mRfc6070C4096)
+  },
+  {
+    "RFC 6070, long password and salt",
+    "Pbkdf2.Rfc6070.Long",
+    "passwordPASSWORDpassword",
+    sizeof ("passwordPASSWORDpassword") - 1,
+    "saltSALTsaltSALTsaltSALTsaltSALTsalt",
+    sizeof ("saltSALTsaltSALTsaltSALTsaltSALTsalt") - 1,
+    4096,
+    SHA1_DIGEST_SIZE,
+    mRfc6070Long,
+    sizeof (mRfc6070Long)
+  },
+  {
+    "RFC 6070, embedded NUL",
+    "Pbkdf2.Rfc6070.Nul",
+    "pass\0word",
+    sizeof ("pass\0word") - 1,
+    "sa\0lt",
+    sizeof ("sa\0lt") - 1,
+    4096,
+    SHA1_DIGEST_SIZE,
+    mRfc6070Nul,
+    sizeof (mRfc6070Nul)
+  },
+  {
+    "RFC 7914 section 11, c = 1",
+    "Pbkdf2.Rfc7914.C1",
+    "passwd",
+    sizeof ("passwd") - 1,
+    "salt",
+    sizeof ("salt") - 1,
+    1,
+    SHA256_DIGEST_SIZE,
+    mRfc7914C1,
+    sizeof (mRfc7914C1)
+  },
+  {
+    "RFC 7914 section 11, c = 80000",
+    "Pbkdf2.Rfc7914.C80000",
+    "Password",
+    sizeof ("Password") - 1,
+    "NaCl",
+    sizeof ("NaCl") - 1,
+    80000,
+    SHA256_DIGEST_SIZE,
+    mRfc7914C80000,
+    sizeof (mRfc7914C80000)
+  },
+  {
+    "SHA-256, password longer than a block, output not a whole number of lanes",
+    "Pbkdf2.Sha256.LongPassword",
+    LONG_PASSWORD,
+    sizeof (LONG_PASSWORD) - 1,
+    "saltSALT",
+    sizeof ("saltSALT") - 1,
+    100,
+    SHA256_DIGEST_SIZE,
+    mSha256LongPassword,
+    sizeof (mSha256LongPassword)
+  },
+  {
+    "SHA-384, c = 2",
+    "Pbkdf2.Sha384.C2",
+    "password",
+    sizeof ("password") - 1,
+    "salt",
+    sizeof ("salt") - 1,
+    2,
+    SHA384_DIGEST_SIZE,
+    mSha384C2,
+    sizeof (mSha384C2)
+  },
+  {
+    "SHA-512, c = 1",
+    "Pbkdf2.Sha512.C1",
+    "password",
+    sizeof ("password") - 1,
+    "salt",
+    sizeof ("salt") - 1,
+    1,
+    SHA512_DIGEST_SIZE,
+    mSha512C1,
+    sizeof (mSha512C1)
+  },
+};
+
+/**
+  Derives the key of one vector and compares it with the expected key.
+
+  @param[in]  Context  The PBKDF2_VECTOR to check.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestPbkdf2Vector (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  CONST PBKDF2_VECTOR  *Vector;
+  UINT8                Key[PBKDF2_MAX_KEY_SIZE];
+
+  Vector = (CONST PBKDF2_VECTOR *)Context;
+  UT_ASSERT_TRUE (Vector->DerivedKeySize <= sizeof (Key));
+
+  ZeroMem (Key, sizeof (Key));
+  UT_ASSERT_TRUE (
+    Pkcs5HashPassword (
+      Vector->PasswordLength,
+      Vector->Password,
+      Vector->SaltLength,
+      (CONST UINT8 *)Vector->Salt,
+      Vector->IterationCount,
+      Vector->DigestSize,
+      Vector->DerivedKeySize,
+      Key
+      )
+    );
+  UT_ASSERT_MEM_EQUAL (Key, Vector->DerivedKey, Vector->DerivedKeySize);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Invalid parameters are rejected.
+
+  @param[in]  Context  Unused.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestPbkdf2InvalidParameters (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8  Key[SHA256_DIGEST_SIZE];
+
+  UT_ASSERT_FALSE (Pkcs5HashPassword (6, "passwd", 4, (CONST UINT8 *)"salt", 0, SHA256_DIGEST_SIZE, sizeof (Key), Key));
+  UT_ASSERT_FALSE (Pkcs5HashPassword (6, "passwd", 4, (CONST UINT8 *)"salt", 1, SHA256_DIGEST_SIZE + 1, sizeof (Key), Key));
+  UT_ASSERT_FALSE (Pkcs5HashPassword (6, "passwd", 4, (CONST UINT8 *)"salt", 1, SHA256_DIGEST_SIZE, 0, Key));
+  UT_ASSERT_FALSE (Pkcs5HashPassword (6, "passwd", 4, (CONST UINT8 *)"salt", 1, SHA256_DIGEST_SIZE, sizeof (Key), NULL));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Adds the PBKDF2 test suite to the framework.
+
+  @param[in]  Framework  The unit test framework.
+
+  @retval  EFI_SUCCESS           The suite was added.
+  @retval  EFI_OUT_OF_RESOURCES  The suite could not be allocated.
+**/
+EFI_STATUS
+RegisterPbkdf2Tests (
+  IN UNIT_TEST_FRAMEWORK_HANDLE  Framework
+  )
+{
+  EFI_STATUS              Status;
+  UNIT_TEST_SUITE_HANDLE  Suite;
+  UINTN                   Index;
+
+  Status = CreateUnitTestSuite (&Suite, Framework, "PBKDF2 Known Answers", "BaseCryptLib.Pbkdf2", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mPbkdf2Vectors); Index++) {
+    AddTestCase (
+      Suite,
+      mPbkdf2Vectors[Index].Description,
+      mPbkdf2Vectors[Index].ClassName,
+      TestPbkdf2Vector,
+      NULL,
+      NULL,
+      (UNIT_TEST_CONTEXT)&mPbkdf2Vectors[Index]
+      );
+  }
+
+  AddTestCase (Suite, "Invalid parameters are rejected", "Pbkdf2.InvalidParameters", TestPbkdf2InvalidParameters, NULL, NULL, NULL);
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,441 @@
+/** @file
+  SHA-256 tree hash tests.
+
+  The expected roots and audit paths follow RFC 9162 section 2.1: the Merkle
+  tree hash MTH () with leaf hashes SHA-256 (0x00 || leaf) and node hashes
+  SHA-256 (0x01 || left || right), split at the largest power of two below
+  the leaf count, and the audit path PATH (m, D[n]) of section 2.1.3.1. They
+  were computed from those definitions, independently of the implementation
+  under test, over leaves of TREE_TEST_LEAF_SIZE bytes of the pattern
+  Data[i] = i.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseCryptLibUnitTest.h"
+
+#define TREE_TEST_LEAF_SIZE  4
+
+//
+// Size of the pattern, enough for 64 leaves.
+//
+#define TREE_TEST_DATA_SIZE  (64 * TREE_TEST_LEAF_SIZE)
+
+//
+// Data size of the tree the audit path vectors belong to: 7 leaves.
+//
+#define TREE_TEST_PROOF_DATA_SIZE  (7 * TREE_TEST_LEAF_SIZE)
+
+typedef struct {
+  UINTN    DataSize;
+  UINT8    Root[SHA256_DIGEST_SIZE];
+} TREE_ROOT_VECTOR;
+
+typedef struct {
+  UINTN          LeafIndex;
+  CONST UINT8    *Proof;
+  UINTN          ProofSize;
+} TREE_PROOF_VECTOR;
+
+STATIC CONST TREE_ROOT_VECTOR  mTreeRootVectors[] = {
+  //
+  // Empty input, the hash of the empty string.
+  //
+  {
+    0,
+    {
+      0xE3, 0xB0, 0xC4, 0x42, 0x98, 0xFC, 0x1C, 0x14, 0x9A, 0xFB, 0xF4, 0xC8, 0x99, 0x6F, 0xB9, 0x24,
+      0x27, 0xAE, 0x41, 0xE4, 0x64, 0x9B, 0x93, 0x4C, 0xA4, 0x95, 0x99, 0x1B, 0x78, 0x52, 0xB8, 0x55,
+    }
+  },
+  //
+  // One short leaf.
+  //
+  {
+    1,
+    {
+      0x96, 0xA2, 0x96, 0xD2, 0x24, 0xF2, 0x85, 0xC6, 0x7B, 0xEE, 0x93, 0xC3, 0x0F, 0x8A, 0x30, 0x91,
+      0x57, 0xF0, 0xDA, 0xA3, 0x5D, 0xC5, 0xB8, 0x7E, 0x41, 0x0B, 0x78, 0x63, 0x0A, 0x09, 0xCF, 0xC7,
+    }
+  },
+  //
+  // One full leaf.
+  //
+  {
+    4,
+    {
+      0xA4, 0x98, 0xEF, 0xA8, 0xD0, 0x75, 0x9E, 0x7B, 0x70, 0x40, 0x95, 0x85, 0x3D, 0xB9, 0xBC, 0x1E,
+      0xF8, 0xCF, 0x65, 0xAF, 0x37, 0xBE, 0xD9, 0xD0, 0x06, 0xC4, 0xB2, 0x91, 0x7E, 0x69, 0x50, 0x61,
+    }
+  },
+  //
+  // 2 leaves.
+  //
+  {
+    8,
+    {
+      0x00, 0x01, 0x34, 0xE5, 0x5E, 0x67, 0x85, 0x4E, 0x1A, 0x3D, 0x28, 0xA7, 0x8C, 0x63, 0x92, 0xB0,
+      0x26, 0x23, 0xC2, 0x50, 0x55, 0x80, 0xB0, 0xF9, 0xD5, 0x71, 0xE0, 0xB4, 0xD3, 0xE2, 0x25, 0x7F,
+    }
+  },
+  //
+  // 3 leaves.
+  //
+  {
+    12,
+    {
+      0x3B, 0x46, 0x9D, 0x6B, 0x25, 0x65, 0x37, 0x4B, 0xF3, 0xF9, 0xD7, 0x40, 0x56, 0x27, 0xA5, 0x9E,
+      0x3D, 0xBA, 0x9A, 0x32, 0x07, 0xF3, 0xC5, 0x2B, 0x06, 0xDB, 0x08, 0xE7, 0x19, 0x0E, 0x1F, 0x14,
+    }
+  },
+  //
+  // 5 leaves.
+  //
+  {
+    20,
+    {
+      0x0A, 0x30, 0xD6, 0x14, 0x8F, 0xC3, 0xD1, 0xC3, 0x8B, 0xC9, 0x06, 0x24, 0x14, 0x8F, 0x20, 0x21,
+      0xEE, 0x9D, 0x4A, 0x72, 0xD2, 0xFD, 0xCB, 0x53, 0xDC, 0xBA, 0x91, 0xE4, 0x62, 0x37, 0xF6, 0xD0,
+    }
+  },
+  //
+  // 7 leaves.
+  //
+  {
+    28,
+    {
+      0x6A, 0x64, 0x8B, 0x43, 0x6A, 0x7B, 0xA0, 0x96, 0x6D, 0x61, 0xD0, 0x3E, 0x31, 0x03, 0x3B, 0x8E,
+      0x6A, 0x5D, 0x69, 0xDC, 0xBF, 0x73, 0x77, 0x7A, 0xFB, 0x50, 0x8A, 0xB1, 0xF0, 0x26, 0x0A, 0x63,
+    }
+  },
+  //
+  // 8 leaves, the last one short.
+  //
+  {
+    30,
+    {
+      0x16, 0x9B, 0xD3, 0x37, 0x2F, 0xDA, 0xC7, 0xE9, 0xFA, 0xDD, 0x0C, 0xCB, 0x66, 0xFC, 0x91, 0x3B,
+      0xA8, 0xE9, 0x59, 0xCB, 0xCC, 0x3F, 0x4E, 0xAA, 0x4B, 0x5B, 0xFA, 0x6A, 0xD6, 0x75, 0xEA, 0x70,
+    }
+  },
+  //
+  // 16 leaves.
+  //
+  {
+    64,
+    {
+      0x7B, 0xD6, 0x69, 0x01, 0x94, 0xF2, 0x22, 0xE3, 0xDE, 0x21, 0x80, 0x6E, 0xB8, 0x29, 0x0B, 0x84,
+      0x1E, 0xED, 0x5A, 0x28, 0xB1, 0x4B, 0x96, 0x78, 0xA4, 0x4D, 0x70, 0xC8, 0x37, 0x78, 0x31, 0xB2,
+    }
+  },
+};
+
+//
+// Audit paths of leaves 0, 4 and 6 of the 7-leaf tree, innermost sibling
+// first.
+//
+STATIC CONST UINT8  mTreeProofLeaf0[] = {
+  0x5A, 0xB0, 0x68, 0x00, 0x27, 0xD2, 0x5A, 0xDB, 0xC3, 0x96, 0x35, 0xAE, 0x41, 0xB3, 0xBF, 0xDB,
+  0xD9, 0xB3, 0xC4, 0xBD, 0x82, 0x98, 0x99, 0xD1, 0xBA, 0x9C, 0x84, 0x51, 0x55, 0xE6, 0x04, 0xF0,
+  0xD5, 0xEB, 0xBC, 0x39, 0xE8, 0xBD, 0x0D, 0xCE, 0xB9, 0xF7, 0x12, 0x0B, 0xA5, 0x88, 0xF9, 0x1A,
+  0x38, 0x67, 0x14, 0xBF, 0x51, 0xE3, 0x20, 0x37, 0x3F, 0x66, 0x79, 0x27, 0x23, 0x16, 0x66, 0xDA,
+  0x6A, 0x6E, 0x34, 0x83, 0xAE, 0x06, 0xD8, 0xA9, 0xE5, 0x1F, 0x8E, 0x35, 0x8A, 0xD2, 0xAB, 0x66,
+  0x4F, 0xF4, 0x9D, 0x2C, 0xCA, 0xF7, 0x35, 0x99, 0xFC, 0xE9, 0x7D, 0x68, 0xBB, 0x5C, 0xA8, 0xD7,
+};
+
+STATIC CONST UINT8  mTreeProofLeaf4[] = {
+  0x7D, 0xFE, 0x7F, 0x54, 0x43, 0xDB, 0x12, 0x60, 0xD4, 0x20, 0x47, 0x6A, 0x9F, 0x96, 0xF8, 0x1A,
+  0x4E, 0x82, 0x63, 0x0F, 0xF6, 0x58, 0x8C, 0xD4, 0x56, 0x0E, 0xE3, 0xC8, 0xC0, 0x24, 0xA1, 0x2F,
+  0xB6, 0xDC, 0xE9, 0x34, 0x43, 0xA4, 0xF9, 0x2A, 0x7C, 0x78, 0x09, 0xC2, 0x09, 0x19, 0xAB, 0xA6,
+  0x1B, 0x0E, 0x19, 0x6F, 0xFC, 0x24, 0x27, 0xE9, 0x6C, 0x18, 0x1B, 0x95, 0xA4, 0x55, 0x56, 0xC5,
+  0x51, 0x6C, 0x43, 0xCB, 0x9E, 0x4F, 0x82, 0xFE, 0x70, 0x43, 0x77, 0x03, 0xF0, 0xA4, 0x16, 0x49,
+  0xC5, 0xFD, 0x96, 0x3B, 0xA5, 0xF4, 0xBE, 0x8B, 0x73, 0x6D, 0xCA, 0x20, 0xBA, 0xE0, 0x5B, 0xDD,
+};
+
+STATIC CONST UINT8  mTreeProofLeaf6[] = {
+  0x83, 0x90, 0x99, 0x99, 0x38, 0xD7, 0x09, 0x25, 0x96, 0xCB, 0x98, 0xA1, 0x4E, 0x20, 0x61, 0x2C,
+  0xB3, 0x3C, 0xCA, 0xA2, 0x67, 0xF8, 0xC5, 0xC5, 0x55, 0xE1, 0x8E, 0xE6, 0xA7, 0x67, 0xE9, 0xDD,
+  0x51, 0x6C, 0x43, 0xCB, 0x9E, 0x4F, 0x82, 0xFE, 0x70, 0x43, 0x77, 0x03, 0xF0, 0xA4, 0x16, 0x49,
+  0xC5, 0xFD, 0x96, 0x3B, 0xA5, 0xF4, 0xBE, 0x8B, 0x73, 0x6D, 0xCA, 0x20, 0xBA, 0xE0, 0x5B, 0xDD,
+};
+
+STATIC CONST TREE_PROOF_VECTOR  mTreeProofVectors[] = {
+  { 0, mTreeProofLeaf0, sizeof (mTreeProofLeaf0) },
+  { 4, mTreeProofLeaf4, sizeof (mTreeProofLeaf4) },
+  { 6, mTreeProofLeaf6, sizeof (mTreeProofLeaf6) },
+};
+
+STATIC UINT8  mTreeData[TREE_TEST_DATA_SIZE];
+
+/**
+  Fills the pattern the vectors were computed over.
+
+  @param[in]  Context  Unused.
+
+  @retval  UNIT_TEST_PASSED  The pattern is ready.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TreeFillPattern (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < sizeof (mTreeData); Index++) {
+    mTreeData[Index] = (UINT8)Index;
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Builds the stored tree of a prefix of the pattern.
+
+  @param[in]   DataSize  Size of the prefix in bytes.
+  @param[in]   LeafSize  Size of a leaf in bytes.
+
+  @return  The tree context, to be freed with FreePool (), or NULL.
+**/
+STATIC
+VOID *
+TreeBuild (
+  IN UINTN  DataSize,
+  IN UINTN  LeafSize
+  )
+{
+  VOID   *Tree;
+  UINTN  TreeSize;
+
+  TreeSize = Sha256TreeGetContextSize (DataSize, LeafSize);
+  if (TreeSize == 0) {
+    return NULL;
+  }
+
+  Tree = AllocatePool (TreeSize);
+  if ((Tree != NULL) && !Sha256TreeInit (Tree, TreeSize, mTreeData, DataSize, LeafSize)) {
+    FreePool (Tree);
+    Tree = NULL;
+  }
+
+  return Tree;
+}
+
+/**
+  Sha256TreeHashAll () and Sha256TreeGetRoot () return the RFC 9162 Merkle
+  tree hash.
+
+  @param[in]  Context  Unused.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestTreeRootVectors (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8  Root[SHA256_DIGEST_SIZE];
+  VOID   *Tree;
+  UINTN  Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (mTreeRootVectors); Index++) {
+    UT_ASSERT_TRUE (Sha256TreeHashAll (mTreeData, mTreeRootVectors[Index].DataSize, TREE_TEST_LEAF_SIZE, Root));
+    UT_ASSERT_MEM_EQUAL (Root, mTreeRootVectors[Index].Root, SHA256_DIGEST_SIZE);
+
+    Tree = TreeBuild (mTreeRootVectors[Index].DataSize, TREE_TEST_LEAF_SIZE);
+    UT_ASSERT_NOT_NULL (Tree);
+    ZeroMem (Root, sizeof (Root));
+    UT_ASSERT_TRUE (Sha256TreeGetRoot (Tree, Root));
+    FreePool (Tree);
+    UT_ASSERT_MEM_EQUAL (Root, mTreeRootVectors[Index].Root, SHA256_DIGEST_SIZE);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Sha256TreeGetProof () returns the RFC 9162 audit path, and
+  Sha256TreeVerifyProof () accepts it.
+
+  @param[in]  Context  Unused.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestTreeProofVectors (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  CONST TREE_PROOF_VECTOR  *Vector;
+  UINT8                    Root[SHA256_DIGEST_SIZE];
+  UINT8                    Proof[3 * SHA256_DIGEST_SIZE];
+  UINTN                    ProofSize;
+  VOID                     *Tree;
+  UINTN                    Index;
+
+  Tree = TreeBuild (TREE_TEST_PROOF_DATA_SIZE, TREE_TEST_LEAF_SIZE);
+  UT_ASSERT_NOT_NULL (Tree);
+  UT_ASSERT_TRUE (Sha256TreeGetRoot (Tree, Root));
+
+  for (Index = 0; Index < ARRAY_SIZE (mTreeProofVectors); Index++) {
+    Vector = &mTreeProofVectors[Index];
+
+    ProofSize = 0;
+    UT_ASSERT_FALSE (Sha256TreeGetProof (Tree, Vector->LeafIndex, NULL, &ProofSize));
+    UT_ASSERT_EQUAL (ProofSize, Vector->ProofSize);
+
+    ProofSize = sizeof (Proof);
+    UT_ASSERT_TRUE (Sha256TreeGetProof (Tree, Vector->LeafIndex, Proof, &ProofSize));
+    UT_ASSERT_EQUAL (ProofSize, Vector->ProofSize);
+    UT_ASSERT_MEM_EQUAL (Proof, Vector->Proof, Vector->ProofSize);
+
+    UT_ASSERT_TRUE (
+      Sha256TreeVerifyProof (
+        mTreeData + Vector->LeafIndex * TREE_TEST_LEAF_SIZE,
+        TREE_TEST_LEAF_SIZE,
+        Vector->LeafIndex,
+        TREE_TEST_PROOF_DATA_SIZE / TREE_TEST_LEAF_SIZE,
+        Vector->Proof,
+        Vector->ProofSize,
+        Root
+        )
+      );
+  }
+
+  FreePool (Tree);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Every leaf of trees of 1 to 33 leaves, with a full or a short last leaf,
+  verifies against the root, and a changed leaf, index or proof does not.
+
+  @param[in]  Context  Unused.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestTreeProofRoundTrip (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8        Root[SHA256_DIGEST_SIZE];
+  UINT8        Proof[6 * SHA256_DIGEST_SIZE];
+  UINT8        Leaf[TREE_TEST_LEAF_SIZE];
+  UINTN        ProofSize;
+  UINTN        DataSize;
+  UINTN        LeafCount;
+  UINTN        LeafIndex;
+  UINTN        LeafDataSize;
+  CONST UINT8  *LeafData;
+  VOID         *Tree;
+
+  for (DataSize = 1; DataSize <= 33 * TREE_TEST_LEAF_SIZE; DataSize++) {
+    Tree = TreeBuild (DataSize, TREE_TEST_LEAF_SIZE);
+    UT_ASSERT_NOT_NULL (Tree);
+    UT_ASSERT_TRUE (Sha256TreeGetRoot (Tree, Root));
+
+    LeafCount = (DataSize + TREE_TEST_LEAF_SIZE - 1) / TREE_TEST_LEAF_SIZE;
+    for (LeafIndex = 0; LeafIndex < LeafCount; LeafIndex++) {
+      LeafData     = mTreeData + LeafIndex * TREE_TEST_LEAF_SIZE;
+      LeafDataSize = MIN (TREE_TEST_LEAF_SIZE, DataSize - LeafIndex * TREE_TEST_LEAF_SIZE);
+
+      ProofSize = sizeof (Proof);
+      UT_ASSERT_TRUE (Sha256TreeGetProof (Tree, LeafIndex, Proof, &ProofSize));
+      UT_ASSERT_TRUE (Sha256TreeVerifyProof (LeafData, LeafDataSize, LeafIndex, LeafCount, Proof, ProofSize, Root));
+
+      CopyMem (Leaf, LeafData, LeafDataSize);
+      Leaf[0] ^= 1;
+      UT_ASSERT_FALSE (Sha256TreeVerifyProof (Leaf, LeafDataSize, LeafIndex, LeafCount, Proof, ProofSize, Root));
+
+      if (LeafCount > 1) {
+        UT_ASSERT_FALSE (Sha256TreeVerifyProof (LeafData, LeafDataSize, LeafIndex ^ 1, LeafCount, Proof, ProofSize, Root));
+        Proof[ProofSize - 1] ^= 1;
+        UT_ASSERT_FALSE (Sha256TreeVerifyProof (LeafData, LeafDataSize, LeafIndex, LeafCount, Proof, ProofSize, Root));
+      }
+    }
+
+    UT_ASSERT_FALSE (Sha256TreeGetProof (Tree, LeafCount, Proof, &ProofSize));
+    FreePool (Tree);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Sha256TreeUpdate () leaves the tree with the root of the changed data.
+
+  @param[in]  Context  Unused.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestTreeUpdate (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8  Root[SHA256_DIGEST_SIZE];
+  UINT8  Expected[SHA256_DIGEST_SIZE];
+  VOID   *Tree;
+
+  Tree = TreeBuild (TREE_TEST_DATA_SIZE - 1, TREE_TEST_LEAF_SIZE);
+  UT_ASSERT_NOT_NULL (Tree);
+
+  //
+  // A range across two leaves, then the short last leaf.
+  //
+  mTreeData[37] ^= 0xFF;
+  mTreeData[42] ^= 0xFF;
+  UT_ASSERT_TRUE (Sha256TreeUpdate (Tree, mTreeData, 37, 6));
+  UT_ASSERT_TRUE (Sha256TreeGetRoot (Tree, Root));
+  UT_ASSERT_TRUE (Sha256TreeHashAll (mTreeData, TREE_TEST_DATA_SIZE - 1, TREE_TEST_LEAF_SIZE, Expected));
+  UT_ASSERT_MEM_EQUAL (Root, Expected, SHA256_DIGEST_SIZE);
+
+  mTreeData[TREE_TEST_DATA_SIZE - 2] ^= 0xFF;
+  UT_ASSERT_TRUE (Sha256TreeUpdate (Tree, mTreeData, TREE_TEST_DATA_SIZE - 2, 1));
+  UT_ASSERT_TRUE (Sha256TreeGetRoot (Tree, Root));
+  UT_ASSERT_TRUE (Sha256TreeHashAll (mTreeData, TREE_TEST_DATA_SIZE - 1, TREE_TEST_LEAF_SIZE, Expected));
+  UT_ASSERT_MEM_EQUAL (Root, Expected, SHA256_DIGEST_SIZE);
+
+  UT_ASSERT_FALSE (Sha256TreeUpdate (Tree, mTreeData, TREE_TEST_DATA_SIZE - 2, 2));
+  FreePool (Tree);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Adds the SHA-256 tree test suite to the framework.
+
+  @param[in]  Framework  The unit test framework.
+
+  @retval  EFI_SUCCESS           The suite was added.
+  @retval  EFI_OUT_OF_RESOURCES  The suite could not be allocated.
+**/
+EFI_STATUS
+RegisterSha256TreeTests (
+  IN UNIT_TEST_FRAMEWORK_HANDLE  Framework
+  )
+{
+  EFI_STATUS              Status;
+  UNIT_TEST_SUITE_HANDLE  Suite;
+
+  Status = CreateUnitTestSuite (&Suite, Framework, "SHA-256 Tree", "BaseCryptLib.Sha256Tree", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  AddTestCase (Suite, "Roots match RFC 9162", "Sha256Tree.Root", TestTreeRootVectors, TreeFillPattern, NULL, NULL);
+  AddTestCase (Suite, "Audit paths match RFC 9162", "Sha256Tree.Proof", TestTreeProofVectors, TreeFillPattern, NULL, NULL);
+  AddTestCase (Suite, "Proofs verify and reject changes", "Sha256Tree.ProofRoundTrip", TestTreeProofRoundTrip, TreeFillPattern, NULL, NULL);
+  AddTestCase (Suite, "Updates match a full hash", "Sha256Tree.Update", TestTreeUpdate, TreeFillPattern, NULL, NULL);
+  return EFI_SUCCESS;
+}
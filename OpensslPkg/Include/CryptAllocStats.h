@@ -0,0 +1,105 @@
+/** @file
+  Allocation statistics for the BaseCryptLib C runtime allocation wrappers.
+
+  When PcdCryptAllocStatsEnable is TRUE in a DEBUG build, every malloc(),
+  realloc() and free() issued by the crypto library is recorded: per call
+  site counts, live and peak bytes, and a size histogram. In RELEASE builds,
+  or with the PCD disabled, the query functions return EFI_UNSUPPORTED.
+
+  The per-API cost of an operation can be measured by taking a snapshot
+  before and after the call and subtracting the counters.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef CRYPT_ALLOC_STATS_H_
+#define CRYPT_ALLOC_STATS_H_
+
+#include <Uefi.h>
+
+//
+// Number of distinct call sites tracked individually. Allocations from
+// further call sites are only counted in the totals.
+//
+#define CRYPT_ALLOC_STATS_MAX_SITES  32
+
+//
+// Size histogram buckets. Bucket N counts requests of at most
+// (16 << N) bytes; the last bucket counts everything larger.
+//
+#define CRYPT_ALLOC_STATS_BUCKETS  12
+
+typedef struct {
+  //
+  // Return address of the malloc()/realloc() caller.
+  //
+  UINTN     CallSite;
+  UINT64    Allocations;
+  UINT64    Frees;
+  UINT64    TotalBytes;
+  UINT64    LiveBytes;
+} CRYPT_ALLOC_SITE_STATS;
+
+typedef struct {
+  UINT64                    Allocations;
+  UINT64                    Reallocations;
+  UINT64                    Frees;
+  UINT64                    Failures;
+  UINT64                    TotalBytes;
+  UINT64                    LiveBytes;
+  UINT64                    PeakBytes;
+  UINT64                    Histogram[CRYPT_ALLOC_STATS_BUCKETS];
+  //
+  // Allocations whose call site did not fit in Sites[].
+  //
+  UINT64                    UntrackedSiteAllocations;
+  UINTN                     SiteCount;
+  CRYPT_ALLOC_SITE_STATS    Sites[CRYPT_ALLOC_STATS_MAX_SITES];
+} CRYPT_ALLOC_STATS;
+
+/**
+  Retrieves a snapshot of the allocation statistics.
+
+  @param[out]  Stats  Receives the statistics.
+
+  @retval  EFI_SUCCESS            Stats was filled in.
+  @retval  EFI_INVALID_PARAMETER  Stats is NULL.
+  @retval  EFI_UNSUPPORTED        Allocation statistics are not built in.
+**/
+EFI_STATUS
+EFIAPI
+CryptAllocStatsGet (
+  OUT CRYPT_ALLOC_STATS  *Stats
+  );
+
+/**
+  Clears the counters and call site table. Live byte accounting of buffers
+  allocated before the reset is kept so LiveBytes stays accurate.
+
+  @retval  EFI_SUCCESS      The statistics were reset.
+  @retval  EFI_UNSUPPORTED  Allocation statistics are not built in.
+**/
+EFI_STATUS
+EFIAPI
+CryptAllocStatsReset (
+  VOID
+  );
+
+/**
+  Prints the allocation statistics through DebugLib. In OneCrypto builds this
+  ends up in OneCryptoDebugPrint.
+
+  @param[in]  ErrorLevel  DEBUG error level to print at, e.g. DEBUG_INFO.
+
+  @retval  EFI_SUCCESS      The statistics were printed.
+  @retval  EFI_UNSUPPORTED  Allocation statistics are not built in.
+**/
+EFI_STATUS
+EFIAPI
+CryptAllocStatsDump (
+  IN UINTN  ErrorLevel
+  );
+
+#endif // CRYPT_ALLOC_STATS_H_
@@ -0,0 +1,93 @@
+/** @file
+  PE/COFF Authenticode image hashing.
+
+  The digest is the one AuthenticodeVerify () expects as ImageHash.
+
+  The OpenSSL and MbedTLS DXE, PEI, SMM and host instances implement these
+  functions. The SEC and RUNTIME instances return FALSE.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef CRYPT_AUTHENTICODE_HASH_H_
+#define CRYPT_AUTHENTICODE_HASH_H_
+
+#include <Uefi.h>
+
+/**
+  Compute the Authenticode digest of a PE/COFF image, as needed for the
+  ImageHash parameter of AuthenticodeVerify ().
+
+  The digest covers the image headers without the CheckSum field and the
+  Certificate Table entry, the section data in PointerToRawData order, and
+  any trailing data except the attribute certificate table. The function does
+  not allocate memory.
+
+  If Image or Digest is NULL, then return FALSE.
+  If HashNid is not supported, then return FALSE.
+
+  Caution: This function may receive untrusted input.
+  The PE/COFF image is external input, so this function will validate every
+  offset it reads against ImageSize.
+
+  @param[in]   Image      Pointer to the PE/COFF image, as read from storage.
+  @param[in]   ImageSize  Size of the image in bytes.
+  @param[in]   HashNid    CRYPTO_NID_SHA256, CRYPTO_NID_SHA384 or
+                          CRYPTO_NID_SHA512.
+  @param[out]  Digest     Buffer receiving the digest. It must be large enough
+                          for the digest of HashNid.
+
+  @retval  TRUE   The digest was computed.
+  @retval  FALSE  An input was invalid, or the image is not a well formed
+                  PE32/PE32+ image.
+
+**/
+BOOLEAN
+EFIAPI
+AuthenticodeHashImage (
+  IN  CONST VOID  *Image,
+  IN  UINTN       ImageSize,
+  IN  UINTN       HashNid,
+  OUT UINT8       *Digest
+  );
+
+/**
+  Compute the Authenticode digests of several PE/COFF images.
+
+  Where the library instance has MP dispatch (PEI, SMM, and DXE drivers
+  whose DSC maps DxeCryptMpDispatchLib), the images are hashed
+  concurrently, one at a time per processor, on the calling processor and
+  the APs. Elsewhere they are hashed in turn on the calling processor.
+  Each digest is the same as AuthenticodeHashImage () computes.
+
+  If Images, ImageSizes, Digests or Results is NULL, then return FALSE.
+
+  @param[in]   Images      Array of ImageCount pointers to PE/COFF images.
+  @param[in]   ImageSizes  Array of the image sizes in bytes.
+  @param[in]   ImageCount  Number of images.
+  @param[in]   HashNid     CRYPTO_NID_SHA256, CRYPTO_NID_SHA384 or
+                           CRYPTO_NID_SHA512.
+  @param[out]  Digests     Array of ImageCount digest buffers, each large
+                           enough for the digest of HashNid.
+  @param[out]  Results     Array receiving, per image, whether its digest
+                           was computed.
+
+  @retval  TRUE   All digests were computed.
+  @retval  FALSE  An input was invalid, or at least one image failed; see
+                  Results.
+
+**/
+BOOLEAN
+EFIAPI
+AuthenticodeHashImageBatch (
+  IN  CONST VOID   **Images,
+  IN  CONST UINTN  *ImageSizes,
+  IN  UINTN        ImageCount,
+  IN  UINTN        HashNid,
+  OUT UINT8        **Digests,
+  OUT BOOLEAN      *Results
+  );
+
+#endif // CRYPT_AUTHENTICODE_HASH_H_
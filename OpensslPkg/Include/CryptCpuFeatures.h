@@ -0,0 +1,107 @@
+/** @file
+  CPU features behind the accelerated OpenSSL code paths.
+
+  OpenSSL selects its assembly implementations from capability words it
+  fills in at start-up: OPENSSL_ia32cap_P on IA32 and X64 and
+  OPENSSL_armcap_P on AARCH64. GetCryptoProviderCpuFeatures () reports those
+  words, after PcdOpensslIa32CapOverride or PcdOpensslArmCapOverride has
+  been applied, together with an architecture-neutral summary.
+
+  A feature bit means OpenSSL is allowed to use the corresponding path. The
+  path is only taken if the OpensslLib flavor in the image has code for it,
+  so an OpensslLib without assembly reports EFI_UNSUPPORTED instead.
+
+  The OpenSSL DXE, PEI and SMM instances report the words. The SEC, RUNTIME
+  and host instances, and every MbedTLS instance, return EFI_UNSUPPORTED.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef CRYPT_CPU_FEATURES_H_
+#define CRYPT_CPU_FEATURES_H_
+
+#include <Uefi.h>
+
+//
+// AES-NI, or the Armv8 AES instructions.
+//
+#define CRYPT_CPU_FEATURE_AES  BIT0
+//
+// PCLMULQDQ, or PMULL, used for GHASH.
+//
+#define CRYPT_CPU_FEATURE_CLMUL   BIT1
+#define CRYPT_CPU_FEATURE_SHA1    BIT2
+#define CRYPT_CPU_FEATURE_SHA256  BIT3
+#define CRYPT_CPU_FEATURE_SHA512  BIT4
+//
+// Armv8 SHA3 instructions (EOR3, RAX1, XAR, BCAX).
+//
+#define CRYPT_CPU_FEATURE_SHA3  BIT5
+#define CRYPT_CPU_FEATURE_SM3   BIT6
+#define CRYPT_CPU_FEATURE_SM4   BIT7
+//
+// RDRAND or RDSEED, or the Armv8.5 RNDR register.
+//
+#define CRYPT_CPU_FEATURE_RNG  BIT8
+//
+// SSSE3, or Advanced SIMD (NEON).
+//
+#define CRYPT_CPU_FEATURE_SIMD  BIT9
+#define CRYPT_CPU_FEATURE_AVX   BIT10
+#define CRYPT_CPU_FEATURE_AVX2  BIT11
+//
+// AVX-512 F, BW and VL together.
+//
+#define CRYPT_CPU_FEATURE_AVX512  BIT12
+//
+// VAES and VPCLMULQDQ together.
+//
+#define CRYPT_CPU_FEATURE_VAES  BIT13
+//
+// BMI2 and ADX together, used for big number multiplication.
+//
+#define CRYPT_CPU_FEATURE_MULX_ADX  BIT14
+#define CRYPT_CPU_FEATURE_SVE       BIT15
+#define CRYPT_CPU_FEATURE_SVE2      BIT16
+
+//
+// Capability words kept, enough for the ten OPENSSL_ia32cap_P words of
+// OpenSSL 3.5.
+//
+#define CRYPT_CPU_CAPABILITY_WORDS  10
+
+typedef struct {
+  //
+  // CRYPT_CPU_FEATURE_* bits OpenSSL may use.
+  //
+  UINT64    Features;
+  //
+  // Number of valid entries in Capability.
+  //
+  UINT32    CapabilityCount;
+  //
+  // OPENSSL_ia32cap_P, or OPENSSL_armcap_P in the first entry, in the
+  // format the OPENSSL_ia32cap and OPENSSL_armcap overrides use.
+  //
+  UINT32    Capability[CRYPT_CPU_CAPABILITY_WORDS];
+} CRYPT_CPU_FEATURES;
+
+/**
+  Reports the CPU features OpenSSL selects its accelerated code paths from.
+
+  @param[out]  Features  Receives the features and the raw capability words.
+
+  @retval  EFI_SUCCESS            Features was filled in.
+  @retval  EFI_INVALID_PARAMETER  Features is NULL.
+  @retval  EFI_UNSUPPORTED        The OpenSSL library has no CPU specific
+                                  code for this architecture.
+**/
+EFI_STATUS
+EFIAPI
+GetCryptoProviderCpuFeatures (
+  OUT CRYPT_CPU_FEATURES  *Features
+  );
+
+#endif
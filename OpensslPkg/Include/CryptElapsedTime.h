@@ -0,0 +1,51 @@
+/** @file
+  Performance counter interval conversion shared by TlsLib and OneCrypto.
+
+  TlsLib, OneCryptoBin and the OneCrypto loaders each time part of crypto
+  bring-up. They are separate images with no common library besides
+  TimerLib, so the conversion lives here as an inline function instead of in
+  a new library class that every platform DSC would have to map.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef CRYPT_ELAPSED_TIME_H_
+#define CRYPT_ELAPSED_TIME_H_
+
+#include <Base.h>
+#include <Library/TimerLib.h>
+
+/**
+  Convert a performance counter interval to nanoseconds.
+
+  Handles both count-up and count-down performance counters.
+
+  @param[in]  StartTicks  Performance counter value at the start of the interval.
+  @param[in]  EndTicks    Performance counter value at the end of the interval.
+
+  @return  Elapsed time in nanoseconds, or 0 if no performance counter is available.
+**/
+STATIC inline
+UINT64
+CryptElapsedNanoSeconds (
+  IN UINT64  StartTicks,
+  IN UINT64  EndTicks
+  )
+{
+  UINT64  CounterStart;
+  UINT64  CounterEnd;
+
+  if (GetPerformanceCounterProperties (&CounterStart, &CounterEnd) == 0) {
+    return 0;
+  }
+
+  if (CounterStart > CounterEnd) {
+    return GetTimeInNanoSecond (StartTicks - EndTicks);
+  }
+
+  return GetTimeInNanoSecond (EndTicks - StartTicks);
+}
+
+#endif // CRYPT_ELAPSED_TIME_H_
@@ -0,0 +1,80 @@
+/** @file
+  Hash many independent messages in one call.
+
+  The OpenSSL and MbedTLS DXE, PEI, SMM and host instances implement the
+  batch functions, and share the messages with the APs where the instance
+  has MP dispatch. The SEC and RUNTIME instances return FALSE.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef CRYPT_HASH_BATCH_H_
+#define CRYPT_HASH_BATCH_H_
+
+#include <Uefi.h>
+
+/**
+  Computes the SHA-256 digests of several independent messages.
+
+  Each digest is the same as Sha256HashAll () computes for the message.
+  Where the library instance has MP dispatch (PEI, SMM, and DXE drivers
+  whose DSC maps DxeCryptMpDispatchLib), the messages are shared between
+  the calling processor and the APs.
+
+  If Count is not 0 and Messages, Sizes or Digests is NULL, then return
+  FALSE.
+
+  @param[in]   Messages  Array of Count pointers to the messages. An entry
+                         may be NULL if its size is 0.
+  @param[in]   Sizes     Array of the message sizes in bytes.
+  @param[out]  Digests   Array of Count buffers, each receiving a 32-byte
+                         SHA-256 digest.
+  @param[in]   Count     Number of messages.
+
+  @retval TRUE   All digests were computed.
+  @retval FALSE  An input was invalid. No digest was computed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashAllBatch (
+  IN  CONST VOID   **Messages,
+  IN  CONST UINTN  *Sizes,
+  OUT UINT8        **Digests,
+  IN  UINTN        Count
+  );
+
+/**
+  Computes the SHA-384 digests of several independent messages.
+
+  Each digest is the same as Sha384HashAll () computes for the message.
+  Where the library instance has MP dispatch (PEI, SMM, and DXE drivers
+  whose DSC maps DxeCryptMpDispatchLib), the messages are shared between
+  the calling processor and the APs.
+
+  If Count is not 0 and Messages, Sizes or Digests is NULL, then return
+  FALSE.
+
+  @param[in]   Messages  Array of Count pointers to the messages. An entry
+                         may be NULL if its size is 0.
+  @param[in]   Sizes     Array of the message sizes in bytes.
+  @param[out]  Digests   Array of Count buffers, each receiving a 48-byte
+                         SHA-384 digest.
+  @param[in]   Count     Number of messages.
+
+  @retval TRUE   All digests were computed.
+  @retval FALSE  An input was invalid. No digest was computed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha384HashAllBatch (
+  IN  CONST VOID   **Messages,
+  IN  CONST UINTN  *Sizes,
+  OUT UINT8        **Digests,
+  IN  UINTN        Count
+  );
+
+#endif // CRYPT_HASH_BATCH_H_
@@ -0,0 +1,165 @@
+/** @file
+  Cached SHA-256 block digests of a memory region that changes in place.
+
+  Writers mark the ranges they change, and Sha256HashCacheRefresh () re-hashes
+  only those blocks. The root is the one Sha256TreeHashAll () (see
+  CryptHashTree.h) computes over the whole region.
+
+  The OpenSSL DXE, PEI, SMM and host instances implement these functions.
+  The SEC and RUNTIME instances, and every MbedTLS instance, return FALSE or
+  0.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef CRYPT_HASH_CACHE_H_
+#define CRYPT_HASH_CACHE_H_
+
+#include <Uefi.h>
+
+/**
+  Retrieves the size, in bytes, of a hash cache for a region.
+
+  @param[in]  RegionSize  Size of the tracked region in bytes.
+  @param[in]  BlockSize   Size of a block in bytes.
+
+  @return  The size of the cache, or 0 if BlockSize is 0 or the size
+           overflows.
+
+**/
+UINTN
+EFIAPI
+Sha256HashCacheGetContextSize (
+  IN UINTN  RegionSize,
+  IN UINTN  BlockSize
+  );
+
+/**
+  Retrieves the smallest block size whose hash cache for a region fits a
+  memory budget.
+
+  Smaller blocks make a refresh after a small change cheaper, at the cost of
+  a larger cache. The block size returned is a power of two of at least
+  512 bytes.
+
+  @param[in]  RegionSize  Size of the tracked region in bytes.
+  @param[in]  Budget      Largest acceptable cache size in bytes.
+
+  @return  The block size, or 0 if no cache for the region fits Budget.
+
+**/
+UINTN
+EFIAPI
+Sha256HashCacheGetBlockSize (
+  IN UINTN  RegionSize,
+  IN UINTN  Budget
+  );
+
+/**
+  Starts tracking a region: hashes all of its blocks into the cache.
+
+  The region must stay mapped at the same address while it is tracked.
+
+  If Cache is NULL, CacheSize is smaller than
+  Sha256HashCacheGetContextSize (RegionSize, BlockSize), BlockSize is 0, or
+  Region is NULL while RegionSize is not 0, then return FALSE.
+
+  @param[out]  Cache       Buffer receiving the cache.
+  @param[in]   CacheSize   Size of Cache in bytes.
+  @param[in]   Region      The tracked region.
+  @param[in]   RegionSize  Size of the region in bytes.
+  @param[in]   BlockSize   Size of a block in bytes. The last block may be
+                           shorter.
+
+  @retval TRUE   The cache holds the digests of the whole region.
+  @retval FALSE  An input was invalid.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashCacheInit (
+  OUT VOID        *Cache,
+  IN  UINTN       CacheSize,
+  IN  CONST VOID  *Region,
+  IN  UINTN       RegionSize,
+  IN  UINTN       BlockSize
+  );
+
+/**
+  Records that a byte range of the tracked region changed.
+
+  The blocks overlapping the range are re-hashed by the next
+  Sha256HashCacheRefresh (). Marking a range before or after writing it
+  are both fine, as long as the write is done before the refresh.
+
+  If Cache does not hold a hash cache, or the range is not within the
+  region, then return FALSE.
+
+  @param[in,out]  Cache   The hash cache.
+  @param[in]      Offset  Offset of the first changed byte.
+  @param[in]      Length  Number of changed bytes.
+
+  @retval TRUE   The range is marked.
+  @retval FALSE  An input was invalid.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashCacheMarkDirty (
+  IN OUT VOID   *Cache,
+  IN     UINTN  Offset,
+  IN     UINTN  Length
+  );
+
+/**
+  Re-hashes the dirty blocks of the tracked region and returns its tree
+  hash.
+
+  Only the dirty blocks and their ancestors in the tree are hashed. Root
+  receives the same value as Sha256TreeHashAll () computes over the whole
+  region with the block size of the cache.
+
+  If Cache does not hold a hash cache, then return FALSE.
+
+  @param[in,out]  Cache  The hash cache.
+  @param[out]     Root   Receives the 32-byte root hash. May be NULL.
+
+  @retval TRUE   No block is dirty any more.
+  @retval FALSE  An input was invalid.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashCacheRefresh (
+  IN OUT VOID   *Cache,
+  OUT    UINT8  *Root  OPTIONAL
+  );
+
+/**
+  Retrieves the cached digest of the block holding a region offset.
+
+  The digest is the leaf hash of the tree, SHA-256 (0x00 || block), as of
+  the last refresh.
+
+  If Cache does not hold a hash cache, Offset is not within the region,
+  the block is dirty, or Digest is NULL, then return FALSE.
+
+  @param[in]   Cache   The hash cache.
+  @param[in]   Offset  Offset within the tracked region.
+  @param[out]  Digest  Receives the 32-byte block digest.
+
+  @retval TRUE   Digest holds the cached digest.
+  @retval FALSE  An input was invalid, or the block is dirty.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashCacheGetBlockDigest (
+  IN  CONST VOID  *Cache,
+  IN  UINTN       Offset,
+  OUT UINT8       *Digest
+  );
+
+#endif // CRYPT_HASH_CACHE_H_
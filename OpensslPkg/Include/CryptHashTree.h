@@ -0,0 +1,216 @@
+/** @file
+  SHA-256 tree hash over fixed-size leaves, with audit paths.
+
+  The tree follows RFC 9162, section 2.1. Sha256TreeHashAll () returns the
+  root only; Sha256TreeInit () keeps every node in a caller supplied context
+  so that updates re-hash only what changed.
+
+  The OpenSSL DXE, PEI, SMM and host instances implement these functions.
+  The SEC and RUNTIME instances, and every MbedTLS instance, return FALSE or
+  0.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef CRYPT_HASH_TREE_H_
+#define CRYPT_HASH_TREE_H_
+
+#include <Uefi.h>
+
+/**
+  Computes the SHA-256 tree hash of a buffer.
+
+  The leaves are hashed a chunk at a time, shared between the calling
+  processor and the APs where the library instance has MP services, and
+  folded into at most one pending subtree root per level, so no memory is
+  allocated.
+
+  If Root is NULL, Data is NULL while DataSize is not 0, or LeafSize is 0,
+  then return FALSE.
+
+  @param[in]   Data      Data to hash.
+  @param[in]   DataSize  Size of Data in bytes.
+  @param[in]   LeafSize  Size of a leaf in bytes. The last leaf may be
+                         shorter.
+  @param[out]  Root      Receives the 32-byte root hash.
+
+  @retval TRUE   Root holds the tree hash.
+  @retval FALSE  An input was invalid.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256TreeHashAll (
+  IN  CONST VOID  *Data,
+  IN  UINTN       DataSize,
+  IN  UINTN       LeafSize,
+  OUT UINT8       *Root
+  );
+
+/**
+  Retrieves the size, in bytes, of the context required to keep the SHA-256
+  tree of a buffer.
+
+  @param[in]  DataSize  Size of the hashed buffer in bytes.
+  @param[in]  LeafSize  Size of a leaf in bytes.
+
+  @return  The size of the context, or 0 if LeafSize is 0 or the size
+           overflows.
+
+**/
+UINTN
+EFIAPI
+Sha256TreeGetContextSize (
+  IN UINTN  DataSize,
+  IN UINTN  LeafSize
+  );
+
+/**
+  Hashes a buffer into a SHA-256 tree kept in TreeContext.
+
+  The tree hash is the same as Sha256TreeHashAll () computes. The leaves are
+  shared between the calling processor and the APs where the library
+  instance has MP services.
+
+  If TreeContext is NULL, ContextSize is smaller than
+  Sha256TreeGetContextSize (DataSize, LeafSize), LeafSize is 0, or Data is
+  NULL while DataSize is not 0, then return FALSE.
+
+  @param[out]  TreeContext  Context receiving the tree.
+  @param[in]   ContextSize  Size of TreeContext in bytes.
+  @param[in]   Data         Data to hash.
+  @param[in]   DataSize     Size of Data in bytes.
+  @param[in]   LeafSize     Size of a leaf in bytes. The last leaf may be
+                            shorter.
+
+  @retval TRUE   The tree was built.
+  @retval FALSE  An input was invalid.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256TreeInit (
+  OUT VOID        *TreeContext,
+  IN  UINTN       ContextSize,
+  IN  CONST VOID  *Data,
+  IN  UINTN       DataSize,
+  IN  UINTN       LeafSize
+  );
+
+/**
+  Re-hashes the leaves of a SHA-256 tree that cover a changed byte range,
+  and their ancestors.
+
+  Data is the whole hashed buffer, of the size the tree was built for. Only
+  the leaves overlapping [Offset, Offset + Length) are read.
+
+  If TreeContext does not hold a tree, Data is NULL, or the range is not
+  within the buffer, then return FALSE.
+
+  @param[in,out]  TreeContext  Context holding the tree.
+  @param[in]      Data         The hashed buffer, with its new contents.
+  @param[in]      Offset       Offset of the first changed byte.
+  @param[in]      Length       Number of changed bytes.
+
+  @retval TRUE   The tree matches the new contents.
+  @retval FALSE  An input was invalid.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256TreeUpdate (
+  IN OUT VOID        *TreeContext,
+  IN     CONST VOID  *Data,
+  IN     UINTN       Offset,
+  IN     UINTN       Length
+  );
+
+/**
+  Retrieves the root hash of a SHA-256 tree.
+
+  If TreeContext does not hold a tree or Root is NULL, then return FALSE.
+
+  @param[in]   TreeContext  Context holding the tree.
+  @param[out]  Root         Receives the 32-byte root hash.
+
+  @retval TRUE   Root holds the tree hash.
+  @retval FALSE  An input was invalid.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256TreeGetRoot (
+  IN  CONST VOID  *TreeContext,
+  OUT UINT8       *Root
+  );
+
+/**
+  Retrieves the audit path of a leaf of a SHA-256 tree.
+
+  The proof is the concatenation of the 32-byte sibling hashes from the leaf
+  level upwards, skipping the levels where the node on the path has no
+  sibling. Sha256TreeVerifyProof () checks it against the root.
+
+  If TreeContext does not hold a tree, LeafIndex is not a leaf of the tree,
+  or ProofSize is NULL, then return FALSE.
+
+  If *ProofSize is too small, it receives the required size and FALSE is
+  returned.
+
+  @param[in]      TreeContext  Context holding the tree.
+  @param[in]      LeafIndex    Index of the leaf.
+  @param[out]     Proof        Buffer receiving the proof. May be NULL to
+                               query the size.
+  @param[in,out]  ProofSize    On input, the size of Proof in bytes. On
+                               output, the size of the proof.
+
+  @retval TRUE   Proof holds the audit path.
+  @retval FALSE  An input was invalid, or Proof is too small.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256TreeGetProof (
+  IN     CONST VOID  *TreeContext,
+  IN     UINTN       LeafIndex,
+  OUT    UINT8       *Proof      OPTIONAL,
+  IN OUT UINTN       *ProofSize
+  );
+
+/**
+  Verifies a leaf of a SHA-256 tree against the root hash, using the audit
+  path returned by Sha256TreeGetProof ().
+
+  The verifier needs neither the other leaves nor the tree context.
+
+  If Leaf is NULL while LeafDataSize is not 0, Proof is NULL while ProofSize
+  is not 0, or Root is NULL, then return FALSE.
+
+  @param[in]  Leaf          Data of the leaf.
+  @param[in]  LeafDataSize  Size of the leaf in bytes. Only the last leaf
+                            may be shorter than the leaf size of the tree.
+  @param[in]  LeafIndex     Index of the leaf.
+  @param[in]  LeafCount     Number of leaves of the tree.
+  @param[in]  Proof         The audit path.
+  @param[in]  ProofSize     Size of Proof in bytes.
+  @param[in]  Root          The 32-byte root hash.
+
+  @retval TRUE   The leaf is part of the tree with this root.
+  @retval FALSE  The proof does not match, or an input was invalid.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256TreeVerifyProof (
+  IN CONST VOID   *Leaf,
+  IN UINTN        LeafDataSize,
+  IN UINTN        LeafIndex,
+  IN UINTN        LeafCount,
+  IN CONST UINT8  *Proof,
+  IN UINTN        ProofSize,
+  IN CONST UINT8  *Root
+  );
+
+#endif // CRYPT_HASH_TREE_H_
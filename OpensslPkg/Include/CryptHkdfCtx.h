@@ -0,0 +1,132 @@
+/** @file
+  HKDF-Expand with a reusable context.
+
+  A context holds the PRK already keyed into HMAC, so deriving several labels
+  from one secret, as the TLS 1.3 key schedule does, keys HMAC once.
+
+  Every instance except SEC implements these functions.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef CRYPT_HKDF_CTX_H_
+#define CRYPT_HKDF_CTX_H_
+
+#include <Uefi.h>
+
+/**
+  Allocate an HKDF-Expand context for SHA256 and key it with a PRK.
+
+  HMAC is keyed once here. Each HkdfExpandCtx () call then starts from the
+  saved inner and outer pad state instead of hashing the PRK again, which is
+  cheaper when a key schedule derives several secrets from one PRK.
+
+  @param[in]   Prk              Pointer to the pseudorandom key.
+  @param[in]   PrkSize          Key size in bytes.
+
+  @return  Pointer to the HKDF-Expand context, or NULL on failure. Free it
+           with HkdfExpandCtxFree ().
+
+**/
+VOID *
+EFIAPI
+HkdfSha256ExpandCtxNew (
+  IN   CONST UINT8  *Prk,
+  IN   UINTN        PrkSize
+  );
+
+/**
+  Allocate an HKDF-Expand context for SHA384 and key it with a PRK.
+
+  HMAC is keyed once here. Each HkdfExpandCtx () call then starts from the
+  saved inner and outer pad state instead of hashing the PRK again, which is
+  cheaper when a key schedule derives several secrets from one PRK.
+
+  @param[in]   Prk              Pointer to the pseudorandom key.
+  @param[in]   PrkSize          Key size in bytes.
+
+  @return  Pointer to the HKDF-Expand context, or NULL on failure. Free it
+           with HkdfExpandCtxFree ().
+
+**/
+VOID *
+EFIAPI
+HkdfSha384ExpandCtxNew (
+  IN   CONST UINT8  *Prk,
+  IN   UINTN        PrkSize
+  );
+
+/**
+  Derive HMAC-based Expand Key Derivation Function (HKDF) output from the PRK
+  held by an HKDF-Expand context.
+
+  The context can be used for any number of calls.
+
+  @param[in]   HkdfCtx          Context from HkdfSha256ExpandCtxNew () or
+                                HkdfSha384ExpandCtxNew ().
+  @param[in]   Info             Pointer to the application specific info. May
+                                be NULL if InfoSize is 0.
+  @param[in]   InfoSize         Info size in bytes.
+  @param[out]  Out              Pointer to buffer to receive hkdf value.
+  @param[in]   OutSize          Size of hkdf bytes to generate. At most 255
+                                times the digest size.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+
+**/
+BOOLEAN
+EFIAPI
+HkdfExpandCtx (
+  IN   VOID         *HkdfCtx,
+  IN   CONST UINT8  *Info,
+  IN   UINTN        InfoSize,
+  OUT  UINT8        *Out,
+  IN   UINTN        OutSize
+  );
+
+/**
+  Derive several HKDF-Expand outputs, one per label, from the PRK held by an
+  HKDF-Expand context.
+
+  Entry Index of each array describes one output, as for HkdfExpandCtx ().
+  Outputs are derived in order and processing stops at the first failure.
+
+  @param[in]   HkdfCtx          Context from HkdfSha256ExpandCtxNew () or
+                                HkdfSha384ExpandCtxNew ().
+  @param[in]   Info             Array of LabelCount info pointers.
+  @param[in]   InfoSize         Array of LabelCount info sizes in bytes.
+  @param[out]  Out              Array of LabelCount output buffers.
+  @param[in]   OutSize          Array of LabelCount output sizes in bytes.
+  @param[in]   LabelCount       Number of outputs to derive.
+
+  @retval TRUE   All outputs generated successfully.
+  @retval FALSE  Invalid parameter, or an output could not be generated.
+
+**/
+BOOLEAN
+EFIAPI
+HkdfExpandCtxBatch (
+  IN   VOID         *HkdfCtx,
+  IN   CONST UINT8  **Info,
+  IN   CONST UINTN  *InfoSize,
+  OUT  UINT8        **Out,
+  IN   CONST UINTN  *OutSize,
+  IN   UINTN        LabelCount
+  );
+
+/**
+  Release an HKDF-Expand context. The keyed HMAC state is cleared.
+
+  @param[in]  HkdfCtx  Context to release. May be NULL.
+
+**/
+VOID
+EFIAPI
+HkdfExpandCtxFree (
+  IN  VOID  *HkdfCtx
+  );
+
+#endif // CRYPT_HKDF_CTX_H_
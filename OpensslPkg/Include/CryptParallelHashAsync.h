@@ -0,0 +1,107 @@
+/** @file
+  ParallelHash256 that returns while the APs are still hashing.
+
+  The OpenSSL DXE, PEI and SMM instances implement these functions. The
+  other instances, including the host ones, return FALSE.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef CRYPT_PARALLEL_HASH_ASYNC_H_
+#define CRYPT_PARALLEL_HASH_ASYNC_H_
+
+#include <Uefi.h>
+
+/**
+  Starts computing ParallelHash256, as defined in NIST's Special Publication
+  800-185, and returns without waiting for the result.
+
+  The blocks are hashed on the APs. The digest is the same as
+  ParallelHash256HashAll () computes. Input, Output and Customization must
+  stay valid until ParallelHash256AsyncFinish () returns, and Output holds
+  the digest only from then on.
+
+  In DXE, Event is signalled once the digest is complete. PEI and MM have no
+  events, so Event must be NULL there. In PEI the MP services only return
+  once the APs are done, so the job is complete when this function returns.
+  In MM the job must be finished before the caller leaves MM.
+
+  @param[in]   Input          Pointer to the input message (X).
+  @param[in]   InputByteLen   The number(>0) of input bytes provided for the
+                              input data.
+  @param[in]   BlockSize      The size of each block (B).
+  @param[out]  Output         Pointer to the output buffer.
+  @param[in]   OutputByteLen  The desired number of output bytes (L).
+  @param[in]   Customization  Pointer to the customization string (S).
+  @param[in]   CustomByteLen  The length of the customization string in
+                              bytes.
+  @param[in]   Event          Event to signal once the digest is complete,
+                              or NULL.
+  @param[out]  Handle         Receives the handle of the job.
+
+  @retval TRUE   The job was started. It must be released with
+                 ParallelHash256AsyncFinish ().
+  @retval FALSE  An input was invalid, Event is not supported in this phase,
+                 or memory could not be allocated. No job was started.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+ParallelHash256HashAllAsync (
+  IN CONST VOID       *Input,
+  IN       UINTN      InputByteLen,
+  IN       UINTN      BlockSize,
+  OUT      VOID       *Output,
+  IN       UINTN      OutputByteLen,
+  IN CONST VOID       *Customization,
+  IN       UINTN      CustomByteLen,
+  IN       EFI_EVENT  Event  OPTIONAL,
+  OUT      VOID       **Handle
+  );
+
+/**
+  Checks whether an asynchronous ParallelHash256 job is complete.
+
+  This function does not wait and may be called any number of times.
+
+  If Handle is NULL or is not a job handle, then return FALSE.
+
+  @param[in]  Handle  Handle from ParallelHash256HashAllAsync ().
+
+  @retval TRUE   The job is complete. ParallelHash256AsyncFinish () returns
+                 without waiting.
+  @retval FALSE  The job is still running.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+ParallelHash256AsyncIsComplete (
+  IN VOID  *Handle
+  );
+
+/**
+  Completes an asynchronous ParallelHash256 job and releases its handle.
+
+  The calling processor hashes the blocks no AP has claimed yet, then waits
+  until the APs are done. Handle is invalid once this function returns.
+
+  If Handle is NULL or is not a job handle, then return FALSE.
+
+  @param[in]  Handle  Handle from ParallelHash256HashAllAsync ().
+
+  @retval TRUE   ParallelHash256 digest computation succeeded.
+  @retval FALSE  ParallelHash256 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+ParallelHash256AsyncFinish (
+  IN VOID  *Handle
+  );
+
+#endif // CRYPT_PARALLEL_HASH_ASYNC_H_
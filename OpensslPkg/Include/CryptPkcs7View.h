@@ -0,0 +1,96 @@
+/** @file
+  Zero-copy views into PKCS#7 SignedData.
+
+  The views return offsets into the caller's buffer instead of copies. Only
+  definite-length DER is supported; Pkcs7GetAttachedContent () and
+  Pkcs7GetSigners () handle the other encodings.
+
+  Every instance except SEC implements these functions.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef CRYPT_PKCS7_VIEW_H_
+#define CRYPT_PKCS7_VIEW_H_
+
+#include <Uefi.h>
+
+/**
+  Locates the attached content of a PKCS#7 signed data without copying it.
+  The input signed data could be wrapped in a ContentInfo structure.
+
+  This is the zero-copy counterpart of Pkcs7GetAttachedContent (): the content
+  is returned as an offset into P7Data, which must stay valid for as long as
+  the content is used.
+
+  If P7Data, ContentOffset, or ContentSize is NULL, then return FALSE. If the
+  P7Data is not a definite-length DER SignedData, or its content is encoded
+  as a constructed OCTET STRING, then return FALSE.
+
+  Caution: This function may receive untrusted input. So this function will do
+           basic check for PKCS#7 data structure.
+
+  @param[in]   P7Data         Pointer to the PKCS#7 signed data to process.
+  @param[in]   P7Length       Length of the PKCS#7 signed data in bytes.
+  @param[out]  ContentOffset  Offset of the attached content within P7Data.
+  @param[out]  ContentSize    The size of the attached content in bytes, or 0
+                              if the signed data is detached.
+
+  @retval     TRUE          The P7Data was correctly formatted for processing.
+  @retval     FALSE         The P7Data was not correctly formatted for processing.
+
+**/
+BOOLEAN
+EFIAPI
+Pkcs7GetAttachedContentView (
+  IN  CONST UINT8  *P7Data,
+  IN  UINTN        P7Length,
+  OUT UINTN        *ContentOffset,
+  OUT UINTN        *ContentSize
+  );
+
+/**
+  Locates the signer's certificates of a PKCS#7 signed data without copying
+  them. The input signed data could be wrapped in a ContentInfo structure.
+
+  This is the zero-copy counterpart of Pkcs7GetSigners (). Each certificate is
+  returned as the offset and size of its DER encoding within P7Data, in
+  SignerInfo order; entry 0 is the certificate Pkcs7GetSigners () returns as
+  TrustedCert.
+
+  If P7Data or CertCount is NULL, then return FALSE. If CertOffset or
+  CertSize is NULL, or *CertCount is smaller than the number of signers, then
+  *CertCount is set to the number of signers and FALSE is returned. If the
+  P7Data is not a definite-length DER SignedData, or a signer's certificate
+  is not included in it, then *CertCount is set to 0 and FALSE is returned.
+
+  Caution: This function may receive untrusted input. So this function will do
+           basic check for PKCS#7 data structure.
+
+  @param[in]      P7Data      Pointer to the PKCS#7 signed data to process.
+  @param[in]      P7Length    Length of the PKCS#7 signed data in bytes.
+  @param[out]     CertOffset  Array receiving the offset of each signer's
+                              certificate within P7Data.
+  @param[out]     CertSize    Array receiving the size of each signer's
+                              certificate in bytes.
+  @param[in,out]  CertCount   On input, the number of entries in CertOffset
+                              and CertSize. On output, the number of signers.
+
+  @retval  TRUE   The signer's certificates were located.
+  @retval  FALSE  The arrays are too small, or the P7Data was not correctly
+                  formatted for processing.
+
+**/
+BOOLEAN
+EFIAPI
+Pkcs7GetSignersView (
+  IN     CONST UINT8  *P7Data,
+  IN     UINTN        P7Length,
+  OUT    UINTN        *CertOffset  OPTIONAL,
+  OUT    UINTN        *CertSize    OPTIONAL,
+  IN OUT UINTN        *CertCount
+  );
+
+#endif // CRYPT_PKCS7_VIEW_H_
@@ -0,0 +1,172 @@
+/** @file
+  Signature verification over a digest, and over a message fed in pieces.
+
+  RsaPssVerifyDigest () is RsaPssVerify () for a caller that already has the
+  message digest. The streaming functions hash the message as it is fed and
+  check the digest with RsaPssVerifyDigest (), RsaPkcs1Verify () or
+  EcDsaVerify ().
+
+  The OpenSSL and MbedTLS DXE, PEI, SMM and host instances implement these
+  functions. The RUNTIME instances and the OpenSSL SEC instance return FALSE
+  or NULL, and the MbedTLS SEC instance does not have them.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef CRYPT_SIG_VERIFY_H_
+#define CRYPT_SIG_VERIFY_H_
+
+#include <Uefi.h>
+
+/**
+  Verifies the RSA signature with RSASSA-PSS signature scheme defined in RFC 8017,
+  over a message digest computed by the caller.
+
+  This is RsaPssVerify () for callers that hash the message themselves, e.g.
+  incrementally while reading it. The digest algorithm is selected by
+  HashSize, and the mask generation function uses the same algorithm.
+  Salt length should be equal to digest length.
+
+  @param[in]  RsaContext      Pointer to RSA context for signature verification.
+  @param[in]  MessageHash     Pointer to octet message hash to be checked.
+  @param[in]  HashSize        Size of the message hash in bytes: 32, 48 or 64.
+  @param[in]  Signature       Pointer to RSASSA-PSS signature to be verified.
+  @param[in]  SigSize         Size of signature in bytes.
+  @param[in]  SaltLen         Salt length for PSS encoding.
+
+  @retval  TRUE   Valid signature encoded in RSASSA-PSS.
+  @retval  FALSE  Invalid signature or invalid RSA context.
+
+**/
+BOOLEAN
+EFIAPI
+RsaPssVerifyDigest (
+  IN  VOID         *RsaContext,
+  IN  CONST UINT8  *MessageHash,
+  IN  UINTN        HashSize,
+  IN  CONST UINT8  *Signature,
+  IN  UINTN        SigSize,
+  IN  UINT16       SaltLen
+  );
+
+/**
+  Start a streaming RSA-SSA verification with EMSA-PKCS1-v1_5 encoding.
+
+  RsaContext must stay valid until SigVerifyFree () is called.
+
+  @param[in]  RsaContext  Pointer to RSA context for signature verification.
+  @param[in]  HashNid     CRYPTO_NID_SHA256, CRYPTO_NID_SHA384 or CRYPTO_NID_SHA512.
+
+  @return  Pointer to the verify context, or NULL on invalid parameters or
+           allocation failure. Free it with SigVerifyFree ().
+
+**/
+VOID *
+EFIAPI
+RsaPkcs1VerifyInit (
+  IN  VOID   *RsaContext,
+  IN  UINTN  HashNid
+  );
+
+/**
+  Start a streaming RSASSA-PSS verification (RFC 8017).
+
+  The mask generation function uses the same digest as the message. The
+  salt length must equal the digest length, as for RsaPssVerify ().
+
+  RsaContext must stay valid until SigVerifyFree () is called.
+
+  @param[in]  RsaContext  Pointer to RSA context for signature verification.
+  @param[in]  DigestLen   Length of digest for RSA operation: 32, 48 or 64.
+  @param[in]  SaltLen     Salt length for PSS encoding.
+
+  @return  Pointer to the verify context, or NULL on invalid parameters or
+           allocation failure. Free it with SigVerifyFree ().
+
+**/
+VOID *
+EFIAPI
+RsaPssVerifyInit (
+  IN  VOID    *RsaContext,
+  IN  UINT16  DigestLen,
+  IN  UINT16  SaltLen
+  );
+
+/**
+  Start a streaming EC-DSA verification.
+
+  EcContext must stay valid until SigVerifyFree () is called.
+
+  @param[in]  EcContext  Pointer to EC context for signature verification.
+  @param[in]  HashNid    CRYPTO_NID_SHA256, CRYPTO_NID_SHA384 or CRYPTO_NID_SHA512.
+
+  @return  Pointer to the verify context, or NULL on invalid parameters or
+           allocation failure. Free it with SigVerifyFree ().
+
+**/
+VOID *
+EFIAPI
+EcDsaVerifyInit (
+  IN  VOID   *EcContext,
+  IN  UINTN  HashNid
+  );
+
+/**
+  Hash the next part of the message being verified.
+
+  @param[in, out]  VerifyContext  Context from one of the *VerifyInit () functions.
+  @param[in]       Data           Pointer to the message data.
+  @param[in]       DataSize       Size of Data in bytes.
+
+  @retval  TRUE   The data was hashed.
+  @retval  FALSE  Invalid parameter, or SigVerifyFinal () was already called.
+
+**/
+BOOLEAN
+EFIAPI
+SigVerifyUpdate (
+  IN OUT  VOID        *VerifyContext,
+  IN      CONST VOID  *Data,
+  IN      UINTN       DataSize
+  );
+
+/**
+  Finish the hash and verify the signature over the whole message.
+
+  The context cannot be updated afterwards; it must still be freed with
+  SigVerifyFree ().
+
+  @param[in, out]  VerifyContext  Context from one of the *VerifyInit () functions.
+  @param[in]       Signature      Pointer to the signature to be verified. For
+                                  EC-DSA this is R || S as for EcDsaVerify ().
+  @param[in]       SigSize        Size of signature in bytes.
+
+  @retval  TRUE   Valid signature.
+  @retval  FALSE  Invalid signature or invalid parameter.
+
+**/
+BOOLEAN
+EFIAPI
+SigVerifyFinal (
+  IN OUT  VOID         *VerifyContext,
+  IN      CONST UINT8  *Signature,
+  IN      UINTN        SigSize
+  );
+
+/**
+  Release a streaming verify context.
+
+  The RSA or EC context passed to the *VerifyInit () function is not freed.
+
+  @param[in]  VerifyContext  Context to release. May be NULL.
+
+**/
+VOID
+EFIAPI
+SigVerifyFree (
+  IN  VOID  *VerifyContext
+  );
+
+#endif // CRYPT_SIG_VERIFY_H_
@@ -0,0 +1,107 @@
+/** @file
+  Shared, pre-parsed CA certificate bundle.
+
+  A bundle is parsed once and can then be referenced by any number of TLS
+  contexts, instead of calling TlsSetCaCertificate () for every certificate
+  of every connection.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef TLS_CA_BUNDLE_H_
+#define TLS_CA_BUNDLE_H_
+
+#include <Uefi.h>
+
+/**
+  Parse a set of CA certificates once into a CA bundle that any number of
+  TLS contexts can share through TlsCtxSetCaBundle().
+
+  Data can be:
+    - a sequence of EFI_SIGNATURE_LISTs, such as the content of the
+      EFI_TLS_CA_CERTIFICATE variable; entries that are not EFI_CERT_X509_GUID
+      are skipped;
+    - one or more PEM-encoded X.509 certificates;
+    - one or more concatenated DER-encoded X.509 certificates.
+
+  @param[in]  Data      Pointer to the certificates.
+  @param[in]  DataSize  Size of Data in bytes.
+
+  @return  The CA bundle, or NULL if Data is invalid, holds no certificate, or
+           memory allocation failed. Free it with TlsCaBundleFree().
+
+**/
+VOID *
+EFIAPI
+TlsCaBundleNew (
+  IN CONST VOID  *Data,
+  IN UINTN       DataSize
+  );
+
+/**
+  Release a CA bundle.
+
+  Contexts the bundle was attached to keep their reference to its
+  certificates, so the bundle can be freed as soon as it has been attached.
+
+  @param[in]  CaBundle  The CA bundle from TlsCaBundleNew(). May be NULL.
+
+**/
+VOID
+EFIAPI
+TlsCaBundleFree (
+  IN VOID  *CaBundle
+  );
+
+/**
+  Get the parse statistics of a CA bundle.
+
+  @param[in]   CaBundle      The CA bundle from TlsCaBundleNew().
+  @param[out]  CertCount     Number of certificates in the bundle. Optional.
+  @param[out]  ParseNs       Time TlsCaBundleNew() spent parsing, in
+                             nanoseconds. 0 without a performance counter.
+                             Optional.
+  @param[out]  EncodedBytes  Total DER size of the certificates. Optional.
+  @param[out]  HeapBytes     Heap the parsed certificates occupy. 0 unless
+                             BaseCryptLib allocation statistics are enabled.
+                             Optional.
+
+  @retval  EFI_SUCCESS            The statistics were returned.
+  @retval  EFI_INVALID_PARAMETER  CaBundle is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+TlsCaBundleGetStats (
+  IN  VOID    *CaBundle,
+  OUT UINTN   *CertCount     OPTIONAL,
+  OUT UINT64  *ParseNs       OPTIONAL,
+  OUT UINTN   *EncodedBytes  OPTIONAL,
+  OUT UINT64  *HeapBytes     OPTIONAL
+  );
+
+/**
+  Make a TLS context verify peers against a CA bundle.
+
+  The context references the bundle's certificates instead of holding its own
+  copy, and replaces any CA certificates added to it before. The bundle is
+  read-only once created: TlsSetCaCertificate() on a connection of the
+  context only succeeds for certificates already in the bundle.
+
+  @param[in]  TlsCtx    Pointer to the SSL_CTX object.
+  @param[in]  CaBundle  The CA bundle from TlsCaBundleNew().
+
+  @retval  EFI_SUCCESS            The bundle was attached.
+  @retval  EFI_INVALID_PARAMETER  TlsCtx or CaBundle is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+TlsCtxSetCaBundle (
+  IN VOID  *TlsCtx,
+  IN VOID  *CaBundle
+  );
+
+#endif // TLS_CA_BUNDLE_H_
@@ -0,0 +1,53 @@
+/** @file
+  Read TLS application data without copying the received records.
+
+  TlsReadInPlace () combines TlsCtrlTrafficIn () and TlsRead () and, for a
+  buffer of complete records, decrypts them in the caller's buffer.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef TLS_READ_IN_PLACE_H_
+#define TLS_READ_IN_PLACE_H_
+
+#include <Uefi.h>
+
+/**
+  Decrypts received TLS records in the buffer that holds them.
+
+  This function is an alternative to TlsCtrlTrafficIn() followed by
+  TlsRead() for the network stack. Buffer holds records exactly as received;
+  on return it holds the application data they carried. When Buffer holds
+  complete records and no earlier input is pending, the read BIO hands the
+  records to OpenSSL from Buffer, so the copy into the connection's read ring
+  is skipped. OpenSSL still copies each record into its own record buffer
+  before decrypting it. The plaintext of each record is written over
+  ciphertext that has already been consumed. Otherwise the records are
+  copied into the ring first, as TlsCtrlTrafficIn() would.
+
+  Handshake messages that arrive after the handshake, such as TLS 1.3
+  session tickets, are processed and produce no application data. Any
+  response OpenSSL builds for them is returned by TlsCtrlTrafficOut().
+
+  @param[in]      Tls         Pointer to the TLS connection.
+  @param[in,out]  Buffer      On input, the received TLS records. On output,
+                              the decrypted application data.
+  @param[in]      BufferSize  Number of bytes of records in Buffer.
+
+  @retval  >=0   Number of application data bytes now at the start of Buffer.
+                 0 means the records carried no application data, or ended in
+                 a partial record that is kept for the next call.
+  @retval  <0    Decryption failed or the parameters are invalid.
+
+**/
+INTN
+EFIAPI
+TlsReadInPlace (
+  IN     VOID   *Tls,
+  IN OUT VOID   *Buffer,
+  IN     UINTN  BufferSize
+  );
+
+#endif // TLS_READ_IN_PLACE_H_
@@ -0,0 +1,63 @@
+/** @file
+  Client-side TLS session cache.
+
+  A context with a session cache lets later connections to the same server
+  name resume the session of an earlier one with an abbreviated handshake.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef TLS_SESSION_CACHE_H_
+#define TLS_SESSION_CACHE_H_
+
+#include <Uefi.h>
+
+/**
+  Enable, resize or disable the client session cache of a TLS context.
+
+  With the cache enabled, every TLS object created from TlsCtx by TlsNew()
+  stores the session (including a session ticket) it negotiated under the
+  server name set by TlsSetVerifyHost(), and offers it again when the next
+  connection to the same server name starts its handshake. Calling this
+  function again drops all cached sessions.
+
+  A connection has to be closed with TlsCloseNotify() before TlsFree() for
+  its session to stay resumable. TLS 1.2 sessions resume by session ID only,
+  because OpenSSL does not use TLS 1.2 tickets at the security level set by
+  TlsNew().
+
+  @param[in]  TlsCtx      Pointer to the SSL_CTX object.
+  @param[in]  MaxEntries  Number of server names to keep sessions for.
+                          0 disables the cache.
+
+  @retval  EFI_SUCCESS           The session cache was configured.
+  @retval  EFI_INVALID_PARAMETER TlsCtx is NULL.
+  @retval  EFI_OUT_OF_RESOURCES  Memory allocation failed.
+
+**/
+EFI_STATUS
+EFIAPI
+TlsCtxSetSessionCache (
+  IN VOID   *TlsCtx,
+  IN UINTN  MaxEntries
+  );
+
+/**
+  Check whether the handshake of a TLS object resumed a cached session.
+
+  @param[in]  Tls  Pointer to the TLS object.
+
+  @retval  TRUE   The connection resumed an earlier session.
+  @retval  FALSE  The connection did a full handshake, has not completed the
+                  handshake yet, or Tls is NULL.
+
+**/
+BOOLEAN
+EFIAPI
+TlsSessionReused (
+  IN VOID  *Tls
+  );
+
+#endif // TLS_SESSION_CACHE_H_
@@ -0,0 +1,397 @@
+/** @file
+  Internal fixed-context digest and HMAC layer over the OpenSSL SHA cores.
+
+  SHA1_*, SHA256_* and SHA384/512_* process whole blocks with the
+  sha*_block_data_order () routines of OpensslLib, which are the assembly
+  implementations in the accelerated flavors. No EVP object, provider or
+  heap memory is involved, so a context can live on the stack.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "CryptDigest.h"
+
+typedef struct {
+  INT32     Nid;
+  UINT32    DigestSize;
+  UINT32    BlockSize;
+} CRYPT_DIGEST_ALGORITHM;
+
+STATIC CONST CRYPT_DIGEST_ALGORITHM  mCryptDigestAlgorithms[] = {
+  { NID_sha256, SHA256_DIGEST_LENGTH, SHA256_CBLOCK },
+  { NID_sha384, SHA384_DIGEST_LENGTH, SHA512_CBLOCK },
+  { NID_sha512, SHA512_DIGEST_LENGTH, SHA512_CBLOCK },
+  { NID_sha1,   SHA_DIGEST_LENGTH,    SHA_CBLOCK    },
+};
+
+/**
+  Looks up an algorithm.
+
+  @param[in]  Nid  OpenSSL NID of the digest algorithm.
+
+  @return  The algorithm, or NULL if it is not supported.
+**/
+STATIC
+CONST CRYPT_DIGEST_ALGORITHM *
+CryptDigestFind (
+  IN INT32  Nid
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (mCryptDigestAlgorithms); Index++) {
+    if (mCryptDigestAlgorithms[Index].Nid == Nid) {
+      return &mCryptDigestAlgorithms[Index];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Returns the digest size of an algorithm.
+
+  @param[in]  Nid  OpenSSL NID of the digest algorithm.
+
+  @return  The digest size in bytes, or 0 if the algorithm is not supported
+           by this layer.
+**/
+UINTN
+CryptDigestGetSize (
+  IN INT32  Nid
+  )
+{
+  CONST CRYPT_DIGEST_ALGORITHM  *Algorithm;
+
+  Algorithm = CryptDigestFind (Nid);
+  return (Algorithm == NULL) ? 0 : Algorithm->DigestSize;
+}
+
+/**
+  Starts a digest computation.
+
+  @param[out]  Context  Context to initialize.
+  @param[in]   Nid      OpenSSL NID of the digest algorithm.
+
+  @retval  TRUE   Context was initialized.
+  @retval  FALSE  The algorithm is not supported by this layer.
+**/
+BOOLEAN
+CryptDigestInit (
+  OUT CRYPT_DIGEST_CTX  *Context,
+  IN  INT32             Nid
+  )
+{
+  CONST CRYPT_DIGEST_ALGORITHM  *Algorithm;
+  INT32                         Result;
+
+  ASSERT (Context != NULL);
+
+  Context->Nid = NID_undef;
+  Algorithm    = CryptDigestFind (Nid);
+  if (Algorithm == NULL) {
+    return FALSE;
+  }
+
+  switch (Nid) {
+    case NID_sha256:
+      Result = SHA256_Init (&Context->State.Sha256);
+      break;
+    case NID_sha384:
+      Result = SHA384_Init (&Context->State.Sha512);
+      break;
+    case NID_sha512:
+      Result = SHA512_Init (&Context->State.Sha512);
+      break;
+    default:
+      Result = SHA1_Init (&Context->State.Sha1);
+      break;
+  }
+
+  if (Result != 1) {
+    return FALSE;
+  }
+
+  Context->Nid        = Nid;
+  Context->DigestSize = Algorithm->DigestSize;
+  Context->BlockSize  = Algorithm->BlockSize;
+  return TRUE;
+}
+
+/**
+  Adds data to a digest computation.
+
+  @param[in,out]  Context   Initialized context.
+  @param[in]      Data      Data to hash. May be NULL if DataSize is 0.
+  @param[in]      DataSize  Size of Data in bytes.
+
+  @retval  TRUE   Data was hashed.
+  @retval  FALSE  Context is not initialized, or Data is NULL.
+**/
+BOOLEAN
+CryptDigestUpdate (
+  IN OUT CRYPT_DIGEST_CTX  *Context,
+  IN     CONST VOID        *Data,
+  IN     UINTN             DataSize
+  )
+{
+  ASSERT (Context != NULL);
+
+  if ((Data == NULL) && (DataSize != 0)) {
+    return FALSE;
+  }
+
+  if (DataSize == 0) {
+    return (BOOLEAN)(Context->Nid != NID_undef);
+  }
+
+  switch (Context->Nid) {
+    case NID_sha256:
+      return (BOOLEAN)(SHA256_Update (&Context->State.Sha256, Data, DataSize) == 1);
+    case NID_sha384:
+    case NID_sha512:
+      //
+      // SHA-384 only differs from SHA-512 in its initial state and in the
+      // digest length recorded in the context.
+      //
+      return (BOOLEAN)(SHA512_Update (&Context->State.Sha512, Data, DataSize) == 1);
+    case NID_sha1:
+      return (BOOLEAN)(SHA1_Update (&Context->State.Sha1, Data, DataSize) == 1);
+    default:
+      return FALSE;
+  }
+}
+
+/**
+  Completes a digest computation and clears the context.
+
+  @param[in,out]  Context  Initialized context.
+  @param[out]     Digest   Receives Context->DigestSize bytes.
+
+  @retval  TRUE   Digest holds the digest.
+  @retval  FALSE  Context is not initialized.
+**/
+BOOLEAN
+CryptDigestFinal (
+  IN OUT CRYPT_DIGEST_CTX  *Context,
+  OUT    UINT8             *Digest
+  )
+{
+  INT32  Result;
+
+  ASSERT (Context != NULL);
+  ASSERT (Digest != NULL);
+
+  switch (Context->Nid) {
+    case NID_sha256:
+      Result = SHA256_Final (Digest, &Context->State.Sha256);
+      break;
+    case NID_sha384:
+    case NID_sha512:
+      Result = SHA512_Final (Digest, &Context->State.Sha512);
+      break;
+    case NID_sha1:
+      Result = SHA1_Final (Digest, &Context->State.Sha1);
+      break;
+    default:
+      return FALSE;
+  }
+
+  ZeroMem (Context, sizeof (*Context));
+  return (BOOLEAN)(Result == 1);
+}
+
+/**
+  Computes the digest of a buffer.
+
+  @param[in]   Nid       OpenSSL NID of the digest algorithm.
+  @param[in]   Data      Data to hash. May be NULL if DataSize is 0.
+  @param[in]   DataSize  Size of Data in bytes.
+  @param[out]  Digest    Receives CryptDigestGetSize (Nid) bytes.
+
+  @retval  TRUE   Digest holds the digest.
+  @retval  FALSE  The algorithm is not supported, or Data is NULL.
+**/
+BOOLEAN
+CryptDigestAll (
+  IN  INT32       Nid,
+  IN  CONST VOID  *Data,
+  IN  UINTN       DataSize,
+  OUT UINT8       *Digest
+  )
+{
+  CRYPT_DIGEST_CTX  Context;
+
+  if (!CryptDigestInit (&Context, Nid)) {
+    return FALSE;
+  }
+
+  if (!CryptDigestUpdate (&Context, Data, DataSize)) {
+    ZeroMem (&Context, sizeof (Context));
+    return FALSE;
+  }
+
+  return CryptDigestFinal (&Context, Digest);
+}
+
+/**
+  Starts an HMAC computation (RFC 2104).
+
+  @param[out]  Context  Context to initialize.
+  @param[in]   Nid      OpenSSL NID of the digest algorithm.
+  @param[in]   Key      HMAC key. May be NULL if KeySize is 0.
+  @param[in]   KeySize  Size of Key in bytes.
+
+  @retval  TRUE   Context was initialized.
+  @retval  FALSE  The algorithm is not supported, or Key is NULL.
+**/
+BOOLEAN
+CryptHmacInit (
+  OUT CRYPT_HMAC_CTX  *Context,
+  IN  INT32           Nid,
+  IN  CONST UINT8     *Key,
+  IN  UINTN           KeySize
+  )
+{
+  UINT8    Pad[CRYPT_DIGEST_MAX_BLOCK_SIZE];
+  UINTN    BlockSize;
+  UINTN    Index;
+  BOOLEAN  Result;
+
+  ASSERT (Context != NULL);
+
+  Context->Outer.Nid = NID_undef;
+  if (((Key == NULL) && (KeySize != 0)) || !CryptDigestInit (&Context->Inner, Nid)) {
+    Context->Inner.Nid = NID_undef;
+    return FALSE;
+  }
+
+  //
+  // K0 is the key zero padded to a block, or its digest if it is longer.
+  //
+  BlockSize = Context->Inner.BlockSize;
+  ZeroMem (Pad, BlockSize);
+  if (KeySize > BlockSize) {
+    Result = (BOOLEAN)(CryptDigestUpdate (&Context->Inner, Key, KeySize) &&
+                       CryptDigestFinal (&Context->Inner, Pad) &&
+                       CryptDigestInit (&Context->Inner, Nid));
+  } else {
+    CopyMem (Pad, Key, KeySize);
+    Result = TRUE;
+  }
+
+  for (Index = 0; Index < BlockSize; Index++) {
+    Pad[Index] ^= 0x36;
+  }
+
+  Result = (BOOLEAN)(Result && CryptDigestUpdate (&Context->Inner, Pad, BlockSize));
+
+  for (Index = 0; Index < BlockSize; Index++) {
+    Pad[Index] ^= 0x36 ^ 0x5c;
+  }
+
+  Result = (BOOLEAN)(Result &&
+                     CryptDigestInit (&Context->Outer, Nid) &&
+                     CryptDigestUpdate (&Context->Outer, Pad, BlockSize));
+
+  ZeroMem (Pad, sizeof (Pad));
+  if (!Result) {
+    ZeroMem (Context, sizeof (*Context));
+  }
+
+  return Result;
+}
+
+/**
+  Adds data to an HMAC computation.
+
+  @param[in,out]  Context   Initialized context.
+  @param[in]      Data      Data to authenticate. May be NULL if DataSize
+                            is 0.
+  @param[in]      DataSize  Size of Data in bytes.
+
+  @retval  TRUE   Data was hashed.
+  @retval  FALSE  Context is not initialized, or Data is NULL.
+**/
+BOOLEAN
+CryptHmacUpdate (
+  IN OUT CRYPT_HMAC_CTX  *Context,
+  IN     CONST VOID      *Data,
+  IN     UINTN           DataSize
+  )
+{
+  ASSERT (Context != NULL);
+
+  return CryptDigestUpdate (&Context->Inner, Data, DataSize);
+}
+
+/**
+  Completes an HMAC computation and clears the context.
+
+  @param[in,out]  Context  Initialized context.
+  @param[out]     Mac      Receives the digest size of the algorithm in
+                           bytes.
+
+  @retval  TRUE   Mac holds the HMAC.
+  @retval  FALSE  Context is not initialized.
+**/
+BOOLEAN
+CryptHmacFinal (
+  IN OUT CRYPT_HMAC_CTX  *Context,
+  OUT    UINT8           *Mac
+  )
+{
+  UINT8    Digest[CRYPT_DIGEST_MAX_SIZE];
+  UINTN    DigestSize;
+  BOOLEAN  Result;
+
+  ASSERT (Context != NULL);
+
+  DigestSize = Context->Inner.DigestSize;
+  Result     = (BOOLEAN)(CryptDigestFinal (&Context->Inner, Digest) &&
+                         CryptDigestUpdate (&Context->Outer, Digest, DigestSize) &&
+                         CryptDigestFinal (&Context->Outer, Mac));
+
+  ZeroMem (Digest, sizeof (Digest));
+  ZeroMem (Context, sizeof (*Context));
+  return Result;
+}
+
+/**
+  Computes the HMAC of a buffer.
+
+  @param[in]   Nid       OpenSSL NID of the digest algorithm.
+  @param[in]   Key       HMAC key. May be NULL if KeySize is 0.
+  @param[in]   KeySize   Size of Key in bytes.
+  @param[in]   Data      Data to authenticate. May be NULL if DataSize is 0.
+  @param[in]   DataSize  Size of Data in bytes.
+  @param[out]  Mac       Receives CryptDigestGetSize (Nid) bytes.
+
+  @retval  TRUE   Mac holds the HMAC.
+  @retval  FALSE  The algorithm is not supported, or Key or Data is NULL.
+**/
+BOOLEAN
+CryptHmacAll (
+  IN  INT32        Nid,
+  IN  CONST UINT8  *Key,
+  IN  UINTN        KeySize,
+  IN  CONST VOID   *Data,
+  IN  UINTN        DataSize,
+  OUT UINT8        *Mac
+  )
+{
+  CRYPT_HMAC_CTX  Context;
+
+  if (!CryptHmacInit (&Context, Nid, Key, KeySize)) {
+    return FALSE;
+  }
+
+  if (!CryptHmacUpdate (&Context, Data, DataSize)) {
+    ZeroMem (&Context, sizeof (Context));
+    return FALSE;
+  }
+
+  return CryptHmacFinal (&Context, Mac);
+}
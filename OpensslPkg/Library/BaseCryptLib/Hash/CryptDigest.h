@@ -0,0 +1,214 @@
+/** @file
+  Internal fixed-context digest and HMAC layer.
+
+  The HMAC, HKDF, RSA-PSS and time-stamp wrappers hash short inputs on
+  every call. Going through EVP costs an EVP_MD_CTX or EVP_MAC_CTX
+  allocation, a provider fetch and OSSL_PARAM marshalling per operation,
+  which outweighs the compression itself below a few KB. These routines
+  call the SHA-1 and SHA-2 block cores of OpensslLib directly on a context
+  owned by the caller, usually on the stack, and never allocate.
+
+  Algorithms are identified by OpenSSL NIDs so that call sites holding an
+  EVP_MD or an ASN.1 object can map it with EVP_MD_get_type () or
+  OBJ_obj2nid ().
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef CRYPT_DIGEST_H_
+#define CRYPT_DIGEST_H_
+
+#include "InternalCryptLib.h"
+#include <openssl/obj_mac.h>
+#include <openssl/sha.h>
+
+//
+// Largest digest and block size of the supported algorithms (SHA-512).
+//
+#define CRYPT_DIGEST_MAX_SIZE        SHA512_DIGEST_LENGTH
+#define CRYPT_DIGEST_MAX_BLOCK_SIZE  SHA512_CBLOCK
+
+typedef struct {
+  //
+  // NID_sha1, NID_sha256, NID_sha384 or NID_sha512. NID_undef once the
+  // context is finalized or was never initialized.
+  //
+  INT32     Nid;
+  UINT32    DigestSize;
+  UINT32    BlockSize;
+  union {
+    SHA_CTX       Sha1;
+    SHA256_CTX    Sha256;
+    SHA512_CTX    Sha512;
+  } State;
+} CRYPT_DIGEST_CTX;
+
+typedef struct {
+  //
+  // Inner hash, started with the key XOR ipad block.
+  //
+  CRYPT_DIGEST_CTX    Inner;
+  //
+  // Outer hash, started with the key XOR opad block.
+  //
+  CRYPT_DIGEST_CTX    Outer;
+} CRYPT_HMAC_CTX;
+
+/**
+  Returns the digest size of an algorithm.
+
+  @param[in]  Nid  OpenSSL NID of the digest algorithm.
+
+  @return  The digest size in bytes, or 0 if the algorithm is not supported
+           by this layer.
+**/
+UINTN
+CryptDigestGetSize (
+  IN INT32  Nid
+  );
+
+/**
+  Starts a digest computation.
+
+  @param[out]  Context  Context to initialize.
+  @param[in]   Nid      OpenSSL NID of the digest algorithm.
+
+  @retval  TRUE   Context was initialized.
+  @retval  FALSE  The algorithm is not supported by this layer.
+**/
+BOOLEAN
+CryptDigestInit (
+  OUT CRYPT_DIGEST_CTX  *Context,
+  IN  INT32             Nid
+  );
+
+/**
+  Adds data to a digest computation.
+
+  @param[in,out]  Context   Initialized context.
+  @param[in]      Data      Data to hash. May be NULL if DataSize is 0.
+  @param[in]      DataSize  Size of Data in bytes.
+
+  @retval  TRUE   Data was hashed.
+  @retval  FALSE  Context is not initialized, or Data is NULL.
+**/
+BOOLEAN
+CryptDigestUpdate (
+  IN OUT CRYPT_DIGEST_CTX  *Context,
+  IN     CONST VOID        *Data,
+  IN     UINTN             DataSize
+  );
+
+/**
+  Completes a digest computation and clears the context.
+
+  @param[in,out]  Context  Initialized context.
+  @param[out]     Digest   Receives Context->DigestSize bytes.
+
+  @retval  TRUE   Digest holds the digest.
+  @retval  FALSE  Context is not initialized.
+**/
+BOOLEAN
+CryptDigestFinal (
+  IN OUT CRYPT_DIGEST_CTX  *Context,
+  OUT    UINT8             *Digest
+  );
+
+/**
+  Computes the digest of a buffer.
+
+  @param[in]   Nid       OpenSSL NID of the digest algorithm.
+  @param[in]   Data      Data to hash. May be NULL if DataSize is 0.
+  @param[in]   DataSize  Size of Data in bytes.
+  @param[out]  Digest    Receives CryptDigestGetSize (Nid) bytes.
+
+  @retval  TRUE   Digest holds the digest.
+  @retval  FALSE  The algorithm is not supported, or Data is NULL.
+**/
+BOOLEAN
+CryptDigestAll (
+  IN  INT32       Nid,
+  IN  CONST VOID  *Data,
+  IN  UINTN       DataSize,
+  OUT UINT8       *Digest
+  );
+
+/**
+  Starts an HMAC computation (RFC 2104).
+
+  @param[out]  Context  Context to initialize.
+  @param[in]   Nid      OpenSSL NID of the digest algorithm.
+  @param[in]   Key      HMAC key. May be NULL if KeySize is 0.
+  @param[in]   KeySize  Size of Key in bytes.
+
+  @retval  TRUE   Context was initialized.
+  @retval  FALSE  The algorithm is not supported, or Key is NULL.
+**/
+BOOLEAN
+CryptHmacInit (
+  OUT CRYPT_HMAC_CTX  *Context,
+  IN  INT32           Nid,
+  IN  CONST UINT8     *Key,
+  IN  UINTN           KeySize
+  );
+
+/**
+  Adds data to an HMAC computation.
+
+  @param[in,out]  Context   Initialized context.
+  @param[in]      Data      Data to authenticate. May be NULL if DataSize
+                            is 0.
+  @param[in]      DataSize  Size of Data in bytes.
+
+  @retval  TRUE   Data was hashed.
+  @retval  FALSE  Context is not initialized, or Data is NULL.
+**/
+BOOLEAN
+CryptHmacUpdate (
+  IN OUT CRYPT_HMAC_CTX  *Context,
+  IN     CONST VOID      *Data,
+  IN     UINTN           DataSize
+  );
+
+/**
+  Completes an HMAC computation and clears the context.
+
+  @param[in,out]  Context  Initialized context.
+  @param[out]     Mac      Receives the digest size of the algorithm in
+                           bytes.
+
+  @retval  TRUE   Mac holds the HMAC.
+  @retval  FALSE  Context is not initialized.
+**/
+BOOLEAN
+CryptHmacFinal (
+  IN OUT CRYPT_HMAC_CTX  *Context,
+  OUT    UINT8           *Mac
+  );
+
+/**
+  Computes the HMAC of a buffer.
+
+  @param[in]   Nid       OpenSSL NID of the digest algorithm.
+  @param[in]   Key       HMAC key. May be NULL if KeySize is 0.
+  @param[in]   KeySize   Size of Key in bytes.
+  @param[in]   Data      Data to authenticate. May be NULL if DataSize is 0.
+  @param[in]   DataSize  Size of Data in bytes.
+  @param[out]  Mac       Receives CryptDigestGetSize (Nid) bytes.
+
+  @retval  TRUE   Mac holds the HMAC.
+  @retval  FALSE  The algorithm is not supported, or Key or Data is NULL.
+**/
+BOOLEAN
+CryptHmacAll (
+  IN  INT32        Nid,
+  IN  CONST UINT8  *Key,
+  IN  UINTN        KeySize,
+  IN  CONST VOID   *Data,
+  IN  UINTN        DataSize,
+  OUT UINT8        *Mac
+  );
+
+#endif
@@ -0,0 +1,24 @@
+/** @file
+  Dispatch ParallelHash blocks to the APs through CryptMpDispatchLib, for
+  the instance that DXE drivers and OneCryptoBin share. The DSC decides
+  whether any AP is started.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "CryptParallelHash.h"
+
+/**
+  Dispatch the block task to each AP.
+
+**/
+VOID
+EFIAPI
+DispatchBlockToAp (
+  VOID
+  )
+{
+  DispatchToAp (ParallelHashApExecute, NULL);
+}
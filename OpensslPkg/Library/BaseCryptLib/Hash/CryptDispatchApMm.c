@@ -9,27 +9,95 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "CryptParallelHash.h"
 #include <Library/MmServicesTableLib.h>
 
+// MU_CHANGE [BEGIN]
+
 /**
-  Dispatch the block task to each AP in SMM mode.
+  Run a procedure on each AP in SMM mode.
+
+  MmStartupThisAp () does not wait for the AP, so the APs may still be
+  running Procedure when this function returns.
 
+  @param[in]  Procedure  Procedure to run on each AP.
+  @param[in]  Argument   Argument passed to Procedure.
+
+  @return  The number of APs Procedure was started on.
 **/
-VOID
+UINTN
 EFIAPI
-DispatchBlockToAp (
-  VOID
+DispatchToAp (
+  IN EFI_AP_PROCEDURE  Procedure,
+  IN VOID              *Argument
   )
 {
   UINTN  Index;
+  UINTN  Started;
 
   if (gMmst == NULL) {
-    return;
+    return 0;
   }
 
+  Started = 0;
   for (Index = 0; Index < gMmst->NumberOfCpus; Index++) {
     if (Index != gMmst->CurrentlyExecutingCpu) {
-      gMmst->MmStartupThisAp (ParallelHashApExecute, Index, NULL);
+      if (!EFI_ERROR (gMmst->MmStartupThisAp (Procedure, Index, Argument))) {
+        Started++;
+      }
     }
   }
 
-  return;
+  return Started;
 }
+
+/**
+  Start a procedure on each AP in SMM mode and return without waiting for
+  the APs.
+
+  MM has no events, so completion is reported through Argument only. The APs
+  only run while in MM, so the caller must wait for them before it leaves MM.
+
+  @param[in]   Procedure  Procedure to run on each AP.
+  @param[in]   Argument   Argument passed to Procedure.
+  @param[in]   WaitEvent  Must be NULL.
+  @param[out]  Running    Number of APs Procedure was started on.
+
+  @retval EFI_SUCCESS      Procedure was started, or has run on the calling
+                           processor.
+  @retval EFI_UNSUPPORTED  WaitEvent is not NULL.
+**/
+EFI_STATUS
+EFIAPI
+DispatchToApAsync (
+  IN  EFI_AP_PROCEDURE  Procedure,
+  IN  VOID              *Argument,
+  IN  EFI_EVENT         WaitEvent  OPTIONAL,
+  OUT UINTN             *Running
+  )
+{
+  *Running = 0;
+
+  if (WaitEvent != NULL) {
+    return EFI_UNSUPPORTED;
+  }
+
+  *Running = DispatchToAp (Procedure, Argument);
+  if (*Running == 0) {
+    Procedure (Argument);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Dispatch the block task to each AP in SMM mode.
+
+**/
+VOID
+EFIAPI
+DispatchBlockToAp (
+  VOID
+  )
+{
+  DispatchToAp (ParallelHashApExecute, NULL);
+}
+
+// MU_CHANGE [END]
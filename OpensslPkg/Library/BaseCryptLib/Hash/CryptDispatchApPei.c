@@ -12,14 +12,24 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Ppi/MpServices.h>
 #include <Library/PeiServicesLib.h>
 
+// MU_CHANGE [BEGIN]
+
 /**
-  Dispatch the block task to each AP in PEI phase.
+  Run a procedure on each AP in PEI phase.
+
+  StartupAllAPs () is blocking in PEI, so all APs are done when this
+  function returns.
 
+  @param[in]  Procedure  Procedure to run on each AP.
+  @param[in]  Argument   Argument passed to Procedure.
+
+  @return  0, no AP is still running Procedure.
 **/
-VOID
+UINTN
 EFIAPI
-DispatchBlockToAp (
-  VOID
+DispatchToAp (
+  IN EFI_AP_PROCEDURE  Procedure,
+  IN VOID              *Argument
   )
 {
   EFI_STATUS               Status;
@@ -38,17 +48,72 @@ DispatchBlockToAp (
     //
     // Failed to locate MpServices Ppi, do parallel hash by one core.
     //
-    DEBUG ((DEBUG_ERROR, "[DispatchBlockToApPei] Failed to locate MpServices Ppi. Status = %r\n", Status));
-    return;
+    DEBUG ((DEBUG_ERROR, "[DispatchToApPei] Failed to locate MpServices Ppi. Status = %r\n", Status));
+    return 0;
   }
 
   Status = MpServicesPpi->StartupAllAPs (
                             (CONST EFI_PEI_SERVICES **)PeiServices,
                             MpServicesPpi,
-                            ParallelHashApExecute,
+                            Procedure,
                             FALSE,
                             0,
-                            NULL
+                            Argument
                             );
-  return;
+  return 0;
+}
+
+/**
+  Run a procedure on each AP in PEI phase, then on the calling processor.
+
+  PEI has no events and its MP services only return once the APs are done,
+  so Procedure has completed when this function returns. The calling
+  processor runs Procedure last to finish whatever no AP has done, or all of
+  it when there are no APs.
+
+  EDKII_PEI_MP_SERVICES2_PPI could run Procedure on the calling processor
+  alongside the APs, but it is declared by UefiCpuPkg, which OpensslPkg does
+  not depend on.
+
+  @param[in]   Procedure  Procedure to run on each processor.
+  @param[in]   Argument   Argument passed to Procedure.
+  @param[in]   WaitEvent  Must be NULL.
+  @param[out]  Running    Set to 0, no AP is still running Procedure.
+
+  @retval EFI_SUCCESS      Procedure has completed.
+  @retval EFI_UNSUPPORTED  WaitEvent is not NULL.
+**/
+EFI_STATUS
+EFIAPI
+DispatchToApAsync (
+  IN  EFI_AP_PROCEDURE  Procedure,
+  IN  VOID              *Argument,
+  IN  EFI_EVENT         WaitEvent  OPTIONAL,
+  OUT UINTN             *Running
+  )
+{
+  *Running = 0;
+
+  if (WaitEvent != NULL) {
+    return EFI_UNSUPPORTED;
+  }
+
+  DispatchToAp (Procedure, Argument);
+  Procedure (Argument);
+  return EFI_SUCCESS;
 }
+
+/**
+  Dispatch the block task to each AP in PEI phase.
+
+**/
+VOID
+EFIAPI
+DispatchBlockToAp (
+  VOID
+  )
+{
+  DispatchToAp (ParallelHashApExecute, NULL);
+}
+
+// MU_CHANGE [END]
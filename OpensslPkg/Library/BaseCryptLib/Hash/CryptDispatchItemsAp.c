@@ -0,0 +1,117 @@
+/** @file
+  Share independent work items between the calling processor and the APs.
+
+  The APs are started through DispatchToAp (), which the PEI and SMM
+  instances build from CryptDispatchApPei.c and CryptDispatchApMm.c and
+  BaseCryptLib.inf takes from CryptMpDispatchLib. Every processor, including the caller, claims the next
+  unprocessed item with an atomic increment until none are left, so the work
+  needs no allocation and no per-item locks.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "CryptParallelHash.h"
+#include <Library/SynchronizationLib.h>
+
+typedef struct {
+  CRYPT_ITEM_PROCEDURE    Procedure;
+  VOID                    *Context;
+  UINTN                   ItemCount;
+  volatile UINT32         NextItem;
+  volatile UINT32         ApsDone;
+} DISPATCH_ITEMS;
+
+/**
+  Process items until none are left.
+
+  @param[in]  Items  Shared work queue.
+**/
+STATIC
+VOID
+DispatchItemsRun (
+  IN DISPATCH_ITEMS  *Items
+  )
+{
+  UINTN  Index;
+
+  for ( ; ;) {
+    Index = InterlockedIncrement (&Items->NextItem) - 1;
+    if (Index >= Items->ItemCount) {
+      return;
+    }
+
+    Items->Procedure (Items->Context, Index);
+  }
+}
+
+/**
+  AP entry point: process items, then report that this AP is done.
+
+  @param[in]  Buffer  Shared work queue.
+**/
+STATIC
+VOID
+EFIAPI
+DispatchItemsApExecute (
+  IN OUT VOID  *Buffer
+  )
+{
+  DispatchItemsRun ((DISPATCH_ITEMS *)Buffer);
+  InterlockedIncrement (&((DISPATCH_ITEMS *)Buffer)->ApsDone);
+}
+
+/**
+  Run Procedure once for each of ItemCount independent items and return
+  when all of them are done.
+
+  The items are shared between the calling processor and the APs, so
+  Procedure must not use services that are not MP safe, such as memory
+  allocation.
+
+  @param[in]  Procedure  Procedure to run for each item.
+  @param[in]  Context    Context passed to Procedure.
+  @param[in]  ItemCount  Number of items.
+**/
+VOID
+EFIAPI
+DispatchItemsToAp (
+  IN CRYPT_ITEM_PROCEDURE  Procedure,
+  IN VOID                  *Context,
+  IN UINTN                 ItemCount
+  )
+{
+  DISPATCH_ITEMS  Items;
+  UINTN           Running;
+  UINTN           Index;
+
+  //
+  // A single item is not worth waking the APs for. The claim counter is
+  // 32 bits and each processor overshoots it once, so very large batches
+  // stay on this processor too.
+  //
+  if ((ItemCount < 2) || (ItemCount > MAX_UINT32 / 2)) {
+    for (Index = 0; Index < ItemCount; Index++) {
+      Procedure (Context, Index);
+    }
+
+    return;
+  }
+
+  Items.Procedure = Procedure;
+  Items.Context   = Context;
+  Items.ItemCount = ItemCount;
+  Items.NextItem  = 0;
+  Items.ApsDone   = 0;
+
+  Running = DispatchToAp (DispatchItemsApExecute, &Items);
+  DispatchItemsRun (&Items);
+
+  //
+  // Items lives on this stack, so wait for every AP that may still touch it.
+  //
+  while (Items.ApsDone < Running) {
+    CpuPause ();
+  }
+}
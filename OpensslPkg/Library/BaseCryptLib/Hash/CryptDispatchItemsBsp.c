@@ -0,0 +1,36 @@
+/** @file
+  Run independent work items on the calling processor, for library instances
+  without MP dispatch.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+
+/**
+  Run Procedure once for each of ItemCount independent items and return
+  when all of them are done.
+
+  This instance has no MP dispatch, so all items run on the calling
+  processor, in order.
+
+  @param[in]  Procedure  Procedure to run for each item.
+  @param[in]  Context    Context passed to Procedure.
+  @param[in]  ItemCount  Number of items.
+**/
+VOID
+EFIAPI
+DispatchItemsToAp (
+  IN CRYPT_ITEM_PROCEDURE  Procedure,
+  IN VOID                  *Context,
+  IN UINTN                 ItemCount
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < ItemCount; Index++) {
+    Procedure (Context, Index);
+  }
+}
@@ -0,0 +1,64 @@
+/** @file
+  Batch message hashing which does not provide real capabilities.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+#include <CryptHashBatch.h>
+
+/**
+  Computes the SHA-256 digests of several independent messages.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[in]   Messages  Array of Count pointers to the messages.
+  @param[in]   Sizes     Array of the message sizes in bytes.
+  @param[out]  Digests   Array of Count buffers, each receiving a 32-byte
+                         SHA-256 digest.
+  @param[in]   Count     Number of messages.
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashAllBatch (
+  IN  CONST VOID   **Messages,
+  IN  CONST UINTN  *Sizes,
+  OUT UINT8        **Digests,
+  IN  UINTN        Count
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+/**
+  Computes the SHA-384 digests of several independent messages.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[in]   Messages  Array of Count pointers to the messages.
+  @param[in]   Sizes     Array of the message sizes in bytes.
+  @param[out]  Digests   Array of Count buffers, each receiving a 48-byte
+                         SHA-384 digest.
+  @param[in]   Count     Number of messages.
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha384HashAllBatch (
+  IN  CONST VOID   **Messages,
+  IN  CONST UINTN  *Sizes,
+  OUT UINT8        **Digests,
+  IN  UINTN        Count
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
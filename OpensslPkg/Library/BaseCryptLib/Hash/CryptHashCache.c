@@ -0,0 +1,477 @@
+/** @file
+  Cached block digests of a tracked memory region.
+
+  A hash cache keeps the SHA-256 tree (see CryptSha256Tree.c) of a region
+  whose contents change in place, such as a variable store or a capsule
+  staging buffer. Writers mark the byte ranges they change with
+  Sha256HashCacheMarkDirty (). Sha256HashCacheRefresh () then re-hashes only
+  the dirty blocks and the tree nodes above them, so re-measuring the region
+  costs in proportion to what changed, and returns the same root as
+  Sha256TreeHashAll () over the whole region.
+
+  The cache lives in one caller supplied buffer and never allocates, so it
+  works in MM with a fixed memory budget as well as in DXE.
+  Sha256HashCacheGetBlockSize () picks the smallest block size whose cache
+  fits a given budget. Dirty blocks are hashed through DispatchItemsToAp ()
+  once there are enough of them to be worth waking the APs for.
+
+  The cache is not MP safe: marking and refreshing must be serialized by the
+  caller, like any other update of the tracked region.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "CryptSha256Tree.h"
+#include <CryptHashCache.h>
+
+#define HASH_CACHE_SIGNATURE  SIGNATURE_32 ('S', '2', 'H', 'C')
+
+//
+// Smallest block size Sha256HashCacheGetBlockSize () picks.
+//
+#define HASH_CACHE_MIN_BLOCK_SIZE  512
+
+//
+// Dirty blocks are only shared with the APs once they add up to this many
+// bytes. Smaller refreshes are hashed on the calling processor.
+//
+#define HASH_CACHE_AP_MIN_SIZE  SIZE_64KB
+
+#define HASH_CACHE_WORD_BITS  (sizeof (UINTN) * 8)
+
+typedef struct {
+  UINT32         Signature;
+  CONST UINT8    *Region;
+  //
+  // Number of dirty blocks, and one bit per block in DirtyMap.
+  //
+  UINTN          DirtyCount;
+  UINTN          *DirtyMap;
+  UINTN          DirtyWords;
+  //
+  // The tree of the region, variable size, followed by DirtyMap.
+  //
+  SHA256_TREE    Tree;
+} HASH_CACHE;
+
+/**
+  Returns the size of the cache up to the end of its tree, rounded up so the
+  dirty map that follows is aligned.
+
+  @param[in]  RegionSize  Size of the tracked region in bytes.
+  @param[in]  BlockSize   Size of a block in bytes.
+
+  @return  The size, or 0 if it overflows.
+**/
+STATIC
+UINTN
+HashCacheTreeEnd (
+  IN UINTN  RegionSize,
+  IN UINTN  BlockSize
+  )
+{
+  UINTN  TreeSize;
+
+  TreeSize = Sha256TreeGetContextSize (RegionSize, BlockSize);
+  if ((TreeSize == 0) || (TreeSize > MAX_UINTN - OFFSET_OF (HASH_CACHE, Tree) - sizeof (UINTN))) {
+    return 0;
+  }
+
+  return ALIGN_VALUE (OFFSET_OF (HASH_CACHE, Tree) + TreeSize, sizeof (UINTN));
+}
+
+/**
+  Hash the dirty blocks of one dirty map word.
+
+  @param[in]  Context  The HASH_CACHE.
+  @param[in]  Index    Index of the dirty map word.
+**/
+STATIC
+VOID
+EFIAPI
+HashCacheHashWord (
+  IN VOID   *Context,
+  IN UINTN  Index
+  )
+{
+  HASH_CACHE   *Cache;
+  SHA256_TREE  *Tree;
+  UINTN        Word;
+  UINTN        Bit;
+  UINTN        Block;
+  UINTN        Offset;
+
+  Cache = (HASH_CACHE *)Context;
+  Tree  = &Cache->Tree;
+  Word  = Cache->DirtyMap[Index];
+  for (Bit = 0; Word != 0; Bit++, Word >>= 1) {
+    if ((Word & 1) != 0) {
+      Block  = Index * HASH_CACHE_WORD_BITS + Bit;
+      Offset = Block * Tree->LeafSize;
+      Sha256TreeHashLeaf (Cache->Region + Offset, MIN (Tree->LeafSize, Tree->DataSize - Offset), Tree->Nodes[Block]);
+    }
+  }
+}
+
+/**
+  Finds the next run of dirty blocks.
+
+  @param[in]   Cache  The cache.
+  @param[in]   Start  Block to start the search at.
+  @param[out]  First  Receives the first dirty block at or after Start.
+  @param[out]  Last   Receives the last block of the run.
+
+  @retval  TRUE   A run was found.
+  @retval  FALSE  No block at or after Start is dirty.
+**/
+STATIC
+BOOLEAN
+HashCacheNextRun (
+  IN  CONST HASH_CACHE  *Cache,
+  IN  UINTN             Start,
+  OUT UINTN             *First,
+  OUT UINTN             *Last
+  )
+{
+  UINTN  Count;
+  UINTN  Block;
+
+  Count = Cache->Tree.NodeCount[0];
+  for (Block = Start; Block < Count; Block++) {
+    if ((Block % HASH_CACHE_WORD_BITS == 0) && (Cache->DirtyMap[Block / HASH_CACHE_WORD_BITS] == 0)) {
+      Block += HASH_CACHE_WORD_BITS - 1;
+      continue;
+    }
+
+    if ((Cache->DirtyMap[Block / HASH_CACHE_WORD_BITS] & ((UINTN)1 << (Block % HASH_CACHE_WORD_BITS))) != 0) {
+      break;
+    }
+  }
+
+  if (Block >= Count) {
+    return FALSE;
+  }
+
+  *First = Block;
+  while ((Block + 1 < Count) &&
+         ((Cache->DirtyMap[(Block + 1) / HASH_CACHE_WORD_BITS] & ((UINTN)1 << ((Block + 1) % HASH_CACHE_WORD_BITS))) != 0))
+  {
+    Block++;
+  }
+
+  *Last = Block;
+  return TRUE;
+}
+
+/**
+  Retrieves the size, in bytes, of a hash cache for a region.
+
+  @param[in]  RegionSize  Size of the tracked region in bytes.
+  @param[in]  BlockSize   Size of a block in bytes.
+
+  @return  The size of the cache, or 0 if BlockSize is 0 or the size
+           overflows.
+
+**/
+UINTN
+EFIAPI
+Sha256HashCacheGetContextSize (
+  IN UINTN  RegionSize,
+  IN UINTN  BlockSize
+  )
+{
+  UINTN  TreeEnd;
+  UINTN  Words;
+
+  if (BlockSize == 0) {
+    return 0;
+  }
+
+  TreeEnd = HashCacheTreeEnd (RegionSize, BlockSize);
+  if (TreeEnd == 0) {
+    return 0;
+  }
+
+  Words = (RegionSize / BlockSize + 1) / HASH_CACHE_WORD_BITS + 1;
+  if (Words > (MAX_UINTN - TreeEnd) / sizeof (UINTN)) {
+    return 0;
+  }
+
+  return TreeEnd + Words * sizeof (UINTN);
+}
+
+/**
+  Retrieves the smallest block size whose hash cache for a region fits a
+  memory budget.
+
+  Smaller blocks make a refresh after a small change cheaper, at the cost of
+  a larger cache. The block size returned is a power of two of at least
+  512 bytes.
+
+  @param[in]  RegionSize  Size of the tracked region in bytes.
+  @param[in]  Budget      Largest acceptable cache size in bytes.
+
+  @return  The block size, or 0 if no cache for the region fits Budget.
+
+**/
+UINTN
+EFIAPI
+Sha256HashCacheGetBlockSize (
+  IN UINTN  RegionSize,
+  IN UINTN  Budget
+  )
+{
+  UINTN  BlockSize;
+  UINTN  CacheSize;
+
+  for (BlockSize = HASH_CACHE_MIN_BLOCK_SIZE; BlockSize != 0; BlockSize <<= 1) {
+    CacheSize = Sha256HashCacheGetContextSize (RegionSize, BlockSize);
+    if ((CacheSize != 0) && (CacheSize <= Budget)) {
+      return BlockSize;
+    }
+
+    if (BlockSize >= RegionSize) {
+      break;
+    }
+  }
+
+  return 0;
+}
+
+/**
+  Starts tracking a region: hashes all of its blocks into the cache.
+
+  The region must stay mapped at the same address while it is tracked.
+
+  If Cache is NULL, CacheSize is smaller than
+  Sha256HashCacheGetContextSize (RegionSize, BlockSize), BlockSize is 0, or
+  Region is NULL while RegionSize is not 0, then return FALSE.
+
+  @param[out]  Cache       Buffer receiving the cache.
+  @param[in]   CacheSize   Size of Cache in bytes.
+  @param[in]   Region      The tracked region.
+  @param[in]   RegionSize  Size of the region in bytes.
+  @param[in]   BlockSize   Size of a block in bytes. The last block may be
+                           shorter.
+
+  @retval TRUE   The cache holds the digests of the whole region.
+  @retval FALSE  An input was invalid.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashCacheInit (
+  OUT VOID        *Cache,
+  IN  UINTN       CacheSize,
+  IN  CONST VOID  *Region,
+  IN  UINTN       RegionSize,
+  IN  UINTN       BlockSize
+  )
+{
+  HASH_CACHE  *HashCache;
+  UINTN       RequiredSize;
+  UINTN       TreeEnd;
+
+  if ((Cache == NULL) || (BlockSize == 0) || ((Region == NULL) && (RegionSize != 0))) {
+    return FALSE;
+  }
+
+  RequiredSize = Sha256HashCacheGetContextSize (RegionSize, BlockSize);
+  if ((RequiredSize == 0) || (CacheSize < RequiredSize)) {
+    return FALSE;
+  }
+
+  TreeEnd   = HashCacheTreeEnd (RegionSize, BlockSize);
+  HashCache = (HASH_CACHE *)Cache;
+  if (!Sha256TreeInit (&HashCache->Tree, TreeEnd - OFFSET_OF (HASH_CACHE, Tree), Region, RegionSize, BlockSize)) {
+    return FALSE;
+  }
+
+  HashCache->Signature  = HASH_CACHE_SIGNATURE;
+  HashCache->Region     = (CONST UINT8 *)Region;
+  HashCache->DirtyCount = 0;
+  HashCache->DirtyMap   = (UINTN *)((UINT8 *)Cache + TreeEnd);
+  HashCache->DirtyWords = (RequiredSize - TreeEnd) / sizeof (UINTN);
+  ZeroMem (HashCache->DirtyMap, HashCache->DirtyWords * sizeof (UINTN));
+  return TRUE;
+}
+
+/**
+  Records that a byte range of the tracked region changed.
+
+  The blocks overlapping the range are re-hashed by the next
+  Sha256HashCacheRefresh (). Marking a range before or after writing it
+  are both fine, as long as the write is done before the refresh.
+
+  If Cache does not hold a hash cache, or the range is not within the
+  region, then return FALSE.
+
+  @param[in,out]  Cache   The hash cache.
+  @param[in]      Offset  Offset of the first changed byte.
+  @param[in]      Length  Number of changed bytes.
+
+  @retval TRUE   The range is marked.
+  @retval FALSE  An input was invalid.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashCacheMarkDirty (
+  IN OUT VOID   *Cache,
+  IN     UINTN  Offset,
+  IN     UINTN  Length
+  )
+{
+  HASH_CACHE  *HashCache;
+  UINTN       Block;
+  UINTN       Last;
+  UINTN       Mask;
+
+  HashCache = (HASH_CACHE *)Cache;
+  if ((HashCache == NULL) || (HashCache->Signature != HASH_CACHE_SIGNATURE)) {
+    return FALSE;
+  }
+
+  if ((Offset > HashCache->Tree.DataSize) || (Length > HashCache->Tree.DataSize - Offset)) {
+    return FALSE;
+  }
+
+  if (Length == 0) {
+    return TRUE;
+  }
+
+  Last = (Offset + Length - 1) / HashCache->Tree.LeafSize;
+  for (Block = Offset / HashCache->Tree.LeafSize; Block <= Last; Block++) {
+    Mask = (UINTN)1 << (Block % HASH_CACHE_WORD_BITS);
+    if ((HashCache->DirtyMap[Block / HASH_CACHE_WORD_BITS] & Mask) == 0) {
+      HashCache->DirtyMap[Block / HASH_CACHE_WORD_BITS] |= Mask;
+      HashCache->DirtyCount++;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Re-hashes the dirty blocks of the tracked region and returns its tree
+  hash.
+
+  Only the dirty blocks and their ancestors in the tree are hashed. Root
+  receives the same value as Sha256TreeHashAll () computes over the whole
+  region with the block size of the cache.
+
+  If Cache does not hold a hash cache, then return FALSE.
+
+  @param[in,out]  Cache  The hash cache.
+  @param[out]     Root   Receives the 32-byte root hash. May be NULL.
+
+  @retval TRUE   No block is dirty any more.
+  @retval FALSE  An input was invalid.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashCacheRefresh (
+  IN OUT VOID   *Cache,
+  OUT    UINT8  *Root  OPTIONAL
+  )
+{
+  HASH_CACHE   *HashCache;
+  SHA256_TREE  *Tree;
+  UINTN        Index;
+  UINTN        Level;
+  UINTN        Start;
+  UINTN        First;
+  UINTN        Last;
+  UINTN        Done;
+
+  HashCache = (HASH_CACHE *)Cache;
+  if ((HashCache == NULL) || (HashCache->Signature != HASH_CACHE_SIGNATURE)) {
+    return FALSE;
+  }
+
+  Tree = &HashCache->Tree;
+  if (HashCache->DirtyCount != 0) {
+    if (HashCache->DirtyCount * Tree->LeafSize >= HASH_CACHE_AP_MIN_SIZE) {
+      DispatchItemsToAp (HashCacheHashWord, HashCache, HashCache->DirtyWords);
+    } else {
+      for (Index = 0; Index < HashCache->DirtyWords; Index++) {
+        HashCacheHashWord (HashCache, Index);
+      }
+    }
+
+    //
+    // Walk the runs of dirty blocks once per level. The parents of
+    // neighbouring runs can coincide, so each level resumes after the last
+    // node it recomputed.
+    //
+    for (Level = 1; Level < Tree->LevelCount; Level++) {
+      Done = 0;
+      for (Start = 0; HashCacheNextRun (HashCache, Start, &First, &Last); Start = Last + 1) {
+        First = MAX (First >> Level, Done);
+
+        if (First <= (Last >> Level)) {
+          Sha256TreeRehashNodes (Tree, Level, First, Last >> Level);
+          Done = (Last >> Level) + 1;
+        }
+      }
+    }
+
+    ZeroMem (HashCache->DirtyMap, HashCache->DirtyWords * sizeof (UINTN));
+    HashCache->DirtyCount = 0;
+  }
+
+  if (Root == NULL) {
+    return TRUE;
+  }
+
+  return Sha256TreeGetRoot (Tree, Root);
+}
+
+/**
+  Retrieves the cached digest of the block holding a region offset.
+
+  The digest is the leaf hash of the tree, SHA-256 (0x00 || block), as of
+  the last refresh.
+
+  If Cache does not hold a hash cache, Offset is not within the region,
+  the block is dirty, or Digest is NULL, then return FALSE.
+
+  @param[in]   Cache   The hash cache.
+  @param[in]   Offset  Offset within the tracked region.
+  @param[out]  Digest  Receives the 32-byte block digest.
+
+  @retval TRUE   Digest holds the cached digest.
+  @retval FALSE  An input was invalid, or the block is dirty.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashCacheGetBlockDigest (
+  IN  CONST VOID  *Cache,
+  IN  UINTN       Offset,
+  OUT UINT8       *Digest
+  )
+{
+  CONST HASH_CACHE  *HashCache;
+  UINTN             Block;
+
+  HashCache = (CONST HASH_CACHE *)Cache;
+  if ((HashCache == NULL) || (HashCache->Signature != HASH_CACHE_SIGNATURE) || (Digest == NULL)) {
+    return FALSE;
+  }
+
+  if (Offset >= HashCache->Tree.DataSize) {
+    return FALSE;
+  }
+
+  Block = Offset / HashCache->Tree.LeafSize;
+  if ((HashCache->DirtyMap[Block / HASH_CACHE_WORD_BITS] & ((UINTN)1 << (Block % HASH_CACHE_WORD_BITS))) != 0) {
+    return FALSE;
+  }
+
+  CopyMem (Digest, HashCache->Tree.Nodes[Block], SHA256_DIGEST_SIZE);
+  return TRUE;
+}
@@ -0,0 +1,155 @@
+/** @file
+  Cached block digests of a tracked memory region which does not provide
+  real capabilities.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+#include <CryptHashCache.h>
+
+/**
+  Retrieves the size, in bytes, of a hash cache for a region.
+
+  Return zero to indicate this interface is not supported.
+
+  @param[in]  RegionSize  Size of the tracked region in bytes.
+  @param[in]  BlockSize   Size of a block in bytes.
+
+  @retval  0   This interface is not supported.
+
+**/
+UINTN
+EFIAPI
+Sha256HashCacheGetContextSize (
+  IN UINTN  RegionSize,
+  IN UINTN  BlockSize
+  )
+{
+  ASSERT (FALSE);
+  return 0;
+}
+
+/**
+  Retrieves the smallest block size whose hash cache for a region fits a
+  memory budget.
+
+  Return zero to indicate this interface is not supported.
+
+  @param[in]  RegionSize  Size of the tracked region in bytes.
+  @param[in]  Budget      Largest acceptable cache size in bytes.
+
+  @retval  0   This interface is not supported.
+
+**/
+UINTN
+EFIAPI
+Sha256HashCacheGetBlockSize (
+  IN UINTN  RegionSize,
+  IN UINTN  Budget
+  )
+{
+  ASSERT (FALSE);
+  return 0;
+}
+
+/**
+  Starts tracking a region.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[out]  Cache       Buffer receiving the cache.
+  @param[in]   CacheSize   Size of Cache in bytes.
+  @param[in]   Region      The tracked region.
+  @param[in]   RegionSize  Size of the region in bytes.
+  @param[in]   BlockSize   Size of a block in bytes.
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashCacheInit (
+  OUT VOID        *Cache,
+  IN  UINTN       CacheSize,
+  IN  CONST VOID  *Region,
+  IN  UINTN       RegionSize,
+  IN  UINTN       BlockSize
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+/**
+  Records that a byte range of the tracked region changed.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[in,out]  Cache   The hash cache.
+  @param[in]      Offset  Offset of the first changed byte.
+  @param[in]      Length  Number of changed bytes.
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashCacheMarkDirty (
+  IN OUT VOID   *Cache,
+  IN     UINTN  Offset,
+  IN     UINTN  Length
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+/**
+  Re-hashes the dirty blocks of the tracked region and returns its tree
+  hash.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[in,out]  Cache  The hash cache.
+  @param[out]     Root   Receives the 32-byte root hash.
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashCacheRefresh (
+  IN OUT VOID   *Cache,
+  OUT    UINT8  *Root  OPTIONAL
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+/**
+  Retrieves the cached digest of the block holding a region offset.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[in]   Cache   The hash cache.
+  @param[in]   Offset  Offset within the tracked region.
+  @param[out]  Digest  Receives the 32-byte block digest.
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashCacheGetBlockDigest (
+  IN  CONST VOID  *Cache,
+  IN  UINTN       Offset,
+  OUT UINT8       *Digest
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
@@ -25,6 +25,8 @@ http://creativecommons.org/publicdomain/zero/1.0/
 #define CRYPT_PARALLEL_HASH_H_
 
 #include "InternalCryptLib.h"
+#include <Pi/PiMultiPhase.h>             // MU_CHANGE
+#include <Library/CryptMpDispatchLib.h> // MU_CHANGE
 
 #define KECCAK1600_WIDTH  1600
 
@@ -0,0 +1,364 @@
+/** @file
+  Asynchronous ParallelHash256.
+
+  ParallelHash256HashAll () returns only once every block is hashed, so the
+  calling processor spends the whole measurement waiting on the APs.
+  ParallelHash256HashAllAsync () starts the APs through DispatchToApAsync ()
+  and returns a handle at once. The processors claim blocks with an atomic
+  increment, and the one that completes the last block computes the final
+  cSHAKE256 over the block digests, so the job completes without the caller.
+  The caller polls ParallelHash256AsyncIsComplete (), or in DXE waits for its
+  event, and releases the handle with ParallelHash256AsyncFinish ().
+
+  BaseCryptLib.inf and the PEI and SMM instances build this file, and the
+  other instances use CryptParallelHashAsyncNull.c. BaseCryptLib.inf only
+  starts APs where the DSC maps DxeCryptMpDispatchLib, so in OneCryptoBin
+  the job runs on the calling processor and Event must be NULL. The functions
+  are not in ONE_CRYPTO_PROTOCOL, whose layout CryptoPkg defines, so they
+  are only reachable by linking one of these instances.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "CryptParallelHash.h"
+#include <Library/SynchronizationLib.h>
+#include <CryptParallelHashAsync.h>
+
+#define PARALLELHASH_CUSTOMIZATION  "ParallelHash"
+
+#define PARALLEL_HASH_JOB_SIGNATURE  SIGNATURE_32 ('P', 'H', 'A', 'J')
+
+typedef struct {
+  UINT32              Signature;
+  CONST UINT8         *Input;
+  UINTN               BlockSize;
+  UINTN               BlockNum;
+  UINTN               LastBlockSize;
+  UINTN               BlockResultSize;
+  VOID                *Output;
+  UINTN               OutputByteLen;
+  CONST VOID          *Customization;
+  UINTN               CustomByteLen;
+  //
+  // Combined input (newX) of the final cSHAKE256, stored after the job.
+  //
+  UINT8               *CombinedInput;
+  UINTN               CombinedInputSize;
+  UINT8               *BlockHashResult;
+  //
+  // Number of APs started, set once DispatchToApAsync () returns.
+  //
+  UINTN               Running;
+  volatile UINT32     NextBlock;
+  volatile UINT32     BlocksDone;
+  volatile UINT32     ApsDone;
+  volatile BOOLEAN    BlockFailed;
+  volatile BOOLEAN    Succeeded;
+  volatile BOOLEAN    Completed;
+} PARALLEL_HASH_JOB;
+
+/**
+  Compute the final cSHAKE256 of a job whose blocks are all hashed.
+
+  @param[in,out]  Job  The job.
+**/
+STATIC
+VOID
+ParallelHashJobComplete (
+  IN OUT PARALLEL_HASH_JOB  *Job
+  )
+{
+  BOOLEAN  Succeeded;
+
+  Succeeded = FALSE;
+  if (!Job->BlockFailed) {
+    Succeeded = CShake256HashAll (
+                  Job->CombinedInput,
+                  Job->CombinedInputSize,
+                  Job->OutputByteLen,
+                  PARALLELHASH_CUSTOMIZATION,
+                  AsciiStrLen (PARALLELHASH_CUSTOMIZATION),
+                  Job->Customization,
+                  Job->CustomByteLen,
+                  Job->Output
+                  );
+  }
+
+  Job->Succeeded = Succeeded;
+
+  //
+  // Output and Succeeded must be visible before Completed.
+  //
+  MemoryFence ();
+  Job->Completed = TRUE;
+}
+
+/**
+  Hash blocks of a job until none are left.
+
+  @param[in,out]  Job  The job.
+**/
+STATIC
+VOID
+ParallelHashJobRun (
+  IN OUT PARALLEL_HASH_JOB  *Job
+  )
+{
+  UINTN  Index;
+
+  for ( ; ;) {
+    Index = InterlockedIncrement (&Job->NextBlock) - 1;
+    if (Index >= Job->BlockNum) {
+      return;
+    }
+
+    if (!CShake256HashAll (
+           Job->Input + Index * Job->BlockSize,
+           (Index == (Job->BlockNum - 1)) ? Job->LastBlockSize : Job->BlockSize,
+           Job->BlockResultSize,
+           NULL,
+           0,
+           NULL,
+           0,
+           Job->BlockHashResult + Index * Job->BlockResultSize
+           ))
+    {
+      Job->BlockFailed = TRUE;
+    }
+
+    if (InterlockedIncrement (&Job->BlocksDone) == Job->BlockNum) {
+      ParallelHashJobComplete (Job);
+    }
+  }
+}
+
+/**
+  AP entry point: hash blocks, then report that this AP is done.
+
+  @param[in,out]  Buffer  The job.
+**/
+STATIC
+VOID
+EFIAPI
+ParallelHashJobApExecute (
+  IN OUT VOID  *Buffer
+  )
+{
+  ParallelHashJobRun ((PARALLEL_HASH_JOB *)Buffer);
+  InterlockedIncrement (&((PARALLEL_HASH_JOB *)Buffer)->ApsDone);
+}
+
+/**
+  Starts computing ParallelHash256, as defined in NIST's Special Publication
+  800-185, and returns without waiting for the result.
+
+  The blocks are hashed on the APs. The digest is the same as
+  ParallelHash256HashAll () computes. Input, Output and Customization must
+  stay valid until ParallelHash256AsyncFinish () returns, and Output holds
+  the digest only from then on.
+
+  In DXE, Event is signalled once the digest is complete. PEI and MM have no
+  events, so Event must be NULL there. In PEI the MP services only return
+  once the APs are done, so the job is complete when this function returns.
+  In MM the job must be finished before the caller leaves MM.
+
+  @param[in]   Input          Pointer to the input message (X).
+  @param[in]   InputByteLen   The number(>0) of input bytes provided for the
+                              input data.
+  @param[in]   BlockSize      The size of each block (B).
+  @param[out]  Output         Pointer to the output buffer.
+  @param[in]   OutputByteLen  The desired number of output bytes (L).
+  @param[in]   Customization  Pointer to the customization string (S).
+  @param[in]   CustomByteLen  The length of the customization string in
+                              bytes.
+  @param[in]   Event          Event to signal once the digest is complete,
+                              or NULL.
+  @param[out]  Handle         Receives the handle of the job.
+
+  @retval TRUE   The job was started. It must be released with
+                 ParallelHash256AsyncFinish ().
+  @retval FALSE  An input was invalid, Event is not supported in this phase,
+                 or memory could not be allocated. No job was started.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+ParallelHash256HashAllAsync (
+  IN CONST VOID       *Input,
+  IN       UINTN      InputByteLen,
+  IN       UINTN      BlockSize,
+  OUT      VOID       *Output,
+  IN       UINTN      OutputByteLen,
+  IN CONST VOID       *Customization,
+  IN       UINTN      CustomByteLen,
+  IN       EFI_EVENT  Event  OPTIONAL,
+  OUT      VOID       **Handle
+  )
+{
+  PARALLEL_HASH_JOB  *Job;
+  UINT8              EncBufB[sizeof (UINTN)+1];
+  UINTN              EncSizeB;
+  UINT8              EncBufN[sizeof (UINTN)+1];
+  UINTN              EncSizeN;
+  UINT8              EncBufL[sizeof (UINTN)+1];
+  UINTN              EncSizeL;
+  UINTN              BlockNum;
+  UINTN              CombinedInputSize;
+  UINTN              Offset;
+  UINTN              Running;
+  EFI_STATUS         Status;
+
+  if ((InputByteLen == 0) || (OutputByteLen == 0) || (BlockSize == 0)) {
+    return FALSE;
+  }
+
+  if ((Input == NULL) || (Output == NULL) || (Handle == NULL)) {
+    return FALSE;
+  }
+
+  if ((CustomByteLen != 0) && (Customization == NULL)) {
+    return FALSE;
+  }
+
+  //
+  // The claim counter is 32 bits and each processor overshoots it once.
+  //
+  BlockNum = InputByteLen / BlockSize + ((InputByteLen % BlockSize == 0) ? 0 : 1);
+  if (BlockNum > MAX_UINT32 / 2) {
+    return FALSE;
+  }
+
+  if (OutputByteLen > (MAX_UINTN - sizeof (PARALLEL_HASH_JOB) - 3 * sizeof (EncBufB)) / BlockNum) {
+    return FALSE;
+  }
+
+  EncSizeB = LeftEncode (EncBufB, BlockSize);
+  EncSizeN = RightEncode (EncBufN, BlockNum);
+  EncSizeL = RightEncode (EncBufL, OutputByteLen * CHAR_BIT);
+
+  CombinedInputSize = EncSizeB + EncSizeN + EncSizeL + BlockNum * OutputByteLen;
+  Job               = AllocatePool (sizeof (PARALLEL_HASH_JOB) + CombinedInputSize);
+  if (Job == NULL) {
+    return FALSE;
+  }
+
+  Job->Signature         = PARALLEL_HASH_JOB_SIGNATURE;
+  Job->Input             = (CONST UINT8 *)Input;
+  Job->BlockSize         = BlockSize;
+  Job->BlockNum          = BlockNum;
+  Job->LastBlockSize     = (InputByteLen % BlockSize == 0) ? BlockSize : InputByteLen % BlockSize;
+  Job->BlockResultSize   = OutputByteLen;
+  Job->Output            = Output;
+  Job->OutputByteLen     = OutputByteLen;
+  Job->Customization     = Customization;
+  Job->CustomByteLen     = CustomByteLen;
+  Job->CombinedInput     = (UINT8 *)(Job + 1);
+  Job->CombinedInputSize = CombinedInputSize;
+  Job->BlockHashResult   = Job->CombinedInput + EncSizeB;
+  Job->Running           = 0;
+  Job->NextBlock         = 0;
+  Job->BlocksDone        = 0;
+  Job->ApsDone           = 0;
+  Job->BlockFailed       = FALSE;
+  Job->Succeeded         = FALSE;
+  Job->Completed         = FALSE;
+
+  //
+  // newX = LeftEncode(B) || z[0] || ... || z[n-1] || RightEncode(n) ||
+  // RightEncode(L). Only the block digests z[i] are left to fill.
+  //
+  CopyMem (Job->CombinedInput, EncBufB, EncSizeB);
+  Offset = EncSizeB + BlockNum * OutputByteLen;
+  CopyMem (Job->CombinedInput + Offset, EncBufN, EncSizeN);
+  Offset += EncSizeN;
+  CopyMem (Job->CombinedInput + Offset, EncBufL, EncSizeL);
+
+  Status = DispatchToApAsync (ParallelHashJobApExecute, Job, Event, &Running);
+  if (EFI_ERROR (Status)) {
+    ZeroMem (Job, sizeof (PARALLEL_HASH_JOB) + CombinedInputSize);
+    FreePool (Job);
+    return FALSE;
+  }
+
+  Job->Running = Running;
+  *Handle      = Job;
+  return TRUE;
+}
+
+/**
+  Checks whether an asynchronous ParallelHash256 job is complete.
+
+  This function does not wait and may be called any number of times.
+
+  If Handle is NULL or is not a job handle, then return FALSE.
+
+  @param[in]  Handle  Handle from ParallelHash256HashAllAsync ().
+
+  @retval TRUE   The job is complete. ParallelHash256AsyncFinish () returns
+                 without waiting.
+  @retval FALSE  The job is still running.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+ParallelHash256AsyncIsComplete (
+  IN VOID  *Handle
+  )
+{
+  PARALLEL_HASH_JOB  *Job;
+
+  Job = (PARALLEL_HASH_JOB *)Handle;
+  if ((Job == NULL) || (Job->Signature != PARALLEL_HASH_JOB_SIGNATURE)) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)(Job->Completed && (Job->ApsDone >= Job->Running));
+}
+
+/**
+  Completes an asynchronous ParallelHash256 job and releases its handle.
+
+  The calling processor hashes the blocks no AP has claimed yet, then waits
+  until the APs are done. Handle is invalid once this function returns.
+
+  If Handle is NULL or is not a job handle, then return FALSE.
+
+  @param[in]  Handle  Handle from ParallelHash256HashAllAsync ().
+
+  @retval TRUE   ParallelHash256 digest computation succeeded.
+  @retval FALSE  ParallelHash256 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+ParallelHash256AsyncFinish (
+  IN VOID  *Handle
+  )
+{
+  PARALLEL_HASH_JOB  *Job;
+  BOOLEAN            Succeeded;
+
+  Job = (PARALLEL_HASH_JOB *)Handle;
+  if ((Job == NULL) || (Job->Signature != PARALLEL_HASH_JOB_SIGNATURE)) {
+    return FALSE;
+  }
+
+  ParallelHashJobRun (Job);
+
+  //
+  // The job is freed below, so wait for every AP that may still touch it.
+  //
+  while (!ParallelHash256AsyncIsComplete (Job)) {
+    CpuPause ();
+  }
+
+  Succeeded = Job->Succeeded;
+  ZeroMem (Job, sizeof (PARALLEL_HASH_JOB) + Job->CombinedInputSize);
+  FreePool (Job);
+  return Succeeded;
+}
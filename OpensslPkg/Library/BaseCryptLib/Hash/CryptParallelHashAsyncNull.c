@@ -0,0 +1,90 @@
+/** @file
+  Asynchronous ParallelHash256 which does not provide real capabilities.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+#include <CryptParallelHashAsync.h>
+
+/**
+  Starts computing ParallelHash256, as defined in NIST's Special Publication
+  800-185, and returns without waiting for the result.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[in]   Input          Pointer to the input message (X).
+  @param[in]   InputByteLen   The number(>0) of input bytes provided for the
+                              input data.
+  @param[in]   BlockSize      The size of each block (B).
+  @param[out]  Output         Pointer to the output buffer.
+  @param[in]   OutputByteLen  The desired number of output bytes (L).
+  @param[in]   Customization  Pointer to the customization string (S).
+  @param[in]   CustomByteLen  The length of the customization string in
+                              bytes.
+  @param[in]   Event          Event to signal once the digest is complete,
+                              or NULL.
+  @param[out]  Handle         Receives the handle of the job.
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+ParallelHash256HashAllAsync (
+  IN CONST VOID       *Input,
+  IN       UINTN      InputByteLen,
+  IN       UINTN      BlockSize,
+  OUT      VOID       *Output,
+  IN       UINTN      OutputByteLen,
+  IN CONST VOID       *Customization,
+  IN       UINTN      CustomByteLen,
+  IN       EFI_EVENT  Event  OPTIONAL,
+  OUT      VOID       **Handle
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+/**
+  Checks whether an asynchronous ParallelHash256 job is complete.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[in]  Handle  Handle from ParallelHash256HashAllAsync ().
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+ParallelHash256AsyncIsComplete (
+  IN VOID  *Handle
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+/**
+  Completes an asynchronous ParallelHash256 job and releases its handle.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[in]  Handle  Handle from ParallelHash256HashAllAsync ().
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+ParallelHash256AsyncFinish (
+  IN VOID  *Handle
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
@@ -0,0 +1,729 @@
+/** @file
+  SHA-256 tree hash over fixed-size leaves.
+
+  The input is split into leaves of LeafSize bytes, the last one possibly
+  shorter, and hashed as the Merkle tree of RFC 9162, section 2.1:
+
+    leaf hash  = SHA-256 (0x00 || leaf)
+    node hash  = SHA-256 (0x01 || left || right)
+
+  A level with an odd number of nodes promotes its last node unchanged to
+  the next level, which gives the same root as the largest-power-of-two
+  split of the RFC. The tree hash of empty input is SHA-256 of the empty
+  string. The different leaf and node prefixes keep a leaf from being
+  passed off as an interior node.
+
+  Leaves are independent, so they are hashed through DispatchItemsToAp ():
+  on instances with MP dispatch (PEI, SMM, and DXE drivers whose DSC maps
+  DxeCryptMpDispatchLib) the calling processor and the APs share them. Interior nodes are one compression each and are hashed on
+  the calling processor.
+
+  Sha256TreeHashAll () computes the root with a fixed amount of stack.
+  Sha256TreeInit () instead keeps every node of the tree in a caller
+  supplied context, so that Sha256TreeUpdate () only re-hashes the leaves
+  that changed and their ancestors, and Sha256TreeGetProof () can return the
+  audit path of any leaf for Sha256TreeVerifyProof ().
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "CryptSha256Tree.h"
+#include <CryptHashTree.h>
+
+#define SHA256_TREE_LEAF_PREFIX  0x00
+#define SHA256_TREE_NODE_PREFIX  0x01
+
+//
+// Leaves are handed to the processors in groups of about this many bytes,
+// so that claiming a group costs little next to hashing it.
+//
+#define SHA256_TREE_GROUP_SIZE  SIZE_16KB
+
+//
+// Leaf digests computed at once by Sha256TreeHashAll ().
+//
+#define SHA256_TREE_CHUNK_LEAVES  32
+
+typedef struct {
+  CONST UINT8    *Data;
+  UINTN          DataSize;
+  UINTN          LeafSize;
+  UINTN          FirstLeaf;
+  UINTN          LeafCount;
+  UINTN          GroupLeaves;
+  UINT8          (*Digests)[SHA256_DIGEST_SIZE];
+} SHA256_TREE_LEAVES;
+
+/**
+  Hash a leaf.
+
+  @param[in]   Leaf      Leaf data.
+  @param[in]   LeafSize  Size of the leaf in bytes.
+  @param[out]  Digest    Receives the leaf hash.
+**/
+VOID
+Sha256TreeHashLeaf (
+  IN  CONST UINT8  *Leaf,
+  IN  UINTN        LeafSize,
+  OUT UINT8        *Digest
+  )
+{
+  SHA256_CTX  Context;
+  UINT8       Prefix;
+
+  Prefix = SHA256_TREE_LEAF_PREFIX;
+  SHA256_Init (&Context);
+  SHA256_Update (&Context, &Prefix, sizeof (Prefix));
+  SHA256_Update (&Context, Leaf, LeafSize);
+  SHA256_Final (Digest, &Context);
+}
+
+/**
+  Hash an interior node.
+
+  Digest may be the same buffer as Left or Right.
+
+  @param[in]   Left    Hash of the left child.
+  @param[in]   Right   Hash of the right child.
+  @param[out]  Digest  Receives the node hash.
+**/
+STATIC
+VOID
+Sha256TreeHashNode (
+  IN  CONST UINT8  *Left,
+  IN  CONST UINT8  *Right,
+  OUT UINT8        *Digest
+  )
+{
+  SHA256_CTX  Context;
+  UINT8       Prefix;
+
+  Prefix = SHA256_TREE_NODE_PREFIX;
+  SHA256_Init (&Context);
+  SHA256_Update (&Context, &Prefix, sizeof (Prefix));
+  SHA256_Update (&Context, Left, SHA256_DIGEST_SIZE);
+  SHA256_Update (&Context, Right, SHA256_DIGEST_SIZE);
+  SHA256_Final (Digest, &Context);
+}
+
+/**
+  Hash one group of leaves.
+
+  @param[in]  Context  The SHA256_TREE_LEAVES.
+  @param[in]  Index    Index of the group to hash.
+**/
+STATIC
+VOID
+EFIAPI
+Sha256TreeHashLeafGroup (
+  IN VOID   *Context,
+  IN UINTN  Index
+  )
+{
+  SHA256_TREE_LEAVES  *Leaves;
+  UINTN               Leaf;
+  UINTN               End;
+  UINTN               Offset;
+
+  Leaves = (SHA256_TREE_LEAVES *)Context;
+  Leaf   = Index * Leaves->GroupLeaves;
+  End    = MIN (Leaf + Leaves->GroupLeaves, Leaves->LeafCount);
+
+  for ( ; Leaf < End; Leaf++) {
+    Offset = (Leaves->FirstLeaf + Leaf) * Leaves->LeafSize;
+    Sha256TreeHashLeaf (
+      Leaves->Data + Offset,
+      MIN (Leaves->LeafSize, Leaves->DataSize - Offset),
+      Leaves->Digests[Leaf]
+      );
+  }
+}
+
+/**
+  Hash a run of consecutive leaves, sharing them between the processors.
+
+  @param[in]   Data       Start of the hashed data.
+  @param[in]   DataSize   Size of the hashed data in bytes.
+  @param[in]   LeafSize   Size of a leaf in bytes.
+  @param[in]   FirstLeaf  Index of the first leaf to hash.
+  @param[in]   LeafCount  Number of leaves to hash. They must all start
+                          within Data.
+  @param[out]  Digests    Receives LeafCount leaf hashes.
+**/
+STATIC
+VOID
+Sha256TreeHashLeaves (
+  IN  CONST UINT8  *Data,
+  IN  UINTN        DataSize,
+  IN  UINTN        LeafSize,
+  IN  UINTN        FirstLeaf,
+  IN  UINTN        LeafCount,
+  OUT UINT8        (*Digests)[SHA256_DIGEST_SIZE]
+  )
+{
+  SHA256_TREE_LEAVES  Leaves;
+
+  Leaves.Data        = Data;
+  Leaves.DataSize    = DataSize;
+  Leaves.LeafSize    = LeafSize;
+  Leaves.FirstLeaf   = FirstLeaf;
+  Leaves.LeafCount   = LeafCount;
+  Leaves.GroupLeaves = MAX (1, SHA256_TREE_GROUP_SIZE / LeafSize);
+  Leaves.Digests     = Digests;
+
+  DispatchItemsToAp (
+    Sha256TreeHashLeafGroup,
+    &Leaves,
+    (LeafCount + Leaves.GroupLeaves - 1) / Leaves.GroupLeaves
+    );
+}
+
+/**
+  Returns the number of leaves of the input.
+
+  @param[in]  DataSize  Size of the input in bytes.
+  @param[in]  LeafSize  Size of a leaf in bytes, not 0.
+
+  @return  The number of leaves.
+**/
+STATIC
+UINTN
+Sha256TreeLeafCount (
+  IN UINTN  DataSize,
+  IN UINTN  LeafSize
+  )
+{
+  return DataSize / LeafSize + ((DataSize % LeafSize != 0) ? 1 : 0);
+}
+
+/**
+  Computes the layout of the stored tree.
+
+  @param[in]   LeafCount   Number of leaves.
+  @param[out]  NodeCount   Receives the node count of each level. May be
+                           NULL.
+  @param[out]  LevelStart  Receives the index of the first node of each
+                           level. May be NULL.
+  @param[out]  LevelCount  Receives the number of levels. May be NULL.
+
+  @return  The total number of nodes, or 0 if it overflows.
+**/
+STATIC
+UINTN
+Sha256TreeLayout (
+  IN  UINTN  LeafCount,
+  OUT UINTN  *NodeCount   OPTIONAL,
+  OUT UINTN  *LevelStart  OPTIONAL,
+  OUT UINTN  *LevelCount  OPTIONAL
+  )
+{
+  UINTN  Level;
+  UINTN  Count;
+  UINTN  Total;
+
+  Level = 0;
+  Count = LeafCount;
+  Total = 0;
+  for ( ; ;) {
+    if (NodeCount != NULL) {
+      NodeCount[Level]  = Count;
+      LevelStart[Level] = Total;
+    }
+
+    if (Total > MAX_UINTN - Count) {
+      return 0;
+    }
+
+    Total += Count;
+    Level++;
+    if (Count <= 1) {
+      break;
+    }
+
+    Count = Count / 2 + (Count & 1);
+  }
+
+  if (LevelCount != NULL) {
+    *LevelCount = Level;
+  }
+
+  return Total;
+}
+
+/**
+  Recomputes a run of nodes of a stored tree from their children.
+
+  @param[in,out]  Tree   The tree.
+  @param[in]      Level  Level of the nodes, at least 1.
+  @param[in]      First  Index of the first node to recompute.
+  @param[in]      Last   Index of the last node to recompute.
+**/
+VOID
+Sha256TreeRehashNodes (
+  IN OUT SHA256_TREE  *Tree,
+  IN     UINTN        Level,
+  IN     UINTN        First,
+  IN     UINTN        Last
+  )
+{
+  UINTN  Node;
+  UINT8  (*Children)[SHA256_DIGEST_SIZE];
+  UINT8  (*Nodes)[SHA256_DIGEST_SIZE];
+
+  Children = &Tree->Nodes[Tree->LevelStart[Level - 1]];
+  Nodes    = &Tree->Nodes[Tree->LevelStart[Level]];
+  for (Node = First; Node <= Last; Node++) {
+    if (2 * Node + 1 < Tree->NodeCount[Level - 1]) {
+      Sha256TreeHashNode (Children[2 * Node], Children[2 * Node + 1], Nodes[Node]);
+    } else {
+      CopyMem (Nodes[Node], Children[2 * Node], SHA256_DIGEST_SIZE);
+    }
+  }
+}
+
+/**
+  Recomputes the ancestors of a run of leaves, up to the root.
+
+  @param[in,out]  Tree   The tree.
+  @param[in]      First  Index of the first changed leaf.
+  @param[in]      Last   Index of the last changed leaf.
+**/
+STATIC
+VOID
+Sha256TreeRehashAncestors (
+  IN OUT SHA256_TREE  *Tree,
+  IN     UINTN        First,
+  IN     UINTN        Last
+  )
+{
+  UINTN  Level;
+
+  for (Level = 1; Level < Tree->LevelCount; Level++) {
+    First /= 2;
+    Last  /= 2;
+    Sha256TreeRehashNodes (Tree, Level, First, Last);
+  }
+}
+
+/**
+  Computes the SHA-256 tree hash of a buffer.
+
+  The leaves are hashed a chunk at a time, shared between the calling
+  processor and the APs where the library instance has MP services, and
+  folded into at most one pending subtree root per level, so no memory is
+  allocated.
+
+  If Root is NULL, Data is NULL while DataSize is not 0, or LeafSize is 0,
+  then return FALSE.
+
+  @param[in]   Data      Data to hash.
+  @param[in]   DataSize  Size of Data in bytes.
+  @param[in]   LeafSize  Size of a leaf in bytes. The last leaf may be
+                         shorter.
+  @param[out]  Root      Receives the 32-byte root hash.
+
+  @retval TRUE   Root holds the tree hash.
+  @retval FALSE  An input was invalid.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256TreeHashAll (
+  IN  CONST VOID  *Data,
+  IN  UINTN       DataSize,
+  IN  UINTN       LeafSize,
+  OUT UINT8       *Root
+  )
+{
+  UINT8  Leaves[SHA256_TREE_CHUNK_LEAVES][SHA256_DIGEST_SIZE];
+  UINT8  Pending[SHA256_TREE_MAX_LEVELS - 1][SHA256_DIGEST_SIZE];
+  UINTN  LeafCount;
+  UINTN  Leaf;
+  UINTN  Chunk;
+  UINTN  Index;
+  UINTN  Merged;
+  UINTN  Level;
+  UINTN  Top;
+
+  if ((Root == NULL) || (LeafSize == 0) || ((Data == NULL) && (DataSize != 0))) {
+    return FALSE;
+  }
+
+  if (DataSize == 0) {
+    return Sha256HashAll (NULL, 0, Root);
+  }
+
+  //
+  // Pending[Level] holds the root of a complete subtree of 2^Level leaves
+  // when bit Level of the number of leaves folded so far is set.
+  //
+  LeafCount = Sha256TreeLeafCount (DataSize, LeafSize);
+  for (Leaf = 0; Leaf < LeafCount; Leaf += Chunk) {
+    Chunk = MIN (LeafCount - Leaf, SHA256_TREE_CHUNK_LEAVES);
+    Sha256TreeHashLeaves (Data, DataSize, LeafSize, Leaf, Chunk, Leaves);
+
+    for (Index = 0; Index < Chunk; Index++) {
+      //
+      // Merge the new leaf with the pending subtrees of equal size, as in
+      // a binary increment of the leaf count.
+      //
+      Merged = Leaf + Index;
+      for (Level = 0; (Merged & 1) != 0; Level++) {
+        Sha256TreeHashNode (Pending[Level], Leaves[Index], Leaves[Index]);
+        Merged >>= 1;
+      }
+
+      CopyMem (Pending[Level], Leaves[Index], SHA256_DIGEST_SIZE);
+    }
+  }
+
+  //
+  // Fold the pending subtrees from the smallest one upwards. The smallest
+  // is the rightmost, so it is always the right child.
+  //
+  for (Top = 0; (LeafCount & ((UINTN)1 << Top)) == 0; Top++) {
+  }
+
+  CopyMem (Root, Pending[Top], SHA256_DIGEST_SIZE);
+  for (Level = Top + 1; Level < ARRAY_SIZE (Pending); Level++) {
+    if ((LeafCount & ((UINTN)1 << Level)) != 0) {
+      Sha256TreeHashNode (Pending[Level], Root, Root);
+    }
+  }
+
+  ZeroMem (Leaves, sizeof (Leaves));
+  ZeroMem (Pending, sizeof (Pending));
+  return TRUE;
+}
+
+/**
+  Retrieves the size, in bytes, of the context required to keep the SHA-256
+  tree of a buffer.
+
+  @param[in]  DataSize  Size of the hashed buffer in bytes.
+  @param[in]  LeafSize  Size of a leaf in bytes.
+
+  @return  The size of the context, or 0 if LeafSize is 0 or the size
+           overflows.
+
+**/
+UINTN
+EFIAPI
+Sha256TreeGetContextSize (
+  IN UINTN  DataSize,
+  IN UINTN  LeafSize
+  )
+{
+  UINTN  Nodes;
+
+  if (LeafSize == 0) {
+    return 0;
+  }
+
+  Nodes = Sha256TreeLayout (Sha256TreeLeafCount (DataSize, LeafSize), NULL, NULL, NULL);
+  if ((Nodes == 0) && (DataSize != 0)) {
+    return 0;
+  }
+
+  if (Nodes > (MAX_UINTN - OFFSET_OF (SHA256_TREE, Nodes)) / SHA256_DIGEST_SIZE) {
+    return 0;
+  }
+
+  return OFFSET_OF (SHA256_TREE, Nodes) + MAX (Nodes, 1) * SHA256_DIGEST_SIZE;
+}
+
+/**
+  Hashes a buffer into a SHA-256 tree kept in TreeContext.
+
+  The tree hash is the same as Sha256TreeHashAll () computes. The leaves are
+  shared between the calling processor and the APs where the library
+  instance has MP services.
+
+  If TreeContext is NULL, ContextSize is smaller than
+  Sha256TreeGetContextSize (DataSize, LeafSize), LeafSize is 0, or Data is
+  NULL while DataSize is not 0, then return FALSE.
+
+  @param[out]  TreeContext  Context receiving the tree.
+  @param[in]   ContextSize  Size of TreeContext in bytes.
+  @param[in]   Data         Data to hash.
+  @param[in]   DataSize     Size of Data in bytes.
+  @param[in]   LeafSize     Size of a leaf in bytes. The last leaf may be
+                            shorter.
+
+  @retval TRUE   The tree was built.
+  @retval FALSE  An input was invalid.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256TreeInit (
+  OUT VOID        *TreeContext,
+  IN  UINTN       ContextSize,
+  IN  CONST VOID  *Data,
+  IN  UINTN       DataSize,
+  IN  UINTN       LeafSize
+  )
+{
+  SHA256_TREE  *Tree;
+  UINTN        RequiredSize;
+  UINTN        LeafCount;
+
+  if ((TreeContext == NULL) || (LeafSize == 0) || ((Data == NULL) && (DataSize != 0))) {
+    return FALSE;
+  }
+
+  RequiredSize = Sha256TreeGetContextSize (DataSize, LeafSize);
+  if ((RequiredSize == 0) || (ContextSize < RequiredSize)) {
+    return FALSE;
+  }
+
+  Tree            = (SHA256_TREE *)TreeContext;
+  Tree->Signature = SHA256_TREE_SIGNATURE;
+  Tree->DataSize  = DataSize;
+  Tree->LeafSize  = LeafSize;
+  LeafCount       = Sha256TreeLeafCount (DataSize, LeafSize);
+  Sha256TreeLayout (LeafCount, Tree->NodeCount, Tree->LevelStart, &Tree->LevelCount);
+
+  if (LeafCount == 0) {
+    return TRUE;
+  }
+
+  Sha256TreeHashLeaves (Data, DataSize, LeafSize, 0, LeafCount, Tree->Nodes);
+  Sha256TreeRehashAncestors (Tree, 0, LeafCount - 1);
+  return TRUE;
+}
+
+/**
+  Re-hashes the leaves of a SHA-256 tree that cover a changed byte range,
+  and their ancestors.
+
+  Data is the whole hashed buffer, of the size the tree was built for. Only
+  the leaves overlapping [Offset, Offset + Length) are read.
+
+  If TreeContext does not hold a tree, Data is NULL, or the range is not
+  within the buffer, then return FALSE.
+
+  @param[in,out]  TreeContext  Context holding the tree.
+  @param[in]      Data         The hashed buffer, with its new contents.
+  @param[in]      Offset       Offset of the first changed byte.
+  @param[in]      Length       Number of changed bytes.
+
+  @retval TRUE   The tree matches the new contents.
+  @retval FALSE  An input was invalid.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256TreeUpdate (
+  IN OUT VOID        *TreeContext,
+  IN     CONST VOID  *Data,
+  IN     UINTN       Offset,
+  IN     UINTN       Length
+  )
+{
+  SHA256_TREE  *Tree;
+  UINTN        First;
+  UINTN        Last;
+
+  Tree = (SHA256_TREE *)TreeContext;
+  if ((Tree == NULL) || (Tree->Signature != SHA256_TREE_SIGNATURE) || (Data == NULL)) {
+    return FALSE;
+  }
+
+  if ((Offset > Tree->DataSize) || (Length > Tree->DataSize - Offset)) {
+    return FALSE;
+  }
+
+  if (Length == 0) {
+    return TRUE;
+  }
+
+  First = Offset / Tree->LeafSize;
+  Last  = (Offset + Length - 1) / Tree->LeafSize;
+  Sha256TreeHashLeaves (Data, Tree->DataSize, Tree->LeafSize, First, Last - First + 1, &Tree->Nodes[First]);
+  Sha256TreeRehashAncestors (Tree, First, Last);
+  return TRUE;
+}
+
+/**
+  Retrieves the root hash of a SHA-256 tree.
+
+  If TreeContext does not hold a tree or Root is NULL, then return FALSE.
+
+  @param[in]   TreeContext  Context holding the tree.
+  @param[out]  Root         Receives the 32-byte root hash.
+
+  @retval TRUE   Root holds the tree hash.
+  @retval FALSE  An input was invalid.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256TreeGetRoot (
+  IN  CONST VOID  *TreeContext,
+  OUT UINT8       *Root
+  )
+{
+  CONST SHA256_TREE  *Tree;
+
+  Tree = (CONST SHA256_TREE *)TreeContext;
+  if ((Tree == NULL) || (Tree->Signature != SHA256_TREE_SIGNATURE) || (Root == NULL)) {
+    return FALSE;
+  }
+
+  if (Tree->NodeCount[0] == 0) {
+    return Sha256HashAll (NULL, 0, Root);
+  }
+
+  CopyMem (Root, Tree->Nodes[Tree->LevelStart[Tree->LevelCount - 1]], SHA256_DIGEST_SIZE);
+  return TRUE;
+}
+
+/**
+  Retrieves the audit path of a leaf of a SHA-256 tree.
+
+  The proof is the concatenation of the 32-byte sibling hashes from the leaf
+  level upwards, skipping the levels where the node on the path has no
+  sibling. Sha256TreeVerifyProof () checks it against the root.
+
+  If TreeContext does not hold a tree, LeafIndex is not a leaf of the tree,
+  or ProofSize is NULL, then return FALSE.
+
+  If *ProofSize is too small, it receives the required size and FALSE is
+  returned.
+
+  @param[in]      TreeContext  Context holding the tree.
+  @param[in]      LeafIndex    Index of the leaf.
+  @param[out]     Proof        Buffer receiving the proof. May be NULL to
+                               query the size.
+  @param[in,out]  ProofSize    On input, the size of Proof in bytes. On
+                               output, the size of the proof.
+
+  @retval TRUE   Proof holds the audit path.
+  @retval FALSE  An input was invalid, or Proof is too small.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256TreeGetProof (
+  IN     CONST VOID  *TreeContext,
+  IN     UINTN       LeafIndex,
+  OUT    UINT8       *Proof      OPTIONAL,
+  IN OUT UINTN       *ProofSize
+  )
+{
+  CONST SHA256_TREE  *Tree;
+  UINTN              Level;
+  UINTN              Index;
+  UINTN              Required;
+
+  Tree = (CONST SHA256_TREE *)TreeContext;
+  if ((Tree == NULL) || (Tree->Signature != SHA256_TREE_SIGNATURE) || (ProofSize == NULL)) {
+    return FALSE;
+  }
+
+  if (LeafIndex >= Tree->NodeCount[0]) {
+    return FALSE;
+  }
+
+  Required = 0;
+  Index    = LeafIndex;
+  for (Level = 0; Level + 1 < Tree->LevelCount; Level++) {
+    if ((Index ^ 1) < Tree->NodeCount[Level]) {
+      Required += SHA256_DIGEST_SIZE;
+    }
+
+    Index /= 2;
+  }
+
+  if ((Proof == NULL) || (*ProofSize < Required)) {
+    *ProofSize = Required;
+    return FALSE;
+  }
+
+  *ProofSize = Required;
+  Index      = LeafIndex;
+  for (Level = 0; Level + 1 < Tree->LevelCount; Level++) {
+    if ((Index ^ 1) < Tree->NodeCount[Level]) {
+      CopyMem (Proof, Tree->Nodes[Tree->LevelStart[Level] + (Index ^ 1)], SHA256_DIGEST_SIZE);
+      Proof += SHA256_DIGEST_SIZE;
+    }
+
+    Index /= 2;
+  }
+
+  return TRUE;
+}
+
+/**
+  Verifies a leaf of a SHA-256 tree against the root hash, using the audit
+  path returned by Sha256TreeGetProof ().
+
+  The verifier needs neither the other leaves nor the tree context.
+
+  If Leaf is NULL while LeafDataSize is not 0, Proof is NULL while ProofSize
+  is not 0, or Root is NULL, then return FALSE.
+
+  @param[in]  Leaf          Data of the leaf.
+  @param[in]  LeafDataSize  Size of the leaf in bytes. Only the last leaf
+                            may be shorter than the leaf size of the tree.
+  @param[in]  LeafIndex     Index of the leaf.
+  @param[in]  LeafCount     Number of leaves of the tree.
+  @param[in]  Proof         The audit path.
+  @param[in]  ProofSize     Size of Proof in bytes.
+  @param[in]  Root          The 32-byte root hash.
+
+  @retval TRUE   The leaf is part of the tree with this root.
+  @retval FALSE  The proof does not match, or an input was invalid.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256TreeVerifyProof (
+  IN CONST VOID   *Leaf,
+  IN UINTN        LeafDataSize,
+  IN UINTN        LeafIndex,
+  IN UINTN        LeafCount,
+  IN CONST UINT8  *Proof,
+  IN UINTN        ProofSize,
+  IN CONST UINT8  *Root
+  )
+{
+  UINT8  Digest[SHA256_DIGEST_SIZE];
+  UINTN  Index;
+  UINTN  Count;
+
+  if (((Leaf == NULL) && (LeafDataSize != 0)) || ((Proof == NULL) && (ProofSize != 0)) || (Root == NULL)) {
+    return FALSE;
+  }
+
+  if (LeafIndex >= LeafCount) {
+    return FALSE;
+  }
+
+  Sha256TreeHashLeaf (Leaf, LeafDataSize, Digest);
+
+  Index = LeafIndex;
+  for (Count = LeafCount; Count > 1; Count = Count / 2 + (Count & 1)) {
+    if ((Index ^ 1) < Count) {
+      if (ProofSize < SHA256_DIGEST_SIZE) {
+        return FALSE;
+      }
+
+      if ((Index & 1) != 0) {
+        Sha256TreeHashNode (Proof, Digest, Digest);
+      } else {
+        Sha256TreeHashNode (Digest, Proof, Digest);
+      }
+
+      Proof     += SHA256_DIGEST_SIZE;
+      ProofSize -= SHA256_DIGEST_SIZE;
+    }
+
+    Index /= 2;
+  }
+
+  return (BOOLEAN)((ProofSize == 0) && (CompareMem (Digest, Root, SHA256_DIGEST_SIZE) == 0));
+}
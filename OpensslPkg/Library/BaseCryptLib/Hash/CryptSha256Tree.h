@@ -0,0 +1,73 @@
+/** @file
+  Internal layout of the stored SHA-256 tree, shared by the tree hash and
+  the hash cache built on it.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef CRYPT_SHA256_TREE_H_
+#define CRYPT_SHA256_TREE_H_
+
+#include "InternalCryptLib.h"
+#include <openssl/sha.h>
+
+//
+// Levels of a tree over at most MAX_UINTN leaves, including the root.
+//
+#define SHA256_TREE_MAX_LEVELS  (sizeof (UINTN) * 8 + 1)
+
+#define SHA256_TREE_SIGNATURE  SIGNATURE_32 ('S', '2', 'T', 'R')
+
+typedef struct {
+  UINT32    Signature;
+  UINTN     DataSize;
+  UINTN     LeafSize;
+  UINTN     LevelCount;
+  //
+  // Number of nodes of each level, level 0 being the leaves and level
+  // LevelCount - 1 the root.
+  //
+  UINTN     NodeCount[SHA256_TREE_MAX_LEVELS];
+  //
+  // Index in Nodes of the first node of each level.
+  //
+  UINTN     LevelStart[SHA256_TREE_MAX_LEVELS];
+  //
+  // The nodes of all levels, variable size.
+  //
+  UINT8     Nodes[1][SHA256_DIGEST_SIZE];
+} SHA256_TREE;
+
+/**
+  Hash a leaf.
+
+  @param[in]   Leaf      Leaf data.
+  @param[in]   LeafSize  Size of the leaf in bytes.
+  @param[out]  Digest    Receives the leaf hash.
+**/
+VOID
+Sha256TreeHashLeaf (
+  IN  CONST UINT8  *Leaf,
+  IN  UINTN        LeafSize,
+  OUT UINT8        *Digest
+  );
+
+/**
+  Recomputes a run of nodes of a stored tree from their children.
+
+  @param[in,out]  Tree   The tree.
+  @param[in]      Level  Level of the nodes, at least 1.
+  @param[in]      First  Index of the first node to recompute.
+  @param[in]      Last   Index of the last node to recompute.
+**/
+VOID
+Sha256TreeRehashNodes (
+  IN OUT SHA256_TREE  *Tree,
+  IN     UINTN        Level,
+  IN     UINTN        First,
+  IN     UINTN        Last
+  );
+
+#endif
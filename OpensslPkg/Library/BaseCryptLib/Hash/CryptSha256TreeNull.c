@@ -0,0 +1,193 @@
+/** @file
+  SHA-256 tree hash which does not provide real capabilities.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+#include <CryptHashTree.h>
+
+/**
+  Computes the SHA-256 tree hash of a buffer.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[in]   Data      Data to hash.
+  @param[in]   DataSize  Size of Data in bytes.
+  @param[in]   LeafSize  Size of a leaf in bytes.
+  @param[out]  Root      Receives the 32-byte root hash.
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256TreeHashAll (
+  IN  CONST VOID  *Data,
+  IN  UINTN       DataSize,
+  IN  UINTN       LeafSize,
+  OUT UINT8       *Root
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+/**
+  Retrieves the size, in bytes, of the context required to keep the SHA-256
+  tree of a buffer.
+
+  Return zero to indicate this interface is not supported.
+
+  @param[in]  DataSize  Size of the hashed buffer in bytes.
+  @param[in]  LeafSize  Size of a leaf in bytes.
+
+  @retval  0   This interface is not supported.
+
+**/
+UINTN
+EFIAPI
+Sha256TreeGetContextSize (
+  IN UINTN  DataSize,
+  IN UINTN  LeafSize
+  )
+{
+  ASSERT (FALSE);
+  return 0;
+}
+
+/**
+  Hashes a buffer into a SHA-256 tree kept in TreeContext.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[out]  TreeContext  Context receiving the tree.
+  @param[in]   ContextSize  Size of TreeContext in bytes.
+  @param[in]   Data         Data to hash.
+  @param[in]   DataSize     Size of Data in bytes.
+  @param[in]   LeafSize     Size of a leaf in bytes.
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256TreeInit (
+  OUT VOID        *TreeContext,
+  IN  UINTN       ContextSize,
+  IN  CONST VOID  *Data,
+  IN  UINTN       DataSize,
+  IN  UINTN       LeafSize
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+/**
+  Re-hashes the leaves of a SHA-256 tree that cover a changed byte range.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[in,out]  TreeContext  Context holding the tree.
+  @param[in]      Data         The hashed buffer, with its new contents.
+  @param[in]      Offset       Offset of the first changed byte.
+  @param[in]      Length       Number of changed bytes.
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256TreeUpdate (
+  IN OUT VOID        *TreeContext,
+  IN     CONST VOID  *Data,
+  IN     UINTN       Offset,
+  IN     UINTN       Length
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+/**
+  Retrieves the root hash of a SHA-256 tree.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[in]   TreeContext  Context holding the tree.
+  @param[out]  Root         Receives the 32-byte root hash.
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256TreeGetRoot (
+  IN  CONST VOID  *TreeContext,
+  OUT UINT8       *Root
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+/**
+  Retrieves the audit path of a leaf of a SHA-256 tree.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[in]      TreeContext  Context holding the tree.
+  @param[in]      LeafIndex    Index of the leaf.
+  @param[out]     Proof        Buffer receiving the proof.
+  @param[in,out]  ProofSize    Size of Proof in bytes.
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256TreeGetProof (
+  IN     CONST VOID  *TreeContext,
+  IN     UINTN       LeafIndex,
+  OUT    UINT8       *Proof      OPTIONAL,
+  IN OUT UINTN       *ProofSize
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+/**
+  Verifies a leaf of a SHA-256 tree against the root hash.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[in]  Leaf          Data of the leaf.
+  @param[in]  LeafDataSize  Size of the leaf in bytes.
+  @param[in]  LeafIndex     Index of the leaf.
+  @param[in]  LeafCount     Number of leaves of the tree.
+  @param[in]  Proof         The audit path.
+  @param[in]  ProofSize     Size of Proof in bytes.
+  @param[in]  Root          The 32-byte root hash.
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256TreeVerifyProof (
+  IN CONST VOID   *Leaf,
+  IN UINTN        LeafDataSize,
+  IN UINTN        LeafIndex,
+  IN UINTN        LeafCount,
+  IN CONST UINT8  *Proof,
+  IN UINTN        ProofSize,
+  IN CONST UINT8  *Root
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
@@ -8,22 +8,17 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "InternalCryptLib.h"
 // MU_CHANGE [BEGIN]
-#include <openssl/evp.h>
-#include <openssl/params.h>
-#include <openssl/core_names.h>
-
 //
-// Wrapper structure to hold EVP_MAC_CTX so that HmacMdDuplicate can
-// replace the inner context while preserving the outer pointer.
+// HMAC runs on the fixed-context digest layer instead of EVP_MAC, so a
+// context is one flat allocation and the one-shot functions do not
+// allocate at all.
 //
-typedef struct {
-  EVP_MAC_CTX    *Ctx;
-} HMAC_CTX_WRAPPER;
+#include "Hash/CryptDigest.h"
 
 /**
-  Allocates and initializes one EVP_MAC_CTX context for subsequent HMAC-MD use.  // MU_CHANGE
+  Allocates one CRYPT_HMAC_CTX context for subsequent HMAC-MD use.  // MU_CHANGE
 
-  @return  Pointer to the HMAC_CTX_WRAPPER that has been initialized.
+  @return  Pointer to the CRYPT_HMAC_CTX that has been allocated.
            If the allocation fails, HmacMdNew() returns NULL.
 
 **/
@@ -35,43 +30,17 @@ HmacMdNew (
   )
 {
   // MU_CHANGE [BEGIN]
-  EVP_MAC           *Mac;
-  HMAC_CTX_WRAPPER  *Wrapper;
-
   //
-  // Fetch the HMAC algorithm from the default provider.
+  // The context is not keyed until HmacMdSetKey () (Nid is NID_undef).
   //
-  Mac = EVP_MAC_fetch (NULL, "HMAC", NULL);
-  if (Mac == NULL) {
-    return NULL;
-  }
-
-  Wrapper = AllocateZeroPool (sizeof (HMAC_CTX_WRAPPER));
-  if (Wrapper == NULL) {
-    EVP_MAC_free (Mac);
-    return NULL;
-  }
-
-  //
-  // Allocate EVP_MAC_CTX.  The context holds its own reference to the
-  // EVP_MAC object, so we can free it immediately after ctx creation.
-  //
-  Wrapper->Ctx = EVP_MAC_CTX_new (Mac);
-  EVP_MAC_free (Mac);
-
-  if (Wrapper->Ctx == NULL) {
-    FreePool (Wrapper);
-    return NULL;
-  }
-
-  return (VOID *)Wrapper;
+  return AllocateZeroPool (sizeof (CRYPT_HMAC_CTX));
   // MU_CHANGE [END]
 }
 
 /**
-  Release the specified HMAC_CTX_WRAPPER context.  // MU_CHANGE
+  Release the specified CRYPT_HMAC_CTX context.  // MU_CHANGE
 
-  @param[in]  HmacMdCtx  Pointer to the HMAC_CTX_WRAPPER context to be released.  // MU_CHANGE
+  @param[in]  HmacMdCtx  Pointer to the CRYPT_HMAC_CTX context to be released.  // MU_CHANGE
 
 **/
 STATIC
@@ -81,12 +50,9 @@ HmacMdFree (
   )
 {
   // MU_CHANGE [BEGIN]
-  HMAC_CTX_WRAPPER  *Wrapper;
-
   if (HmacMdCtx != NULL) {
-    Wrapper = (HMAC_CTX_WRAPPER *)HmacMdCtx;
-    EVP_MAC_CTX_free (Wrapper->Ctx);
-    FreePool (Wrapper);
+    ZeroMem (HmacMdCtx, sizeof (CRYPT_HMAC_CTX));
+    FreePool (HmacMdCtx);
   }
 
   // MU_CHANGE [END]
@@ -98,7 +64,7 @@ HmacMdFree (
 
   If HmacMdContext is NULL, then return FALSE.
 
-  @param[in]   MdName             Digest algorithm name (e.g. "SHA256").  // MU_CHANGE
+  @param[in]   MdNid              Digest algorithm NID (e.g. NID_sha256).  // MU_CHANGE
   @param[out]  HmacMdContext      Pointer to HMAC-MD context.
   @param[in]   Key                Pointer to the user-supplied key.
   @param[in]   KeySize            Key size in bytes.
@@ -111,7 +77,7 @@ STATIC
 BOOLEAN
 HmacMdSetKey (
   // MU_CHANGE [BEGIN]
-  IN      CONST CHAR8  *MdName,
+  IN      INT32        MdNid,
   IN OUT  VOID         *HmacMdContext,
   IN      CONST UINT8  *Key,
   IN      UINTN        KeySize
@@ -119,32 +85,15 @@ HmacMdSetKey (
   )
 {
   // MU_CHANGE [BEGIN]
-  HMAC_CTX_WRAPPER  *Wrapper;
-  OSSL_PARAM        Params[2];
-
   //
   // Check input parameters.
   //
-  if ((HmacMdContext == NULL) || (KeySize > INT_MAX) || (Key == NULL) || (MdName == NULL)) {
-    return FALSE;
-  }
-
-  Wrapper = (HMAC_CTX_WRAPPER *)HmacMdContext;
-
-  Params[0] = OSSL_PARAM_construct_utf8_string (
-                OSSL_MAC_PARAM_DIGEST,
-                (char *)MdName,
-                0
-                );
-  Params[1] = OSSL_PARAM_construct_end ();
-
-  if (EVP_MAC_init (Wrapper->Ctx, Key, (size_t)KeySize, Params) != 1) {
+  if ((HmacMdContext == NULL) || (KeySize > INT_MAX) || (Key == NULL)) {
     return FALSE;
   }
 
+  return CryptHmacInit ((CRYPT_HMAC_CTX *)HmacMdContext, MdNid, Key, KeySize);
   // MU_CHANGE [END]
-
-  return TRUE;
 }
 
 /**
@@ -167,11 +116,6 @@ HmacMdDuplicate (
   OUT  VOID        *NewHmacMdContext
   )
 {
-  // MU_CHANGE [BEGIN]
-  HMAC_CTX_WRAPPER  *SrcWrapper;
-  HMAC_CTX_WRAPPER  *DstWrapper;
-  EVP_MAC_CTX       *NewCtx;
-
   //
   // Check input parameters.
   //
@@ -179,21 +123,7 @@ HmacMdDuplicate (
     return FALSE;
   }
 
-  SrcWrapper = (HMAC_CTX_WRAPPER *)HmacMdContext;
-  DstWrapper = (HMAC_CTX_WRAPPER *)NewHmacMdContext;
-
-  NewCtx = EVP_MAC_CTX_dup (SrcWrapper->Ctx);
-  if (NewCtx == NULL) {
-    return FALSE;
-  }
-
-  //
-  // Replace the destination's inner context with the duplicated one.
-  //
-  EVP_MAC_CTX_free (DstWrapper->Ctx);
-  DstWrapper->Ctx = NewCtx;
-
-  // MU_CHANGE [END]
+  CopyMem (NewHmacMdContext, HmacMdContext, sizeof (CRYPT_HMAC_CTX));  // MU_CHANGE
   return TRUE;
 }
 
@@ -224,8 +154,6 @@ HmacMdUpdate (
   )
 {
   // MU_CHANGE [BEGIN]
-  HMAC_CTX_WRAPPER  *Wrapper;
-
   //
   // Check input parameters.
   //
@@ -233,25 +161,8 @@ HmacMdUpdate (
     return FALSE;
   }
 
-  //
-  // Check invalid parameters, in case that only DataLength was checked in OpenSSL
-  //
-  if ((Data == NULL) && (DataSize != 0)) {
-    return FALSE;
-  }
-
-  Wrapper = (HMAC_CTX_WRAPPER *)HmacMdContext;
-
-  //
-  // OpenSSL HMAC-MD digest update
-  //
-  if (EVP_MAC_update (Wrapper->Ctx, Data, DataSize) != 1) {
-    return FALSE;
-  }
-
+  return CryptHmacUpdate ((CRYPT_HMAC_CTX *)HmacMdContext, Data, DataSize);
   // MU_CHANGE [END]
-
-  return TRUE;
 }
 
 /**
@@ -282,10 +193,6 @@ HmacMdFinal (
   )
 {
   // MU_CHANGE [BEGIN]
-  HMAC_CTX_WRAPPER  *Wrapper;
-  size_t            MacSize;
-  size_t            Length;
-
   //
   // Check input parameters.
   //
@@ -293,19 +200,8 @@ HmacMdFinal (
     return FALSE;
   }
 
-  Wrapper = (HMAC_CTX_WRAPPER *)HmacMdContext;
-
-  //
-  // OpenSSL HMAC-MD digest finalization
-  //
-  MacSize = EVP_MAC_CTX_get_mac_size (Wrapper->Ctx);
-  if (EVP_MAC_final (Wrapper->Ctx, HmacValue, &Length, MacSize) != 1) {
-    return FALSE;
-  }
-
+  return CryptHmacFinal ((CRYPT_HMAC_CTX *)HmacMdContext, HmacValue);
   // MU_CHANGE [END]
-
-  return TRUE;
 }
 
 /**
@@ -317,7 +213,7 @@ HmacMdFinal (
   If this interface is not supported, then return FALSE.
   If HmacValue is NULL, then return FALSE.
 
-  @param[in]   MdName      Digest algorithm name (e.g. "SHA256").  // MU_CHANGE
+  @param[in]   MdNid       Digest algorithm NID (e.g. NID_sha256).  // MU_CHANGE
   @param[in]   Data        Pointer to the buffer containing the data to be digested.
   @param[in]   DataSize    Size of Data buffer in bytes.
   @param[in]   Key         Pointer to the user-supplied key.
@@ -334,7 +230,7 @@ STATIC
 BOOLEAN
 HmacMdAll (
   // MU_CHANGE [BEGIN]
-  IN   CONST CHAR8  *MdName,
+  IN   INT32        MdNid,
   IN   CONST VOID   *Data,
   IN   UINTN        DataSize,
   IN   CONST UINT8  *Key,
@@ -344,56 +240,15 @@ HmacMdAll (
   )
 {
   // MU_CHANGE [BEGIN]
-  EVP_MAC      *Mac;
-  EVP_MAC_CTX  *Ctx;
-  OSSL_PARAM   Params[2];
-  size_t       MacSize;
-  size_t       Length;
-  BOOLEAN      RetVal;
-
   //
   // Check input parameters.
   //
-  if ((MdName == NULL) || (Data == NULL) || (Key == NULL) || (HmacValue == NULL) || (KeySize > INT_MAX) || (DataSize > INT_MAX)) {
-    return FALSE;
-  }
-
-  Mac = EVP_MAC_fetch (NULL, "HMAC", NULL);
-  if (Mac == NULL) {
-    return FALSE;
-  }
-
-  Ctx = EVP_MAC_CTX_new (Mac);
-  EVP_MAC_free (Mac);
-  if (Ctx == NULL) {
+  if ((Data == NULL) || (Key == NULL) || (HmacValue == NULL) || (KeySize > INT_MAX) || (DataSize > INT_MAX)) {
     return FALSE;
   }
 
-  Params[0] = OSSL_PARAM_construct_utf8_string (
-                OSSL_MAC_PARAM_DIGEST,
-                (char *)MdName,
-                0
-                );
-  Params[1] = OSSL_PARAM_construct_end ();
-
-  RetVal = (BOOLEAN)(EVP_MAC_init (Ctx, Key, (UINTN)KeySize, Params) == 1);  // MU_CHANGE
-  if (!RetVal) {
-    goto Done;
-  }
-
-  RetVal = (BOOLEAN)(EVP_MAC_update (Ctx, Data, (UINTN)DataSize) == 1);  // MU_CHANGE
-  if (!RetVal) {
-    goto Done;
-  }
-
-  MacSize = EVP_MAC_CTX_get_mac_size (Ctx);
-  RetVal  = (BOOLEAN)(EVP_MAC_final (Ctx, HmacValue, &Length, MacSize) == 1);
+  return CryptHmacAll (MdNid, Key, KeySize, Data, DataSize, HmacValue);
   // MU_CHANGE [END]
-
-Done:
-  EVP_MAC_CTX_free (Ctx);  // MU_CHANGE
-
-  return RetVal;
 }
 
 /**
@@ -449,7 +304,7 @@ HmacSha256SetKey (
   IN   UINTN        KeySize
   )
 {
-  return HmacMdSetKey ("SHA256", HmacSha256Context, Key, KeySize);  // MU_CHANGE
+  return HmacMdSetKey (NID_sha256, HmacSha256Context, Key, KeySize);  // MU_CHANGE
 }
 
 /**
@@ -564,7 +419,7 @@ HmacSha256All (
   OUT  UINT8        *HmacValue
   )
 {
-  return HmacMdAll ("SHA256", Data, DataSize, Key, KeySize, HmacValue);  // MU_CHANGE
+  return HmacMdAll (NID_sha256, Data, DataSize, Key, KeySize, HmacValue);  // MU_CHANGE
 }
 
 /**
@@ -622,7 +477,7 @@ HmacSha384SetKey (
   IN   UINTN        KeySize
   )
 {
-  return HmacMdSetKey ("SHA384", HmacSha384Context, Key, KeySize);  // MU_CHANGE
+  return HmacMdSetKey (NID_sha384, HmacSha384Context, Key, KeySize);  // MU_CHANGE
 }
 
 /**
@@ -743,5 +598,5 @@ HmacSha384All (
   OUT  UINT8        *HmacValue
   )
 {
-  return HmacMdAll ("SHA384", Data, DataSize, Key, KeySize, HmacValue);  // MU_CHANGE
+  return HmacMdAll (NID_sha384, Data, DataSize, Key, KeySize, HmacValue);  // MU_CHANGE
 }
@@ -0,0 +1,36 @@
+/** @file
+  GetCryptoProviderCpuFeatures () for BaseCryptLib instances that do not
+  report the OpenSSL capability words (SEC, RUNTIME and the host build).
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseMemoryLib.h>
+#include <CryptCpuFeatures.h>
+
+/**
+  Reports the CPU features OpenSSL selects its accelerated code paths from.
+
+  This instance does not report them.
+
+  @param[out]  Features  Cleared.
+
+  @retval  EFI_INVALID_PARAMETER  Features is NULL.
+  @retval  EFI_UNSUPPORTED        This interface is not supported.
+**/
+EFI_STATUS
+EFIAPI
+GetCryptoProviderCpuFeatures (
+  OUT CRYPT_CPU_FEATURES  *Features
+  )
+{
+  if (Features == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  ZeroMem (Features, sizeof (*Features));
+  return EFI_UNSUPPORTED;
+}
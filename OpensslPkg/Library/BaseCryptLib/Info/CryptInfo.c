@@ -1,7 +1,8 @@
 /** @file
   Cryptographic Library Information Implementation.
 
-  This module provides version information for the underlying OpenSSL library.
+  This module provides version information for the underlying OpenSSL library,
+  and reports the CPU features its accelerated code paths are selected from.
 
   Copyright (c) Microsoft Corporation.
   SPDX-License-Identifier: BSD-2-Clause-Patent
@@ -11,8 +12,63 @@
 #include <openssl/opensslv.h>
 #include <openssl/crypto.h>
 #include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/OpensslLib.h>
+#include <CryptCpuFeatures.h>
 #include "InternalCryptLib.h"
 
+typedef struct {
+  //
+  // Capability word the bits are in.
+  //
+  UINT8     Word;
+  //
+  // Bits that must all be set.
+  //
+  UINT32    Mask;
+  UINT64    Feature;
+} CPU_FEATURE_MAP;
+
+//
+// Capability bits behind each feature. On IA32 and X64 the words are the
+// CPUID registers OpenSSL records: 1 is leaf 1 ECX, 2 and 3 are leaf 7 EBX
+// and ECX, and 5 is leaf 7 sub-leaf 1 EAX. On AARCH64 the bits are the
+// ARMV7_* and ARMV8_* values of crypto/arm_arch.h.
+//
+STATIC CONST CPU_FEATURE_MAP  mCpuFeatureMap[] = {
+ #if defined (MDE_CPU_IA32) || defined (MDE_CPU_X64)
+  { 1, BIT25,                 CRYPT_CPU_FEATURE_AES      },
+  { 1, BIT1,                  CRYPT_CPU_FEATURE_CLMUL    },
+  { 2, BIT29,                 CRYPT_CPU_FEATURE_SHA1     },
+  { 2, BIT29,                 CRYPT_CPU_FEATURE_SHA256   },
+  { 5, BIT0,                  CRYPT_CPU_FEATURE_SHA512   },
+  { 5, BIT1,                  CRYPT_CPU_FEATURE_SM3      },
+  { 5, BIT2,                  CRYPT_CPU_FEATURE_SM4      },
+  { 1, BIT30,                 CRYPT_CPU_FEATURE_RNG      },
+  { 2, BIT18,                 CRYPT_CPU_FEATURE_RNG      },
+  { 1, BIT9,                  CRYPT_CPU_FEATURE_SIMD     },
+  { 1, BIT28,                 CRYPT_CPU_FEATURE_AVX      },
+  { 2, BIT5,                  CRYPT_CPU_FEATURE_AVX2     },
+  { 2, BIT16 | BIT30 | BIT31, CRYPT_CPU_FEATURE_AVX512   },
+  { 3, BIT9 | BIT10,          CRYPT_CPU_FEATURE_VAES     },
+  { 2, BIT8 | BIT19,          CRYPT_CPU_FEATURE_MULX_ADX },
+ #elif defined (MDE_CPU_AARCH64)
+  { 0, BIT2,                  CRYPT_CPU_FEATURE_AES      },
+  { 0, BIT5,                  CRYPT_CPU_FEATURE_CLMUL    },
+  { 0, BIT3,                  CRYPT_CPU_FEATURE_SHA1     },
+  { 0, BIT4,                  CRYPT_CPU_FEATURE_SHA256   },
+  { 0, BIT6,                  CRYPT_CPU_FEATURE_SHA512   },
+  { 0, BIT11,                 CRYPT_CPU_FEATURE_SHA3     },
+  { 0, BIT9,                  CRYPT_CPU_FEATURE_SM3      },
+  { 0, BIT10,                 CRYPT_CPU_FEATURE_SM4      },
+  { 0, BIT8,                  CRYPT_CPU_FEATURE_RNG      },
+  { 0, BIT0,                  CRYPT_CPU_FEATURE_SIMD     },
+  { 0, BIT13,                 CRYPT_CPU_FEATURE_SVE      },
+  { 0, BIT14,                 CRYPT_CPU_FEATURE_SVE2     },
+ #endif
+  { 0, 0,                     0                          }
+};
+
 /**
   Gets the cryptographic provider version information.
 
@@ -62,3 +118,47 @@ GetCryptoProviderVersionString (
 
   return EFI_SUCCESS;
 }
+
+/**
+  Reports the CPU features OpenSSL selects its accelerated code paths from.
+
+  The capability words are read after OpenSSL applied the platform override
+  (PcdOpensslIa32CapOverride or PcdOpensslArmCapOverride), so the report
+  shows the paths that are actually allowed.
+
+  @param[out]  Features  Receives the features and the raw capability words.
+
+  @retval  EFI_SUCCESS            Features was filled in.
+  @retval  EFI_INVALID_PARAMETER  Features is NULL.
+  @retval  EFI_UNSUPPORTED        The OpenSSL library has no CPU specific
+                                  code for this architecture.
+**/
+EFI_STATUS
+EFIAPI
+GetCryptoProviderCpuFeatures (
+  OUT CRYPT_CPU_FEATURES  *Features
+  )
+{
+  CONST CPU_FEATURE_MAP  *Map;
+  UINTN                  Count;
+
+  if (Features == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  ZeroMem (Features, sizeof (*Features));
+
+  Count = CRYPT_CPU_CAPABILITY_WORDS;
+  if (RETURN_ERROR (OpensslLibGetCpuCapability (Features->Capability, &Count))) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Features->CapabilityCount = (UINT32)Count;
+  for (Map = mCpuFeatureMap; Map->Feature != 0; Map++) {
+    if ((Map->Word < Count) && ((Features->Capability[Map->Word] & Map->Mask) == Map->Mask)) {
+      Features->Features |= Map->Feature;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
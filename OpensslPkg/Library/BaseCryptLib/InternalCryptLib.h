@@ -63,4 +63,42 @@ WrapPkcs7Data (
   OUT UINTN        *WrapDataSize
   );
 
+// MU_CHANGE [BEGIN]
+
+/**
+  Work item procedure for DispatchItemsToAp ().
+
+  @param[in]  Context  Context passed to DispatchItemsToAp ().
+  @param[in]  Index    Index of the item to process.
+**/
+typedef
+VOID
+(EFIAPI *CRYPT_ITEM_PROCEDURE)(
+  IN VOID   *Context,
+  IN UINTN  Index
+  );
+
+/**
+  Run Procedure once for each of ItemCount independent items and return
+  when all of them are done.
+
+  Where the library instance has MP dispatch (see CryptDispatchItemsAp.c),
+  the items are shared between the calling processor and the APs, so
+  Procedure must not use services that are not MP safe, such as memory
+  allocation. Otherwise they all run on the calling processor.
+
+  @param[in]  Procedure  Procedure to run for each item.
+  @param[in]  Context    Context passed to Procedure.
+  @param[in]  ItemCount  Number of items.
+**/
+VOID
+EFIAPI
+DispatchItemsToAp (
+  IN CRYPT_ITEM_PROCEDURE  Procedure,
+  IN VOID                  *Context,
+  IN UINTN                 ItemCount
+  );
+
+// MU_CHANGE [END]
+
 #endif
@@ -7,90 +7,32 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 
 #include "InternalCryptLib.h"
-#include <openssl/evp.h>
-#include <openssl/kdf.h>
-
-/**
-  Derive HMAC-based Extract-and-Expand Key Derivation Function (HKDF).
-
-  @param[in]   Md               Message Digest.
-  @param[in]   Key              Pointer to the user-supplied key.
-  @param[in]   KeySize          Key size in bytes.
-  @param[in]   Salt             Pointer to the salt(non-secret) value.
-  @param[in]   SaltSize         Salt size in bytes.
-  @param[in]   Info             Pointer to the application specific info.
-  @param[in]   InfoSize         Info size in bytes.
-  @param[out]  Out              Pointer to buffer to receive hkdf value.
-  @param[in]   OutSize          Size of hkdf bytes to generate.
-
-  @retval TRUE   Hkdf generated successfully.
-  @retval FALSE  Hkdf generation failed.
-
-**/
-STATIC
-BOOLEAN
-HkdfMdExtractAndExpand (
-  IN   CONST EVP_MD  *Md,
-  IN   CONST UINT8   *Key,
-  IN   UINTN         KeySize,
-  IN   CONST UINT8   *Salt,
-  IN   UINTN         SaltSize,
-  IN   CONST UINT8   *Info,
-  IN   UINTN         InfoSize,
-  OUT  UINT8         *Out,
-  IN   UINTN         OutSize
-  )
-{
-  EVP_PKEY_CTX  *pHkdfCtx;
-  BOOLEAN       Result;
-
-  if ((Key == NULL) || (Salt == NULL) || (Info == NULL) || (Out == NULL) ||
-      (KeySize > INT_MAX) || (SaltSize > INT_MAX) || (InfoSize > INT_MAX) || (OutSize > INT_MAX))
-  {
-    return FALSE;
-  }
-
-  pHkdfCtx = EVP_PKEY_CTX_new_id (EVP_PKEY_HKDF, NULL);
-  if (pHkdfCtx == NULL) {
-    return FALSE;
-  }
-
-  Result = EVP_PKEY_derive_init (pHkdfCtx) > 0;
-  if (Result) {
-    Result = EVP_PKEY_CTX_set_hkdf_md (pHkdfCtx, Md) > 0;
-  }
-
-  if (Result) {
-    Result = EVP_PKEY_CTX_set1_hkdf_salt (pHkdfCtx, Salt, (UINT32)SaltSize) > 0;
-  }
-
-  if (Result) {
-    Result = EVP_PKEY_CTX_set1_hkdf_key (pHkdfCtx, Key, (UINT32)KeySize) > 0;
-  }
-
-  if (Result) {
-    Result = EVP_PKEY_CTX_add1_hkdf_info (pHkdfCtx, Info, (UINT32)InfoSize) > 0;
-  }
-
-  if (Result) {
-    Result = EVP_PKEY_derive (pHkdfCtx, Out, &OutSize) > 0;
-  }
-
-  EVP_PKEY_CTX_free (pHkdfCtx);
-  pHkdfCtx = NULL;
-  return Result;
-}
+#include <CryptHkdfCtx.h>  // MU_CHANGE
+// MU_CHANGE [BEGIN]
+//
+// HKDF (RFC 5869) is built on the fixed-context HMAC of the digest layer
+// instead of the EVP_PKEY_HKDF method, which allocates a KDF context and
+// marshals its parameters on every call.
+//
+#include "Hash/CryptDigest.h"
+
+//
+// RFC 5869 limits the output to 255 blocks.
+//
+#define HKDF_MAX_BLOCKS  255
 
 /**
   Derive HMAC-based Extract key Derivation Function (HKDF).
 
-  @param[in]   Md               message digest.
+  @param[in]   MdNid            Message digest NID.
   @param[in]   Key              Pointer to the user-supplied key.
   @param[in]   KeySize          key size in bytes.
   @param[in]   Salt             Pointer to the salt(non-secret) value.
   @param[in]   SaltSize         salt size in bytes.
   @param[out]  PrkOut           Pointer to buffer to receive hkdf value.
-  @param[in]   PrkOutSize       size of hkdf bytes to generate.
+  @param[in]   PrkOutSize       size of hkdf bytes to generate. At least
+                                the digest size; only the digest size is
+                                written.
 
   @retval true   Hkdf generated successfully.
   @retval false  Hkdf generation failed.
@@ -99,7 +41,7 @@ HkdfMdExtractAndExpand (
 STATIC
 BOOLEAN
 HkdfMdExtract (
-  IN CONST EVP_MD  *Md,
+  IN INT32         MdNid,
   IN CONST UINT8   *Key,
   IN  UINTN        KeySize,
   IN CONST UINT8   *Salt,
@@ -108,9 +50,6 @@ HkdfMdExtract (
   UINTN            PrkOutSize
   )
 {
-  EVP_PKEY_CTX  *pHkdfCtx;
-  BOOLEAN       Result;
-
   if ((Key == NULL) || (Salt == NULL) || (PrkOut == NULL) ||
       (KeySize > INT_MAX) || (SaltSize > INT_MAX) ||
       (PrkOutSize > INT_MAX))
@@ -118,53 +57,92 @@ HkdfMdExtract (
     return FALSE;
   }
 
-  pHkdfCtx = EVP_PKEY_CTX_new_id (EVP_PKEY_HKDF, NULL);
-  if (pHkdfCtx == NULL) {
+  if (PrkOutSize < CryptDigestGetSize (MdNid)) {
     return FALSE;
   }
 
-  Result = EVP_PKEY_derive_init (pHkdfCtx) > 0;
-  if (Result) {
-    Result = EVP_PKEY_CTX_set_hkdf_md (pHkdfCtx, Md) > 0;
-  }
+  //
+  // PRK = HMAC-Hash (salt, IKM)
+  //
+  return CryptHmacAll (MdNid, Salt, SaltSize, Key, KeySize, PrkOut);
+}
 
-  if (Result) {
-    Result =
-      EVP_PKEY_CTX_hkdf_mode (
-        pHkdfCtx,
-        EVP_PKEY_HKDEF_MODE_EXTRACT_ONLY
-        ) > 0;
-  }
+/**
+  Derive HKDF-Expand output with an HMAC already keyed with the PRK.
 
-  if (Result) {
-    Result = EVP_PKEY_CTX_set1_hkdf_salt (
-               pHkdfCtx,
-               Salt,
-               (uint32_t)SaltSize
-               ) > 0;
+  @param[in]   Keyed            HMAC context keyed with the PRK. It is not
+                                modified.
+  @param[in]   Info             Pointer to the application specific info. May
+                                be NULL if InfoSize is 0.
+  @param[in]   InfoSize         Info size in bytes.
+  @param[out]  Out              Pointer to buffer to receive hkdf value.
+  @param[in]   OutSize          Size of hkdf bytes to generate.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+
+**/
+STATIC
+BOOLEAN
+HkdfExpandKeyed (
+  IN   CONST CRYPT_HMAC_CTX  *Keyed,
+  IN   CONST UINT8           *Info,
+  IN   UINTN                 InfoSize,
+  OUT  UINT8                 *Out,
+  IN   UINTN                 OutSize
+  )
+{
+  CRYPT_HMAC_CTX  Context;
+  UINT8           Block[CRYPT_DIGEST_MAX_SIZE];
+  UINT8           Counter;
+  UINTN           DigestSize;
+  UINTN           Offset;
+  UINTN           Size;
+  BOOLEAN         Result;
+
+  DigestSize = Keyed->Inner.DigestSize;
+  if ((OutSize == 0) || (OutSize > HKDF_MAX_BLOCKS * DigestSize)) {
+    return FALSE;
   }
 
-  if (Result) {
-    Result = EVP_PKEY_CTX_set1_hkdf_key (
-               pHkdfCtx,
-               Key,
-               (uint32_t)KeySize
-               ) > 0;
+  //
+  // T(N) = HMAC-Hash (PRK, T(N - 1) | info | N), with T(0) empty. Every
+  // block starts from a copy of the keyed state, so the PRK is hashed once.
+  //
+  Result = TRUE;
+  for (Offset = 0, Counter = 1; Result && (Offset < OutSize); Counter++) {
+    CopyMem (&Context, Keyed, sizeof (Context));
+    if ((Offset != 0) && !CryptHmacUpdate (&Context, Block, DigestSize)) {
+      Result = FALSE;
+    } else if (!CryptHmacUpdate (&Context, Info, InfoSize)) {
+      Result = FALSE;
+    } else if (!CryptHmacUpdate (&Context, &Counter, sizeof (Counter))) {
+      Result = FALSE;
+    } else if (!CryptHmacFinal (&Context, Block)) {
+      Result = FALSE;
+    } else {
+      Size = MIN (OutSize - Offset, DigestSize);
+      CopyMem (Out + Offset, Block, Size);
+      Offset += Size;
+    }
   }
 
-  if (Result) {
-    Result = EVP_PKEY_derive (pHkdfCtx, PrkOut, &PrkOutSize) > 0;
+  //
+  // Never hand back a partial or stale key stream.
+  //
+  if (!Result) {
+    ZeroMem (Out, OutSize);
   }
 
-  EVP_PKEY_CTX_free (pHkdfCtx);
-  pHkdfCtx = NULL;
+  ZeroMem (&Context, sizeof (Context));
+  ZeroMem (Block, sizeof (Block));
   return Result;
 }
 
 /**
-  Derive SHA256 HMAC-based Expand Key Derivation Function (HKDF).
+  Derive HMAC-based Expand Key Derivation Function (HKDF).
 
-  @param[in]   Md               Message Digest.
+  @param[in]   MdNid            Message digest NID.
   @param[in]   Prk              Pointer to the user-supplied key.
   @param[in]   PrkSize          Key size in bytes.
   @param[in]   Info             Pointer to the application specific info.
@@ -179,7 +157,7 @@ HkdfMdExtract (
 STATIC
 BOOLEAN
 HkdfMdExpand (
-  IN   CONST EVP_MD  *Md,
+  IN   INT32         MdNid,
   IN   CONST UINT8   *Prk,
   IN   UINTN         PrkSize,
   IN   CONST UINT8   *Info,
@@ -188,8 +166,8 @@ HkdfMdExpand (
   IN   UINTN         OutSize
   )
 {
-  EVP_PKEY_CTX  *pHkdfCtx;
-  BOOLEAN       Result;
+  CRYPT_HMAC_CTX  Keyed;
+  BOOLEAN         Result;
 
   if ((Prk == NULL) || (Info == NULL) || (Out == NULL) ||
       (PrkSize > INT_MAX) || (InfoSize > INT_MAX) || (OutSize > INT_MAX))
@@ -197,37 +175,59 @@ HkdfMdExpand (
     return FALSE;
   }
 
-  pHkdfCtx = EVP_PKEY_CTX_new_id (EVP_PKEY_HKDF, NULL);
-  if (pHkdfCtx == NULL) {
+  if (!CryptHmacInit (&Keyed, MdNid, Prk, PrkSize)) {
     return FALSE;
   }
 
-  Result = EVP_PKEY_derive_init (pHkdfCtx) > 0;
-  if (Result) {
-    Result = EVP_PKEY_CTX_set_hkdf_md (pHkdfCtx, Md) > 0;
-  }
+  Result = HkdfExpandKeyed (&Keyed, Info, InfoSize, Out, OutSize);
 
-  if (Result) {
-    Result = EVP_PKEY_CTX_hkdf_mode (pHkdfCtx, EVP_PKEY_HKDEF_MODE_EXPAND_ONLY) > 0;
-  }
+  ZeroMem (&Keyed, sizeof (Keyed));
+  return Result;
+}
 
-  if (Result) {
-    Result = EVP_PKEY_CTX_set1_hkdf_key (pHkdfCtx, Prk, (UINT32)PrkSize) > 0;
-  }
+/**
+  Derive HMAC-based Extract-and-Expand Key Derivation Function (HKDF).
 
-  if (Result) {
-    Result = EVP_PKEY_CTX_add1_hkdf_info (pHkdfCtx, Info, (UINT32)InfoSize) > 0;
-  }
+  @param[in]   MdNid            Message digest NID.
+  @param[in]   Key              Pointer to the user-supplied key.
+  @param[in]   KeySize          Key size in bytes.
+  @param[in]   Salt             Pointer to the salt(non-secret) value.
+  @param[in]   SaltSize         Salt size in bytes.
+  @param[in]   Info             Pointer to the application specific info.
+  @param[in]   InfoSize         Info size in bytes.
+  @param[out]  Out              Pointer to buffer to receive hkdf value.
+  @param[in]   OutSize          Size of hkdf bytes to generate.
 
-  if (Result) {
-    Result = EVP_PKEY_derive (pHkdfCtx, Out, &OutSize) > 0;
-  }
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+
+**/
+STATIC
+BOOLEAN
+HkdfMdExtractAndExpand (
+  IN   INT32         MdNid,
+  IN   CONST UINT8   *Key,
+  IN   UINTN         KeySize,
+  IN   CONST UINT8   *Salt,
+  IN   UINTN         SaltSize,
+  IN   CONST UINT8   *Info,
+  IN   UINTN         InfoSize,
+  OUT  UINT8         *Out,
+  IN   UINTN         OutSize
+  )
+{
+  UINT8    Prk[CRYPT_DIGEST_MAX_SIZE];
+  BOOLEAN  Result;
 
-  EVP_PKEY_CTX_free (pHkdfCtx);
-  pHkdfCtx = NULL;
+  Result = (BOOLEAN)(HkdfMdExtract (MdNid, Key, KeySize, Salt, SaltSize, Prk, sizeof (Prk)) &&
+                     HkdfMdExpand (MdNid, Prk, CryptDigestGetSize (MdNid), Info, InfoSize, Out, OutSize));
+
+  ZeroMem (Prk, sizeof (Prk));
   return Result;
 }
 
+// MU_CHANGE [END]
+
 /**
   Derive HMAC-based Extract-and-Expand Key Derivation Function (HKDF).
 
@@ -257,7 +257,7 @@ HkdfSha256ExtractAndExpand (
   IN   UINTN        OutSize
   )
 {
-  return HkdfMdExtractAndExpand (EVP_sha256 (), Key, KeySize, Salt, SaltSize, Info, InfoSize, Out, OutSize);
+  return HkdfMdExtractAndExpand (NID_sha256, Key, KeySize, Salt, SaltSize, Info, InfoSize, Out, OutSize);  // MU_CHANGE
 }
 
 /**
@@ -286,7 +286,7 @@ HkdfSha256Extract (
   )
 {
   return HkdfMdExtract (
-           EVP_sha256 (),
+           NID_sha256,  // MU_CHANGE
            Key,
            KeySize,
            Salt,
@@ -321,7 +321,7 @@ HkdfSha256Expand (
   IN   UINTN        OutSize
   )
 {
-  return HkdfMdExpand (EVP_sha256 (), Prk, PrkSize, Info, InfoSize, Out, OutSize);
+  return HkdfMdExpand (NID_sha256, Prk, PrkSize, Info, InfoSize, Out, OutSize);  // MU_CHANGE
 }
 
 /**
@@ -353,7 +353,7 @@ HkdfSha384ExtractAndExpand (
   IN   UINTN        OutSize
   )
 {
-  return HkdfMdExtractAndExpand (EVP_sha384 (), Key, KeySize, Salt, SaltSize, Info, InfoSize, Out, OutSize);
+  return HkdfMdExtractAndExpand (NID_sha384, Key, KeySize, Salt, SaltSize, Info, InfoSize, Out, OutSize);  // MU_CHANGE
 }
 
 /**
@@ -382,7 +382,7 @@ HkdfSha384Extract (
   )
 {
   return HkdfMdExtract (
-           EVP_sha384 (),
+           NID_sha384,  // MU_CHANGE
            Key,
            KeySize,
            Salt,
@@ -417,5 +417,207 @@ HkdfSha384Expand (
   IN   UINTN        OutSize
   )
 {
-  return HkdfMdExpand (EVP_sha384 (), Prk, PrkSize, Info, InfoSize, Out, OutSize);
+  return HkdfMdExpand (NID_sha384, Prk, PrkSize, Info, InfoSize, Out, OutSize);  // MU_CHANGE
+}
+
+///
+/// HKDF-Expand context: an HMAC keyed with the PRK. Every block starts from
+/// a copy of the saved pad state without rehashing the PRK.
+///
+typedef struct {
+  CRYPT_HMAC_CTX    Keyed;
+} HKDF_EXPAND_CTX;
+
+/**
+  Allocate an HKDF-Expand context and key its HMAC with the PRK.
+
+  @param[in]   MdNid            Message digest NID.
+  @param[in]   Prk              Pointer to the pseudorandom key.
+  @param[in]   PrkSize          Key size in bytes.
+
+  @return  Pointer to the HKDF-Expand context, or NULL on failure.
+
+**/
+STATIC
+VOID *
+HkdfMdExpandCtxNew (
+  IN   INT32        MdNid,
+  IN   CONST UINT8  *Prk,
+  IN   UINTN        PrkSize
+  )
+{
+  HKDF_EXPAND_CTX  *Ctx;
+
+  if ((Prk == NULL) || (PrkSize == 0) || (PrkSize > INT_MAX)) {
+    return NULL;
+  }
+
+  Ctx = AllocatePool (sizeof (HKDF_EXPAND_CTX));
+  if (Ctx == NULL) {
+    return NULL;
+  }
+
+  if (!CryptHmacInit (&Ctx->Keyed, MdNid, Prk, PrkSize)) {
+    FreePool (Ctx);
+    return NULL;
+  }
+
+  return Ctx;
+}
+
+/**
+  Allocate an HKDF-Expand context for SHA256 and key it with a PRK.
+
+  HMAC is keyed once here. Each HkdfExpandCtx () call then starts from the
+  saved inner and outer pad state instead of hashing the PRK again, which is
+  cheaper when a key schedule derives several secrets from one PRK.
+
+  @param[in]   Prk              Pointer to the pseudorandom key.
+  @param[in]   PrkSize          Key size in bytes.
+
+  @return  Pointer to the HKDF-Expand context, or NULL on failure. Free it
+           with HkdfExpandCtxFree ().
+
+**/
+VOID *
+EFIAPI
+HkdfSha256ExpandCtxNew (
+  IN   CONST UINT8  *Prk,
+  IN   UINTN        PrkSize
+  )
+{
+  return HkdfMdExpandCtxNew (NID_sha256, Prk, PrkSize);
+}
+
+/**
+  Allocate an HKDF-Expand context for SHA384 and key it with a PRK.
+
+  HMAC is keyed once here. Each HkdfExpandCtx () call then starts from the
+  saved inner and outer pad state instead of hashing the PRK again, which is
+  cheaper when a key schedule derives several secrets from one PRK.
+
+  @param[in]   Prk              Pointer to the pseudorandom key.
+  @param[in]   PrkSize          Key size in bytes.
+
+  @return  Pointer to the HKDF-Expand context, or NULL on failure. Free it
+           with HkdfExpandCtxFree ().
+
+**/
+VOID *
+EFIAPI
+HkdfSha384ExpandCtxNew (
+  IN   CONST UINT8  *Prk,
+  IN   UINTN        PrkSize
+  )
+{
+  return HkdfMdExpandCtxNew (NID_sha384, Prk, PrkSize);
+}
+
+/**
+  Derive HMAC-based Expand Key Derivation Function (HKDF) output from the PRK
+  held by an HKDF-Expand context.
+
+  The context can be used for any number of calls.
+
+  @param[in]   HkdfCtx          Context from HkdfSha256ExpandCtxNew () or
+                                HkdfSha384ExpandCtxNew ().
+  @param[in]   Info             Pointer to the application specific info. May
+                                be NULL if InfoSize is 0.
+  @param[in]   InfoSize         Info size in bytes.
+  @param[out]  Out              Pointer to buffer to receive hkdf value.
+  @param[in]   OutSize          Size of hkdf bytes to generate. At most 255
+                                times the digest size.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+
+**/
+BOOLEAN
+EFIAPI
+HkdfExpandCtx (
+  IN   VOID         *HkdfCtx,
+  IN   CONST UINT8  *Info,
+  IN   UINTN        InfoSize,
+  OUT  UINT8        *Out,
+  IN   UINTN        OutSize
+  )
+{
+  HKDF_EXPAND_CTX  *Ctx;
+
+  Ctx = (HKDF_EXPAND_CTX *)HkdfCtx;
+  if ((Ctx == NULL) || (Out == NULL) || ((Info == NULL) && (InfoSize != 0))) {
+    return FALSE;
+  }
+
+  return HkdfExpandKeyed (&Ctx->Keyed, Info, InfoSize, Out, OutSize);
+}
+
+/**
+  Derive several HKDF-Expand outputs, one per label, from the PRK held by an
+  HKDF-Expand context.
+
+  Entry Index of each array describes one output, as for HkdfExpandCtx ().
+  Outputs are derived in order and processing stops at the first failure.
+
+  @param[in]   HkdfCtx          Context from HkdfSha256ExpandCtxNew () or
+                                HkdfSha384ExpandCtxNew ().
+  @param[in]   Info             Array of LabelCount info pointers.
+  @param[in]   InfoSize         Array of LabelCount info sizes in bytes.
+  @param[out]  Out              Array of LabelCount output buffers.
+  @param[in]   OutSize          Array of LabelCount output sizes in bytes.
+  @param[in]   LabelCount       Number of outputs to derive.
+
+  @retval TRUE   All outputs generated successfully.
+  @retval FALSE  Invalid parameter, or an output could not be generated.
+
+**/
+BOOLEAN
+EFIAPI
+HkdfExpandCtxBatch (
+  IN   VOID         *HkdfCtx,
+  IN   CONST UINT8  **Info,
+  IN   CONST UINTN  *InfoSize,
+  OUT  UINT8        **Out,
+  IN   CONST UINTN  *OutSize,
+  IN   UINTN        LabelCount
+  )
+{
+  UINTN  Index;
+
+  if ((HkdfCtx == NULL) || (LabelCount == 0) ||
+      (Info == NULL) || (InfoSize == NULL) || (Out == NULL) || (OutSize == NULL))
+  {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < LabelCount; Index++) {
+    if (!HkdfExpandCtx (HkdfCtx, Info[Index], InfoSize[Index], Out[Index], OutSize[Index])) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Release an HKDF-Expand context. The keyed HMAC state is cleared.
+
+  @param[in]  HkdfCtx  Context to release. May be NULL.
+
+**/
+VOID
+EFIAPI
+HkdfExpandCtxFree (
+  IN  VOID  *HkdfCtx
+  )
+{
+  HKDF_EXPAND_CTX  *Ctx;
+
+  Ctx = (HKDF_EXPAND_CTX *)HkdfCtx;
+  if (Ctx == NULL) {
+    return;
+  }
+
+  ZeroMem (Ctx, sizeof (*Ctx));
+  FreePool (Ctx);
 }
@@ -0,0 +1,450 @@
+/** @file
+  PE/COFF Authenticode image hashing.
+
+  AuthenticodeVerify () checks a signature against an image digest the caller
+  computed. AuthenticodeHashImage () computes that digest as defined in the
+  "Windows Authenticode Portable Executable Signature Format" specification:
+
+    1. The headers, excluding the CheckSum field and the Certificate Table
+       data directory entry.
+    2. The raw data of every section, in PointerToRawData order.
+    3. Any data after the last section, excluding the attribute certificate
+       table.
+
+  The image is walked in a single pass over the caller's buffer. Sections are
+  ordered with a selection over the section table instead of a sorted copy,
+  and the hash context lives on the stack, so hashing does not allocate and
+  can run on APs; AuthenticodeHashImageBatch () relies on that.
+
+  Caution: This module requires additional review when modified.
+  This library will have external input - PE/COFF image.
+  This external input must be validated carefully to avoid security issue like
+  buffer overflow, integer overflow.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+#include <IndustryStandard/PeImage.h>
+#include <CryptAuthenticodeHash.h>
+
+//
+// The Windows loader rejects images with more sections; the bound also caps
+// the quadratic section ordering.
+//
+#define AUTHENTICODE_MAX_SECTIONS  96
+
+//
+// Large enough for the SHA-256/384/512 contexts of both backends.
+//
+#define AUTHENTICODE_HASH_CONTEXT_SIZE  512
+
+typedef
+UINTN
+(EFIAPI *HASH_GET_CONTEXT_SIZE)(
+  VOID
+  );
+
+typedef
+BOOLEAN
+(EFIAPI *HASH_INIT)(
+  OUT VOID  *HashContext
+  );
+
+typedef
+BOOLEAN
+(EFIAPI *HASH_UPDATE)(
+  IN OUT VOID        *HashContext,
+  IN     CONST VOID  *Data,
+  IN     UINTN       DataSize
+  );
+
+typedef
+BOOLEAN
+(EFIAPI *HASH_FINAL)(
+  IN OUT VOID   *HashContext,
+  OUT    UINT8  *HashValue
+  );
+
+typedef struct {
+  UINTN                    HashNid;
+  HASH_GET_CONTEXT_SIZE    GetContextSize;
+  HASH_INIT                Init;
+  HASH_UPDATE              Update;
+  HASH_FINAL               Final;
+} AUTHENTICODE_HASH;
+
+STATIC CONST AUTHENTICODE_HASH  mAuthenticodeHashes[] = {
+  { CRYPTO_NID_SHA256, Sha256GetContextSize, Sha256Init, Sha256Update, Sha256Final },
+  { CRYPTO_NID_SHA384, Sha384GetContextSize, Sha384Init, Sha384Update, Sha384Final },
+  { CRYPTO_NID_SHA512, Sha512GetContextSize, Sha512Init, Sha512Update, Sha512Final },
+};
+
+typedef struct {
+  CONST UINT8    **Images;
+  CONST UINTN    *ImageSizes;
+  UINTN          HashNid;
+  UINT8          **Digests;
+  BOOLEAN        *Results;
+} AUTHENTICODE_HASH_BATCH;
+
+/**
+  Hash the sections of an image in PointerToRawData order.
+
+  Sections with the same PointerToRawData keep their section table order, as
+  with the stable sort consumers traditionally use.
+
+  @param[in]      Hash              Hash algorithm.
+  @param[in,out]  HashContext       Started hash context.
+  @param[in]      Image             Image buffer.
+  @param[in]      ImageSize         Size of Image in bytes.
+  @param[in]      Section           First entry of the section table.
+  @param[in]      NumberOfSections  Number of section table entries.
+  @param[in,out]  SumOfBytesHashed  Bytes of Image hashed so far.
+
+  @retval  TRUE   The sections were hashed.
+  @retval  FALSE  A section lies outside the image, or hashing failed.
+**/
+STATIC
+BOOLEAN
+AuthenticodeHashSections (
+  IN     CONST AUTHENTICODE_HASH         *Hash,
+  IN OUT VOID                            *HashContext,
+  IN     CONST UINT8                     *Image,
+  IN     UINTN                           ImageSize,
+  IN     CONST EFI_IMAGE_SECTION_HEADER  *Section,
+  IN     UINTN                           NumberOfSections,
+  IN OUT UINTN                           *SumOfBytesHashed
+  )
+{
+  UINTN   Hashed;
+  UINTN   Index;
+  UINTN   Next;
+  UINTN   Previous;
+  UINT32  Offset;
+  UINT32  Size;
+
+  Previous = MAX_UINTN;
+  for (Hashed = 0; Hashed < NumberOfSections; Hashed++) {
+    //
+    // Next is the first section after Previous in (PointerToRawData, index)
+    // order.
+    //
+    Next = MAX_UINTN;
+    for (Index = 0; Index < NumberOfSections; Index++) {
+      if ((Previous != MAX_UINTN) &&
+          ((Section[Index].PointerToRawData < Section[Previous].PointerToRawData) ||
+           ((Section[Index].PointerToRawData == Section[Previous].PointerToRawData) && (Index <= Previous))))
+      {
+        continue;
+      }
+
+      if ((Next == MAX_UINTN) || (Section[Index].PointerToRawData < Section[Next].PointerToRawData)) {
+        Next = Index;
+      }
+    }
+
+    Previous = Next;
+    Offset   = Section[Next].PointerToRawData;
+    Size     = Section[Next].SizeOfRawData;
+    if (Size == 0) {
+      continue;
+    }
+
+    if ((Size > ImageSize) || (Offset > ImageSize - Size) || (Size > MAX_UINTN - *SumOfBytesHashed)) {
+      return FALSE;
+    }
+
+    if (!Hash->Update (HashContext, Image + Offset, Size)) {
+      return FALSE;
+    }
+
+    *SumOfBytesHashed += Size;
+  }
+
+  return TRUE;
+}
+
+/**
+  Compute the Authenticode digest of a PE/COFF image, as needed for the
+  ImageHash parameter of AuthenticodeVerify ().
+
+  The digest covers the image headers without the CheckSum field and the
+  Certificate Table entry, the section data in PointerToRawData order, and
+  any trailing data except the attribute certificate table. The function does
+  not allocate memory.
+
+  If Image or Digest is NULL, then return FALSE.
+  If HashNid is not supported, then return FALSE.
+
+  Caution: This function may receive untrusted input.
+  The PE/COFF image is external input, so this function will validate every
+  offset it reads against ImageSize.
+
+  @param[in]   Image      Pointer to the PE/COFF image, as read from storage.
+  @param[in]   ImageSize  Size of the image in bytes.
+  @param[in]   HashNid    CRYPTO_NID_SHA256, CRYPTO_NID_SHA384 or
+                          CRYPTO_NID_SHA512.
+  @param[out]  Digest     Buffer receiving the digest. It must be large enough
+                          for the digest of HashNid.
+
+  @retval  TRUE   The digest was computed.
+  @retval  FALSE  An input was invalid, or the image is not a well formed
+                  PE32/PE32+ image.
+
+**/
+BOOLEAN
+EFIAPI
+AuthenticodeHashImage (
+  IN  CONST VOID  *Image,
+  IN  UINTN       ImageSize,
+  IN  UINTN       HashNid,
+  OUT UINT8       *Digest
+  )
+{
+  CONST UINT8                          *Bytes;
+  CONST AUTHENTICODE_HASH              *Hash;
+  UINT64                               HashContext[AUTHENTICODE_HASH_CONTEXT_SIZE / sizeof (UINT64)];
+  EFI_IMAGE_OPTIONAL_HEADER_PTR_UNION  Hdr;
+  CONST EFI_IMAGE_DATA_DIRECTORY       *SecDataDir;
+  CONST UINT8                          *CheckSum;
+  UINT32                               NumberOfRvaAndSizes;
+  UINTN                                PeOffset;
+  UINTN                                OptionalHeaderOffset;
+  UINTN                                SectionTableOffset;
+  UINTN                                SizeOfHeaders;
+  UINTN                                NumberOfSections;
+  UINTN                                SumOfBytesHashed;
+  UINTN                                CertSize;
+  UINTN                                Offset;
+  UINTN                                Index;
+  BOOLEAN                              Status;
+
+  if ((Image == NULL) || (Digest == NULL)) {
+    return FALSE;
+  }
+
+  Hash = NULL;
+  for (Index = 0; Index < ARRAY_SIZE (mAuthenticodeHashes); Index++) {
+    if (mAuthenticodeHashes[Index].HashNid == HashNid) {
+      Hash = &mAuthenticodeHashes[Index];
+      break;
+    }
+  }
+
+  if ((Hash == NULL) || (Hash->GetContextSize () > sizeof (HashContext))) {
+    return FALSE;
+  }
+
+  //
+  // Locate the PE header, after an optional DOS stub.
+  //
+  Bytes    = (CONST UINT8 *)Image;
+  PeOffset = 0;
+  if ((ImageSize >= sizeof (EFI_IMAGE_DOS_HEADER)) &&
+      (((CONST EFI_IMAGE_DOS_HEADER *)Bytes)->e_magic == EFI_IMAGE_DOS_SIGNATURE))
+  {
+    PeOffset = ((CONST EFI_IMAGE_DOS_HEADER *)Bytes)->e_lfanew;
+  }
+
+  OptionalHeaderOffset = PeOffset + sizeof (UINT32) + sizeof (EFI_IMAGE_FILE_HEADER);
+  if ((PeOffset > ImageSize) || (ImageSize - PeOffset < sizeof (EFI_IMAGE_NT_HEADERS32))) {
+    return FALSE;
+  }
+
+  Hdr.Union = (EFI_IMAGE_OPTIONAL_HEADER_UNION *)(Bytes + PeOffset);
+  if (Hdr.Pe32->Signature != EFI_IMAGE_NT_SIGNATURE) {
+    return FALSE;
+  }
+
+  SectionTableOffset = OptionalHeaderOffset + Hdr.Pe32->FileHeader.SizeOfOptionalHeader;
+  NumberOfSections   = Hdr.Pe32->FileHeader.NumberOfSections;
+
+  //
+  // The fixed part of the optional header must be present; the data
+  // directory entries beyond NumberOfRvaAndSizes need not be.
+  //
+  if (Hdr.Pe32->OptionalHeader.Magic == EFI_IMAGE_NT_OPTIONAL_HDR32_MAGIC) {
+    if (Hdr.Pe32->FileHeader.SizeOfOptionalHeader < OFFSET_OF (EFI_IMAGE_OPTIONAL_HEADER32, DataDirectory)) {
+      return FALSE;
+    }
+
+    CheckSum            = (CONST UINT8 *)&Hdr.Pe32->OptionalHeader.CheckSum;
+    NumberOfRvaAndSizes = Hdr.Pe32->OptionalHeader.NumberOfRvaAndSizes;
+    SecDataDir          = &Hdr.Pe32->OptionalHeader.DataDirectory[EFI_IMAGE_DIRECTORY_ENTRY_SECURITY];
+    SizeOfHeaders       = Hdr.Pe32->OptionalHeader.SizeOfHeaders;
+  } else if (Hdr.Pe32->OptionalHeader.Magic == EFI_IMAGE_NT_OPTIONAL_HDR64_MAGIC) {
+    if ((ImageSize - PeOffset < sizeof (EFI_IMAGE_NT_HEADERS64)) ||
+        (Hdr.Pe32Plus->FileHeader.SizeOfOptionalHeader < OFFSET_OF (EFI_IMAGE_OPTIONAL_HEADER64, DataDirectory)))
+    {
+      return FALSE;
+    }
+
+    CheckSum            = (CONST UINT8 *)&Hdr.Pe32Plus->OptionalHeader.CheckSum;
+    NumberOfRvaAndSizes = Hdr.Pe32Plus->OptionalHeader.NumberOfRvaAndSizes;
+    SecDataDir          = &Hdr.Pe32Plus->OptionalHeader.DataDirectory[EFI_IMAGE_DIRECTORY_ENTRY_SECURITY];
+    SizeOfHeaders       = Hdr.Pe32Plus->OptionalHeader.SizeOfHeaders;
+  } else {
+    return FALSE;
+  }
+
+  //
+  // The Certificate Table entry only exists, and is only excluded, if the
+  // data directory reaches it.
+  //
+  if (NumberOfRvaAndSizes <= EFI_IMAGE_DIRECTORY_ENTRY_SECURITY) {
+    SecDataDir = NULL;
+  } else if ((UINTN)((CONST UINT8 *)(SecDataDir + 1) - Bytes) > SectionTableOffset) {
+    return FALSE;
+  }
+
+  if ((SizeOfHeaders > ImageSize) ||
+      (SectionTableOffset > SizeOfHeaders) ||
+      (NumberOfSections > AUTHENTICODE_MAX_SECTIONS) ||
+      (NumberOfSections * sizeof (EFI_IMAGE_SECTION_HEADER) > ImageSize - SectionTableOffset))
+  {
+    return FALSE;
+  }
+
+  if (!Hash->Init (HashContext)) {
+    return FALSE;
+  }
+
+  //
+  // 1. Headers: up to CheckSum, from CheckSum to the Certificate Table entry
+  //    (if any), and from there to SizeOfHeaders.
+  //
+  Offset = (UINTN)(CheckSum - Bytes);
+  Status = Hash->Update (HashContext, Bytes, Offset);
+  Offset = Offset + sizeof (UINT32);
+  if (SecDataDir != NULL) {
+    Status = Status && Hash->Update (HashContext, Bytes + Offset, (UINTN)((CONST UINT8 *)SecDataDir - Bytes) - Offset);
+    Offset = (UINTN)((CONST UINT8 *)(SecDataDir + 1) - Bytes);
+  }
+
+  Status = Status && Hash->Update (HashContext, Bytes + Offset, SizeOfHeaders - Offset);
+  if (!Status) {
+    return FALSE;
+  }
+
+  //
+  // 2. Section data.
+  //
+  SumOfBytesHashed = SizeOfHeaders;
+  if (!AuthenticodeHashSections (
+         Hash,
+         HashContext,
+         Bytes,
+         ImageSize,
+         (CONST EFI_IMAGE_SECTION_HEADER *)(Bytes + SectionTableOffset),
+         NumberOfSections,
+         &SumOfBytesHashed
+         ))
+  {
+    return FALSE;
+  }
+
+  //
+  // 3. Trailing data, without the attribute certificate table.
+  //
+  if (ImageSize > SumOfBytesHashed) {
+    CertSize = (SecDataDir != NULL) ? SecDataDir->Size : 0;
+    if (ImageSize - SumOfBytesHashed < CertSize) {
+      return FALSE;
+    }
+
+    if (!Hash->Update (HashContext, Bytes + SumOfBytesHashed, ImageSize - SumOfBytesHashed - CertSize)) {
+      return FALSE;
+    }
+  }
+
+  return Hash->Final (HashContext, Digest);
+}
+
+/**
+  Hash one image of a batch.
+
+  @param[in]  Context  The AUTHENTICODE_HASH_BATCH.
+  @param[in]  Index    Index of the image to hash.
+**/
+STATIC
+VOID
+EFIAPI
+AuthenticodeHashBatchItem (
+  IN VOID   *Context,
+  IN UINTN  Index
+  )
+{
+  AUTHENTICODE_HASH_BATCH  *Batch;
+
+  Batch                 = (AUTHENTICODE_HASH_BATCH *)Context;
+  Batch->Results[Index] = AuthenticodeHashImage (
+                            Batch->Images[Index],
+                            Batch->ImageSizes[Index],
+                            Batch->HashNid,
+                            Batch->Digests[Index]
+                            );
+}
+
+/**
+  Compute the Authenticode digests of several PE/COFF images.
+
+  Where the library instance has MP dispatch (PEI, SMM, and DXE drivers
+  whose DSC maps DxeCryptMpDispatchLib), the images are hashed
+  concurrently, one at a time per processor, on the calling processor and
+  the APs. Elsewhere they are hashed in turn on the calling processor.
+  Each digest is the same as AuthenticodeHashImage () computes.
+
+  If Images, ImageSizes, Digests or Results is NULL, then return FALSE.
+
+  @param[in]   Images      Array of ImageCount pointers to PE/COFF images.
+  @param[in]   ImageSizes  Array of the image sizes in bytes.
+  @param[in]   ImageCount  Number of images.
+  @param[in]   HashNid     CRYPTO_NID_SHA256, CRYPTO_NID_SHA384 or
+                           CRYPTO_NID_SHA512.
+  @param[out]  Digests     Array of ImageCount digest buffers, each large
+                           enough for the digest of HashNid.
+  @param[out]  Results     Array receiving, per image, whether its digest
+                           was computed.
+
+  @retval  TRUE   All digests were computed.
+  @retval  FALSE  An input was invalid, or at least one image failed; see
+                  Results.
+
+**/
+BOOLEAN
+EFIAPI
+AuthenticodeHashImageBatch (
+  IN  CONST VOID   **Images,
+  IN  CONST UINTN  *ImageSizes,
+  IN  UINTN        ImageCount,
+  IN  UINTN        HashNid,
+  OUT UINT8        **Digests,
+  OUT BOOLEAN      *Results
+  )
+{
+  AUTHENTICODE_HASH_BATCH  Batch;
+  UINTN                    Index;
+
+  if ((Images == NULL) || (ImageSizes == NULL) || (Digests == NULL) || (Results == NULL)) {
+    return FALSE;
+  }
+
+  Batch.Images     = (CONST UINT8 **)Images;
+  Batch.ImageSizes = ImageSizes;
+  Batch.HashNid    = HashNid;
+  Batch.Digests    = Digests;
+  Batch.Results    = Results;
+
+  DispatchItemsToAp (AuthenticodeHashBatchItem, &Batch, ImageCount);
+
+  for (Index = 0; Index < ImageCount; Index++) {
+    if (!Results[Index]) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
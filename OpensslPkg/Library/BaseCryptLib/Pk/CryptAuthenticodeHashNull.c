@@ -0,0 +1,69 @@
+/** @file
+  PE/COFF Authenticode image hashing which does not provide real capabilities.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+#include <CryptAuthenticodeHash.h>
+
+/**
+  Compute the Authenticode digest of a PE/COFF image.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[in]   Image      Pointer to the PE/COFF image, as read from storage.
+  @param[in]   ImageSize  Size of the image in bytes.
+  @param[in]   HashNid    CRYPTO_NID_SHA256, CRYPTO_NID_SHA384 or
+                          CRYPTO_NID_SHA512.
+  @param[out]  Digest     Buffer receiving the digest.
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+AuthenticodeHashImage (
+  IN  CONST VOID  *Image,
+  IN  UINTN       ImageSize,
+  IN  UINTN       HashNid,
+  OUT UINT8       *Digest
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+/**
+  Compute the Authenticode digests of several PE/COFF images.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[in]   Images      Array of ImageCount pointers to PE/COFF images.
+  @param[in]   ImageSizes  Array of the image sizes in bytes.
+  @param[in]   ImageCount  Number of images.
+  @param[in]   HashNid     CRYPTO_NID_SHA256, CRYPTO_NID_SHA384 or
+                           CRYPTO_NID_SHA512.
+  @param[out]  Digests     Array of ImageCount digest buffers.
+  @param[out]  Results     Array receiving, per image, whether its digest
+                           was computed.
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+AuthenticodeHashImageBatch (
+  IN  CONST VOID   **Images,
+  IN  CONST UINTN  *ImageSizes,
+  IN  UINTN        ImageCount,
+  IN  UINTN        HashNid,
+  OUT UINT8        **Digests,
+  OUT BOOLEAN      *Results
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
@@ -7,8 +7,369 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 
 #include "InternalCryptLib.h"
+#include <Library/PcdLib.h>
 #include <openssl/evp.h>
 #include <openssl/hmac.h>
+#include <openssl/sha.h>
+
+//
+// Number of PBKDF2 output blocks (T_i) derived side by side. The lanes are
+// independent, so interleaving them lets the CPU overlap their compression
+// functions instead of waiting on one serial U_j chain.
+//
+#define PBKDF2_LANES  4
+
+//
+// Encodes the HMAC output length (pad block + one digest) in bits into the
+// last bytes of a single-block SHA-2 message.
+//
+STATIC
+VOID
+Pbkdf2SetBitLength (
+  OUT UINT8  *BlockEnd,
+  IN  UINTN  BitLength
+  )
+{
+  BlockEnd[-1] = (UINT8)BitLength;
+  BlockEnd[-2] = (UINT8)(BitLength >> 8);
+}
+
+/**
+  PBKDF2-HMAC-SHA256 with precomputed pad states.
+
+  The HMAC inner and outer states after the key XOR ipad/opad block are
+  computed once. Every U_j after U_1 is then exactly two SHA-256
+  compressions over a pre-padded block, with no per-iteration HMAC context
+  setup.
+
+  Parameters are as for Pkcs5HashPassword() and are already validated.
+
+  @retval  TRUE   The key was derived.
+  @retval  FALSE  A hash operation failed.
+**/
+STATIC
+BOOLEAN
+Pbkdf2Sha256 (
+  IN  CONST UINT8  *Password,
+  IN  UINTN        PasswordLength,
+  IN  CONST UINT8  *Salt,
+  IN  UINTN        SaltLength,
+  IN  UINTN        IterationCount,
+  IN  UINTN        KeyLength,
+  OUT UINT8        *OutKey
+  )
+{
+  SHA256_CTX  Inner;
+  SHA256_CTX  Outer;
+  SHA256_CTX  Ctx;
+  UINT8       Pad[SHA256_CBLOCK];
+  UINT8       Block[PBKDF2_LANES][SHA256_CBLOCK];
+  SHA_LONG    Acc[PBKDF2_LANES][SHA256_DIGEST_SIZE / sizeof (SHA_LONG)];
+  UINT8       Counter[4];
+  UINT32      BlockIndex;
+  UINTN       Lanes;
+  UINTN       Lane;
+  UINTN       Iteration;
+  UINTN       Index;
+  UINTN       Size;
+  BOOLEAN     Status;
+
+  Status = FALSE;
+
+  //
+  // K0 = H(K) if K is longer than a block, otherwise K zero padded.
+  //
+  ZeroMem (Pad, sizeof (Pad));
+  if (PasswordLength > SHA256_CBLOCK) {
+    if (SHA256 (Password, PasswordLength, Pad) == NULL) {
+      goto Done;
+    }
+  } else {
+    CopyMem (Pad, Password, PasswordLength);
+  }
+
+  for (Index = 0; Index < SHA256_CBLOCK; Index++) {
+    Pad[Index] ^= 0x36;
+  }
+
+  if (!SHA256_Init (&Inner) || !SHA256_Update (&Inner, Pad, SHA256_CBLOCK)) {
+    goto Done;
+  }
+
+  for (Index = 0; Index < SHA256_CBLOCK; Index++) {
+    Pad[Index] ^= 0x36 ^ 0x5c;
+  }
+
+  if (!SHA256_Init (&Outer) || !SHA256_Update (&Outer, Pad, SHA256_CBLOCK)) {
+    goto Done;
+  }
+
+  //
+  // Both the inner and the outer hash of every U_j (j > 1) cover one pad
+  // block plus one digest, so they share the same single-block padding.
+  //
+  ZeroMem (Block, sizeof (Block));
+  for (Lane = 0; Lane < PBKDF2_LANES; Lane++) {
+    Block[Lane][SHA256_DIGEST_SIZE] = 0x80;
+    Pbkdf2SetBitLength (Block[Lane] + SHA256_CBLOCK, (SHA256_CBLOCK + SHA256_DIGEST_SIZE) * 8);
+  }
+
+  BlockIndex = 1;
+  while (KeyLength > 0) {
+    Lanes = MIN (PBKDF2_LANES, (KeyLength + SHA256_DIGEST_SIZE - 1) / SHA256_DIGEST_SIZE);
+
+    //
+    // U_1 = HMAC (P, S || INT (i)).
+    //
+    for (Lane = 0; Lane < Lanes; Lane++) {
+      Counter[0] = (UINT8)((BlockIndex + Lane) >> 24);
+      Counter[1] = (UINT8)((BlockIndex + Lane) >> 16);
+      Counter[2] = (UINT8)((BlockIndex + Lane) >> 8);
+      Counter[3] = (UINT8)(BlockIndex + Lane);
+
+      CopyMem (&Ctx, &Inner, sizeof (Ctx));
+      if (!SHA256_Update (&Ctx, Salt, SaltLength) ||
+          !SHA256_Update (&Ctx, Counter, sizeof (Counter)) ||
+          !SHA256_Final (Block[Lane], &Ctx))
+      {
+        goto Done;
+      }
+
+      CopyMem (&Ctx, &Outer, sizeof (Ctx));
+      if (!SHA256_Update (&Ctx, Block[Lane], SHA256_DIGEST_SIZE) ||
+          !SHA256_Final (Block[Lane], &Ctx))
+      {
+        goto Done;
+      }
+
+      for (Index = 0; Index < ARRAY_SIZE (Acc[Lane]); Index++) {
+        Acc[Lane][Index] = ((SHA_LONG)Block[Lane][Index * 4] << 24) |
+                           ((SHA_LONG)Block[Lane][Index * 4 + 1] << 16) |
+                           ((SHA_LONG)Block[Lane][Index * 4 + 2] << 8) |
+                           (SHA_LONG)Block[Lane][Index * 4 + 3];
+      }
+    }
+
+    //
+    // U_j = HMAC (P, U_j-1), two compressions per lane per iteration.
+    //
+    for (Iteration = 1; Iteration < IterationCount; Iteration++) {
+      for (Lane = 0; Lane < Lanes; Lane++) {
+        CopyMem (Ctx.h, Inner.h, sizeof (Ctx.h));
+        SHA256_Transform (&Ctx, Block[Lane]);
+        for (Index = 0; Index < ARRAY_SIZE (Ctx.h); Index++) {
+          Block[Lane][Index * 4]     = (UINT8)(Ctx.h[Index] >> 24);
+          Block[Lane][Index * 4 + 1] = (UINT8)(Ctx.h[Index] >> 16);
+          Block[Lane][Index * 4 + 2] = (UINT8)(Ctx.h[Index] >> 8);
+          Block[Lane][Index * 4 + 3] = (UINT8)Ctx.h[Index];
+        }
+
+        CopyMem (Ctx.h, Outer.h, sizeof (Ctx.h));
+        SHA256_Transform (&Ctx, Block[Lane]);
+        for (Index = 0; Index < ARRAY_SIZE (Ctx.h); Index++) {
+          Block[Lane][Index * 4]     = (UINT8)(Ctx.h[Index] >> 24);
+          Block[Lane][Index * 4 + 1] = (UINT8)(Ctx.h[Index] >> 16);
+          Block[Lane][Index * 4 + 2] = (UINT8)(Ctx.h[Index] >> 8);
+          Block[Lane][Index * 4 + 3] = (UINT8)Ctx.h[Index];
+          Acc[Lane][Index]          ^= Ctx.h[Index];
+        }
+      }
+    }
+
+    //
+    // T_i = U_1 ^ ... ^ U_c, truncated for the last block.
+    //
+    for (Lane = 0; Lane < Lanes; Lane++) {
+      Size = MIN (KeyLength, SHA256_DIGEST_SIZE);
+      for (Index = 0; Index < Size; Index++) {
+        OutKey[Index] = (UINT8)(Acc[Lane][Index / 4] >> (24 - 8 * (Index % 4)));
+      }
+
+      OutKey    += Size;
+      KeyLength -= Size;
+    }
+
+    BlockIndex += (UINT32)Lanes;
+  }
+
+  Status = TRUE;
+
+Done:
+  ZeroMem (&Inner, sizeof (Inner));
+  ZeroMem (&Outer, sizeof (Outer));
+  ZeroMem (&Ctx, sizeof (Ctx));
+  ZeroMem (Pad, sizeof (Pad));
+  ZeroMem (Block, sizeof (Block));
+  ZeroMem (Acc, sizeof (Acc));
+  return Status;
+}
+
+/**
+  PBKDF2-HMAC-SHA384/SHA512 with precomputed pad states.
+
+  See Pbkdf2Sha256(). SHA-384 shares the SHA-512 compression function and
+  only differs in its initial state and in the truncated digest.
+
+  @param[in]  DigestSize  SHA384_DIGEST_SIZE or SHA512_DIGEST_SIZE.
+
+  Other parameters are as for Pkcs5HashPassword() and are already validated.
+
+  @retval  TRUE   The key was derived.
+  @retval  FALSE  A hash operation failed.
+**/
+STATIC
+BOOLEAN
+Pbkdf2Sha512 (
+  IN  CONST UINT8  *Password,
+  IN  UINTN        PasswordLength,
+  IN  CONST UINT8  *Salt,
+  IN  UINTN        SaltLength,
+  IN  UINTN        IterationCount,
+  IN  UINTN        DigestSize,
+  IN  UINTN        KeyLength,
+  OUT UINT8        *OutKey
+  )
+{
+  SHA512_CTX    Inner;
+  SHA512_CTX    Outer;
+  SHA512_CTX    Ctx;
+  UINT8         Pad[SHA512_CBLOCK];
+  UINT8         Block[PBKDF2_LANES][SHA512_CBLOCK];
+  SHA_LONG64    Acc[PBKDF2_LANES][SHA512_DIGEST_SIZE / sizeof (SHA_LONG64)];
+  UINT8         Counter[4];
+  UINT32        BlockIndex;
+  UINTN         Words;
+  UINTN         Lanes;
+  UINTN         Lane;
+  UINTN         Iteration;
+  UINTN         Index;
+  UINTN         Shift;
+  UINTN         Size;
+  BOOLEAN       Status;
+
+  Status = FALSE;
+  Words  = DigestSize / sizeof (SHA_LONG64);
+
+  ZeroMem (Pad, sizeof (Pad));
+  if (PasswordLength > SHA512_CBLOCK) {
+    if (((DigestSize == SHA384_DIGEST_SIZE) ? SHA384 (Password, PasswordLength, Pad) :
+         SHA512 (Password, PasswordLength, Pad)) == NULL)
+    {
+      goto Done;
+    }
+  } else {
+    CopyMem (Pad, Password, PasswordLength);
+  }
+
+  for (Index = 0; Index < SHA512_CBLOCK; Index++) {
+    Pad[Index] ^= 0x36;
+  }
+
+  if (!((DigestSize == SHA384_DIGEST_SIZE) ? SHA384_Init (&Inner) : SHA512_Init (&Inner)) ||
+      !SHA512_Update (&Inner, Pad, SHA512_CBLOCK))
+  {
+    goto Done;
+  }
+
+  for (Index = 0; Index < SHA512_CBLOCK; Index++) {
+    Pad[Index] ^= 0x36 ^ 0x5c;
+  }
+
+  if (!((DigestSize == SHA384_DIGEST_SIZE) ? SHA384_Init (&Outer) : SHA512_Init (&Outer)) ||
+      !SHA512_Update (&Outer, Pad, SHA512_CBLOCK))
+  {
+    goto Done;
+  }
+
+  ZeroMem (Block, sizeof (Block));
+  for (Lane = 0; Lane < PBKDF2_LANES; Lane++) {
+    Block[Lane][DigestSize] = 0x80;
+    Pbkdf2SetBitLength (Block[Lane] + SHA512_CBLOCK, (SHA512_CBLOCK + DigestSize) * 8);
+  }
+
+  BlockIndex = 1;
+  while (KeyLength > 0) {
+    Lanes = MIN (PBKDF2_LANES, (KeyLength + DigestSize - 1) / DigestSize);
+
+    for (Lane = 0; Lane < Lanes; Lane++) {
+      Counter[0] = (UINT8)((BlockIndex + Lane) >> 24);
+      Counter[1] = (UINT8)((BlockIndex + Lane) >> 16);
+      Counter[2] = (UINT8)((BlockIndex + Lane) >> 8);
+      Counter[3] = (UINT8)(BlockIndex + Lane);
+
+      //
+      // SHA384_Update/Final are aliases of the SHA-512 ones; Final honours
+      // the digest length recorded in the context.
+      //
+      CopyMem (&Ctx, &Inner, sizeof (Ctx));
+      if (!SHA512_Update (&Ctx, Salt, SaltLength) ||
+          !SHA512_Update (&Ctx, Counter, sizeof (Counter)) ||
+          !SHA512_Final (Block[Lane], &Ctx))
+      {
+        goto Done;
+      }
+
+      CopyMem (&Ctx, &Outer, sizeof (Ctx));
+      if (!SHA512_Update (&Ctx, Block[Lane], DigestSize) ||
+          !SHA512_Final (Block[Lane], &Ctx))
+      {
+        goto Done;
+      }
+
+      for (Index = 0; Index < Words; Index++) {
+        Acc[Lane][Index] = 0;
+        for (Shift = 0; Shift < 8; Shift++) {
+          Acc[Lane][Index] = (Acc[Lane][Index] << 8) | Block[Lane][Index * 8 + Shift];
+        }
+      }
+    }
+
+    for (Iteration = 1; Iteration < IterationCount; Iteration++) {
+      for (Lane = 0; Lane < Lanes; Lane++) {
+        CopyMem (Ctx.h, Inner.h, sizeof (Ctx.h));
+        SHA512_Transform (&Ctx, Block[Lane]);
+        for (Index = 0; Index < Words; Index++) {
+          for (Shift = 0; Shift < 8; Shift++) {
+            Block[Lane][Index * 8 + Shift] = (UINT8)(Ctx.h[Index] >> (56 - 8 * Shift));
+          }
+        }
+
+        CopyMem (Ctx.h, Outer.h, sizeof (Ctx.h));
+        SHA512_Transform (&Ctx, Block[Lane]);
+        for (Index = 0; Index < Words; Index++) {
+          for (Shift = 0; Shift < 8; Shift++) {
+            Block[Lane][Index * 8 + Shift] = (UINT8)(Ctx.h[Index] >> (56 - 8 * Shift));
+          }
+
+          Acc[Lane][Index] ^= Ctx.h[Index];
+        }
+      }
+    }
+
+    for (Lane = 0; Lane < Lanes; Lane++) {
+      Size = MIN (KeyLength, DigestSize);
+      for (Index = 0; Index < Size; Index++) {
+        OutKey[Index] = (UINT8)(Acc[Lane][Index / 8] >> (56 - 8 * (Index % 8)));
+      }
+
+      OutKey    += Size;
+      KeyLength -= Size;
+    }
+
+    BlockIndex += (UINT32)Lanes;
+  }
+
+  Status = TRUE;
+
+Done:
+  ZeroMem (&Inner, sizeof (Inner));
+  ZeroMem (&Outer, sizeof (Outer));
+  ZeroMem (&Ctx, sizeof (Ctx));
+  ZeroMem (Pad, sizeof (Pad));
+  ZeroMem (Block, sizeof (Block));
+  ZeroMem (Acc, sizeof (Acc));
+  return Status;
+}
 
 /**
   Derives a key from a password using a salt and iteration count, based on PKCS#5 v2.0
@@ -91,6 +452,20 @@ Pkcs5HashPassword (
       break;
   }
 
+  //
+  // SHA-2 derivations take the precomputed pad state path when the platform
+  // selects it; SHA-1 always goes through OpenSSL.
+  //
+  if (FeaturePcdGet (PcdCryptPbkdf2FastPath)) {
+    if (DigestSize == SHA256_DIGEST_SIZE) {
+      return Pbkdf2Sha256 ((CONST UINT8 *)Password, PasswordLength, Salt, SaltLength, IterationCount, KeyLength, OutKey);
+    }
+
+    if ((DigestSize == SHA384_DIGEST_SIZE) || (DigestSize == SHA512_DIGEST_SIZE)) {
+      return Pbkdf2Sha512 ((CONST UINT8 *)Password, PasswordLength, Salt, SaltLength, IterationCount, DigestSize, KeyLength, OutKey);
+    }
+  }
+
   //
   // Perform password-based key derivation routines.
   //
@@ -0,0 +1,510 @@
+/** @file
+  Zero-copy views into PKCS#7 SignedData.
+
+  These functions locate the attached content and the signer certificates of
+  a PKCS#7 SignedData with a minimal DER walker and return their offsets
+  within the caller's buffer. Nothing is decoded into library objects and
+  nothing is allocated, so large signed payloads such as capsules are not
+  copied.
+
+  Only definite-length encodings are walked. Inputs that use BER
+  indefinite lengths or constructed OCTET STRINGs are rejected; callers can
+  fall back to Pkcs7GetAttachedContent () and Pkcs7GetSigners () for those.
+
+  Caution: This module requires additional review when modified.
+  This library will have external input - signature.
+  This external input must be validated carefully to avoid security issue like
+  buffer overflow, integer overflow.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+#include <CryptPkcs7View.h>
+
+#define DER_TAG_INTEGER       0x02
+#define DER_TAG_OCTET_STRING  0x04
+#define DER_TAG_OID           0x06
+#define DER_TAG_SEQUENCE      0x30
+#define DER_TAG_SET           0x31
+#define DER_TAG_CONTEXT_0     0xA0
+#define DER_TAG_CONTEXT_1     0xA1
+
+//
+// Lengths above 2^32 - 1 bytes cannot occur in a firmware signature.
+//
+#define DER_MAX_LENGTH_OCTETS  4
+
+//
+// 1.2.840.113549.1.7.2 (signedData).
+//
+STATIC CONST UINT8  mPkcs7SignedDataOid[] = { 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x02 };
+
+//
+// Offsets of the SignedData fields used by the views. Each range is the
+// value of the field, i.e. excludes its tag and length octets.
+//
+typedef struct {
+  UINTN    ContentInfoStart;
+  UINTN    ContentInfoEnd;
+  UINTN    CertificatesStart;
+  UINTN    CertificatesEnd;
+  UINTN    SignerInfosStart;
+  UINTN    SignerInfosEnd;
+} PKCS7_SIGNED_DATA_VIEW;
+
+/**
+  Reads the DER element starting at Data[Start] and checks its tag.
+
+  @param[in]   Data        DER buffer.
+  @param[in]   Start       Offset of the tag octet.
+  @param[in]   End         Offset just past the enclosing value.
+  @param[in]   Tag         Expected tag octet.
+  @param[out]  ValueStart  Offset of the first value octet.
+  @param[out]  ValueEnd    Offset just past the last value octet.
+
+  @retval  TRUE   The element has the expected tag and fits within End.
+  @retval  FALSE  The tag differs, or the element is truncated or not
+                  definite-length encoded.
+**/
+STATIC
+BOOLEAN
+DerReadElement (
+  IN  CONST UINT8  *Data,
+  IN  UINTN        Start,
+  IN  UINTN        End,
+  IN  UINT8        Tag,
+  OUT UINTN        *ValueStart,
+  OUT UINTN        *ValueEnd
+  )
+{
+  UINTN  Length;
+  UINTN  Octets;
+
+  if ((Start >= End) || (End - Start < 2) || (Data[Start] != Tag)) {
+    return FALSE;
+  }
+
+  Start++;
+  Length = Data[Start++];
+  if (Length >= 0x80) {
+    //
+    // 0x80 is the BER indefinite form; anything above is the long form.
+    //
+    Octets = Length & 0x7F;
+    if ((Octets == 0) || (Octets > DER_MAX_LENGTH_OCTETS) || (Octets > End - Start)) {
+      return FALSE;
+    }
+
+    Length = 0;
+    while (Octets-- > 0) {
+      Length = (Length << 8) | Data[Start++];
+    }
+  }
+
+  if (Length > End - Start) {
+    return FALSE;
+  }
+
+  *ValueStart = Start;
+  *ValueEnd   = Start + Length;
+  return TRUE;
+}
+
+/**
+  Returns the tag of the DER element at Data[Start], or 0 if there is none.
+
+  @param[in]  Data   DER buffer.
+  @param[in]  Start  Offset of the element.
+  @param[in]  End    Offset just past the enclosing value.
+
+  @return  The tag octet, or 0 at the end of the enclosing value.
+**/
+STATIC
+UINT8
+DerPeekTag (
+  IN CONST UINT8  *Data,
+  IN UINTN        Start,
+  IN UINTN        End
+  )
+{
+  return (Start < End) ? Data[Start] : 0;
+}
+
+/**
+  Checks that the DER element at Data[Start] is an OBJECT IDENTIFIER with the
+  given value.
+
+  @param[in]   Data      DER buffer.
+  @param[in]   Start     Offset of the element.
+  @param[in]   End       Offset just past the enclosing value.
+  @param[in]   Oid       Expected OID value octets.
+  @param[in]   OidSize   Size of Oid in bytes.
+  @param[out]  Next      Offset of the element that follows.
+  @param[out]  Matches   TRUE if the OID equals Oid.
+
+  @retval  TRUE   An OID was read.
+  @retval  FALSE  The element is not a well formed OID.
+**/
+STATIC
+BOOLEAN
+DerReadOid (
+  IN  CONST UINT8  *Data,
+  IN  UINTN        Start,
+  IN  UINTN        End,
+  IN  CONST UINT8  *Oid,
+  IN  UINTN        OidSize,
+  OUT UINTN        *Next,
+  OUT BOOLEAN      *Matches
+  )
+{
+  UINTN  ValueStart;
+
+  if (!DerReadElement (Data, Start, End, DER_TAG_OID, &ValueStart, Next)) {
+    return FALSE;
+  }
+
+  *Matches = (BOOLEAN)((*Next - ValueStart == OidSize) &&
+                       (CompareMem (Data + ValueStart, Oid, OidSize) == 0));
+  return TRUE;
+}
+
+/**
+  Locates the SignedData fields in a PKCS#7 message. The message may be a
+  ContentInfo wrapping the SignedData, or a bare SignedData.
+
+  @param[in]   P7Data    PKCS#7 message.
+  @param[in]   P7Length  Length of P7Data in bytes.
+  @param[out]  View      Offsets of the SignedData fields within P7Data.
+
+  @retval  TRUE   The SignedData was located.
+  @retval  FALSE  P7Data is not a definite-length PKCS#7 SignedData.
+**/
+STATIC
+BOOLEAN
+Pkcs7ParseSignedData (
+  IN  CONST UINT8             *P7Data,
+  IN  UINTN                   P7Length,
+  OUT PKCS7_SIGNED_DATA_VIEW  *View
+  )
+{
+  UINTN    Start;
+  UINTN    End;
+  UINTN    Next;
+  BOOLEAN  IsSignedData;
+
+  if (!DerReadElement (P7Data, 0, P7Length, DER_TAG_SEQUENCE, &Start, &End)) {
+    return FALSE;
+  }
+
+  //
+  // ContentInfo ::= SEQUENCE { contentType OID, content [0] EXPLICIT ANY }
+  //
+  if (DerPeekTag (P7Data, Start, End) == DER_TAG_OID) {
+    if (!DerReadOid (P7Data, Start, End, mPkcs7SignedDataOid, sizeof (mPkcs7SignedDataOid), &Next, &IsSignedData) ||
+        !IsSignedData ||
+        !DerReadElement (P7Data, Next, End, DER_TAG_CONTEXT_0, &Start, &End) ||
+        !DerReadElement (P7Data, Start, End, DER_TAG_SEQUENCE, &Start, &End))
+    {
+      return FALSE;
+    }
+  }
+
+  //
+  // SignedData ::= SEQUENCE {
+  //   version           INTEGER,
+  //   digestAlgorithms  SET,
+  //   contentInfo       ContentInfo,
+  //   certificates      [0] IMPLICIT SET OF Certificate OPTIONAL,
+  //   crls              [1] IMPLICIT SET OPTIONAL,
+  //   signerInfos       SET OF SignerInfo }
+  //
+  if (!DerReadElement (P7Data, Start, End, DER_TAG_INTEGER, &Next, &Start) ||
+      !DerReadElement (P7Data, Start, End, DER_TAG_SET, &Next, &Start) ||
+      !DerReadElement (P7Data, Start, End, DER_TAG_SEQUENCE, &View->ContentInfoStart, &View->ContentInfoEnd))
+  {
+    return FALSE;
+  }
+
+  Start                   = View->ContentInfoEnd;
+  View->CertificatesStart = Start;
+  View->CertificatesEnd   = Start;
+  if (DerPeekTag (P7Data, Start, End) == DER_TAG_CONTEXT_0) {
+    if (!DerReadElement (P7Data, Start, End, DER_TAG_CONTEXT_0, &View->CertificatesStart, &View->CertificatesEnd)) {
+      return FALSE;
+    }
+
+    Start = View->CertificatesEnd;
+  }
+
+  if (DerPeekTag (P7Data, Start, End) == DER_TAG_CONTEXT_1) {
+    if (!DerReadElement (P7Data, Start, End, DER_TAG_CONTEXT_1, &Next, &Start)) {
+      return FALSE;
+    }
+  }
+
+  return DerReadElement (P7Data, Start, End, DER_TAG_SET, &View->SignerInfosStart, &View->SignerInfosEnd);
+}
+
+/**
+  Finds the certificate whose issuer and serial number match a SignerInfo.
+
+  Issuer names are compared by their DER encoding.
+
+  @param[in]   P7Data        PKCS#7 message.
+  @param[in]   View          Offsets of the SignedData fields.
+  @param[in]   IssuerStart   Offset of the signer's issuer Name element.
+  @param[in]   IssuerEnd     Offset just past the issuer Name element.
+  @param[in]   SerialStart   Offset of the signer's serial INTEGER element.
+  @param[in]   SerialEnd     Offset just past the serial INTEGER element.
+  @param[out]  CertStart     Offset of the matching Certificate element.
+  @param[out]  CertEnd       Offset just past the matching Certificate element.
+
+  @retval  TRUE   A matching certificate was found.
+  @retval  FALSE  No certificate matches, or a certificate is malformed.
+**/
+STATIC
+BOOLEAN
+Pkcs7FindSignerCert (
+  IN  CONST UINT8                   *P7Data,
+  IN  CONST PKCS7_SIGNED_DATA_VIEW  *View,
+  IN  UINTN                         IssuerStart,
+  IN  UINTN                         IssuerEnd,
+  IN  UINTN                         SerialStart,
+  IN  UINTN                         SerialEnd,
+  OUT UINTN                         *CertStart,
+  OUT UINTN                         *CertEnd
+  )
+{
+  UINTN  Cert;
+  UINTN  Next;
+  UINTN  Start;
+  UINTN  End;
+  UINTN  Serial;
+  UINTN  Issuer;
+  UINTN  Value;
+
+  for (Cert = View->CertificatesStart; Cert < View->CertificatesEnd; Cert = Next) {
+    //
+    // Certificate ::= SEQUENCE { tbsCertificate SEQUENCE {
+    //   version [0] EXPLICIT OPTIONAL, serialNumber INTEGER,
+    //   signature AlgorithmIdentifier, issuer Name, ... } ... }
+    //
+    if (!DerReadElement (P7Data, Cert, View->CertificatesEnd, DER_TAG_SEQUENCE, &Start, &Next) ||
+        !DerReadElement (P7Data, Start, Next, DER_TAG_SEQUENCE, &Start, &End))
+    {
+      return FALSE;
+    }
+
+    if (DerPeekTag (P7Data, Start, End) == DER_TAG_CONTEXT_0) {
+      if (!DerReadElement (P7Data, Start, End, DER_TAG_CONTEXT_0, &Value, &Start)) {
+        return FALSE;
+      }
+    }
+
+    Serial = Start;
+    if (!DerReadElement (P7Data, Serial, End, DER_TAG_INTEGER, &Value, &Start) ||
+        !DerReadElement (P7Data, Start, End, DER_TAG_SEQUENCE, &Value, &Issuer) ||
+        !DerReadElement (P7Data, Issuer, End, DER_TAG_SEQUENCE, &Value, &End))
+    {
+      return FALSE;
+    }
+
+    if ((Start - Serial == SerialEnd - SerialStart) &&
+        (End - Issuer == IssuerEnd - IssuerStart) &&
+        (CompareMem (P7Data + Serial, P7Data + SerialStart, Start - Serial) == 0) &&
+        (CompareMem (P7Data + Issuer, P7Data + IssuerStart, End - Issuer) == 0))
+    {
+      *CertStart = Cert;
+      *CertEnd   = Next;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+  Locates the attached content of a PKCS#7 signed data without copying it.
+  The input signed data could be wrapped in a ContentInfo structure.
+
+  This is the zero-copy counterpart of Pkcs7GetAttachedContent (): the content
+  is returned as an offset into P7Data, which must stay valid for as long as
+  the content is used.
+
+  If P7Data, ContentOffset, or ContentSize is NULL, then return FALSE. If the
+  P7Data is not a definite-length DER SignedData, or its content is encoded
+  as a constructed OCTET STRING, then return FALSE.
+
+  Caution: This function may receive untrusted input. So this function will do
+           basic check for PKCS#7 data structure.
+
+  @param[in]   P7Data         Pointer to the PKCS#7 signed data to process.
+  @param[in]   P7Length       Length of the PKCS#7 signed data in bytes.
+  @param[out]  ContentOffset  Offset of the attached content within P7Data.
+  @param[out]  ContentSize    The size of the attached content in bytes, or 0
+                              if the signed data is detached.
+
+  @retval     TRUE          The P7Data was correctly formatted for processing.
+  @retval     FALSE         The P7Data was not correctly formatted for processing.
+
+**/
+BOOLEAN
+EFIAPI
+Pkcs7GetAttachedContentView (
+  IN  CONST UINT8  *P7Data,
+  IN  UINTN        P7Length,
+  OUT UINTN        *ContentOffset,
+  OUT UINTN        *ContentSize
+  )
+{
+  PKCS7_SIGNED_DATA_VIEW  View;
+  UINTN                   Start;
+  UINTN                   End;
+  UINTN                   Value;
+
+  if ((P7Data == NULL) || (ContentOffset == NULL) || (ContentSize == NULL)) {
+    return FALSE;
+  }
+
+  *ContentOffset = 0;
+  *ContentSize   = 0;
+
+  //
+  // Like Pkcs7GetAttachedContent (), the eContentType is skipped, not
+  // checked: content of any type is returned when it is an OCTET STRING.
+  //
+  if (!Pkcs7ParseSignedData (P7Data, P7Length, &View) ||
+      !DerReadElement (P7Data, View.ContentInfoStart, View.ContentInfoEnd, DER_TAG_OID, &Value, &Start))
+  {
+    return FALSE;
+  }
+
+  //
+  // No content for PKCS7 detached signedData.
+  //
+  if (Start == View.ContentInfoEnd) {
+    return TRUE;
+  }
+
+  if (!DerReadElement (P7Data, Start, View.ContentInfoEnd, DER_TAG_CONTEXT_0, &Start, &End) ||
+      !DerReadElement (P7Data, Start, End, DER_TAG_OCTET_STRING, &Start, &End))
+  {
+    return FALSE;
+  }
+
+  *ContentOffset = Start;
+  *ContentSize   = End - Start;
+  return TRUE;
+}
+
+/**
+  Locates the signer's certificates of a PKCS#7 signed data without copying
+  them. The input signed data could be wrapped in a ContentInfo structure.
+
+  This is the zero-copy counterpart of Pkcs7GetSigners (). Each certificate is
+  returned as the offset and size of its DER encoding within P7Data, in
+  SignerInfo order; entry 0 is the certificate Pkcs7GetSigners () returns as
+  TrustedCert.
+
+  If P7Data or CertCount is NULL, then return FALSE. If CertOffset or
+  CertSize is NULL, or *CertCount is smaller than the number of signers, then
+  *CertCount is set to the number of signers and FALSE is returned. If the
+  P7Data is not a definite-length DER SignedData, or a signer's certificate
+  is not included in it, then *CertCount is set to 0 and FALSE is returned.
+
+  Caution: This function may receive untrusted input. So this function will do
+           basic check for PKCS#7 data structure.
+
+  @param[in]      P7Data      Pointer to the PKCS#7 signed data to process.
+  @param[in]      P7Length    Length of the PKCS#7 signed data in bytes.
+  @param[out]     CertOffset  Array receiving the offset of each signer's
+                              certificate within P7Data.
+  @param[out]     CertSize    Array receiving the size of each signer's
+                              certificate in bytes.
+  @param[in,out]  CertCount   On input, the number of entries in CertOffset
+                              and CertSize. On output, the number of signers.
+
+  @retval  TRUE   The signer's certificates were located.
+  @retval  FALSE  The arrays are too small, or the P7Data was not correctly
+                  formatted for processing.
+
+**/
+BOOLEAN
+EFIAPI
+Pkcs7GetSignersView (
+  IN     CONST UINT8  *P7Data,
+  IN     UINTN        P7Length,
+  OUT    UINTN        *CertOffset  OPTIONAL,
+  OUT    UINTN        *CertSize    OPTIONAL,
+  IN OUT UINTN        *CertCount
+  )
+{
+  PKCS7_SIGNED_DATA_VIEW  View;
+  UINTN                   Signer;
+  UINTN                   Next;
+  UINTN                   Start;
+  UINTN                   End;
+  UINTN                   Issuer;
+  UINTN                   Serial;
+  UINTN                   Value;
+  UINTN                   CertStart;
+  UINTN                   CertEnd;
+  UINTN                   Count;
+  UINTN                   Capacity;
+
+  if ((P7Data == NULL) || (CertCount == NULL)) {
+    return FALSE;
+  }
+
+  Capacity = ((CertOffset == NULL) || (CertSize == NULL)) ? 0 : *CertCount;
+  Count    = 0;
+
+  if (!Pkcs7ParseSignedData (P7Data, P7Length, &View)) {
+    goto _Error;
+  }
+
+  for (Signer = View.SignerInfosStart; Signer < View.SignerInfosEnd; Signer = Next) {
+    //
+    // SignerInfo ::= SEQUENCE { version INTEGER,
+    //   issuerAndSerialNumber SEQUENCE { issuer Name, serialNumber INTEGER }, ... }
+    //
+    if (!DerReadElement (P7Data, Signer, View.SignerInfosEnd, DER_TAG_SEQUENCE, &Start, &Next) ||
+        !DerReadElement (P7Data, Start, Next, DER_TAG_INTEGER, &Value, &Start) ||
+        !DerReadElement (P7Data, Start, Next, DER_TAG_SEQUENCE, &Start, &End))
+    {
+      goto _Error;
+    }
+
+    Issuer = Start;
+    if (!DerReadElement (P7Data, Issuer, End, DER_TAG_SEQUENCE, &Value, &Serial) ||
+        !DerReadElement (P7Data, Serial, End, DER_TAG_INTEGER, &Value, &End) ||
+        !Pkcs7FindSignerCert (P7Data, &View, Issuer, Serial, Serial, End, &CertStart, &CertEnd))
+    {
+      goto _Error;
+    }
+
+    if (Count < Capacity) {
+      CertOffset[Count] = CertStart;
+      CertSize[Count]   = CertEnd - CertStart;
+    }
+
+    Count++;
+  }
+
+  //
+  // Pkcs7GetSigners () fails when there are no signers as well.
+  //
+  if (Count == 0) {
+    goto _Error;
+  }
+
+  *CertCount = Count;
+  return (BOOLEAN)(Count <= Capacity);
+
+_Error:
+  *CertCount = 0;
+  return FALSE;
+}
@@ -0,0 +1,69 @@
+/** @file
+  Zero-copy PKCS#7 SignedData views which do not provide real capabilities.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+#include <CryptPkcs7View.h>
+
+/**
+  Locates the attached content of a PKCS#7 signed data without copying it.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[in]   P7Data         Pointer to the PKCS#7 signed data to process.
+  @param[in]   P7Length       Length of the PKCS#7 signed data in bytes.
+  @param[out]  ContentOffset  Offset of the attached content within P7Data.
+  @param[out]  ContentSize    The size of the attached content in bytes, or 0
+                              if the signed data is detached.
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Pkcs7GetAttachedContentView (
+  IN  CONST UINT8  *P7Data,
+  IN  UINTN        P7Length,
+  OUT UINTN        *ContentOffset,
+  OUT UINTN        *ContentSize
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+/**
+  Locates the signer's certificates of a PKCS#7 signed data without copying
+  them.
+
+  Return FALSE to indicate this interface is not supported.
+
+  @param[in]      P7Data      Pointer to the PKCS#7 signed data to process.
+  @param[in]      P7Length    Length of the PKCS#7 signed data in bytes.
+  @param[out]     CertOffset  Array receiving the offset of each signer's
+                              certificate within P7Data.
+  @param[out]     CertSize    Array receiving the size of each signer's
+                              certificate in bytes.
+  @param[in,out]  CertCount   On input, the number of entries in CertOffset
+                              and CertSize. On output, the number of signers.
+
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Pkcs7GetSignersView (
+  IN     CONST UINT8  *P7Data,
+  IN     UINTN        P7Length,
+  OUT    UINTN        *CertOffset  OPTIONAL,
+  OUT    UINTN        *CertSize    OPTIONAL,
+  IN OUT UINTN        *CertCount
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
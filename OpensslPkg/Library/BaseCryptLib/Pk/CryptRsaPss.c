@@ -3,6 +3,7 @@
 
   This file implements following APIs which provide basic capabilities for RSA:
   1) RsaPssVerify
+  2) RsaPssVerifyDigest
 
   // MU_CHANGE [BEGIN]
   Uses OpenSSL 3.x EVP_PKEY provider-based APIs instead of deprecated RSA APIs.
@@ -14,6 +15,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 
 #include "InternalCryptLib.h"
+#include <CryptSigVerify.h>  // MU_CHANGE
 
 #include <openssl/bn.h>
 #include <openssl/rsa.h>
@@ -22,6 +24,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 // MU_CHANGE [BEGIN]
 #include "CryptRsaPkeyCtx.h"
+#include "Hash/CryptDigest.h"
 
 // MU_CHANGE [END]
 
@@ -83,17 +86,10 @@ RsaPssVerify (
   IN  UINT16       SaltLen
   )
 {
-  BOOLEAN       Result;
-  EVP_PKEY      *Pkey;  // MU_CHANGE
-  EVP_MD_CTX    *EvpVerifyCtx;
-  EVP_PKEY_CTX  *KeyCtx;
+  // MU_CHANGE [BEGIN]
   CONST EVP_MD  *HashAlg;
-
-  Result       = FALSE;
-  Pkey         = NULL;  // MU_CHANGE
-  EvpVerifyCtx = NULL;
-  KeyCtx       = NULL;
-  HashAlg      = NULL;
+  UINT8         Digest[CRYPT_DIGEST_MAX_SIZE];
+  // MU_CHANGE [END]
 
   if (RsaContext == NULL) {
     return FALSE;
@@ -119,48 +115,103 @@ RsaPssVerify (
 
   // MU_CHANGE [BEGIN]
   //
-  // Build EVP_PKEY from the RSA_PKEY_CTX key components.
+  // Hash the message with the digest layer instead of an EVP_MD_CTX, then
+  // verify the signature over the digest.
   //
-  Pkey = RsaBuildEvpPkey ((RSA_PKEY_CTX *)RsaContext);
-  if (Pkey == NULL) {
+  if (!CryptDigestAll (EVP_MD_get_type (HashAlg), Message, MsgSize, Digest)) {
     return FALSE;
-    // MU_CHANGE [END]
   }
 
-  EvpVerifyCtx = EVP_MD_CTX_new ();  // MU_CHANGE
-  if (EvpVerifyCtx == NULL) {
-    goto _Exit;
+  return RsaPssVerifyDigest (RsaContext, Digest, DigestLen, Signature, SigSize, SaltLen);
+  // MU_CHANGE [END]
+}
+
+/**
+  Verifies the RSA signature with RSASSA-PSS signature scheme defined in RFC 8017,
+  over a message digest computed by the caller.
+
+  This is RsaPssVerify () for callers that hash the message themselves, e.g.
+  incrementally while reading it. The digest algorithm is selected by
+  HashSize, and the mask generation function uses the same algorithm.
+  Salt length should be equal to digest length.
+
+  @param[in]  RsaContext      Pointer to RSA context for signature verification.
+  @param[in]  MessageHash     Pointer to octet message hash to be checked.
+  @param[in]  HashSize        Size of the message hash in bytes: 32, 48 or 64.
+  @param[in]  Signature       Pointer to RSASSA-PSS signature to be verified.
+  @param[in]  SigSize         Size of signature in bytes.
+  @param[in]  SaltLen         Salt length for PSS encoding.
+
+  @retval  TRUE   Valid signature encoded in RSASSA-PSS.
+  @retval  FALSE  Invalid signature or invalid RSA context.
+
+**/
+BOOLEAN
+EFIAPI
+RsaPssVerifyDigest (
+  IN  VOID         *RsaContext,
+  IN  CONST UINT8  *MessageHash,
+  IN  UINTN        HashSize,
+  IN  CONST UINT8  *Signature,
+  IN  UINTN        SigSize,
+  IN  UINT16       SaltLen
+  )
+{
+  EVP_PKEY      *Pkey;
+  EVP_PKEY_CTX  *KeyCtx;
+  CONST EVP_MD  *HashAlg;
+  BOOLEAN       Result;
+
+  if ((RsaContext == NULL) || (MessageHash == NULL)) {
+    return FALSE;
   }
 
-  Result = EVP_DigestVerifyInit (EvpVerifyCtx, &KeyCtx, HashAlg, NULL, Pkey) > 0;  // MU_CHANGE
+  if ((Signature == NULL) || (SigSize == 0) || (SigSize > INT_MAX)) {
+    return FALSE;
+  }
+
+  if (SaltLen != HashSize) {
+    return FALSE;
+  }
+
+  HashAlg = GetEvpMD (SaltLen);
+  if (HashAlg == NULL) {
+    return FALSE;
+  }
+
+  Pkey = RsaBuildEvpPkey ((RSA_PKEY_CTX *)RsaContext);
+  if (Pkey == NULL) {
+    return FALSE;
+  }
+
+  KeyCtx = EVP_PKEY_CTX_new_from_pkey (NULL, Pkey, NULL);
   if (KeyCtx == NULL) {
-    goto _Exit;
+    return FALSE;
   }
 
+  Result = EVP_PKEY_verify_init (KeyCtx) > 0;
+
   if (Result) {
     Result = EVP_PKEY_CTX_set_rsa_padding (KeyCtx, RSA_PKCS1_PSS_PADDING) > 0;
   }
 
   if (Result) {
-    Result = EVP_PKEY_CTX_set_rsa_pss_saltlen (KeyCtx, SaltLen) > 0;
+    Result = EVP_PKEY_CTX_set_signature_md (KeyCtx, HashAlg) > 0;
   }
 
   if (Result) {
-    Result = EVP_PKEY_CTX_set_rsa_mgf1_md (KeyCtx, HashAlg) > 0;
+    Result = EVP_PKEY_CTX_set_rsa_pss_saltlen (KeyCtx, SaltLen) > 0;
   }
 
   if (Result) {
-    Result = EVP_DigestVerifyUpdate (EvpVerifyCtx, Message, (UINT32)MsgSize) > 0;
+    Result = EVP_PKEY_CTX_set_rsa_mgf1_md (KeyCtx, HashAlg) > 0;
   }
 
   if (Result) {
-    Result = EVP_DigestVerifyFinal (EvpVerifyCtx, Signature, (UINT32)SigSize) > 0;
+    Result = EVP_PKEY_verify (KeyCtx, Signature, SigSize, MessageHash, HashSize) == 1;
   }
 
-_Exit:
-  if (EvpVerifyCtx != NULL) {
-    EVP_MD_CTX_free (EvpVerifyCtx);  // MU_CHANGE
-  }
+  EVP_PKEY_CTX_free (KeyCtx);
 
   return Result;
 }
@@ -22,6 +22,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 // MU_CHANGE [BEGIN]
 #include "CryptRsaPkeyCtx.h"
+#include "Hash/CryptDigest.h"
 
 // MU_CHANGE [END]
 
@@ -100,15 +101,14 @@ RsaPssSign (
   BOOLEAN       Result;
   UINTN         RsaSigSize;
   EVP_PKEY      *Pkey;  // MU_CHANGE
-  EVP_MD_CTX    *EvpVerifyCtx;
   EVP_PKEY_CTX  *KeyCtx;
   CONST EVP_MD  *HashAlg;
+  UINT8         Digest[CRYPT_DIGEST_MAX_SIZE];  // MU_CHANGE
 
-  Result       = FALSE;
-  Pkey         = NULL;  // MU_CHANGE
-  EvpVerifyCtx = NULL;
-  KeyCtx       = NULL;
-  HashAlg      = NULL;
+  Result  = FALSE;
+  Pkey    = NULL;  // MU_CHANGE
+  KeyCtx  = NULL;
+  HashAlg = NULL;
 
   if (RsaContext == NULL) {
     return FALSE;
@@ -148,40 +148,45 @@ RsaPssSign (
     return FALSE;
   }
 
-  EvpVerifyCtx = EVP_MD_CTX_new ();  // MU_CHANGE
-  if (EvpVerifyCtx == NULL) {
-    goto _Exit;
+  // MU_CHANGE [BEGIN]
+  //
+  // Hash the message with the digest layer instead of an EVP_MD_CTX, then
+  // sign the digest.
+  //
+  if (!CryptDigestAll (EVP_MD_get_type (HashAlg), Message, MsgSize, Digest)) {
+    return FALSE;
   }
 
-  Result = EVP_DigestSignInit (EvpVerifyCtx, &KeyCtx, HashAlg, NULL, Pkey) > 0;  // MU_CHANGE
+  KeyCtx = EVP_PKEY_CTX_new_from_pkey (NULL, Pkey, NULL);
   if (KeyCtx == NULL) {
-    goto _Exit;
+    return FALSE;
   }
 
+  Result = EVP_PKEY_sign_init (KeyCtx) > 0;
+
   if (Result) {
-    Result = EVP_PKEY_CTX_set_rsa_padding (KeyCtx, RSA_PKCS1_PSS_PADDING) > 0;
+    Result = EVP_PKEY_CTX_set_signature_md (KeyCtx, HashAlg) > 0;
   }
 
+  // MU_CHANGE [END]
+
   if (Result) {
-    Result = EVP_PKEY_CTX_set_rsa_pss_saltlen (KeyCtx, SaltLen) > 0;
+    Result = EVP_PKEY_CTX_set_rsa_padding (KeyCtx, RSA_PKCS1_PSS_PADDING) > 0;
   }
 
   if (Result) {
-    Result = EVP_PKEY_CTX_set_rsa_mgf1_md (KeyCtx, HashAlg) > 0;
+    Result = EVP_PKEY_CTX_set_rsa_pss_saltlen (KeyCtx, SaltLen) > 0;
   }
 
   if (Result) {
-    Result = EVP_DigestSignUpdate (EvpVerifyCtx, Message, (UINT32)MsgSize) > 0;
+    Result = EVP_PKEY_CTX_set_rsa_mgf1_md (KeyCtx, HashAlg) > 0;
   }
 
   if (Result) {
-    Result = EVP_DigestSignFinal (EvpVerifyCtx, Signature, SigSize) > 0;
+    Result = EVP_PKEY_sign (KeyCtx, Signature, SigSize, Digest, DigestLen) > 0;  // MU_CHANGE
   }
 
-_Exit:
-  if (EvpVerifyCtx != NULL) {
-    EVP_MD_CTX_free (EvpVerifyCtx);  // MU_CHANGE
-  }
+  EVP_PKEY_CTX_free (KeyCtx);  // MU_CHANGE
 
   return Result;
 }
@@ -0,0 +1,348 @@
+/** @file
+  Streaming signature verification over BaseCryptLib.
+
+  RsaPssVerify () needs the whole message in one buffer, and RsaPkcs1Verify ()
+  and EcDsaVerify () need the caller to hash it first. The functions here let
+  a caller feed a large image in pieces, e.g. as it is read from flash:
+
+    Ctx = RsaPssVerifyInit (RsaContext, SHA256_DIGEST_SIZE, SHA256_DIGEST_SIZE);
+    while (...) {
+      SigVerifyUpdate (Ctx, Chunk, ChunkSize);
+    }
+    Valid = SigVerifyFinal (Ctx, Signature, SigSize);
+    SigVerifyFree (Ctx);
+
+  The message is hashed with the BaseCryptLib hash functions and the digest is
+  then checked with RsaPssVerifyDigest (), RsaPkcs1Verify () or EcDsaVerify (),
+  so the result is the same as for the one-shot functions.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+#include <CryptSigVerify.h>
+
+typedef enum {
+  SigVerifyRsaPss,
+  SigVerifyRsaPkcs1,
+  SigVerifyEcDsa
+} SIG_VERIFY_SCHEME;
+
+///
+/// Streaming verify context. The hash context follows the structure in the
+/// same allocation.
+///
+typedef struct {
+  SIG_VERIFY_SCHEME    Scheme;
+  VOID                 *KeyContext;
+  UINTN                HashNid;
+  UINTN                HashSize;
+  UINT16               SaltLen;
+  BOOLEAN              Finalized;
+  VOID                 *HashContext;
+} SIG_VERIFY_CONTEXT;
+
+/**
+  Allocate a verify context and start the hash for HashNid.
+
+  @param[in]  Scheme      Signature scheme to check in SigVerifyFinal ().
+  @param[in]  KeyContext  RSA or EC context holding the public key.
+  @param[in]  HashNid     CRYPTO_NID_SHA256, CRYPTO_NID_SHA384 or CRYPTO_NID_SHA512.
+  @param[in]  SaltLen     PSS salt length. Ignored for other schemes.
+
+  @return  The new context, or NULL if HashNid is not supported or the
+           allocation failed.
+
+**/
+STATIC
+SIG_VERIFY_CONTEXT *
+SigVerifyNew (
+  IN  SIG_VERIFY_SCHEME  Scheme,
+  IN  VOID               *KeyContext,
+  IN  UINTN              HashNid,
+  IN  UINT16             SaltLen
+  )
+{
+  SIG_VERIFY_CONTEXT  *Ctx;
+  UINTN               HashSize;
+  UINTN               HashCtxSize;
+  BOOLEAN             Result;
+
+  if (KeyContext == NULL) {
+    return NULL;
+  }
+
+  switch (HashNid) {
+    case CRYPTO_NID_SHA256:
+      HashSize    = SHA256_DIGEST_SIZE;
+      HashCtxSize = Sha256GetContextSize ();
+      break;
+    case CRYPTO_NID_SHA384:
+      HashSize    = SHA384_DIGEST_SIZE;
+      HashCtxSize = Sha384GetContextSize ();
+      break;
+    case CRYPTO_NID_SHA512:
+      HashSize    = SHA512_DIGEST_SIZE;
+      HashCtxSize = Sha512GetContextSize ();
+      break;
+    default:
+      return NULL;
+  }
+
+  if (HashCtxSize == 0) {
+    return NULL;
+  }
+
+  Ctx = AllocateZeroPool (sizeof (SIG_VERIFY_CONTEXT) + HashCtxSize);
+  if (Ctx == NULL) {
+    return NULL;
+  }
+
+  Ctx->Scheme      = Scheme;
+  Ctx->KeyContext  = KeyContext;
+  Ctx->HashNid     = HashNid;
+  Ctx->HashSize    = HashSize;
+  Ctx->SaltLen     = SaltLen;
+  Ctx->HashContext = Ctx + 1;
+
+  switch (HashNid) {
+    case CRYPTO_NID_SHA256:
+      Result = Sha256Init (Ctx->HashContext);
+      break;
+    case CRYPTO_NID_SHA384:
+      Result = Sha384Init (Ctx->HashContext);
+      break;
+    default:
+      Result = Sha512Init (Ctx->HashContext);
+      break;
+  }
+
+  if (!Result) {
+    FreePool (Ctx);
+    return NULL;
+  }
+
+  return Ctx;
+}
+
+/**
+  Start a streaming RSASSA-PSS verification (RFC 8017).
+
+  The mask generation function uses the same digest as the message. The
+  salt length must equal the digest length, as for RsaPssVerify ().
+
+  RsaContext must stay valid until SigVerifyFree () is called.
+
+  @param[in]  RsaContext  Pointer to RSA context for signature verification.
+  @param[in]  DigestLen   Length of digest for RSA operation: 32, 48 or 64.
+  @param[in]  SaltLen     Salt length for PSS encoding.
+
+  @return  Pointer to the verify context, or NULL on invalid parameters or
+           allocation failure. Free it with SigVerifyFree ().
+
+**/
+VOID *
+EFIAPI
+RsaPssVerifyInit (
+  IN  VOID    *RsaContext,
+  IN  UINT16  DigestLen,
+  IN  UINT16  SaltLen
+  )
+{
+  UINTN  HashNid;
+
+  if (SaltLen != DigestLen) {
+    return NULL;
+  }
+
+  switch (DigestLen) {
+    case SHA256_DIGEST_SIZE:
+      HashNid = CRYPTO_NID_SHA256;
+      break;
+    case SHA384_DIGEST_SIZE:
+      HashNid = CRYPTO_NID_SHA384;
+      break;
+    case SHA512_DIGEST_SIZE:
+      HashNid = CRYPTO_NID_SHA512;
+      break;
+    default:
+      return NULL;
+  }
+
+  return SigVerifyNew (SigVerifyRsaPss, RsaContext, HashNid, SaltLen);
+}
+
+/**
+  Start a streaming RSA-SSA verification with EMSA-PKCS1-v1_5 encoding.
+
+  RsaContext must stay valid until SigVerifyFree () is called.
+
+  @param[in]  RsaContext  Pointer to RSA context for signature verification.
+  @param[in]  HashNid     CRYPTO_NID_SHA256, CRYPTO_NID_SHA384 or CRYPTO_NID_SHA512.
+
+  @return  Pointer to the verify context, or NULL on invalid parameters or
+           allocation failure. Free it with SigVerifyFree ().
+
+**/
+VOID *
+EFIAPI
+RsaPkcs1VerifyInit (
+  IN  VOID   *RsaContext,
+  IN  UINTN  HashNid
+  )
+{
+  return SigVerifyNew (SigVerifyRsaPkcs1, RsaContext, HashNid, 0);
+}
+
+/**
+  Start a streaming EC-DSA verification.
+
+  EcContext must stay valid until SigVerifyFree () is called.
+
+  @param[in]  EcContext  Pointer to EC context for signature verification.
+  @param[in]  HashNid    CRYPTO_NID_SHA256, CRYPTO_NID_SHA384 or CRYPTO_NID_SHA512.
+
+  @return  Pointer to the verify context, or NULL on invalid parameters or
+           allocation failure. Free it with SigVerifyFree ().
+
+**/
+VOID *
+EFIAPI
+EcDsaVerifyInit (
+  IN  VOID   *EcContext,
+  IN  UINTN  HashNid
+  )
+{
+  return SigVerifyNew (SigVerifyEcDsa, EcContext, HashNid, 0);
+}
+
+/**
+  Hash the next part of the message being verified.
+
+  @param[in, out]  VerifyContext  Context from one of the *VerifyInit () functions.
+  @param[in]       Data           Pointer to the message data.
+  @param[in]       DataSize       Size of Data in bytes.
+
+  @retval  TRUE   The data was hashed.
+  @retval  FALSE  Invalid parameter, or SigVerifyFinal () was already called.
+
+**/
+BOOLEAN
+EFIAPI
+SigVerifyUpdate (
+  IN OUT  VOID        *VerifyContext,
+  IN      CONST VOID  *Data,
+  IN      UINTN       DataSize
+  )
+{
+  SIG_VERIFY_CONTEXT  *Ctx;
+
+  Ctx = (SIG_VERIFY_CONTEXT *)VerifyContext;
+  if ((Ctx == NULL) || Ctx->Finalized) {
+    return FALSE;
+  }
+
+  if ((Data == NULL) && (DataSize != 0)) {
+    return FALSE;
+  }
+
+  switch (Ctx->HashNid) {
+    case CRYPTO_NID_SHA256:
+      return Sha256Update (Ctx->HashContext, Data, DataSize);
+    case CRYPTO_NID_SHA384:
+      return Sha384Update (Ctx->HashContext, Data, DataSize);
+    default:
+      return Sha512Update (Ctx->HashContext, Data, DataSize);
+  }
+}
+
+/**
+  Finish the hash and verify the signature over the whole message.
+
+  The context cannot be updated afterwards; it must still be freed with
+  SigVerifyFree ().
+
+  @param[in, out]  VerifyContext  Context from one of the *VerifyInit () functions.
+  @param[in]       Signature      Pointer to the signature to be verified. For
+                                  EC-DSA this is R || S as for EcDsaVerify ().
+  @param[in]       SigSize        Size of signature in bytes.
+
+  @retval  TRUE   Valid signature.
+  @retval  FALSE  Invalid signature or invalid parameter.
+
+**/
+BOOLEAN
+EFIAPI
+SigVerifyFinal (
+  IN OUT  VOID         *VerifyContext,
+  IN      CONST UINT8  *Signature,
+  IN      UINTN        SigSize
+  )
+{
+  SIG_VERIFY_CONTEXT  *Ctx;
+  UINT8               Digest[SHA512_DIGEST_SIZE];
+  BOOLEAN             Result;
+
+  Ctx = (SIG_VERIFY_CONTEXT *)VerifyContext;
+  if ((Ctx == NULL) || Ctx->Finalized || (Signature == NULL)) {
+    return FALSE;
+  }
+
+  Ctx->Finalized = TRUE;
+
+  switch (Ctx->HashNid) {
+    case CRYPTO_NID_SHA256:
+      Result = Sha256Final (Ctx->HashContext, Digest);
+      break;
+    case CRYPTO_NID_SHA384:
+      Result = Sha384Final (Ctx->HashContext, Digest);
+      break;
+    default:
+      Result = Sha512Final (Ctx->HashContext, Digest);
+      break;
+  }
+
+  if (!Result) {
+    return FALSE;
+  }
+
+  switch (Ctx->Scheme) {
+    case SigVerifyRsaPss:
+      Result = RsaPssVerifyDigest (Ctx->KeyContext, Digest, Ctx->HashSize, Signature, SigSize, Ctx->SaltLen);
+      break;
+    case SigVerifyRsaPkcs1:
+      Result = RsaPkcs1Verify (Ctx->KeyContext, Digest, Ctx->HashSize, Signature, SigSize);
+      break;
+    default:
+      Result = EcDsaVerify (Ctx->KeyContext, Ctx->HashNid, Digest, Ctx->HashSize, Signature, SigSize);
+      break;
+  }
+
+  return Result;
+}
+
+/**
+  Release a streaming verify context.
+
+  The RSA or EC context passed to the *VerifyInit () function is not freed.
+
+  @param[in]  VerifyContext  Context to release. May be NULL.
+
+**/
+VOID
+EFIAPI
+SigVerifyFree (
+  IN  VOID  *VerifyContext
+  )
+{
+  SIG_VERIFY_CONTEXT  *Ctx;
+
+  Ctx = (SIG_VERIFY_CONTEXT *)VerifyContext;
+  if (Ctx == NULL) {
+    return;
+  }
+
+  FreePool (Ctx);
+}
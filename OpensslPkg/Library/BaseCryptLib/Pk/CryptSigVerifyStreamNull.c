@@ -0,0 +1,151 @@
+/** @file
+  Streaming signature verification which does not provide real capabilities.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+#include <CryptSigVerify.h>
+
+/**
+  Start a streaming RSASSA-PSS verification (RFC 8017).
+
+  The mask generation function uses the same digest as the message. The
+  salt length must equal the digest length, as for RsaPssVerify ().
+
+  RsaContext must stay valid until SigVerifyFree () is called.
+
+  @param[in]  RsaContext  Pointer to RSA context for signature verification.
+  @param[in]  DigestLen   Length of digest for RSA operation: 32, 48 or 64.
+  @param[in]  SaltLen     Salt length for PSS encoding.
+
+  @return  Pointer to the verify context, or NULL on invalid parameters or
+           allocation failure. Free it with SigVerifyFree ().
+
+**/
+VOID *
+EFIAPI
+RsaPssVerifyInit (
+  IN  VOID    *RsaContext,
+  IN  UINT16  DigestLen,
+  IN  UINT16  SaltLen
+  )
+{
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Start a streaming RSA-SSA verification with EMSA-PKCS1-v1_5 encoding.
+
+  RsaContext must stay valid until SigVerifyFree () is called.
+
+  @param[in]  RsaContext  Pointer to RSA context for signature verification.
+  @param[in]  HashNid     CRYPTO_NID_SHA256, CRYPTO_NID_SHA384 or CRYPTO_NID_SHA512.
+
+  @return  Pointer to the verify context, or NULL on invalid parameters or
+           allocation failure. Free it with SigVerifyFree ().
+
+**/
+VOID *
+EFIAPI
+RsaPkcs1VerifyInit (
+  IN  VOID   *RsaContext,
+  IN  UINTN  HashNid
+  )
+{
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Start a streaming EC-DSA verification.
+
+  EcContext must stay valid until SigVerifyFree () is called.
+
+  @param[in]  EcContext  Pointer to EC context for signature verification.
+  @param[in]  HashNid    CRYPTO_NID_SHA256, CRYPTO_NID_SHA384 or CRYPTO_NID_SHA512.
+
+  @return  Pointer to the verify context, or NULL on invalid parameters or
+           allocation failure. Free it with SigVerifyFree ().
+
+**/
+VOID *
+EFIAPI
+EcDsaVerifyInit (
+  IN  VOID   *EcContext,
+  IN  UINTN  HashNid
+  )
+{
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Hash the next part of the message being verified.
+
+  @param[in, out]  VerifyContext  Context from one of the *VerifyInit () functions.
+  @param[in]       Data           Pointer to the message data.
+  @param[in]       DataSize       Size of Data in bytes.
+
+  @retval  TRUE   The data was hashed.
+  @retval  FALSE  Invalid parameter, or SigVerifyFinal () was already called.
+
+**/
+BOOLEAN
+EFIAPI
+SigVerifyUpdate (
+  IN OUT  VOID        *VerifyContext,
+  IN      CONST VOID  *Data,
+  IN      UINTN       DataSize
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+/**
+  Finish the hash and verify the signature over the whole message.
+
+  The context cannot be updated afterwards; it must still be freed with
+  SigVerifyFree ().
+
+  @param[in, out]  VerifyContext  Context from one of the *VerifyInit () functions.
+  @param[in]       Signature      Pointer to the signature to be verified. For
+                                  EC-DSA this is R || S as for EcDsaVerify ().
+  @param[in]       SigSize        Size of signature in bytes.
+
+  @retval  TRUE   Valid signature.
+  @retval  FALSE  Invalid signature or invalid parameter.
+
+**/
+BOOLEAN
+EFIAPI
+SigVerifyFinal (
+  IN OUT  VOID         *VerifyContext,
+  IN      CONST UINT8  *Signature,
+  IN      UINTN        SigSize
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+/**
+  Release a streaming verify context.
+
+  The RSA or EC context passed to the *VerifyInit () function is not freed.
+
+  @param[in]  VerifyContext  Context to release. May be NULL.
+
+**/
+VOID
+EFIAPI
+SigVerifyFree (
+  IN  VOID  *VerifyContext
+  )
+{
+  ASSERT (FALSE);
+}
@@ -11,6 +11,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 
 #include "InternalCryptLib.h"
+#include "Hash/CryptDigest.h"  // MU_CHANGE
 
 #include <openssl/asn1.h>
 #include <openssl/asn1t.h>
@@ -254,15 +255,14 @@ CheckTSTInfo (
   CONST EVP_MD        *Md;
   EVP_MD_CTX          *MdCtx;
   UINTN               MdSize;
-  UINT8               *HashedMsg;
+  UINT8               HashedMsg[EVP_MAX_MD_SIZE];  // MU_CHANGE
 
   //
   // Initialization
   //
-  Status    = FALSE;
-  HashAlgo  = NULL;
-  HashedMsg = NULL;
-  MdCtx     = NULL;
+  Status   = FALSE;
+  HashAlgo = NULL;
+  MdCtx    = NULL;
 
   //
   // -- Check version number of Timestamp:
@@ -297,24 +297,36 @@ CheckTSTInfo (
     goto _Exit;
   }
 
-  MdSize    = EVP_MD_size (Md);
-  HashedMsg = AllocateZeroPool (MdSize);
-  if (HashedMsg == NULL) {
+  // MU_CHANGE [BEGIN]
+  MdSize = EVP_MD_size (Md);
+  if ((MdSize == 0) || (MdSize > sizeof (HashedMsg))) {
     goto _Exit;
   }
 
-  MdCtx = EVP_MD_CTX_new ();
-  if (MdCtx == NULL) {
-    goto _Exit;
-  }
+  //
+  // SHA-1 and SHA-2 imprints are hashed by the digest layer without an
+  // EVP_MD_CTX. Other algorithms still go through EVP.
+  //
+  if (CryptDigestGetSize (EVP_MD_get_type (Md)) != 0) {
+    if (!CryptDigestAll (EVP_MD_get_type (Md), TimestampedData, DataSize, HashedMsg)) {
+      goto _Exit;
+    }
+  } else {
+    MdCtx = EVP_MD_CTX_new ();
+    if (MdCtx == NULL) {
+      goto _Exit;
+    }
 
-  if ((EVP_DigestInit_ex (MdCtx, Md, NULL) != 1) ||
-      (EVP_DigestUpdate (MdCtx, TimestampedData, DataSize) != 1) ||
-      (EVP_DigestFinal (MdCtx, HashedMsg, NULL) != 1))
-  {
-    goto _Exit;
+    if ((EVP_DigestInit_ex (MdCtx, Md, NULL) != 1) ||
+        (EVP_DigestUpdate (MdCtx, TimestampedData, DataSize) != 1) ||
+        (EVP_DigestFinal (MdCtx, HashedMsg, NULL) != 1))
+    {
+      goto _Exit;
+    }
   }
 
+  // MU_CHANGE [END]
+
   if ((MdSize == (UINTN)ASN1_STRING_length (Imprint->HashedMessage)) &&
       (CompareMem (HashedMsg, ASN1_STRING_get0_data (Imprint->HashedMessage), MdSize) != 0))
   {
@@ -344,9 +356,6 @@ CheckTSTInfo (
 _Exit:
   X509_ALGOR_free (HashAlgo);
   EVP_MD_CTX_free (MdCtx);
-  if (HashedMsg != NULL) {
-    FreePool (HashedMsg);
-  }
 
   return Status;
 }
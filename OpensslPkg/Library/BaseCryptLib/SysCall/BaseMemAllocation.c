@@ -9,6 +9,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include <CrtLibSupport.h>
 #include <Library/MemoryAllocationLib.h>
+#include "CryptAllocStatsInternal.h"
 
 //
 // Extra header to record the memory buffer size from malloc routine.
@@ -16,8 +17,9 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define CRYPTMEM_HEAD_SIGNATURE  SIGNATURE_32('c','m','h','d')
 typedef struct {
   UINT32    Signature;
-  UINT32    Reserved;
-  UINTN     Size;
+  UINT32    StatsTag;     // Allocation statistics tag, 0 if not recorded
+  UINTN     Size;         // Size requested by the caller
+  UINTN     Capacity;     // Usable size, at least Size; realloc() grows into it
 } CRYPTMEM_HEAD;
 
 #define CRYPTMEM_OVERHEAD  sizeof(CRYPTMEM_HEAD)
@@ -48,13 +50,16 @@ malloc (
     // Record the memory brief information
     //
     PoolHdr->Signature = CRYPTMEM_HEAD_SIGNATURE;
+    PoolHdr->StatsTag  = CryptAllocStatsRecordAlloc (RETURN_ADDRESS (0), size);
     PoolHdr->Size      = size;
+    PoolHdr->Capacity  = size;
 
     return (VOID *)(PoolHdr + 1);
   } else {
     //
     // The buffer allocation failed.
     //
+    CryptAllocStatsRecordFailure ();
     return NULL;
   }
 }
@@ -69,37 +74,71 @@ realloc (
   CRYPTMEM_HEAD  *OldPoolHdr;
   CRYPTMEM_HEAD  *NewPoolHdr;
   UINTN          OldSize;
-  UINTN          NewSize;
-  VOID           *Data;
+  UINTN          NewCapacity;
 
-  NewSize = (UINTN)size + CRYPTMEM_OVERHEAD;
-  Data    = AllocatePool (NewSize);
-  if (Data != NULL) {
-    NewPoolHdr            = (CRYPTMEM_HEAD *)Data;
-    NewPoolHdr->Signature = CRYPTMEM_HEAD_SIGNATURE;
-    NewPoolHdr->Size      = size;
-    if (ptr != NULL) {
-      //
-      // Retrieve the original size from the buffer header.
-      //
-      OldPoolHdr = (CRYPTMEM_HEAD *)ptr - 1;
-      ASSERT (OldPoolHdr->Signature == CRYPTMEM_HEAD_SIGNATURE);
-      OldSize = OldPoolHdr->Size;
+  if ((UINTN)size > MAX_UINTN - CRYPTMEM_OVERHEAD) {
+    CryptAllocStatsRecordFailure ();
+    return NULL;
+  }
+
+  OldPoolHdr  = NULL;
+  OldSize     = 0;
+  NewCapacity = (UINTN)size;
+  if (ptr != NULL) {
+    //
+    // Retrieve the original size from the buffer header.
+    //
+    OldPoolHdr = (CRYPTMEM_HEAD *)ptr - 1;
+    ASSERT (OldPoolHdr->Signature == CRYPTMEM_HEAD_SIGNATURE);
+    OldSize = OldPoolHdr->Size;
+    CryptAllocStatsRecordRealloc ();
 
+    if (size <= OldPoolHdr->Capacity) {
       //
-      // Duplicate the buffer content.
+      // Shrinking, or growing into the headroom of an earlier growth: the
+      // buffer stays where it is.
       //
-      CopyMem ((VOID *)(NewPoolHdr + 1), ptr, MIN (OldSize, size));
-      FreePool ((VOID *)OldPoolHdr);
+      CryptAllocStatsRecordFree (OldPoolHdr->StatsTag, OldSize);
+      OldPoolHdr->StatsTag = CryptAllocStatsRecordAlloc (RETURN_ADDRESS (0), size);
+      OldPoolHdr->Size     = size;
+      return ptr;
     }
 
-    return (VOID *)(NewPoolHdr + 1);
-  } else {
     //
-    // The buffer allocation failed.
+    // Buffers that grow once usually keep growing (TLS records, ASN.1
+    // encoders), so reserve half as much again. Repeated growth then costs
+    // amortized linear rather than quadratic copying.
+    //
+    NewCapacity += MIN ((UINTN)size / 2, MAX_UINTN - CRYPTMEM_OVERHEAD - (UINTN)size);
+  }
+
+  //
+  // ReallocatePool () copies the header and contents, and may grow the
+  // block in place when the underlying pool supports it.
+  //
+  NewPoolHdr = ReallocatePool (
+                 OldSize + CRYPTMEM_OVERHEAD,
+                 NewCapacity + CRYPTMEM_OVERHEAD,
+                 OldPoolHdr
+                 );
+  if (NewPoolHdr == NULL) {
     //
+    // The buffer allocation failed. The original buffer is left untouched.
+    //
+    CryptAllocStatsRecordFailure ();
     return NULL;
   }
+
+  if (OldPoolHdr != NULL) {
+    CryptAllocStatsRecordFree (NewPoolHdr->StatsTag, OldSize);
+  }
+
+  NewPoolHdr->Signature = CRYPTMEM_HEAD_SIGNATURE;
+  NewPoolHdr->StatsTag  = CryptAllocStatsRecordAlloc (RETURN_ADDRESS (0), size);
+  NewPoolHdr->Size      = size;
+  NewPoolHdr->Capacity  = NewCapacity;
+
+  return (VOID *)(NewPoolHdr + 1);
 }
 
 /* De-allocates or frees a memory block */
@@ -117,6 +156,7 @@ free (
   if (ptr != NULL) {
     PoolHdr = (CRYPTMEM_HEAD *)ptr - 1;
     ASSERT (PoolHdr->Signature == CRYPTMEM_HEAD_SIGNATURE);
+    CryptAllocStatsRecordFree (PoolHdr->StatsTag, PoolHdr->Size);
     FreePool (PoolHdr);
   }
 }
@@ -0,0 +1,361 @@
+/** @file
+  Introsort behind the qsort() wrapper.
+
+  OpenSSL, and the OpenSSL support code built with MbedTLS, sort certificate
+  stacks, name tables and DER SET OF encodings through OPENSSL_sk_sort (),
+  which calls qsort() and regularly passes input that is already sorted.
+  The median-of-three (ninther for large arrays) pivot keeps sorted and
+  reversed input at O(n log n), and a depth limit of twice the binary
+  logarithm of the count hands adversarial input over to heapsort. Only the smaller partition is recursed into, so the stack depth
+  stays logarithmic. Short ranges are finished by insertion sort.
+
+  Elements are swapped in place a word at a time when the base and width
+  allow it, and a byte at a time otherwise, so no temporary element buffer
+  is allocated.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <CrtLibSupport.h>
+
+//
+// Ranges of at most this many elements are insertion sorted.
+//
+#define SORT_INSERTION_MAX  12
+
+//
+// Ranges of at least this many elements take the pivot from the median of
+// three medians of three.
+//
+#define SORT_NINTHER_MIN  128
+
+typedef struct {
+  UINTN               Width;
+  CRT_SORT_COMPARE    Compare;
+  BOOLEAN             WordSwap;
+} CRT_SORT;
+
+/**
+  Exchanges two elements.
+
+  @param[in]      Sort  Sort parameters.
+  @param[in,out]  A     First element.
+  @param[in,out]  B     Second element.
+**/
+STATIC
+VOID
+SortSwap (
+  IN     CONST CRT_SORT  *Sort,
+  IN OUT UINT8           *A,
+  IN OUT UINT8           *B
+  )
+{
+  UINTN  *WordA;
+  UINTN  *WordB;
+  UINTN  Word;
+  UINTN  Index;
+  UINT8  Byte;
+
+  if (Sort->WordSwap) {
+    WordA = (UINTN *)A;
+    WordB = (UINTN *)B;
+    for (Index = 0; Index < Sort->Width / sizeof (UINTN); Index++) {
+      Word         = WordA[Index];
+      WordA[Index] = WordB[Index];
+      WordB[Index] = Word;
+    }
+
+    return;
+  }
+
+  for (Index = 0; Index < Sort->Width; Index++) {
+    Byte     = A[Index];
+    A[Index] = B[Index];
+    B[Index] = Byte;
+  }
+}
+
+/**
+  Returns the median of three elements.
+
+  @param[in]  Sort  Sort parameters.
+  @param[in]  A     First element.
+  @param[in]  B     Second element.
+  @param[in]  C     Third element.
+
+  @return  The one of A, B and C that is neither the smallest nor the
+           largest.
+**/
+STATIC
+UINT8 *
+SortMedian3 (
+  IN CONST CRT_SORT  *Sort,
+  IN UINT8           *A,
+  IN UINT8           *B,
+  IN UINT8           *C
+  )
+{
+  if (Sort->Compare (A, B) < 0) {
+    if (Sort->Compare (B, C) < 0) {
+      return B;
+    }
+
+    return (Sort->Compare (A, C) < 0) ? C : A;
+  }
+
+  if (Sort->Compare (A, C) < 0) {
+    return A;
+  }
+
+  return (Sort->Compare (B, C) < 0) ? C : B;
+}
+
+/**
+  Sorts a short range by insertion.
+
+  @param[in]      Sort   Sort parameters.
+  @param[in,out]  Base   First element of the range.
+  @param[in]      Count  Number of elements in the range.
+**/
+STATIC
+VOID
+SortInsertion (
+  IN     CONST CRT_SORT  *Sort,
+  IN OUT UINT8           *Base,
+  IN     UINTN           Count
+  )
+{
+  UINT8  *End;
+  UINT8  *Next;
+  UINT8  *Element;
+
+  End = Base + Count * Sort->Width;
+  for (Next = Base + Sort->Width; Next < End; Next += Sort->Width) {
+    for (Element = Next;
+         (Element > Base) && (Sort->Compare (Element - Sort->Width, Element) > 0);
+         Element -= Sort->Width)
+    {
+      SortSwap (Sort, Element - Sort->Width, Element);
+    }
+  }
+}
+
+/**
+  Moves an element down a max-heap until both of its children are not
+  greater.
+
+  @param[in]      Sort   Sort parameters.
+  @param[in,out]  Base   First element of the heap.
+  @param[in]      Root   Index of the element to move.
+  @param[in]      Count  Number of elements in the heap.
+**/
+STATIC
+VOID
+SortSiftDown (
+  IN     CONST CRT_SORT  *Sort,
+  IN OUT UINT8           *Base,
+  IN     UINTN           Root,
+  IN     UINTN           Count
+  )
+{
+  UINTN  Child;
+
+  while (Root < Count / 2) {
+    Child = 2 * Root + 1;
+    if ((Child + 1 < Count) &&
+        (Sort->Compare (Base + Child * Sort->Width, Base + (Child + 1) * Sort->Width) < 0))
+    {
+      Child++;
+    }
+
+    if (Sort->Compare (Base + Root * Sort->Width, Base + Child * Sort->Width) >= 0) {
+      return;
+    }
+
+    SortSwap (Sort, Base + Root * Sort->Width, Base + Child * Sort->Width);
+    Root = Child;
+  }
+}
+
+/**
+  Sorts a range by heapsort, once the partitioning depth limit is reached.
+
+  @param[in]      Sort   Sort parameters.
+  @param[in,out]  Base   First element of the range.
+  @param[in]      Count  Number of elements in the range.
+**/
+STATIC
+VOID
+SortHeap (
+  IN     CONST CRT_SORT  *Sort,
+  IN OUT UINT8           *Base,
+  IN     UINTN           Count
+  )
+{
+  UINTN  Index;
+
+  for (Index = Count / 2; Index > 0; Index--) {
+    SortSiftDown (Sort, Base, Index - 1, Count);
+  }
+
+  for (Index = Count - 1; Index > 0; Index--) {
+    SortSwap (Sort, Base, Base + Index * Sort->Width);
+    SortSiftDown (Sort, Base, 0, Index);
+  }
+}
+
+/**
+  Partitions a range around the median of three (or nine) elements.
+
+  Both scans stop at elements equal to the pivot, which splits runs of
+  equal elements evenly instead of degrading.
+
+  @param[in]      Sort   Sort parameters.
+  @param[in,out]  Base   First element of the range.
+  @param[in]      Count  Number of elements in the range, more than
+                         SORT_INSERTION_MAX.
+
+  @return  Final index of the pivot. Elements before it are not greater and
+           elements after it are not less.
+**/
+STATIC
+UINTN
+SortPartition (
+  IN     CONST CRT_SORT  *Sort,
+  IN OUT UINT8           *Base,
+  IN     UINTN           Count
+  )
+{
+  UINTN  Width;
+  UINTN  Step;
+  UINT8  *First;
+  UINT8  *Middle;
+  UINT8  *Last;
+  UINTN  Left;
+  UINTN  Right;
+
+  Width  = Sort->Width;
+  First  = Base;
+  Middle = Base + (Count / 2) * Width;
+  Last   = Base + (Count - 1) * Width;
+  if (Count >= SORT_NINTHER_MIN) {
+    Step   = (Count / 8) * Width;
+    First  = SortMedian3 (Sort, First, First + Step, First + 2 * Step);
+    Middle = SortMedian3 (Sort, Middle - Step, Middle, Middle + Step);
+    Last   = SortMedian3 (Sort, Last - 2 * Step, Last - Step, Last);
+  }
+
+  SortSwap (Sort, Base, SortMedian3 (Sort, First, Middle, Last));
+
+  //
+  // The pivot at index 0 stops the right scan, the bound stops the left.
+  //
+  Left  = 0;
+  Right = Count;
+  for ( ; ; ) {
+    do {
+      Left++;
+    } while ((Left < Count) && (Sort->Compare (Base + Left * Width, Base) < 0));
+
+    do {
+      Right--;
+    } while (Sort->Compare (Base, Base + Right * Width) < 0);
+
+    if (Left >= Right) {
+      break;
+    }
+
+    SortSwap (Sort, Base + Left * Width, Base + Right * Width);
+  }
+
+  SortSwap (Sort, Base, Base + Right * Width);
+  return Right;
+}
+
+/**
+  Sorts a range, recursing into the smaller partition and looping on the
+  larger one.
+
+  @param[in]      Sort   Sort parameters.
+  @param[in,out]  Base   First element of the range.
+  @param[in]      Count  Number of elements in the range.
+  @param[in]      Depth  Partitioning steps left before heapsort takes over.
+**/
+STATIC
+VOID
+SortIntro (
+  IN     CONST CRT_SORT  *Sort,
+  IN OUT UINT8           *Base,
+  IN     UINTN           Count,
+  IN     UINTN           Depth
+  )
+{
+  UINTN  Pivot;
+
+  while (Count > SORT_INSERTION_MAX) {
+    if (Depth == 0) {
+      SortHeap (Sort, Base, Count);
+      return;
+    }
+
+    Depth--;
+    Pivot = SortPartition (Sort, Base, Count);
+    if (Pivot < Count - Pivot - 1) {
+      SortIntro (Sort, Base, Pivot, Depth);
+      Base  += (Pivot + 1) * Sort->Width;
+      Count -= Pivot + 1;
+    } else {
+      SortIntro (Sort, Base + (Pivot + 1) * Sort->Width, Count - Pivot - 1, Depth);
+      Count = Pivot;
+    }
+  }
+
+  SortInsertion (Sort, Base, Count);
+}
+
+/**
+  Sorts an array in place.
+
+  The sort is not stable, as allowed for qsort().
+
+  @param[in,out]  Base     First element of the array.
+  @param[in]      Count    Number of elements.
+  @param[in]      Width    Size of an element in bytes.
+  @param[in]      Compare  Returns less than, equal to or greater than zero
+                           when its first argument orders before, with or
+                           after its second.
+**/
+VOID
+EFIAPI
+CrtQuickSort (
+  IN OUT VOID              *Base,
+  IN     UINTN             Count,
+  IN     UINTN             Width,
+  IN     CRT_SORT_COMPARE  Compare
+  )
+{
+  CRT_SORT  Sort;
+  UINTN     Depth;
+  UINTN     Remaining;
+
+  ASSERT (Compare != NULL);
+
+  if ((Count < 2) || (Width == 0)) {
+    return;
+  }
+
+  ASSERT (Base != NULL);
+
+  Sort.Width    = Width;
+  Sort.Compare  = Compare;
+  Sort.WordSwap = (BOOLEAN)((((UINTN)Base | Width) & (sizeof (UINTN) - 1)) == 0);
+
+  Depth = 0;
+  for (Remaining = Count; Remaining > 1; Remaining >>= 1) {
+    Depth += 2;
+  }
+
+  SortIntro (&Sort, (UINT8 *)Base, Count, Depth);
+}
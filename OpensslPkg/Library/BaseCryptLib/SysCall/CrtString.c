@@ -0,0 +1,462 @@
+/** @file
+  Word-at-a-time string routines behind the C runtime wrappers.
+
+  OpenSSL looks up algorithm names, OIDs and parameters on every fetch, and
+  both OpenSSL and MbedTLS parse names, PEM and certificates, with strlen(),
+  strcmp() and friends. These routines test a whole UINTN per step for the
+  terminator or the searched character, so the word size follows the
+  architecture: 8 bytes on X64 and AARCH64, 4 bytes on IA32 and ARM.
+
+  Words are only read from naturally aligned addresses. An aligned word never
+  crosses a page, so reading the bytes after a terminator within the same
+  word cannot fault, and strict-alignment targets are not affected. Two
+  strings are only compared a word at a time when they share the same
+  alignment.
+
+  Those reads still go past the end of the string object, which C leaves
+  undefined and AddressSanitizer and valgrind report. The word scans are
+  kept in the CrtWordScan* () helpers, which opt out of AddressSanitizer.
+  Host-based unit test builds define CRT_STRING_BYTE_SCAN, which turns the
+  helpers into no-ops so every string is scanned a byte at a time.
+
+  CrtStrnLen () stops after MaxLength characters, and strlen() passes
+  MAX_STRING_SIZE like the AsciiStrnLenS () mapping it replaces, so an
+  unterminated buffer is still not scanned past that bound. Its word scan
+  only reads words that lie entirely within the bound.
+
+  The memory routines stay mapped to BaseMemoryLib, whose platform selected
+  instance (for example BaseMemoryLibOptDxe) already provides architecture
+  optimized versions.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+
+#define WORD_SIZE   sizeof (UINTN)
+#define WORD_MASK   (WORD_SIZE - 1)
+#define WORD_ONES   ((UINTN)-1 / 0xFF)
+#define WORD_HIGHS  (WORD_ONES << 7)
+
+//
+// Non-zero if any byte of Word is zero.
+//
+#define WORD_HAS_ZERO(Word)  (((Word) - WORD_ONES) & ~(Word) & WORD_HIGHS)
+
+//
+// Non-zero if any byte of Word is zero or equal to the byte repeated in
+// Pattern.
+//
+#define WORD_HAS_ZERO_OR(Word, Pattern)  (WORD_HAS_ZERO (Word) | WORD_HAS_ZERO ((Word) ^ (Pattern)))
+
+//
+// Largest reject set CrtStrCspn () scans a word at a time.
+//
+#define CSPN_WORD_SET_MAX  3
+
+//
+// The word scans read the bytes after the terminator on purpose.
+//
+#if defined (__GNUC__) || defined (__clang__)
+#define CRT_WORD_SCAN_NO_SANITIZE  __attribute__ ((no_sanitize_address))
+#else
+#define CRT_WORD_SCAN_NO_SANITIZE
+#endif
+
+/**
+  Skips the words that contain no terminator.
+
+  @param[in]      String  Word aligned position in a null-terminated string.
+  @param[in,out]  Length  Number of characters left to scan.
+
+  @return  Start of the first word that contains the terminator or reaches
+           past Length, or String when CRT_STRING_BYTE_SCAN is defined.
+**/
+STATIC
+CRT_WORD_SCAN_NO_SANITIZE
+CONST CHAR8 *
+CrtWordScanZero (
+  IN     CONST CHAR8  *String,
+  IN OUT UINTN        *Length
+  )
+{
+ #ifndef CRT_STRING_BYTE_SCAN
+  CONST UINTN  *Word;
+
+  for (Word = (CONST UINTN *)String; (*Length >= WORD_SIZE) && (WORD_HAS_ZERO (*Word) == 0); Word++) {
+    *Length -= WORD_SIZE;
+  }
+
+  String = (CONST CHAR8 *)Word;
+ #endif
+  return String;
+}
+
+/**
+  Skips the words that contain neither the terminator nor any byte repeated
+  in the patterns.
+
+  @param[in]  String   Word aligned position in a null-terminated string.
+  @param[in]  Pattern  CSPN_WORD_SET_MAX characters, each repeated across a
+                       word.
+
+  @return  Start of the first word that contains a match, or String when
+           CRT_STRING_BYTE_SCAN is defined.
+**/
+STATIC
+CRT_WORD_SCAN_NO_SANITIZE
+CONST CHAR8 *
+CrtWordScanZeroOr (
+  IN CONST CHAR8  *String,
+  IN CONST UINTN  Pattern[CSPN_WORD_SET_MAX]
+  )
+{
+ #ifndef CRT_STRING_BYTE_SCAN
+  CONST UINTN  *Word;
+
+  for (Word = (CONST UINTN *)String;
+       (WORD_HAS_ZERO_OR (*Word, Pattern[0]) | WORD_HAS_ZERO ((*Word) ^ Pattern[1]) | WORD_HAS_ZERO ((*Word) ^ Pattern[2])) == 0;
+       Word++)
+  {
+  }
+
+  String = (CONST CHAR8 *)Word;
+ #endif
+  return String;
+}
+
+/**
+  Skips the words that are equal in both strings and contain no terminator.
+
+  @param[in,out]  First   Word aligned position in a null-terminated string.
+  @param[in,out]  Second  Position in a null-terminated string with the same
+                          alignment as First.
+  @param[in,out]  Length  Number of characters left to compare.
+**/
+STATIC
+CRT_WORD_SCAN_NO_SANITIZE
+VOID
+CrtWordScanEqual (
+  IN OUT CONST CHAR8  **First,
+  IN OUT CONST CHAR8  **Second,
+  IN OUT UINTN        *Length
+  )
+{
+ #ifndef CRT_STRING_BYTE_SCAN
+  CONST UINTN  *FirstWord;
+  CONST UINTN  *SecondWord;
+
+  FirstWord  = (CONST UINTN *)*First;
+  SecondWord = (CONST UINTN *)*Second;
+  while ((*Length >= WORD_SIZE) && (*FirstWord == *SecondWord) && (WORD_HAS_ZERO (*FirstWord) == 0)) {
+    FirstWord++;
+    SecondWord++;
+    *Length -= WORD_SIZE;
+  }
+
+  *First  = (CONST CHAR8 *)FirstWord;
+  *Second = (CONST CHAR8 *)SecondWord;
+ #endif
+}
+
+/**
+  Builds the 256-bit membership map of the characters of Set.
+
+  @param[in]   Set  Null-terminated set of characters.
+  @param[out]  Map  Receives one bit per character value.
+**/
+STATIC
+VOID
+CrtStrBuildMap (
+  IN  CONST CHAR8  *Set,
+  OUT UINT32       Map[8]
+  )
+{
+  UINTN  Index;
+  UINT8  Char;
+
+  for (Index = 0; Index < 8; Index++) {
+    Map[Index] = 0;
+  }
+
+  for ( ; *Set != '\0'; Set++) {
+    Char            = (UINT8)*Set;
+    Map[Char >> 5] |= 1U << (Char & 31);
+  }
+}
+
+/**
+  Returns the length of a string, scanning at most MaxLength characters.
+
+  @param[in]  String     String to measure.
+  @param[in]  MaxLength  Maximum number of characters to scan.
+
+  @return  Number of characters before the terminator, MaxLength if none of
+           the first MaxLength characters is the terminator, or 0 if String
+           is NULL.
+**/
+UINTN
+EFIAPI
+CrtStrnLen (
+  IN CONST CHAR8  *String,
+  IN UINTN        MaxLength
+  )
+{
+  CONST CHAR8  *Char;
+
+  if (String == NULL) {
+    return 0;
+  }
+
+  for (Char = String; (MaxLength != 0) && (((UINTN)Char & WORD_MASK) != 0); Char++, MaxLength--) {
+    if (*Char == '\0') {
+      return (UINTN)(Char - String);
+    }
+  }
+
+  for (Char = CrtWordScanZero (Char, &MaxLength); (MaxLength != 0) && (*Char != '\0'); Char++, MaxLength--) {
+  }
+
+  return (UINTN)(Char - String);
+}
+
+/**
+  Compares at most Length characters of two null-terminated strings.
+
+  @param[in]  First   Null-terminated string.
+  @param[in]  Second  Null-terminated string.
+  @param[in]  Length  Maximum number of characters to compare.
+
+  @retval  0       The strings are equal up to Length characters.
+  @retval  <0, >0  The difference of the first differing characters, as
+                   unsigned values.
+**/
+INTN
+EFIAPI
+CrtStrnCmp (
+  IN CONST CHAR8  *First,
+  IN CONST CHAR8  *Second,
+  IN UINTN        Length
+  )
+{
+  if ((((UINTN)First ^ (UINTN)Second) & WORD_MASK) == 0) {
+    for ( ; (Length != 0) && (((UINTN)First & WORD_MASK) != 0); First++, Second++, Length--) {
+      if ((*First != *Second) || (*First == '\0')) {
+        return (INTN)(UINT8)*First - (INTN)(UINT8)*Second;
+      }
+    }
+
+    CrtWordScanEqual (&First, &Second, &Length);
+  }
+
+  for ( ; Length != 0; First++, Second++, Length--) {
+    if ((*First != *Second) || (*First == '\0')) {
+      return (INTN)(UINT8)*First - (INTN)(UINT8)*Second;
+    }
+  }
+
+  return 0;
+}
+
+/**
+  Compares two null-terminated strings.
+
+  @param[in]  First   Null-terminated string.
+  @param[in]  Second  Null-terminated string.
+
+  @retval  0       The strings are equal.
+  @retval  <0, >0  The difference of the first differing characters, as
+                   unsigned values.
+**/
+INTN
+EFIAPI
+CrtStrCmp (
+  IN CONST CHAR8  *First,
+  IN CONST CHAR8  *Second
+  )
+{
+  return CrtStrnCmp (First, Second, MAX_UINTN);
+}
+
+/**
+  Finds the first occurrence of a character in a null-terminated string.
+
+  @param[in]  String  Null-terminated string.
+  @param[in]  Char    Character to find. The terminator can be found too.
+
+  @return  Pointer to the character, or NULL if it does not occur.
+**/
+CHAR8 *
+EFIAPI
+CrtStrChr (
+  IN CONST CHAR8  *String,
+  IN CHAR8        Char
+  )
+{
+  UINTN  Pattern[CSPN_WORD_SET_MAX];
+
+  for ( ; ((UINTN)String & WORD_MASK) != 0; String++) {
+    if (*String == Char) {
+      return (CHAR8 *)String;
+    }
+
+    if (*String == '\0') {
+      return NULL;
+    }
+  }
+
+  Pattern[0] = WORD_ONES * (UINT8)Char;
+  Pattern[1] = Pattern[0];
+  Pattern[2] = Pattern[0];
+  for (String = CrtWordScanZeroOr (String, Pattern); ; String++) {
+    if (*String == Char) {
+      return (CHAR8 *)String;
+    }
+
+    if (*String == '\0') {
+      return NULL;
+    }
+  }
+}
+
+/**
+  Finds the last occurrence of a character in a null-terminated string.
+
+  @param[in]  String  Null-terminated string.
+  @param[in]  Char    Character to find. The terminator can be found too.
+
+  @return  Pointer to the character, or NULL if it does not occur.
+**/
+CHAR8 *
+EFIAPI
+CrtStrRChr (
+  IN CONST CHAR8  *String,
+  IN CHAR8        Char
+  )
+{
+  CONST CHAR8  *Last;
+
+  Last = String + CrtStrnLen (String, MAX_UINTN);
+  while (*Last != Char) {
+    if (Last == String) {
+      return NULL;
+    }
+
+    Last--;
+  }
+
+  return (CHAR8 *)Last;
+}
+
+/**
+  Returns the length of the initial segment of String made of characters in
+  Accept.
+
+  @param[in]  String  Null-terminated string to scan.
+  @param[in]  Accept  Null-terminated set of characters.
+
+  @return  Length of the segment.
+**/
+UINTN
+EFIAPI
+CrtStrSpn (
+  IN CONST CHAR8  *String,
+  IN CONST CHAR8  *Accept
+  )
+{
+  UINT32  Map[8];
+  UINTN   Count;
+  UINT8   Char;
+
+  CrtStrBuildMap (Accept, Map);
+  Map[0] &= ~1U;
+
+  for (Count = 0; ; Count++) {
+    Char = (UINT8)String[Count];
+    if ((Map[Char >> 5] & (1U << (Char & 31))) == 0) {
+      return Count;
+    }
+  }
+}
+
+/**
+  Returns the length of the initial segment of String made of characters
+  not in Reject.
+
+  Reject sets of up to CSPN_WORD_SET_MAX characters, such as the separators
+  OpenSSL splits names and property queries at, are scanned a word at a
+  time.
+
+  @param[in]  String  Null-terminated string to scan.
+  @param[in]  Reject  Null-terminated set of characters.
+
+  @return  Length of the segment.
+**/
+UINTN
+EFIAPI
+CrtStrCspn (
+  IN CONST CHAR8  *String,
+  IN CONST CHAR8  *Reject
+  )
+{
+  UINT32       Map[8];
+  UINTN        Pattern[CSPN_WORD_SET_MAX];
+  UINTN        Index;
+  CONST CHAR8  *Char;
+  UINT8        Byte;
+
+  CrtStrBuildMap (Reject, Map);
+  Map[0] |= 1U;
+
+  Char = String;
+  for (Index = 0; (Index < CSPN_WORD_SET_MAX) && (Reject[Index] != '\0'); Index++) {
+    Pattern[Index] = WORD_ONES * (UINT8)Reject[Index];
+  }
+
+  if ((Index != 0) && (Reject[Index] == '\0')) {
+    //
+    // Repeat the first character in unused slots so every word test is
+    // the same.
+    //
+    for ( ; Index < CSPN_WORD_SET_MAX; Index++) {
+      Pattern[Index] = Pattern[0];
+    }
+
+    for ( ; ((UINTN)Char & WORD_MASK) != 0; Char++) {
+      Byte = (UINT8)*Char;
+      if ((Map[Byte >> 5] & (1U << (Byte & 31))) != 0) {
+        return (UINTN)(Char - String);
+      }
+    }
+
+    Char = CrtWordScanZeroOr (Char, Pattern);
+  }
+
+  for ( ; ; Char++) {
+    Byte = (UINT8)*Char;
+    if ((Map[Byte >> 5] & (1U << (Byte & 31))) != 0) {
+      return (UINTN)(Char - String);
+    }
+  }
+}
+
+/**
+  Finds the first character of String that is in Accept.
+
+  @param[in]  String  Null-terminated string to scan.
+  @param[in]  Accept  Null-terminated set of characters.
+
+  @return  Pointer to the character, or NULL if none occurs.
+**/
+CHAR8 *
+EFIAPI
+CrtStrPbrk (
+  IN CONST CHAR8  *String,
+  IN CONST CHAR8  *Accept
+  )
+{
+  String += CrtStrCspn (String, Accept);
+  return (*String != '\0') ? (CHAR8 *)String : NULL;
+}
@@ -8,6 +8,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 
 #include <CrtLibSupport.h>
+#include <Library/PcdLib.h> // MU_CHANGE
 
 int  errno = 0;
 
@@ -15,98 +16,6 @@ FILE  *stderr = NULL;
 FILE  *stdin  = NULL;
 FILE  *stdout = NULL;
 
-typedef
-int
-(*SORT_COMPARE)(
-  IN  VOID  *Buffer1,
-  IN  VOID  *Buffer2
-  );
-
-//
-// Duplicated from EDKII BaseSortLib for qsort() wrapper
-//
-STATIC
-VOID
-QuickSortWorker (
-  IN OUT    VOID          *BufferToSort,
-  IN CONST  UINTN         Count,
-  IN CONST  UINTN         ElementSize,
-  IN        SORT_COMPARE  CompareFunction,
-  IN        VOID          *Buffer
-  )
-{
-  VOID   *Pivot;
-  UINTN  LoopCount;
-  UINTN  NextSwapLocation;
-
-  ASSERT (BufferToSort    != NULL);
-  ASSERT (CompareFunction != NULL);
-  ASSERT (Buffer          != NULL);
-
-  if ((Count < 2) || (ElementSize  < 1)) {
-    return;
-  }
-
-  NextSwapLocation = 0;
-
-  //
-  // Pick a pivot (we choose last element)
-  //
-  Pivot = ((UINT8 *)BufferToSort + ((Count - 1) * ElementSize));
-
-  //
-  // Now get the pivot such that all on "left" are below it
-  // and everything "right" are above it
-  //
-  for (LoopCount = 0; LoopCount < Count - 1; LoopCount++) {
-    //
-    // If the element is less than the pivot
-    //
-    if (CompareFunction ((VOID *)((UINT8 *)BufferToSort + ((LoopCount) * ElementSize)), Pivot) <= 0) {
-      //
-      // Swap
-      //
-      CopyMem (Buffer, (UINT8 *)BufferToSort + (NextSwapLocation * ElementSize), ElementSize);
-      CopyMem ((UINT8 *)BufferToSort + (NextSwapLocation * ElementSize), (UINT8 *)BufferToSort + ((LoopCount) * ElementSize), ElementSize);
-      CopyMem ((UINT8 *)BufferToSort + ((LoopCount) * ElementSize), Buffer, ElementSize);
-
-      //
-      // Increment NextSwapLocation
-      //
-      NextSwapLocation++;
-    }
-  }
-
-  //
-  // Swap pivot to its final position (NextSwapLocation)
-  //
-  CopyMem (Buffer, Pivot, ElementSize);
-  CopyMem (Pivot, (UINT8 *)BufferToSort + (NextSwapLocation * ElementSize), ElementSize);
-  CopyMem ((UINT8 *)BufferToSort + (NextSwapLocation * ElementSize), Buffer, ElementSize);
-
-  //
-  // Now recurse on 2 partial lists.  Neither of these will have the 'pivot' element.
-  // IE list is sorted left half, pivot element, sorted right half...
-  //
-  QuickSortWorker (
-    BufferToSort,
-    NextSwapLocation,
-    ElementSize,
-    CompareFunction,
-    Buffer
-    );
-
-  QuickSortWorker (
-    (UINT8 *)BufferToSort + (NextSwapLocation + 1) * ElementSize,
-    Count - NextSwapLocation - 1,
-    ElementSize,
-    CompareFunction,
-    Buffer
-    );
-
-  return;
-}
-
 // ---------------------------------------------------------
 // Standard C Run-time Library Interface Wrapper
 // ---------------------------------------------------------
@@ -121,7 +30,7 @@ strchr (
   int         ch
   )
 {
-  return ScanMem8 (str, AsciiStrSize (str), (UINT8)ch);
+  return CrtStrChr (str, (CHAR8)ch); // MU_CHANGE
 }
 
 /* Scan a string for the last occurrence of a character */
@@ -131,17 +40,7 @@ strrchr (
   int         c
   )
 {
-  char  *save;
-
-  for (save = NULL; ; ++str) {
-    if (*str == c) {
-      save = (char *)str;
-    }
-
-    if (*str == 0) {
-      return (save);
-    }
-  }
+  return CrtStrRChr (str, (CHAR8)c); // MU_CHANGE
 }
 
 /* Compare first n bytes of string s1 with string s2, ignoring case */
@@ -207,30 +106,7 @@ strspn (
   const char  *s2
   )
 {
-  UINT8   Map[32];
-  UINT32  Index;
-  size_t  Count;
-
-  for (Index = 0; Index < 32; Index++) {
-    Map[Index] = 0;
-  }
-
-  while (*s2) {
-    Map[*s2 >> 3] |= (1 << (*s2 & 7));
-    s2++;
-  }
-
-  if (*s1) {
-    Count = 0;
-    while (Map[*s1 >> 3] & (1 << (*s1 & 7))) {
-      Count++;
-      s1++;
-    }
-
-    return Count;
-  }
-
-  return 0;
+  return CrtStrSpn (s1, s2); // MU_CHANGE
 }
 
 /* Computes the length of the maximum initial segment of the string pointed to by s1
@@ -241,28 +117,7 @@ strcspn (
   const char  *s2
   )
 {
-  UINT8   Map[32];
-  UINT32  Index;
-  size_t  Count;
-
-  for (Index = 0; Index < 32; Index++) {
-    Map[Index] = 0;
-  }
-
-  while (*s2) {
-    Map[*s2 >> 3] |= (1 << (*s2 & 7));
-    s2++;
-  }
-
-  Map[0] |= 1;
-
-  Count = 0;
-  while (!(Map[*s1 >> 3] & (1 << (*s1 & 7)))) {
-    Count++;
-    s1++;
-  }
-
-  return Count;
+  return CrtStrCspn (s1, s2); // MU_CHANGE
 }
 
 char *
@@ -320,7 +175,7 @@ strcmp (
   const char  *s2
   )
 {
-  return (int)AsciiStrCmp (s1, s2);
+  return (int)CrtStrCmp (s1, s2); // MU_CHANGE
 }
 
 //
@@ -431,17 +286,7 @@ strpbrk (
   const char  *accept
   )
 {
-  int  i;
-
-  for ( ; *s != '\0'; s++) {
-    for (i = 0; accept[i] != '\0'; i++) {
-      if (*s == accept[i]) {
-        return (char *)s;
-      }
-    }
-  }
-
-  return NULL;
+  return CrtStrPbrk (s, accept); // MU_CHANGE
 }
 
 /* Convert character to lowercase */
@@ -470,27 +315,7 @@ qsort (
   int ( *compare )(const void *, const void *)
   )
 {
-  VOID  *Buffer;
-
-  ASSERT (base    != NULL);
-  ASSERT (compare != NULL);
-
-  //
-  // Use CRT-style malloc to cover BS and RT memory allocation.
-  //
-  Buffer = malloc (width);
-  if (Buffer == NULL) {
-    ASSERT (Buffer != NULL);
-    return;
-  }
-
-  //
-  // Re-use PerformQuickSort() function Implementation in EDKII BaseSortLib.
-  //
-  QuickSortWorker (base, (UINTN)num, (UINTN)width, (SORT_COMPARE)compare, Buffer);
-
-  free (Buffer);
-  return;
+  CrtQuickSort (base, (UINTN)num, (UINTN)width, compare); // MU_CHANGE
 }
 
 //
@@ -503,6 +328,27 @@ getenv (
   const char  *varname
   )
 {
+  // MU_CHANGE [BEGIN]
+  CONST CHAR8  *Value;
+
+  //
+  // OpenSSL reads its CPU capability overrides from OPENSSL_ia32cap and
+  // OPENSSL_armcap. Serve those from the platform PCDs.
+  //
+  if (AsciiStrCmp (varname, "OPENSSL_ia32cap") == 0) {
+    Value = (CONST CHAR8 *)FixedPcdGetPtr (PcdOpensslIa32CapOverride);
+  } else if (AsciiStrCmp (varname, "OPENSSL_armcap") == 0) {
+    Value = (CONST CHAR8 *)FixedPcdGetPtr (PcdOpensslArmCapOverride);
+  } else {
+    Value = NULL;
+  }
+
+  if ((Value != NULL) && (*Value != '\0')) {
+    return (char *)Value;
+  }
+
+  // MU_CHANGE [END]
+
   //
   // Null getenv() function implementation to satisfy the linker, since there is
   // no direct functionality logic dependency in present UEFI cases.
@@ -0,0 +1,318 @@
+/** @file
+  Allocation statistics recorder for the C runtime allocation wrappers.
+
+  Recording is compiled into DEBUG builds only and is switched on with
+  PcdCryptAllocStatsEnable. Call sites are identified by the return address
+  of the malloc()/realloc() caller; resolve them against the module map file.
+  Note that OpenSSL funnels its allocations through CRYPTO_malloc() and
+  friends, so the per-site table mostly separates OpenSSL from direct CRT
+  users. Snapshot deltas around an API call give the per-API cost.
+
+  The recorder is not MP safe; it relies on the crypto library only being
+  called from one processor at a time.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/PcdLib.h>
+#include "CryptAllocStatsInternal.h"
+
+//
+// Statistics are a debugging aid; RELEASE builds never record them.
+//
+#if defined (MDEPKG_NDEBUG)
+  #define ALLOC_STATS_ENABLED()  FALSE
+#else
+  #define ALLOC_STATS_ENABLED()  FeaturePcdGet (PcdCryptAllocStatsEnable)
+#endif
+
+//
+// A tag stored with each buffer packs the reset generation in the upper 16
+// bits and the call site index + 1 in the lower 16 bits (0 = untracked
+// site). Frees of buffers from an earlier generation only update the totals.
+//
+#define TAG_GENERATION_SHIFT  16
+#define TAG_SITE_MASK         0xFFFF
+
+STATIC CRYPT_ALLOC_STATS  mAllocStats;
+STATIC UINT16             mGeneration = 1;
+
+/**
+  Returns the histogram bucket of an allocation size.
+
+  @param[in]  Size  Requested size in bytes.
+
+  @return  Index into CRYPT_ALLOC_STATS.Histogram.
+**/
+STATIC
+UINTN
+SizeToBucket (
+  IN UINTN  Size
+  )
+{
+  UINTN  Bucket;
+  UINTN  Limit;
+
+  Bucket = 0;
+  Limit  = 16;
+  while ((Size > Limit) && (Bucket < CRYPT_ALLOC_STATS_BUCKETS - 1)) {
+    Limit <<= 1;
+    Bucket++;
+  }
+
+  return Bucket;
+}
+
+/**
+  Records one successful allocation.
+
+  @param[in]  CallSite  Return address of the malloc()/realloc() caller.
+  @param[in]  Size      Requested size in bytes.
+
+  @return  Tag to store with the buffer and pass back to
+           CryptAllocStatsRecordFree (). Zero if nothing was recorded.
+**/
+UINT32
+CryptAllocStatsRecordAlloc (
+  IN VOID   *CallSite,
+  IN UINTN  Size
+  )
+{
+  UINTN                   Index;
+  CRYPT_ALLOC_SITE_STATS  *Site;
+
+  if (!ALLOC_STATS_ENABLED ()) {
+    return 0;
+  }
+
+  mAllocStats.Allocations++;
+  mAllocStats.TotalBytes += Size;
+  mAllocStats.LiveBytes  += Size;
+  if (mAllocStats.LiveBytes > mAllocStats.PeakBytes) {
+    mAllocStats.PeakBytes = mAllocStats.LiveBytes;
+  }
+
+  mAllocStats.Histogram[SizeToBucket (Size)]++;
+
+  for (Index = 0; Index < mAllocStats.SiteCount; Index++) {
+    if (mAllocStats.Sites[Index].CallSite == (UINTN)CallSite) {
+      break;
+    }
+  }
+
+  if (Index == mAllocStats.SiteCount) {
+    if (Index == CRYPT_ALLOC_STATS_MAX_SITES) {
+      mAllocStats.UntrackedSiteAllocations++;
+      return (UINT32)mGeneration << TAG_GENERATION_SHIFT;
+    }
+
+    mAllocStats.Sites[Index].CallSite = (UINTN)CallSite;
+    mAllocStats.SiteCount++;
+  }
+
+  Site = &mAllocStats.Sites[Index];
+  Site->Allocations++;
+  Site->TotalBytes += Size;
+  Site->LiveBytes  += Size;
+
+  return ((UINT32)mGeneration << TAG_GENERATION_SHIFT) | (UINT32)(Index + 1);
+}
+
+/**
+  Records one free of a buffer previously passed to
+  CryptAllocStatsRecordAlloc ().
+
+  @param[in]  Tag   Tag returned when the buffer was allocated.
+  @param[in]  Size  Requested size of the buffer in bytes.
+**/
+VOID
+CryptAllocStatsRecordFree (
+  IN UINT32  Tag,
+  IN UINTN   Size
+  )
+{
+  UINTN                   SiteIndex;
+  CRYPT_ALLOC_SITE_STATS  *Site;
+
+  if (Tag == 0) {
+    return;
+  }
+
+  mAllocStats.LiveBytes -= MIN (Size, mAllocStats.LiveBytes);
+  if ((Tag >> TAG_GENERATION_SHIFT) != mGeneration) {
+    return;
+  }
+
+  mAllocStats.Frees++;
+  SiteIndex = Tag & TAG_SITE_MASK;
+  if ((SiteIndex != 0) && (SiteIndex <= mAllocStats.SiteCount)) {
+    Site = &mAllocStats.Sites[SiteIndex - 1];
+    Site->Frees++;
+    Site->LiveBytes -= MIN (Size, Site->LiveBytes);
+  }
+}
+
+/**
+  Records a realloc() of an existing buffer, whether it was resized in place
+  or moved. The allocation and the free of the old size are recorded
+  separately.
+**/
+VOID
+CryptAllocStatsRecordRealloc (
+  VOID
+  )
+{
+  if (ALLOC_STATS_ENABLED ()) {
+    mAllocStats.Reallocations++;
+  }
+}
+
+/**
+  Records a failed allocation.
+**/
+VOID
+CryptAllocStatsRecordFailure (
+  VOID
+  )
+{
+  if (ALLOC_STATS_ENABLED ()) {
+    mAllocStats.Failures++;
+  }
+}
+
+/**
+  Retrieves a snapshot of the allocation statistics.
+
+  @param[out]  Stats  Receives the statistics.
+
+  @retval  EFI_SUCCESS            Stats was filled in.
+  @retval  EFI_INVALID_PARAMETER  Stats is NULL.
+  @retval  EFI_UNSUPPORTED        Allocation statistics are not built in.
+**/
+EFI_STATUS
+EFIAPI
+CryptAllocStatsGet (
+  OUT CRYPT_ALLOC_STATS  *Stats
+  )
+{
+  if (!ALLOC_STATS_ENABLED ()) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (Stats == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  CopyMem (Stats, &mAllocStats, sizeof (*Stats));
+  return EFI_SUCCESS;
+}
+
+/**
+  Clears the counters and call site table. Live byte accounting of buffers
+  allocated before the reset is kept so LiveBytes stays accurate.
+
+  @retval  EFI_SUCCESS      The statistics were reset.
+  @retval  EFI_UNSUPPORTED  Allocation statistics are not built in.
+**/
+EFI_STATUS
+EFIAPI
+CryptAllocStatsReset (
+  VOID
+  )
+{
+  UINT64  LiveBytes;
+
+  if (!ALLOC_STATS_ENABLED ()) {
+    return EFI_UNSUPPORTED;
+  }
+
+  LiveBytes = mAllocStats.LiveBytes;
+  ZeroMem (&mAllocStats, sizeof (mAllocStats));
+  mAllocStats.LiveBytes = LiveBytes;
+  mAllocStats.PeakBytes = LiveBytes;
+
+  //
+  // Generation 0 is never used so that a zero tag always means "not recorded".
+  //
+  mGeneration++;
+  if (mGeneration == 0) {
+    mGeneration = 1;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Prints the allocation statistics through DebugLib. In OneCrypto builds this
+  ends up in OneCryptoDebugPrint.
+
+  @param[in]  ErrorLevel  DEBUG error level to print at, e.g. DEBUG_INFO.
+
+  @retval  EFI_SUCCESS      The statistics were printed.
+  @retval  EFI_UNSUPPORTED  Allocation statistics are not built in.
+**/
+EFI_STATUS
+EFIAPI
+CryptAllocStatsDump (
+  IN UINTN  ErrorLevel
+  )
+{
+  UINTN                   Index;
+  CRYPT_ALLOC_SITE_STATS  *Site;
+
+  if (!ALLOC_STATS_ENABLED ()) {
+    return EFI_UNSUPPORTED;
+  }
+
+  DEBUG ((
+    ErrorLevel,
+    "CryptAllocStats: allocs %lu, reallocs %lu, frees %lu, failures %lu\n",
+    mAllocStats.Allocations,
+    mAllocStats.Reallocations,
+    mAllocStats.Frees,
+    mAllocStats.Failures
+    ));
+  DEBUG ((
+    ErrorLevel,
+    "CryptAllocStats: total %lu bytes, live %lu bytes, peak %lu bytes\n",
+    mAllocStats.TotalBytes,
+    mAllocStats.LiveBytes,
+    mAllocStats.PeakBytes
+    ));
+
+  for (Index = 0; Index < CRYPT_ALLOC_STATS_BUCKETS; Index++) {
+    if (mAllocStats.Histogram[Index] == 0) {
+      continue;
+    }
+
+    if (Index == CRYPT_ALLOC_STATS_BUCKETS - 1) {
+      DEBUG ((ErrorLevel, "CryptAllocStats:   > %lu bytes: %lu\n", (UINT64)(16 << (Index - 1)), mAllocStats.Histogram[Index]));
+    } else {
+      DEBUG ((ErrorLevel, "CryptAllocStats:  <= %lu bytes: %lu\n", (UINT64)(16 << Index), mAllocStats.Histogram[Index]));
+    }
+  }
+
+  for (Index = 0; Index < mAllocStats.SiteCount; Index++) {
+    Site = &mAllocStats.Sites[Index];
+    DEBUG ((
+      ErrorLevel,
+      "CryptAllocStats: site 0x%p: allocs %lu, frees %lu, bytes %lu, live %lu\n",
+      (VOID *)Site->CallSite,
+      Site->Allocations,
+      Site->Frees,
+      Site->TotalBytes,
+      Site->LiveBytes
+      ));
+  }
+
+  if (mAllocStats.UntrackedSiteAllocations != 0) {
+    DEBUG ((ErrorLevel, "CryptAllocStats: untracked sites: allocs %lu\n", mAllocStats.UntrackedSiteAllocations));
+  }
+
+  return EFI_SUCCESS;
+}
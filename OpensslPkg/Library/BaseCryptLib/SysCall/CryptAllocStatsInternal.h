@@ -0,0 +1,61 @@
+/** @file
+  Internal interface between the C runtime allocation wrappers and the
+  allocation statistics recorder.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef CRYPT_ALLOC_STATS_INTERNAL_H_
+#define CRYPT_ALLOC_STATS_INTERNAL_H_
+
+#include <CryptAllocStats.h>
+
+/**
+  Records one successful allocation.
+
+  @param[in]  CallSite  Return address of the malloc()/realloc() caller.
+  @param[in]  Size      Requested size in bytes.
+
+  @return  Tag to store with the buffer and pass back to
+           CryptAllocStatsRecordFree (). Zero if nothing was recorded.
+**/
+UINT32
+CryptAllocStatsRecordAlloc (
+  IN VOID   *CallSite,
+  IN UINTN  Size
+  );
+
+/**
+  Records one free of a buffer previously passed to
+  CryptAllocStatsRecordAlloc ().
+
+  @param[in]  Tag   Tag returned when the buffer was allocated.
+  @param[in]  Size  Requested size of the buffer in bytes.
+**/
+VOID
+CryptAllocStatsRecordFree (
+  IN UINT32  Tag,
+  IN UINTN   Size
+  );
+
+/**
+  Records a realloc() of an existing buffer, whether it was resized in place
+  or moved. The allocation and the free of the old size are recorded
+  separately.
+**/
+VOID
+CryptAllocStatsRecordRealloc (
+  VOID
+  );
+
+/**
+  Records a failed allocation.
+**/
+VOID
+CryptAllocStatsRecordFailure (
+  VOID
+  );
+
+#endif // CRYPT_ALLOC_STATS_INTERNAL_H_
@@ -0,0 +1,69 @@
+/** @file
+  Null allocation statistics recorder for BaseCryptLib instances that cannot
+  keep writable globals (SEC and PEI).
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include "CryptAllocStatsInternal.h"
+
+UINT32
+CryptAllocStatsRecordAlloc (
+  IN VOID   *CallSite,
+  IN UINTN  Size
+  )
+{
+  return 0;
+}
+
+VOID
+CryptAllocStatsRecordFree (
+  IN UINT32  Tag,
+  IN UINTN   Size
+  )
+{
+}
+
+VOID
+CryptAllocStatsRecordRealloc (
+  VOID
+  )
+{
+}
+
+VOID
+CryptAllocStatsRecordFailure (
+  VOID
+  )
+{
+}
+
+EFI_STATUS
+EFIAPI
+CryptAllocStatsGet (
+  OUT CRYPT_ALLOC_STATS  *Stats
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+EFI_STATUS
+EFIAPI
+CryptAllocStatsReset (
+  VOID
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+EFI_STATUS
+EFIAPI
+CryptAllocStatsDump (
+  IN UINTN  ErrorLevel
+  )
+{
+  return EFI_UNSUPPORTED;
+}
@@ -13,6 +13,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 // #include <Library/UefiRuntimeServicesTableLib.h> // MU_CHANGE
 #include <Library/RealTimeClockLib.h>               // MU_CHANGE
 #include <Library/TimerLib.h>                       // MU_CHANGE
+#include <Library/PcdLib.h>                         // MU_CHANGE
 
 //
 // -- Time Management Routines --
@@ -115,10 +116,92 @@ CalculateTimeT (
   return CalTime;
 }
 
+// MU_CHANGE [BEGIN]
+
+//
+// OpenSSL calls time() many times while verifying a certificate chain or
+// running a TLS handshake. time() reads the real time clock once, then
+// extrapolates from the performance counter until PcdCryptTimeResyncInterval
+// seconds have passed.
+//
+
+//
+// A performance counter that wraps sooner than this could wrap unnoticed
+// between two time() calls, so it is not used to extrapolate the time.
+//
+#define TIME_CACHE_MIN_WRAP_SECONDS  (10ULL * 365 * SECSPERDAY)
+
+//
+// Performance counter properties. mCounterFrequency is 0 until the counter
+// was checked, or if it is not suitable for extrapolation.
+//
+STATIC BOOLEAN  mCounterChecked;
+STATIC UINT64   mCounterFrequency;
+STATIC UINT64   mCounterStart;
+STATIC UINT64   mCounterEnd;
+
+//
+// Real time clock value and performance counter at the last resync.
+//
+STATIC BOOLEAN  mTimeSynced;
+STATIC time_t   mTimeBase;
+STATIC UINT64   mCounterBase;
+
+/**
+  Checks once whether the performance counter can extrapolate the time.
+
+  @retval  TRUE   mCounterFrequency, mCounterStart and mCounterEnd are valid.
+  @retval  FALSE  The counter has no frequency or wraps too soon.
+**/
+STATIC
+BOOLEAN
+TimeCacheCounterUsable (
+  VOID
+  )
+{
+  UINT64  Range;
+
+  if (!mCounterChecked) {
+    mCounterChecked   = TRUE;
+    mCounterFrequency = GetPerformanceCounterProperties (&mCounterStart, &mCounterEnd);
+    Range             = (mCounterStart < mCounterEnd) ? mCounterEnd - mCounterStart : mCounterStart - mCounterEnd;
+    if ((mCounterFrequency == 0) ||
+        (DivU64x64Remainder (Range, mCounterFrequency, NULL) < TIME_CACHE_MIN_WRAP_SECONDS))
+    {
+      mCounterFrequency = 0;
+    }
+  }
+
+  return (BOOLEAN)(mCounterFrequency != 0);
+}
+
+/**
+  Returns the whole seconds elapsed since the last resync.
+
+  @return  Seconds elapsed since mCounterBase was taken.
+**/
+STATIC
+UINT64
+TimeCacheElapsedSeconds (
+  VOID
+  )
+{
+  UINT64  Counter;
+  UINT64  Ticks;
+
+  Counter = GetPerformanceCounter ();
+  if (mCounterStart < mCounterEnd) {
+    Ticks = (Counter >= mCounterBase) ? Counter - mCounterBase
+                                      : (mCounterEnd - mCounterBase) + (Counter - mCounterStart) + 1;
+  } else {
+    Ticks = (Counter <= mCounterBase) ? mCounterBase - Counter
+                                      : (mCounterBase - mCounterEnd) + (mCounterStart - Counter) + 1;
+  }
+
+  return DivU64x64Remainder (Ticks, mCounterFrequency, NULL);
+}
+
 /* Get the system time as seconds elapsed since midnight, January 1, 1970. */
-// INTN time(
-//  INTN *timer
-//  )
 time_t
 time (
   time_t  *timer
@@ -127,17 +210,42 @@ time (
   EFI_STATUS  Status;
   EFI_TIME    Time;
   time_t      CalTime;
+  UINT64      Elapsed;
+  UINT32      Interval;
+
+  //
+  // Extrapolate from the last real time clock read while it is recent.
+  //
+  Interval = FixedPcdGet32 (PcdCryptTimeResyncInterval);
+  if (mTimeSynced) {
+    Elapsed = TimeCacheElapsedSeconds ();
+    if (Elapsed < Interval) {
+      CalTime = mTimeBase + (time_t)Elapsed;
+      if (timer != NULL) {
+        *timer = CalTime;
+      }
+
+      return CalTime;
+    }
+  }
 
   //
   // Get the current time and date information
   //
-  Status = LibGetTime (&Time, NULL); // MU_CHANGE
+  mTimeSynced = FALSE;
+  Status      = LibGetTime (&Time, NULL);
   if (EFI_ERROR (Status) || (Time.Year < 1970)) {
     return 0;
   }
 
   CalTime = CalculateTimeT (&Time);
 
+  if ((Interval != 0) && TimeCacheCounterUsable ()) {
+    mTimeBase    = CalTime;
+    mCounterBase = GetPerformanceCounter ();
+    mTimeSynced  = TRUE;
+  }
+
   if (timer != NULL) {
     *timer = CalTime;
   }
@@ -145,6 +253,8 @@ time (
   return CalTime;
 }
 
+// MU_CHANGE [END]
+
 time_t
 mktime (
   struct tm  *t
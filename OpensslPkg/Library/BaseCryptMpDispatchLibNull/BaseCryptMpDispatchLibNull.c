@@ -0,0 +1,61 @@
+/** @file
+  CryptMpDispatchLib instance without APs. Work handed to it runs on the
+  calling processor only.
+
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/CryptMpDispatchLib.h>
+
+/**
+  Run a procedure on each AP.
+
+  There is no AP to run Procedure. The caller does the work itself.
+
+  @param[in]  Procedure  Procedure to run on each AP.
+  @param[in]  Argument   Argument passed to Procedure.
+
+  @return  0, no AP is running Procedure.
+**/
+UINTN
+EFIAPI
+DispatchToAp (
+  IN EFI_AP_PROCEDURE  Procedure,
+  IN VOID              *Argument
+  )
+{
+  return 0;
+}
+
+/**
+  Run a procedure once on the calling processor.
+
+  @param[in]   Procedure  Procedure to run.
+  @param[in]   Argument   Argument passed to Procedure.
+  @param[in]   WaitEvent  Must be NULL.
+  @param[out]  Running    Set to 0, no AP is running Procedure.
+
+  @retval EFI_SUCCESS      Procedure has completed.
+  @retval EFI_UNSUPPORTED  WaitEvent is not NULL.
+**/
+EFI_STATUS
+EFIAPI
+DispatchToApAsync (
+  IN  EFI_AP_PROCEDURE  Procedure,
+  IN  VOID              *Argument,
+  IN  EFI_EVENT         WaitEvent  OPTIONAL,
+  OUT UINTN             *Running
+  )
+{
+  *Running = 0;
+
+  if (WaitEvent != NULL) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Procedure (Argument);
+  return EFI_SUCCESS;
+}
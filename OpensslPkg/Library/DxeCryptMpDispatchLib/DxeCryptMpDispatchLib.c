@@ -0,0 +1,145 @@
+/** @file
+  Start BaseCryptLib work on the APs through the DXE MP services protocol.
+
+Copyright (c) 2022, Intel Corporation. All rights reserved.<BR>
+Copyright (c) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/CryptMpDispatchLib.h>
+#include <Library/DebugLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Protocol/MpService.h>
+
+//
+// Event passed to StartupAllAPs () when the caller of DispatchToApAsync () has
+// none. Nothing waits on it.
+//
+STATIC EFI_EVENT  mDispatchWaitEvent = NULL;
+
+/**
+  Run a procedure on each AP in DXE phase.
+
+  StartupAllAPs () is called in blocking mode, so all APs are done when this
+  function returns.
+
+  @param[in]  Procedure  Procedure to run on each AP.
+  @param[in]  Argument   Argument passed to Procedure.
+
+  @return  0, no AP is still running Procedure.
+**/
+UINTN
+EFIAPI
+DispatchToAp (
+  IN EFI_AP_PROCEDURE  Procedure,
+  IN VOID              *Argument
+  )
+{
+  EFI_STATUS                Status;
+  EFI_MP_SERVICES_PROTOCOL  *MpServices;
+
+  Status = gBS->LocateProtocol (
+                  &gEfiMpServiceProtocolGuid,
+                  NULL,
+                  (VOID **)&MpServices
+                  );
+  if (EFI_ERROR (Status)) {
+    //
+    // Failed to locate MpServices Protocol, do parallel hash by one core.
+    //
+    DEBUG ((DEBUG_ERROR, "[DispatchToApDxe] Failed to locate MpServices Protocol. Status = %r\n", Status));
+    return 0;
+  }
+
+  Status = MpServices->StartupAllAPs (
+                         MpServices,
+                         Procedure,
+                         FALSE,
+                         NULL,
+                         0,
+                         Argument,
+                         NULL
+                         );
+  return 0;
+}
+
+/**
+  Start a procedure on each AP in DXE phase and return without waiting for
+  the APs.
+
+  StartupAllAPs () returns at once when it is given an event to signal, so
+  the calling processor goes on while the APs run Procedure.
+
+  @param[in]   Procedure  Procedure to run on each AP.
+  @param[in]   Argument   Argument passed to Procedure.
+  @param[in]   WaitEvent  Event signalled once every AP has returned from
+                          Procedure, or NULL.
+  @param[out]  Running    Number of APs that may still be running Procedure.
+
+  @retval EFI_SUCCESS  Procedure was started, or has run on the calling
+                       processor.
+**/
+EFI_STATUS
+EFIAPI
+DispatchToApAsync (
+  IN  EFI_AP_PROCEDURE  Procedure,
+  IN  VOID              *Argument,
+  IN  EFI_EVENT         WaitEvent  OPTIONAL,
+  OUT UINTN             *Running
+  )
+{
+  EFI_STATUS                Status;
+  EFI_MP_SERVICES_PROTOCOL  *MpServices;
+  UINTN                     NumberOfProcessors;
+  UINTN                     NumberOfEnabledProcessors;
+
+  *Running = 0;
+
+  Status = gBS->LocateProtocol (
+                  &gEfiMpServiceProtocolGuid,
+                  NULL,
+                  (VOID **)&MpServices
+                  );
+  if (!EFI_ERROR (Status)) {
+    Status = MpServices->GetNumberOfProcessors (
+                           MpServices,
+                           &NumberOfProcessors,
+                           &NumberOfEnabledProcessors
+                           );
+  }
+
+  if (!EFI_ERROR (Status) && (WaitEvent == NULL) && (mDispatchWaitEvent == NULL)) {
+    Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &mDispatchWaitEvent);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = MpServices->StartupAllAPs (
+                           MpServices,
+                           Procedure,
+                           FALSE,
+                           (WaitEvent != NULL) ? WaitEvent : mDispatchWaitEvent,
+                           0,
+                           Argument,
+                           NULL
+                           );
+  }
+
+  if (EFI_ERROR (Status)) {
+    //
+    // There is no AP, or the APs are still busy with an earlier request, so
+    // run Procedure here and report completion.
+    //
+    DEBUG ((DEBUG_INFO, "[DispatchToApAsyncDxe] APs not started, run on the BSP. Status = %r\n", Status));
+    Procedure (Argument);
+    if (WaitEvent != NULL) {
+      gBS->SignalEvent (WaitEvent);
+    }
+
+    return EFI_SUCCESS;
+  }
+
+  *Running = NumberOfEnabledProcessors - 1;
+  return EFI_SUCCESS;
+}
@@ -19,6 +19,75 @@ OPENSSL_cpuid_setup (
   VOID
   );
 
+// MU_CHANGE [BEGIN]
+#if defined (OPENSSL_CPUID_OBJ)
+  #if defined (MDE_CPU_IA32) || defined (MDE_CPU_X64)
+extern UINT32  OPENSSL_ia32cap_P[];
+
+//
+// OPENSSL_IA32CAP_P_MAX_INDEXES of OpenSSL 3.5.
+//
+  #define OPENSSL_CAPABILITY_WORDS   10
+  #define OPENSSL_CAPABILITY(Index)  OPENSSL_ia32cap_P[Index]
+  #elif defined (MDE_CPU_AARCH64)
+extern UINT32  OPENSSL_armcap_P;
+
+  #define OPENSSL_CAPABILITY_WORDS   1
+  #define OPENSSL_CAPABILITY(Index)  OPENSSL_armcap_P
+  #endif
+#endif
+
+/**
+  Returns the capability words OpenSSL selects its assembly paths from.
+
+  @param[out]     Capability  Receives OPENSSL_ia32cap_P on IA32 and X64, or
+                              OPENSSL_armcap_P on AARCH64.
+  @param[in,out]  Count       On input, the number of entries Capability
+                              holds. On output, the number of capability
+                              words of this architecture.
+
+  @retval RETURN_SUCCESS           Capability holds the words.
+  @retval RETURN_BUFFER_TOO_SMALL  Count is too small and was updated.
+  @retval RETURN_UNSUPPORTED       This OpensslLib has no CPU specific code.
+**/
+#if defined (OPENSSL_CAPABILITY_WORDS)
+RETURN_STATUS
+EFIAPI
+OpensslLibGetCpuCapability (
+  OUT    UINT32  *Capability,
+  IN OUT UINTN   *Count
+  )
+{
+  UINTN  Index;
+
+  if (*Count < OPENSSL_CAPABILITY_WORDS) {
+    *Count = OPENSSL_CAPABILITY_WORDS;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+
+  for (Index = 0; Index < OPENSSL_CAPABILITY_WORDS; Index++) {
+    Capability[Index] = OPENSSL_CAPABILITY (Index);
+  }
+
+  *Count = OPENSSL_CAPABILITY_WORDS;
+  return RETURN_SUCCESS;
+}
+
+#else
+RETURN_STATUS
+EFIAPI
+OpensslLibGetCpuCapability (
+  OUT    UINT32  *Capability,
+  IN OUT UINTN   *Count
+  )
+{
+  return RETURN_UNSUPPORTED;
+}
+
+#endif
+
+// MU_CHANGE [END]
+
 /**
   Constructor routine for OpensslLib.
 
@@ -11,6 +11,44 @@
 
 #include <Library/BaseLib.h>
 
+// MU_CHANGE [BEGIN]
+#include <stdlib.h>
+
+//
+// ID_AA64ISAR0_EL1 fields OpenSSL has accelerated paths for, beyond the ones
+// crypto/arm_arch.h describes.
+//
+#ifndef ARM_ID_AA64ISAR0_EL1_SHA3_SHIFT
+#define ARM_ID_AA64ISAR0_EL1_SHA3_SHIFT  32
+#define ARM_ID_AA64ISAR0_EL1_SHA3_MASK   0xFULL
+#endif
+
+#ifndef ARM_ID_AA64ISAR0_EL1_SM3_SHIFT
+#define ARM_ID_AA64ISAR0_EL1_SM3_SHIFT  36
+#define ARM_ID_AA64ISAR0_EL1_SM3_MASK   0xFULL
+#endif
+
+#ifndef ARM_ID_AA64ISAR0_EL1_SM4_SHIFT
+#define ARM_ID_AA64ISAR0_EL1_SM4_SHIFT  40
+#define ARM_ID_AA64ISAR0_EL1_SM4_MASK   0xFULL
+#endif
+
+#ifndef ARM_ID_AA64ISAR0_EL1_RNDR_SHIFT
+#define ARM_ID_AA64ISAR0_EL1_RNDR_SHIFT  60
+#define ARM_ID_AA64ISAR0_EL1_RNDR_MASK   0xFULL
+#endif
+
+/** Read the Main ID Register, see crypto/arm64cpuid.pl.
+
+  @return  MIDR_EL1.
+**/
+uint32_t
+_armv8_cpuid_probe (
+  void
+  );
+
+// MU_CHANGE [END]
+
 /** Get bits from a value.
 
   Shift the input value from 'shift' bits and apply 'mask'.
@@ -26,12 +64,54 @@
 
 UINT32  OPENSSL_armcap_P = 0;
 
+// MU_CHANGE [BEGIN]
+/** Apply the OPENSSL_armcap override of the platform.
+
+  A number replaces the detected capabilities, as with upstream OpenSSL. A
+  number prefixed with '~' clears those bits instead, like OPENSSL_ia32cap
+  does on x86. Decimal and "0x" hexadecimal numbers are accepted.
+
+  @param   Override  Value of the OPENSSL_armcap variable.
+**/
+STATIC
+VOID
+ApplyArmCapOverride (
+  IN CONST CHAR8  *Override
+  )
+{
+  BOOLEAN  Clear;
+  UINT64   Value;
+
+  Clear = (BOOLEAN)(*Override == '~');
+  if (Clear) {
+    Override++;
+  }
+
+  if ((Override[0] == '0') && ((Override[1] == 'x') || (Override[1] == 'X'))) {
+    if (RETURN_ERROR (AsciiStrHexToUint64S (Override, NULL, &Value))) {
+      return;
+    }
+  } else if (RETURN_ERROR (AsciiStrDecimalToUint64S (Override, NULL, &Value))) {
+    return;
+  }
+
+  if (Clear) {
+    OPENSSL_armcap_P &= ~(UINT32)Value;
+  } else {
+    OPENSSL_armcap_P = (UINT32)Value;
+  }
+}
+
+// MU_CHANGE [END]
+
 void
 OPENSSL_cpuid_setup (
   void
   )
 {
-  UINT64  Isar0;
+  UINT64       Isar0;
+  UINT32       Midr;      // MU_CHANGE
+  CONST CHAR8  *Override; // MU_CHANGE
 
   OPENSSL_armcap_P = 0;
   Isar0            = ArmReadIdAA64Isar0Reg ();
@@ -90,6 +170,66 @@ OPENSSL_cpuid_setup (
   {
     OPENSSL_armcap_P |= ARMV8_SHA512;
   }
+
+  // MU_CHANGE [BEGIN]
+  if (GET_BITFIELD (
+        Isar0,
+        ARM_ID_AA64ISAR0_EL1_SHA3_SHIFT,
+        ARM_ID_AA64ISAR0_EL1_SHA3_MASK
+        ) != 0)
+  {
+    OPENSSL_armcap_P |= ARMV8_SHA3;
+  }
+
+  if (GET_BITFIELD (
+        Isar0,
+        ARM_ID_AA64ISAR0_EL1_SM3_SHIFT,
+        ARM_ID_AA64ISAR0_EL1_SM3_MASK
+        ) != 0)
+  {
+    OPENSSL_armcap_P |= ARMV8_SM3;
+  }
+
+  if (GET_BITFIELD (
+        Isar0,
+        ARM_ID_AA64ISAR0_EL1_SM4_SHIFT,
+        ARM_ID_AA64ISAR0_EL1_SM4_MASK
+        ) != 0)
+  {
+    OPENSSL_armcap_P |= ARMV8_SM4;
+  }
+
+  if (GET_BITFIELD (
+        Isar0,
+        ARM_ID_AA64ISAR0_EL1_RNDR_SHIFT,
+        ARM_ID_AA64ISAR0_EL1_RNDR_MASK
+        ) != 0)
+  {
+    OPENSSL_armcap_P |= ARMV8_RNG;
+  }
+
+  /* The eight-block EOR3 AES-GCM kernels only pay off on these cores, as in
+     upstream armcap.c. The Apple-only tuning bits are left clear.
+  */
+  Midr = _armv8_cpuid_probe ();
+  if (((OPENSSL_armcap_P & ARMV8_SHA3) != 0) &&
+      (MIDR_IS_CPU_MODEL (Midr, ARM_CPU_IMP_ARM, ARM_CPU_PART_V1) ||
+       MIDR_IS_CPU_MODEL (Midr, ARM_CPU_IMP_ARM, ARM_CPU_PART_N2) ||
+       MIDR_IS_CPU_MODEL (Midr, ARM_CPU_IMP_ARM, ARM_CPU_PART_V2)))
+  {
+    OPENSSL_armcap_P |= ARMV8_UNROLL8_EOR3;
+  }
+
+  /* ARMV8_SVE and ARMV8_SVE2 are never detected: firmware leaves SVE register
+     access trapped, and none of the generated assembly has SVE code paths.
+     The override below can still set them for experiments.
+  */
+  Override = getenv ("OPENSSL_armcap");
+  if (Override != NULL) {
+    ApplyArmCapOverride (Override);
+  }
+
+  // MU_CHANGE [END]
 }
 
 /** Read system counter value.
@@ -141,6 +141,13 @@ static const OSSL_ALGORITHM_CAPABLE deflt_ciphers[] = {
     ALG(PROV_NAMES_AES_192_GCM, ossl_aes192gcm_functions),
     ALG(PROV_NAMES_AES_128_GCM, ossl_aes128gcm_functions),
 
+#ifndef OPENSSL_NO_CHACHA
+    ALG(PROV_NAMES_ChaCha20, ossl_chacha20_functions),
+# ifndef OPENSSL_NO_POLY1305
+    ALG(PROV_NAMES_ChaCha20_Poly1305, ossl_chacha20_ossl_poly1305_functions),
+# endif /* OPENSSL_NO_POLY1305 */
+#endif /* OPENSSL_NO_CHACHA */
+
     ALGC (
         PROV_NAMES_AES_128_CBC_HMAC_SHA256,
         ossl_aes128cbc_hmac_sha256_functions,
@@ -158,6 +165,9 @@ static OSSL_ALGORITHM exported_ciphers[OSSL_NELEM(deflt_ciphers)];
 
 static const OSSL_ALGORITHM deflt_macs[] = {
     { PROV_NAMES_HMAC, "provider=default", ossl_hmac_functions },
+#ifndef OPENSSL_NO_POLY1305
+    { PROV_NAMES_POLY1305, "provider=default", ossl_poly1305_functions },
+#endif /* OPENSSL_NO_POLY1305 */
     { NULL, NULL, NULL }
 };
 
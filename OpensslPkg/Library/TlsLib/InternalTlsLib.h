@@ -17,6 +17,11 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/SafeIntLib.h>
+#include <Library/TimerLib.h>
+#include <CryptElapsedTime.h>
+#include <TlsCaBundle.h>
+#include <TlsReadInPlace.h>
+#include <TlsSessionCache.h>
 #include <Protocol/Tls.h>
 #include <IndustryStandard/Tls1.h>
 #include <Library/PcdLib.h>
@@ -40,17 +45,146 @@ typedef struct {
   // Main SSL Connection which is created by a server or a client
   // per established connection.
   //
-  SSL    *Ssl;
+  SSL       *Ssl;
   //
-  // Memory BIO for the TLS/SSL Reading operations.
+  // Ring buffer BIO for the TLS/SSL Reading operations.
   //
-  BIO    *InBio;
+  BIO       *InBio;
   //
-  // Memory BIO for the TLS/SSL Writing operations.
+  // Ring buffer BIO for the TLS/SSL Writing operations.
   //
-  BIO    *OutBio;
+  BIO       *OutBio;
+  //
+  // Number of times the handshake sent a flight and had to wait for the
+  // peer before it could complete.
+  //
+  UINT32    HandshakeRoundTrips;
+  //
+  // Time spent inside SSL_do_handshake(), in nanoseconds.
+  //
+  UINT64    HandshakeNs;
 } TLS_CONNECTION;
 
+//
+// Initial capacities of the ring buffer BIOs of a connection. The read ring
+// has room for a full server handshake flight delivered record by record.
+// The write ring is drained after every handshake step and record write, so
+// it starts with room for one record and only grows for a larger flight,
+// such as one carrying a client certificate chain.
+//
+#define TLS_IN_BIO_CAPACITY   (4 * SSL3_RT_MAX_PACKET_SIZE)
+#define TLS_OUT_BIO_CAPACITY  SSL3_RT_MAX_PACKET_SIZE
+
+/**
+  Create a ring buffer BIO.
+
+  @param[in]  Capacity  Initial size of the ring in bytes. The ring grows when
+                        a write does not fit.
+
+  @return  The new BIO, or NULL if it could not be allocated.
+
+**/
+BIO *
+TlsRingBioNew (
+  IN UINTN  Capacity
+  );
+
+/**
+  Lend a caller buffer to a ring buffer BIO, or take it back.
+
+  While a buffer is lent, reads that have drained the ring continue from it
+  without copying it into the ring first.
+
+  @param[in]  Bio     A BIO created by TlsRingBioNew().
+  @param[in]  Buffer  The buffer to lend, or NULL to take the lent buffer back.
+                      Bytes of it that were not read yet are moved into the
+                      ring.
+  @param[in]  Size    Size of Buffer in bytes.
+
+  @retval  TRUE   The operation succeeded.
+  @retval  FALSE  Unread bytes could not be moved into the ring.
+
+**/
+BOOLEAN
+TlsRingBioLend (
+  IN BIO          *Bio,
+  IN CONST UINT8  *Buffer  OPTIONAL,
+  IN UINTN        Size
+  );
+
+/**
+  Offer the cached session of the connection's server name, if there is one.
+
+  Called before the first handshake step of a client connection.
+
+  @param[in]  Ssl  The SSL connection.
+
+**/
+VOID
+TlsSessionCacheAttach (
+  IN SSL  *Ssl
+  );
+
+/**
+  Drop the cached session of the connection's server name.
+
+  Called when a handshake fails, so a session the server no longer accepts
+  is not offered again.
+
+  @param[in]  Ssl  The SSL connection.
+
+**/
+VOID
+TlsSessionCacheEvict (
+  IN SSL  *Ssl
+  );
+
+/**
+  Check whether a certificate store belongs to a CA bundle.
+
+  @param[in]  Store  The certificate store of a context.
+
+  @retval  TRUE   The store is a shared CA bundle and must not be modified.
+  @retval  FALSE  The store is private to its context.
+
+**/
+BOOLEAN
+TlsCaBundleIsShared (
+  IN X509_STORE  *Store
+  );
+
+/**
+  Check whether a certificate store already holds a certificate.
+
+  @param[in]  Store  The certificate store.
+  @param[in]  Cert   The certificate to look for.
+
+  @retval  TRUE   Store holds Cert.
+  @retval  FALSE  Store does not hold Cert, or the lookup failed.
+
+**/
+BOOLEAN
+TlsCaBundleContains (
+  IN X509_STORE  *Store,
+  IN X509        *Cert
+  );
+
+/**
+  Check whether a buffer holds a whole number of complete TLS records.
+
+  @param[in]  Buffer      The buffer.
+  @param[in]  BufferSize  Size of Buffer in bytes.
+
+  @retval  TRUE   Buffer ends exactly at the end of a record.
+  @retval  FALSE  Buffer is empty or ends inside a record.
+
+**/
+BOOLEAN
+TlsIsCompleteRecords (
+  IN CONST UINT8  *Buffer,
+  IN UINTN        BufferSize
+  );
+
 /* This is a context that we pass to callbacks */
 typedef struct {
   BIO      *BioDebug;
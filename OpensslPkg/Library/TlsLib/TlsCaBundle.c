@@ -0,0 +1,591 @@
+/** @file
+  Shared, pre-parsed CA certificate bundle for TlsLib.
+
+  TlsSetCaCertificate() parses one certificate per call into the store of a
+  single context, so a consumer that walks the EFI_TLS_CA_CERTIFICATE variable
+  for every connection parses the whole bundle every time. A CA bundle parses
+  it once into an X509_STORE, which OpenSSL indexes by subject name, and any
+  number of contexts can then reference that store.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalTlsLib.h"
+#include <CryptAllocStats.h>
+#include <Guid/ImageAuthentication.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+
+typedef struct {
+  X509_STORE    *Store;
+  //
+  // Certificates added to Store, and signature list entries that were not
+  // X.509 certificates.
+  //
+  UINTN         CertCount;
+  UINTN         SkippedCount;
+  //
+  // Total DER size of the certificates, and heap growth while parsing them.
+  // HeapBytes is 0 unless allocation statistics are built in.
+  //
+  UINTN         EncodedBytes;
+  UINT64        HeapBytes;
+  UINT64        ParseNs;
+} TLS_CA_BUNDLE;
+
+//
+// X509_STORE ex_data index marking stores owned by a CA bundle. The value
+// stored is the address of the index itself, since the bundle object may be
+// freed while contexts still hold the store.
+//
+STATIC INT32  mTlsCaBundleIndex = -1;
+
+/**
+  Add a parsed certificate to a CA bundle.
+
+  @param[in, out]  Bundle  The CA bundle.
+  @param[in]       Cert    The certificate. The caller keeps its reference.
+  @param[in]       Size    DER size of the certificate.
+
+  @retval  EFI_SUCCESS           The certificate was added or already present.
+  @retval  EFI_OUT_OF_RESOURCES  The certificate could not be added.
+
+**/
+STATIC
+EFI_STATUS
+TlsCaBundleAddCert (
+  IN OUT TLS_CA_BUNDLE  *Bundle,
+  IN     X509           *Cert,
+  IN     UINTN          Size
+  )
+{
+  unsigned long  ErrorCode;
+  EFI_STATUS     Status;
+
+  Status = EFI_SUCCESS;
+  if (X509_STORE_add_cert (Bundle->Store, Cert) == 1) {
+    Bundle->CertCount++;
+    Bundle->EncodedBytes += Size;
+  } else {
+    //
+    // Ignore "already in table" errors, as TlsSetCaCertificate() does.
+    //
+    ErrorCode = ERR_peek_last_error ();
+    if ((ERR_GET_LIB (ErrorCode) != ERR_LIB_X509) ||
+        (ERR_GET_REASON (ErrorCode) != X509_R_CERT_ALREADY_IN_HASH_TABLE))
+    {
+      Status = EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  ERR_clear_error ();
+  return Status;
+}
+
+/**
+  Add DER-encoded certificates to a CA bundle.
+
+  @param[in, out]  Bundle    The CA bundle.
+  @param[in]       Der       One or more concatenated DER certificates.
+  @param[in]       DerSize   Size of Der in bytes. The certificates must
+                             span it exactly.
+
+  @retval  EFI_SUCCESS           The certificates were added.
+  @retval  EFI_ABORTED           A certificate is malformed.
+  @retval  EFI_OUT_OF_RESOURCES  Memory allocation failed.
+
+**/
+STATIC
+EFI_STATUS
+TlsCaBundleAddDer (
+  IN OUT TLS_CA_BUNDLE  *Bundle,
+  IN     CONST UINT8    *Der,
+  IN     UINTN          DerSize
+  )
+{
+  CONST UINT8  *Ptr;
+  CONST UINT8  *Start;
+  CONST UINT8  *End;
+  X509         *Cert;
+  EFI_STATUS   Status;
+
+  if (DerSize > MAX_INT32) {
+    return EFI_ABORTED;
+  }
+
+  Status = EFI_SUCCESS;
+  End    = Der + DerSize;
+  for (Ptr = Der; Ptr < End && !EFI_ERROR (Status); ) {
+    Start = Ptr;
+    Cert  = d2i_X509 (NULL, &Ptr, (long)(End - Ptr));
+    if (Cert == NULL) {
+      ERR_clear_error ();
+      return EFI_ABORTED;
+    }
+
+    Status = TlsCaBundleAddCert (Bundle, Cert, (UINTN)(Ptr - Start));
+    X509_free (Cert);
+  }
+
+  return Status;
+}
+
+/**
+  Check whether a buffer is a well-formed sequence of EFI_SIGNATURE_LISTs
+  that covers it exactly.
+
+  @param[in]  Data      The buffer.
+  @param[in]  DataSize  Size of Data in bytes.
+
+  @retval  TRUE   Data is a sequence of signature lists.
+  @retval  FALSE  Data is something else.
+
+**/
+STATIC
+BOOLEAN
+TlsCaBundleIsSignatureLists (
+  IN CONST UINT8  *Data,
+  IN UINTN        DataSize
+  )
+{
+  CONST EFI_SIGNATURE_LIST  *List;
+  UINTN                     Offset;
+  UINTN                     Entries;
+
+  for (Offset = 0; Offset < DataSize; Offset += List->SignatureListSize) {
+    if (DataSize - Offset < sizeof (EFI_SIGNATURE_LIST)) {
+      return FALSE;
+    }
+
+    List = (CONST EFI_SIGNATURE_LIST *)(Data + Offset);
+    if ((List->SignatureListSize < sizeof (EFI_SIGNATURE_LIST)) ||
+        (List->SignatureListSize > DataSize - Offset) ||
+        (List->SignatureSize <= sizeof (EFI_GUID)) ||
+        (List->SignatureHeaderSize > List->SignatureListSize - sizeof (EFI_SIGNATURE_LIST)))
+    {
+      return FALSE;
+    }
+
+    Entries = List->SignatureListSize - sizeof (EFI_SIGNATURE_LIST) - List->SignatureHeaderSize;
+    if ((Entries == 0) || (Entries % List->SignatureSize != 0)) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Add the X.509 entries of a sequence of EFI_SIGNATURE_LISTs, the format of
+  the EFI_TLS_CA_CERTIFICATE variable, to a CA bundle. Entries of other
+  signature types are skipped.
+
+  @param[in, out]  Bundle    The CA bundle.
+  @param[in]       Data      Signature lists checked by
+                             TlsCaBundleIsSignatureLists().
+  @param[in]       DataSize  Size of Data in bytes.
+
+  @retval  EFI_SUCCESS  All X.509 entries were added.
+  @retval  Others       An entry could not be added.
+
+**/
+STATIC
+EFI_STATUS
+TlsCaBundleParseSignatureLists (
+  IN OUT TLS_CA_BUNDLE  *Bundle,
+  IN     CONST UINT8    *Data,
+  IN     UINTN          DataSize
+  )
+{
+  CONST EFI_SIGNATURE_LIST  *List;
+  CONST EFI_SIGNATURE_DATA  *Entry;
+  UINTN                     Offset;
+  UINTN                     EntryOffset;
+  EFI_STATUS                Status;
+
+  for (Offset = 0; Offset < DataSize; Offset += List->SignatureListSize) {
+    List        = (CONST EFI_SIGNATURE_LIST *)(Data + Offset);
+    EntryOffset = sizeof (EFI_SIGNATURE_LIST) + List->SignatureHeaderSize;
+    for ( ; EntryOffset < List->SignatureListSize; EntryOffset += List->SignatureSize) {
+      if (!CompareGuid (&List->SignatureType, &gEfiCertX509Guid)) {
+        Bundle->SkippedCount++;
+        continue;
+      }
+
+      Entry  = (CONST EFI_SIGNATURE_DATA *)((CONST UINT8 *)List + EntryOffset);
+      Status = TlsCaBundleAddDer (Bundle, Entry->SignatureData, List->SignatureSize - sizeof (EFI_GUID));
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Add every certificate of a PEM bundle to a CA bundle.
+
+  @param[in, out]  Bundle    The CA bundle.
+  @param[in]       Data      PEM-encoded certificates.
+  @param[in]       DataSize  Size of Data in bytes.
+
+  @retval  EFI_SUCCESS           All certificates were added.
+  @retval  EFI_ABORTED           A certificate is malformed.
+  @retval  EFI_OUT_OF_RESOURCES  Memory allocation failed.
+
+**/
+STATIC
+EFI_STATUS
+TlsCaBundleParsePem (
+  IN OUT TLS_CA_BUNDLE  *Bundle,
+  IN     CONST UINT8    *Data,
+  IN     UINTN          DataSize
+  )
+{
+  BIO            *Bio;
+  X509           *Cert;
+  INT32          DerSize;
+  unsigned long  ErrorCode;
+  EFI_STATUS     Status;
+
+  if (DataSize > MAX_INT32) {
+    return EFI_ABORTED;
+  }
+
+  Bio = BIO_new_mem_buf (Data, (INT32)DataSize);
+  if (Bio == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = EFI_SUCCESS;
+  while (TRUE) {
+    Cert = PEM_read_bio_X509 (Bio, NULL, NULL, NULL);
+    if (Cert == NULL) {
+      //
+      // Running out of PEM blocks ends the bundle; anything else is an error.
+      //
+      ErrorCode = ERR_peek_last_error ();
+      if ((ERR_GET_LIB (ErrorCode) != ERR_LIB_PEM) || (ERR_GET_REASON (ErrorCode) != PEM_R_NO_START_LINE)) {
+        Status = EFI_ABORTED;
+      }
+
+      ERR_clear_error ();
+      break;
+    }
+
+    DerSize = i2d_X509 (Cert, NULL);
+    Status  = TlsCaBundleAddCert (Bundle, Cert, (DerSize > 0) ? (UINTN)DerSize : 0);
+    X509_free (Cert);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+  }
+
+  BIO_free (Bio);
+  return Status;
+}
+
+/**
+  Check whether a buffer starts with a PEM block, ignoring leading white
+  space.
+
+  @param[in]  Data      The buffer.
+  @param[in]  DataSize  Size of Data in bytes.
+
+  @retval  TRUE   Data looks like PEM.
+  @retval  FALSE  Data is binary.
+
+**/
+STATIC
+BOOLEAN
+TlsCaBundleIsPem (
+  IN CONST UINT8  *Data,
+  IN UINTN        DataSize
+  )
+{
+  STATIC CONST CHAR8  PemBegin[] = "-----BEGIN";
+  UINTN               Index;
+
+  for (Index = 0; Index < DataSize; Index++) {
+    if ((Data[Index] != ' ') && (Data[Index] != '\t') && (Data[Index] != '\r') && (Data[Index] != '\n')) {
+      break;
+    }
+  }
+
+  return (BOOLEAN)((DataSize - Index >= sizeof (PemBegin) - 1) &&
+                   (CompareMem (Data + Index, PemBegin, sizeof (PemBegin) - 1) == 0));
+}
+
+/**
+  Release a CA bundle.
+
+  Contexts the bundle was attached to keep their reference to its
+  certificates, so the bundle can be freed as soon as it has been attached.
+
+  @param[in]  CaBundle  The CA bundle from TlsCaBundleNew(). May be NULL.
+
+**/
+VOID
+EFIAPI
+TlsCaBundleFree (
+  IN VOID  *CaBundle
+  )
+{
+  TLS_CA_BUNDLE  *Bundle;
+
+  Bundle = (TLS_CA_BUNDLE *)CaBundle;
+  if (Bundle == NULL) {
+    return;
+  }
+
+  X509_STORE_free (Bundle->Store);
+  FreePool (Bundle);
+}
+
+/**
+  Parse a set of CA certificates once into a CA bundle that any number of
+  TLS contexts can share through TlsCtxSetCaBundle().
+
+  Data can be:
+    - a sequence of EFI_SIGNATURE_LISTs, such as the content of the
+      EFI_TLS_CA_CERTIFICATE variable; entries that are not EFI_CERT_X509_GUID
+      are skipped;
+    - one or more PEM-encoded X.509 certificates;
+    - one or more concatenated DER-encoded X.509 certificates.
+
+  @param[in]  Data      Pointer to the certificates.
+  @param[in]  DataSize  Size of Data in bytes.
+
+  @return  The CA bundle, or NULL if Data is invalid, holds no certificate, or
+           memory allocation failed. Free it with TlsCaBundleFree().
+
+**/
+VOID *
+EFIAPI
+TlsCaBundleNew (
+  IN CONST VOID  *Data,
+  IN UINTN       DataSize
+  )
+{
+  TLS_CA_BUNDLE      *Bundle;
+  CONST UINT8        *Bytes;
+  CRYPT_ALLOC_STATS  *AllocStats;
+  UINT64             LiveBytes;
+  UINT64             StartTicks;
+  EFI_STATUS         Status;
+
+  if ((Data == NULL) || (DataSize == 0)) {
+    return NULL;
+  }
+
+  if (mTlsCaBundleIndex < 0) {
+    mTlsCaBundleIndex = X509_STORE_get_ex_new_index (0, NULL, NULL, NULL, NULL);
+    if (mTlsCaBundleIndex < 0) {
+      return NULL;
+    }
+  }
+
+  Bundle = AllocateZeroPool (sizeof (TLS_CA_BUNDLE));
+  if (Bundle == NULL) {
+    return NULL;
+  }
+
+  //
+  // The statistics snapshot is a few hundred bytes, keep it off the stack.
+  //
+  LiveBytes  = 0;
+  AllocStats = AllocatePool (sizeof (CRYPT_ALLOC_STATS));
+  if ((AllocStats != NULL) && !EFI_ERROR (CryptAllocStatsGet (AllocStats))) {
+    LiveBytes = AllocStats->LiveBytes;
+  }
+
+  StartTicks    = GetPerformanceCounter ();
+  Bytes         = (CONST UINT8 *)Data;
+  Bundle->Store = X509_STORE_new ();
+  if (Bundle->Store == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+  } else if (TlsCaBundleIsPem (Bytes, DataSize)) {
+    Status = TlsCaBundleParsePem (Bundle, Bytes, DataSize);
+  } else if (TlsCaBundleIsSignatureLists (Bytes, DataSize)) {
+    Status = TlsCaBundleParseSignatureLists (Bundle, Bytes, DataSize);
+  } else {
+    Status = TlsCaBundleAddDer (Bundle, Bytes, DataSize);
+  }
+
+  Bundle->ParseNs = CryptElapsedNanoSeconds (StartTicks, GetPerformanceCounter ());
+
+  if ((AllocStats != NULL) && !EFI_ERROR (CryptAllocStatsGet (AllocStats)) && (AllocStats->LiveBytes > LiveBytes)) {
+    Bundle->HeapBytes = AllocStats->LiveBytes - LiveBytes;
+  }
+
+  if (AllocStats != NULL) {
+    FreePool (AllocStats);
+  }
+
+  if (!EFI_ERROR (Status) && (Bundle->CertCount == 0)) {
+    Status = EFI_NOT_FOUND;
+  }
+
+  if (!EFI_ERROR (Status) && (X509_STORE_set_ex_data (Bundle->Store, mTlsCaBundleIndex, &mTlsCaBundleIndex) != 1)) {
+    Status = EFI_OUT_OF_RESOURCES;
+  }
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: CA bundle rejected after %u certificate(s): %r\n", __func__, (UINT32)Bundle->CertCount, Status));
+    TlsCaBundleFree (Bundle);
+    return NULL;
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: %u certificate(s), %u skipped, %u DER bytes, parsed in %lu ns, %lu heap bytes\n",
+    __func__,
+    (UINT32)Bundle->CertCount,
+    (UINT32)Bundle->SkippedCount,
+    (UINT32)Bundle->EncodedBytes,
+    Bundle->ParseNs,
+    Bundle->HeapBytes
+    ));
+
+  return Bundle;
+}
+
+/**
+  Make a TLS context verify peers against a CA bundle.
+
+  The context references the bundle's certificates instead of holding its own
+  copy, and replaces any CA certificates added to it before. The bundle is
+  read-only once created: TlsSetCaCertificate() on a connection of the
+  context only succeeds for certificates already in the bundle.
+
+  @param[in]  TlsCtx    Pointer to the SSL_CTX object.
+  @param[in]  CaBundle  The CA bundle from TlsCaBundleNew().
+
+  @retval  EFI_SUCCESS            The bundle was attached.
+  @retval  EFI_INVALID_PARAMETER  TlsCtx or CaBundle is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+TlsCtxSetCaBundle (
+  IN VOID  *TlsCtx,
+  IN VOID  *CaBundle
+  )
+{
+  TLS_CA_BUNDLE  *Bundle;
+
+  Bundle = (TLS_CA_BUNDLE *)CaBundle;
+  if ((TlsCtx == NULL) || (Bundle == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  SSL_CTX_set1_cert_store ((SSL_CTX *)TlsCtx, Bundle->Store);
+  return EFI_SUCCESS;
+}
+
+/**
+  Get the parse statistics of a CA bundle.
+
+  @param[in]   CaBundle      The CA bundle from TlsCaBundleNew().
+  @param[out]  CertCount     Number of certificates in the bundle. Optional.
+  @param[out]  ParseNs       Time TlsCaBundleNew() spent parsing, in
+                             nanoseconds. 0 without a performance counter.
+                             Optional.
+  @param[out]  EncodedBytes  Total DER size of the certificates. Optional.
+  @param[out]  HeapBytes     Heap the parsed certificates occupy. 0 unless
+                             BaseCryptLib allocation statistics are enabled.
+                             Optional.
+
+  @retval  EFI_SUCCESS            The statistics were returned.
+  @retval  EFI_INVALID_PARAMETER  CaBundle is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+TlsCaBundleGetStats (
+  IN  VOID    *CaBundle,
+  OUT UINTN   *CertCount     OPTIONAL,
+  OUT UINT64  *ParseNs       OPTIONAL,
+  OUT UINTN   *EncodedBytes  OPTIONAL,
+  OUT UINT64  *HeapBytes     OPTIONAL
+  )
+{
+  TLS_CA_BUNDLE  *Bundle;
+
+  Bundle = (TLS_CA_BUNDLE *)CaBundle;
+  if (Bundle == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (CertCount != NULL) {
+    *CertCount = Bundle->CertCount;
+  }
+
+  if (ParseNs != NULL) {
+    *ParseNs = Bundle->ParseNs;
+  }
+
+  if (EncodedBytes != NULL) {
+    *EncodedBytes = Bundle->EncodedBytes;
+  }
+
+  if (HeapBytes != NULL) {
+    *HeapBytes = Bundle->HeapBytes;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Check whether a certificate store belongs to a CA bundle.
+
+  @param[in]  Store  The certificate store of a context.
+
+  @retval  TRUE   The store is a shared CA bundle and must not be modified.
+  @retval  FALSE  The store is private to its context.
+
+**/
+BOOLEAN
+TlsCaBundleIsShared (
+  IN X509_STORE  *Store
+  )
+{
+  return (BOOLEAN)((mTlsCaBundleIndex >= 0) &&
+                   (X509_STORE_get_ex_data (Store, mTlsCaBundleIndex) == &mTlsCaBundleIndex));
+}
+
+/**
+  Check whether a certificate store already holds a certificate.
+
+  @param[in]  Store  The certificate store.
+  @param[in]  Cert   The certificate to look for.
+
+  @retval  TRUE   Store holds Cert.
+  @retval  FALSE  Store does not hold Cert, or the lookup failed.
+
+**/
+BOOLEAN
+TlsCaBundleContains (
+  IN X509_STORE  *Store,
+  IN X509        *Cert
+  )
+{
+  X509_OBJECT  *Object;
+  BOOLEAN      Found;
+
+  Object = X509_OBJECT_new ();
+  if (Object == NULL) {
+    return FALSE;
+  }
+
+  Found = FALSE;
+  if (X509_OBJECT_set1_X509 (Object, Cert) == 1) {
+    Found = (BOOLEAN)(X509_OBJECT_retrieve_match (X509_STORE_get0_objects (Store), Object) != NULL);
+  }
+
+  X509_OBJECT_free (Object);
+  return Found;
+}
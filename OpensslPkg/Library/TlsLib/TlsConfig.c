@@ -94,6 +94,15 @@ TlsSetVersion (
       SSL_set_min_proto_version (TlsConn->Ssl, TLS1_2_VERSION);
       SSL_set_max_proto_version (TlsConn->Ssl, TLS1_2_VERSION);
       break;
+#ifndef OPENSSL_NO_TLS1_3
+    case TLS1_3_VERSION:
+      //
+      // TLS 1.3
+      //
+      SSL_set_min_proto_version (TlsConn->Ssl, TLS1_3_VERSION);
+      SSL_set_max_proto_version (TlsConn->Ssl, TLS1_3_VERSION);
+      break;
+#endif
     default:
       //
       // Unsupported Protocol Version
@@ -148,6 +157,108 @@ TlsSetConnectionEnd (
   return EFI_SUCCESS;
 }
 
+/**
+  Build the colon separated OpenSSL name string for either the TLS 1.3 cipher
+  suites or the TLS 1.2 and earlier ciphers in a list of mapped ciphers.
+
+  OpenSSL configures the two sets separately: SSL_set_cipher_list() ignores
+  TLS 1.3 suites and SSL_set_ciphersuites() accepts nothing else.
+
+  @param[in]   MappedCipher       Ciphers in preference order.
+  @param[in]   MappedCipherCount  Number of entries in MappedCipher.
+  @param[in]   Tls13              TRUE to collect the TLS 1.3 cipher suites,
+                                  FALSE to collect the other ciphers.
+  @param[out]  CipherString       Receives the NUL-terminated string. Must be
+                                  large enough for all names in MappedCipher.
+
+  @return  The number of ciphers written to CipherString.
+
+**/
+STATIC
+UINTN
+TlsBuildCipherString (
+  IN  CONST SSL_CIPHER  **MappedCipher,
+  IN  UINTN             MappedCipherCount,
+  IN  BOOLEAN           Tls13,
+  OUT CHAR8             *CipherString
+  )
+{
+  UINTN        Index;
+  UINTN        Count;
+  CHAR8        *CipherStringPosition;
+  CONST CHAR8  *OpensslCipherName;
+  UINTN        OpensslCipherNameLength;
+
+  Count                = 0;
+  CipherStringPosition = CipherString;
+  for (Index = 0; Index < MappedCipherCount; Index++) {
+    //
+    // TLS 1.3 suites do not define the key exchange.
+    //
+    if ((SSL_CIPHER_get_kx_nid (MappedCipher[Index]) == NID_kx_any) != Tls13) {
+      continue;
+    }
+
+    OpensslCipherName       = SSL_CIPHER_get_name (MappedCipher[Index]);
+    OpensslCipherNameLength = AsciiStrLen (OpensslCipherName);
+    //
+    // Append the colon (":") prefix except for the first mapping, then append
+    // OpensslCipherName.
+    //
+    if (Count > 0) {
+      *(CipherStringPosition++) = ':';
+    }
+
+    CopyMem (
+      CipherStringPosition,
+      OpensslCipherName,
+      OpensslCipherNameLength
+      );
+    CipherStringPosition += OpensslCipherNameLength;
+    Count++;
+  }
+
+  //
+  // NUL-terminate CipherString.
+  //
+  *CipherStringPosition = '\0';
+
+  //
+  // Log CipherString for debugging. CipherString can be very long if the
+  // caller provided a large CipherId array, so log CipherString in segments of
+  // 79 non-newline characters. (MAX_DEBUG_MESSAGE_LENGTH is usually 0x100 in
+  // DebugLib instances.)
+  //
+  DEBUG_CODE_BEGIN ();
+  UINTN  FullLength;
+  UINTN  SegmentLength;
+
+  FullLength = CipherStringPosition - CipherString;
+  DEBUG ((
+    DEBUG_VERBOSE,
+    "%a:%a: %a={\n",
+    gEfiCallerBaseName,
+    __func__,
+    Tls13 ? "CipherSuites" : "CipherString"
+    ));
+  for (CipherStringPosition = CipherString;
+       CipherStringPosition < CipherString + FullLength;
+       CipherStringPosition += SegmentLength)
+  {
+    SegmentLength = FullLength - (CipherStringPosition - CipherString);
+    if (SegmentLength > 79) {
+      SegmentLength = 79;
+    }
+
+    DEBUG ((DEBUG_VERBOSE, "%.*a\n", SegmentLength, CipherStringPosition));
+  }
+
+  DEBUG ((DEBUG_VERBOSE, "}\n"));
+  DEBUG_CODE_END ();
+
+  return Count;
+}
+
 /**
   Set the ciphers list to be used by the TLS object.
 
@@ -183,12 +294,9 @@ TlsSetCipherList (
   UINTN             Index;
   INT32             StackIdx;
   CHAR8             *CipherString;
-  CHAR8             *CipherStringPosition;
 
   STACK_OF (SSL_CIPHER)      *OpensslCipherStack;
   CONST SSL_CIPHER  *OpensslCipher;
-  CONST CHAR8       *OpensslCipherName;
-  UINTN             OpensslCipherNameLength;
 
   TlsConn = (TLS_CONNECTION *)Tls;
   if ((TlsConn == NULL) || (TlsConn->Ssl == NULL) || (CipherId == NULL)) {
@@ -305,79 +413,22 @@ TlsSetCipherList (
   }
 
   //
-  // Go over the collected mappings and populate CipherString.
+  // Set the TLS 1.2 and earlier ciphers, then the TLS 1.3 cipher suites.
+  // CipherString is large enough for either subset of the mappings. A list
+  // that maps to one set only leaves the OpenSSL defaults of the other.
   //
-  CipherStringPosition = CipherString;
-  for (Index = 0; Index < MappedCipherCount; Index++) {
-    OpensslCipher           = MappedCipher[Index];
-    OpensslCipherName       = SSL_CIPHER_get_name (OpensslCipher);
-    OpensslCipherNameLength = AsciiStrLen (OpensslCipherName);
-    //
-    // Append the colon (":") prefix except for the first mapping, then append
-    // OpensslCipherName.
-    //
-    if (Index > 0) {
-      *(CipherStringPosition++) = ':';
+  if (TlsBuildCipherString (MappedCipher, MappedCipherCount, FALSE, CipherString) > 0) {
+    if (SSL_set_cipher_list (TlsConn->Ssl, CipherString) <= 0) {
+      Status = EFI_UNSUPPORTED;
+      goto FreeCipherString;
     }
-
-    CopyMem (
-      CipherStringPosition,
-      OpensslCipherName,
-      OpensslCipherNameLength
-      );
-    CipherStringPosition += OpensslCipherNameLength;
   }
 
-  //
-  // NUL-terminate CipherString.
-  //
-  *(CipherStringPosition++) = '\0';
-  ASSERT (CipherStringPosition == CipherString + CipherStringSize);
-
-  //
-  // Log CipherString for debugging. CipherString can be very long if the
-  // caller provided a large CipherId array, so log CipherString in segments of
-  // 79 non-newline characters. (MAX_DEBUG_MESSAGE_LENGTH is usually 0x100 in
-  // DebugLib instances.)
-  //
-  DEBUG_CODE_BEGIN ();
-  UINTN  FullLength;
-  UINTN  SegmentLength;
-
-  FullLength = CipherStringSize - 1;
-  DEBUG ((
-    DEBUG_VERBOSE,
-    "%a:%a: CipherString={\n",
-    gEfiCallerBaseName,
-    __func__
-    ));
-  for (CipherStringPosition = CipherString;
-       CipherStringPosition < CipherString + FullLength;
-       CipherStringPosition += SegmentLength)
-  {
-    SegmentLength = FullLength - (CipherStringPosition - CipherString);
-    if (SegmentLength > 79) {
-      SegmentLength = 79;
+  if (TlsBuildCipherString (MappedCipher, MappedCipherCount, TRUE, CipherString) > 0) {
+    if (SSL_set_ciphersuites (TlsConn->Ssl, CipherString) <= 0) {
+      Status = EFI_UNSUPPORTED;
+      goto FreeCipherString;
     }
-
-    DEBUG ((DEBUG_VERBOSE, "%.*a\n", SegmentLength, CipherStringPosition));
-  }
-
-  DEBUG ((DEBUG_VERBOSE, "}\n"));
-  //
-  // Restore the pre-debug value of CipherStringPosition by skipping over the
-  // trailing NUL.
-  //
-  CipherStringPosition++;
-  ASSERT (CipherStringPosition == CipherString + CipherStringSize);
-  DEBUG_CODE_END ();
-
-  //
-  // Sets the ciphers for use by the Tls object.
-  //
-  if (SSL_set_cipher_list (TlsConn->Ssl, CipherString) <= 0) {
-    Status = EFI_UNSUPPORTED;
-    goto FreeCipherString;
   }
 
   Status = EFI_SUCCESS;
@@ -693,6 +744,9 @@ TlsSetSessionId (
   @retval  EFI_INVALID_PARAMETER   The parameter is invalid.
   @retval  EFI_OUT_OF_RESOURCES    Required resources could not be allocated.
   @retval  EFI_ABORTED             Invalid X.509 certificate.
+  @retval  EFI_ACCESS_DENIED       The TLS context uses a shared CA bundle
+                                   (TlsCtxSetCaBundle) that does not hold the
+                                   certificate.
 
 **/
 EFI_STATUS
@@ -756,6 +810,18 @@ TlsSetCaCertificate (
     goto ON_EXIT;
   }
 
+  //
+  // A shared CA bundle is read-only. Consumers that still walk the CA list
+  // per connection pass certificates the bundle already holds.
+  //
+  if (TlsCaBundleIsShared (X509Store)) {
+    if (!TlsCaBundleContains (X509Store, Cert)) {
+      Status = EFI_ACCESS_DENIED;
+    }
+
+    goto ON_EXIT;
+  }
+
   //
   // Add certificate to X509 store
   //
@@ -1127,7 +1193,9 @@ TlsSetSignatureAlgoList (
 /**
   Set the EC curve to be used for TLS flows
 
-  This function sets the EC curve to be used for TLS flows.
+  This function sets the EC curve to be used for TLS flows. With TLS 1.3 the
+  curve is also the group the ClientHello key share is generated for, so
+  selecting the group the server uses avoids a HelloRetryRequest round trip.
 
   @param[in]  Tls                Pointer to a TLS object.
   @param[in]  Data               An EC named curve as defined in section 5.1.1 of RFC 4492.
@@ -174,7 +174,9 @@ TlsNew (
     return NULL;
   }
 
-  TlsConn->Ssl = NULL;
+  TlsConn->Ssl                 = NULL;
+  TlsConn->HandshakeRoundTrips = 0;
+  TlsConn->HandshakeNs         = 0;
 
   //
   // Create a new SSL Object
@@ -198,37 +200,27 @@ TlsNew (
   TlsConn->InBio = NULL;
 
   //
-  // Set up Reading BIO for TLS connection
+  // Set up Reading BIO for TLS connection. The ring buffer BIO sets the read
+  // retry flag when it is empty, like a memory BIO with an EOF return of -1.
   //
-  TlsConn->InBio = BIO_new (BIO_s_mem ());
+  TlsConn->InBio = TlsRingBioNew (TLS_IN_BIO_CAPACITY);
   if (TlsConn->InBio == NULL) {
     TlsFree ((VOID *)TlsConn);
     return NULL;
   }
 
-  //
-  // Sets the behaviour of memory BIO when it is empty. It will set the
-  // read retry flag.
-  //
-  BIO_set_mem_eof_return (TlsConn->InBio, -1);
-
   TlsConn->OutBio = NULL;
 
   //
   // Set up Writing BIO for TLS connection
   //
-  TlsConn->OutBio = BIO_new (BIO_s_mem ());
+  TlsConn->OutBio = TlsRingBioNew (TLS_OUT_BIO_CAPACITY);
   if (TlsConn->OutBio == NULL) {
+    BIO_free (TlsConn->InBio);
     TlsFree ((VOID *)TlsConn);
     return NULL;
   }
 
-  //
-  // Sets the behaviour of memory BIO when it is empty. It will set the
-  // write retry flag.
-  //
-  BIO_set_mem_eof_return (TlsConn->OutBio, -1);
-
   ASSERT (TlsConn->Ssl != NULL && TlsConn->InBio != NULL && TlsConn->OutBio != NULL);
 
   //
@@ -81,10 +81,13 @@ TlsDoHandshake (
   TLS_CONNECTION  *TlsConn;
   UINTN           PendingBufferSize;
   INTN            Ret;
+  UINT64          StartTicks;
+  BOOLEAN         Stepped;
 
   TlsConn           = (TLS_CONNECTION *)Tls;
   PendingBufferSize = 0;
   Ret               = 1;
+  Stepped           = FALSE;
 
   if ((TlsConn == NULL) || \
       (TlsConn->Ssl == NULL) || (TlsConn->InBio == NULL) || (TlsConn->OutBio == NULL) || \
@@ -105,15 +108,27 @@ TlsDoHandshake (
     PendingBufferSize = (UINTN)BIO_ctrl_pending (TlsConn->OutBio);
     if (PendingBufferSize == 0) {
       SSL_set_connect_state (TlsConn->Ssl);
-      Ret               = SSL_do_handshake (TlsConn->Ssl);
-      PendingBufferSize = (UINTN)BIO_ctrl_pending (TlsConn->OutBio);
+      if (SSL_in_before (TlsConn->Ssl)) {
+        TlsSessionCacheAttach (TlsConn->Ssl);
+      }
+
+      Stepped    = !SSL_is_init_finished (TlsConn->Ssl);
+      StartTicks = GetPerformanceCounter ();
+      Ret        = SSL_do_handshake (TlsConn->Ssl);
+
+      TlsConn->HandshakeNs += CryptElapsedNanoSeconds (StartTicks, GetPerformanceCounter ());
+      PendingBufferSize     = (UINTN)BIO_ctrl_pending (TlsConn->OutBio);
     }
   } else {
     PendingBufferSize = (UINTN)BIO_ctrl_pending (TlsConn->OutBio);
     if (PendingBufferSize == 0) {
       BIO_write (TlsConn->InBio, BufferIn, (UINT32)BufferInSize);
-      Ret               = SSL_do_handshake (TlsConn->Ssl);
-      PendingBufferSize = (UINTN)BIO_ctrl_pending (TlsConn->OutBio);
+      Stepped    = !SSL_is_init_finished (TlsConn->Ssl);
+      StartTicks = GetPerformanceCounter ();
+      Ret        = SSL_do_handshake (TlsConn->Ssl);
+
+      TlsConn->HandshakeNs += CryptElapsedNanoSeconds (StartTicks, GetPerformanceCounter ());
+      PendingBufferSize     = (UINTN)BIO_ctrl_pending (TlsConn->OutBio);
     }
   }
 
@@ -130,6 +145,7 @@ TlsDoHandshake (
         SSL_get_state (TlsConn->Ssl),
         Ret == SSL_ERROR_SSL ? "SSL" : Ret == SSL_ERROR_SYSCALL ? "SYSCALL" : "ZERO_RETURN"
         ));
+      TlsSessionCacheEvict (TlsConn->Ssl);
       DEBUG_CODE_BEGIN ();
       while (TRUE) {
         unsigned long  ErrorCode;
@@ -158,6 +174,27 @@ TlsDoHandshake (
     }
   }
 
+  //
+  // A flight sent while the handshake is still in progress has to wait for
+  // the server. A full TLS 1.2 handshake waits twice. TLS 1.3 completes when
+  // the client sends its Finished, so it waits once unless the server asks
+  // for another key share. Stepped is TRUE when this call advanced a
+  // handshake that was not yet finished.
+  //
+  if (Stepped && (PendingBufferSize > 0) && !SSL_is_init_finished (TlsConn->Ssl)) {
+    TlsConn->HandshakeRoundTrips++;
+  } else if (Stepped && (Ret == 1)) {
+    DEBUG ((
+      DEBUG_INFO,
+      "%a: TLS 0x%04x %a handshake done in %u round trip(s), %lu ns\n",
+      __func__,
+      SSL_version (TlsConn->Ssl),
+      SSL_session_reused (TlsConn->Ssl) ? "resumed" : "full",
+      TlsConn->HandshakeRoundTrips,
+      TlsConn->HandshakeNs
+      ));
+  }
+
   if (PendingBufferSize > *BufferOutSize) {
     *BufferOutSize = PendingBufferSize;
     return EFI_BUFFER_TOO_SMALL;
@@ -430,6 +467,91 @@ TlsRead (
   return SSL_read (TlsConn->Ssl, Buffer, (UINT32)BufferSize);
 }
 
+/**
+  Decrypts received TLS records in the buffer that holds them.
+
+  This function is an alternative to TlsCtrlTrafficIn() followed by
+  TlsRead() for the network stack. Buffer holds records exactly as received;
+  on return it holds the application data they carried. When Buffer holds
+  complete records and no earlier input is pending, the read BIO hands the
+  records to OpenSSL from Buffer, so the copy into the connection's read ring
+  is skipped. OpenSSL still copies each record into its own record buffer
+  before decrypting it. The plaintext of each record is written over
+  ciphertext that has already been consumed. Otherwise the records are
+  copied into the ring first, as TlsCtrlTrafficIn() would.
+
+  Handshake messages that arrive after the handshake, such as TLS 1.3
+  session tickets, are processed and produce no application data. Any
+  response OpenSSL builds for them is returned by TlsCtrlTrafficOut().
+
+  @param[in]      Tls         Pointer to the TLS connection.
+  @param[in,out]  Buffer      On input, the received TLS records. On output,
+                              the decrypted application data.
+  @param[in]      BufferSize  Number of bytes of records in Buffer.
+
+  @retval  >=0   Number of application data bytes now at the start of Buffer.
+                 0 means the records carried no application data, or ended in
+                 a partial record that is kept for the next call.
+  @retval  <0    Decryption failed or the parameters are invalid.
+
+**/
+INTN
+EFIAPI
+TlsReadInPlace (
+  IN     VOID   *Tls,
+  IN OUT VOID   *Buffer,
+  IN     UINTN  BufferSize
+  )
+{
+  TLS_CONNECTION  *TlsConn;
+  UINT8           *Data;
+  UINTN           Produced;
+  INTN            Ret;
+  BOOLEAN         Lent;
+
+  TlsConn = (TLS_CONNECTION *)Tls;
+  Data    = (UINT8 *)Buffer;
+  if ((TlsConn == NULL) || (TlsConn->Ssl == NULL) || (TlsConn->InBio == NULL) ||
+      (Data == NULL) || (BufferSize == 0) || (BufferSize > MAX_INT32))
+  {
+    return -1;
+  }
+
+  //
+  // Each record's plaintext is no longer than the record, and OpenSSL copies
+  // a whole record out of the BIO before it writes its plaintext, so the
+  // output never overtakes the input. That only holds if every record starts
+  // in Buffer.
+  //
+  Lent = (BOOLEAN)((BIO_ctrl_pending (TlsConn->InBio) == 0) && (SSL_pending (TlsConn->Ssl) == 0) &&
+                   TlsIsCompleteRecords (Data, BufferSize));
+  if (Lent) {
+    TlsRingBioLend (TlsConn->InBio, Data, BufferSize);
+  } else if (BIO_write (TlsConn->InBio, Data, (INT32)BufferSize) != (INT32)BufferSize) {
+    return -1;
+  }
+
+  Produced = 0;
+  while (Produced < BufferSize) {
+    Ret = SSL_read (TlsConn->Ssl, Data + Produced, (INT32)(BufferSize - Produced));
+    if (Ret <= 0) {
+      if (SSL_get_error (TlsConn->Ssl, (INT32)Ret) != SSL_ERROR_WANT_READ) {
+        Produced = MAX_UINTN;
+      }
+
+      break;
+    }
+
+    Produced += (UINTN)Ret;
+  }
+
+  if (Lent && !TlsRingBioLend (TlsConn->InBio, NULL, 0)) {
+    return -1;
+  }
+
+  return (Produced == MAX_UINTN) ? -1 : (INTN)Produced;
+}
+
 /**
   Attempts to write data to a TLS connection.
 
@@ -0,0 +1,48 @@
+/** @file
+  Framing checks on received TLS records.
+
+  Kept apart from TlsProcess.c so that the host unit test can build it
+  without a TLS connection.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalTlsLib.h"
+
+/**
+  Check whether a buffer holds a whole number of complete TLS records.
+
+  @param[in]  Buffer      The buffer.
+  @param[in]  BufferSize  Size of Buffer in bytes.
+
+  @retval  TRUE   Buffer ends exactly at the end of a record.
+  @retval  FALSE  Buffer is empty or ends inside a record.
+
+**/
+BOOLEAN
+TlsIsCompleteRecords (
+  IN CONST UINT8  *Buffer,
+  IN UINTN        BufferSize
+  )
+{
+  UINTN  Offset;
+  UINTN  RecordSize;
+
+  Offset = 0;
+  while ((Offset < BufferSize) && (BufferSize - Offset >= SSL3_RT_HEADER_LENGTH)) {
+    //
+    // The record length comes from the peer. Stop before it can move Offset
+    // past the end of Buffer.
+    //
+    RecordSize = SSL3_RT_HEADER_LENGTH + ((UINTN)Buffer[Offset + 3] << 8 | Buffer[Offset + 4]);
+    if (RecordSize > BufferSize - Offset) {
+      return FALSE;
+    }
+
+    Offset += RecordSize;
+  }
+
+  return (BOOLEAN)((BufferSize > 0) && (Offset == BufferSize));
+}
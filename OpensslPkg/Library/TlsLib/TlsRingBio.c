@@ -0,0 +1,376 @@
+/** @file
+  Fixed-capacity ring buffer BIO for the TLS record traffic of a connection.
+
+  BIO_s_mem() keeps written data in a BUF_MEM that grows with realloc() and
+  moves the remaining bytes down after every read, so bursty traffic keeps
+  reallocating and copying. This BIO reserves its ring once per connection
+  and wraps around instead. It only grows if a write does not fit in the
+  room left, so TlsNew () sizes each ring for the traffic it normally holds.
+
+  The ring can also lend a caller's buffer to OpenSSL: TlsReadInPlace() lets
+  the read side consume complete records directly from the network buffer
+  and decrypts them back into it.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalTlsLib.h"
+
+typedef struct {
+  UINT8          *Buffer;
+  UINTN          Capacity;
+  //
+  // Offset of the oldest byte and number of bytes held.
+  //
+  UINTN          Head;
+  UINTN          Count;
+  //
+  // Caller buffer lent by TlsRingBioLend(), read after the ring is empty.
+  //
+  CONST UINT8    *Lent;
+  UINTN          LentSize;
+  UINTN          LentOffset;
+} TLS_RING_BIO;
+
+STATIC BIO_METHOD  *mTlsRingBioMethod = NULL;
+
+/**
+  Grow the ring so that it can hold at least Needed bytes.
+
+  @param[in, out]  Ring    The ring.
+  @param[in]       Needed  Number of bytes the ring must hold.
+
+  @retval  TRUE   The ring is large enough.
+  @retval  FALSE  Memory allocation failed.
+
+**/
+STATIC
+BOOLEAN
+TlsRingBioGrow (
+  IN OUT TLS_RING_BIO  *Ring,
+  IN     UINTN         Needed
+  )
+{
+  UINT8  *Buffer;
+  UINTN  Capacity;
+  UINTN  First;
+
+  Capacity = Ring->Capacity;
+  while (Capacity < Needed) {
+    if (Capacity > MAX_UINTN / 2) {
+      return FALSE;
+    }
+
+    Capacity *= 2;
+  }
+
+  Buffer = AllocatePool (Capacity);
+  if (Buffer == NULL) {
+    return FALSE;
+  }
+
+  DEBUG ((DEBUG_VERBOSE, "%a: %lu -> %lu bytes\n", __func__, (UINT64)Ring->Capacity, (UINT64)Capacity));
+
+  //
+  // Unwrap the held bytes to the start of the new buffer.
+  //
+  First = MIN (Ring->Count, Ring->Capacity - Ring->Head);
+  CopyMem (Buffer, Ring->Buffer + Ring->Head, First);
+  CopyMem (Buffer + First, Ring->Buffer, Ring->Count - First);
+
+  FreePool (Ring->Buffer);
+  Ring->Buffer   = Buffer;
+  Ring->Capacity = Capacity;
+  Ring->Head     = 0;
+  return TRUE;
+}
+
+/**
+  BIO write callback, appends to the ring.
+
+**/
+STATIC
+INT32
+TlsRingBioWrite (
+  BIO          *Bio,
+  CONST CHAR8  *Data,
+  INT32        Size
+  )
+{
+  TLS_RING_BIO  *Ring;
+  UINTN         Tail;
+  UINTN         First;
+
+  BIO_clear_retry_flags (Bio);
+  Ring = (TLS_RING_BIO *)BIO_get_data (Bio);
+  if ((Ring == NULL) || (Data == NULL) || (Size <= 0)) {
+    return 0;
+  }
+
+  if (((UINTN)Size > Ring->Capacity - Ring->Count) &&
+      !TlsRingBioGrow (Ring, Ring->Count + (UINTN)Size))
+  {
+    return -1;
+  }
+
+  Tail  = (Ring->Head + Ring->Count) % Ring->Capacity;
+  First = MIN ((UINTN)Size, Ring->Capacity - Tail);
+  CopyMem (Ring->Buffer + Tail, Data, First);
+  CopyMem (Ring->Buffer, Data + First, (UINTN)Size - First);
+  Ring->Count += (UINTN)Size;
+
+  return Size;
+}
+
+/**
+  BIO read callback, drains the ring and then the lent buffer.
+
+**/
+STATIC
+INT32
+TlsRingBioRead (
+  BIO    *Bio,
+  CHAR8  *Data,
+  INT32  Size
+  )
+{
+  TLS_RING_BIO  *Ring;
+  UINTN         Copied;
+  UINTN         Length;
+  UINTN         First;
+
+  BIO_clear_retry_flags (Bio);
+  Ring = (TLS_RING_BIO *)BIO_get_data (Bio);
+  if ((Ring == NULL) || (Data == NULL) || (Size <= 0)) {
+    return 0;
+  }
+
+  Copied = 0;
+  if (Ring->Count > 0) {
+    Length = MIN ((UINTN)Size, Ring->Count);
+    First  = MIN (Length, Ring->Capacity - Ring->Head);
+    CopyMem (Data, Ring->Buffer + Ring->Head, First);
+    CopyMem (Data + First, Ring->Buffer, Length - First);
+    Ring->Head   = (Ring->Head + Length) % Ring->Capacity;
+    Ring->Count -= Length;
+    Copied       = Length;
+  }
+
+  if ((Copied < (UINTN)Size) && (Ring->LentOffset < Ring->LentSize)) {
+    Length = MIN ((UINTN)Size - Copied, Ring->LentSize - Ring->LentOffset);
+    CopyMem (Data + Copied, Ring->Lent + Ring->LentOffset, Length);
+    Ring->LentOffset += Length;
+    Copied           += Length;
+  }
+
+  if (Copied == 0) {
+    //
+    // Same as BIO_s_mem() with BIO_set_mem_eof_return (Bio, -1): an empty
+    // ring asks OpenSSL to retry once more data has arrived.
+    //
+    BIO_set_retry_read (Bio);
+    return -1;
+  }
+
+  //
+  // Restart at the front of an empty ring so the next record is contiguous.
+  //
+  if (Ring->Count == 0) {
+    Ring->Head = 0;
+  }
+
+  return (INT32)Copied;
+}
+
+/**
+  BIO control callback.
+
+**/
+STATIC
+long
+TlsRingBioCtrl (
+  BIO    *Bio,
+  INT32  Cmd,
+  long   Num,
+  VOID   *Ptr
+  )
+{
+  TLS_RING_BIO  *Ring;
+
+  Ring = (TLS_RING_BIO *)BIO_get_data (Bio);
+  if (Ring == NULL) {
+    return 0;
+  }
+
+  switch (Cmd) {
+    case BIO_CTRL_PENDING:
+      return (long)(Ring->Count + Ring->LentSize - Ring->LentOffset);
+    case BIO_CTRL_WPENDING:
+      return 0;
+    case BIO_CTRL_EOF:
+      return (Ring->Count == 0) && (Ring->LentOffset == Ring->LentSize);
+    case BIO_CTRL_RESET:
+      Ring->Head  = 0;
+      Ring->Count = 0;
+      return 1;
+    case BIO_CTRL_FLUSH:
+    case BIO_CTRL_DUP:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+/**
+  BIO create callback. TlsRingBioNew () reserves the ring itself, because
+  BIO_new () passes no capacity.
+
+**/
+STATIC
+INT32
+TlsRingBioCreate (
+  BIO  *Bio
+  )
+{
+  TLS_RING_BIO  *Ring;
+
+  Ring = AllocateZeroPool (sizeof (TLS_RING_BIO));
+  if (Ring == NULL) {
+    return 0;
+  }
+
+  BIO_set_data (Bio, Ring);
+  BIO_set_init (Bio, 1);
+  return 1;
+}
+
+/**
+  BIO destroy callback, releases the ring.
+
+**/
+STATIC
+INT32
+TlsRingBioDestroy (
+  BIO  *Bio
+  )
+{
+  TLS_RING_BIO  *Ring;
+
+  Ring = (TLS_RING_BIO *)BIO_get_data (Bio);
+  if (Ring != NULL) {
+    if (Ring->Buffer != NULL) {
+      FreePool (Ring->Buffer);
+    }
+
+    FreePool (Ring);
+    BIO_set_data (Bio, NULL);
+  }
+
+  BIO_set_init (Bio, 0);
+  return 1;
+}
+
+/**
+  Create a ring buffer BIO.
+
+  @param[in]  Capacity  Initial size of the ring in bytes. The ring grows when
+                        a write does not fit.
+
+  @return  The new BIO, or NULL if it could not be allocated.
+
+**/
+BIO *
+TlsRingBioNew (
+  IN UINTN  Capacity
+  )
+{
+  BIO_METHOD    *Method;
+  BIO           *Bio;
+  TLS_RING_BIO  *Ring;
+
+  if (Capacity == 0) {
+    return NULL;
+  }
+
+  if (mTlsRingBioMethod == NULL) {
+    Method = BIO_meth_new (BIO_get_new_index () | BIO_TYPE_SOURCE_SINK, "TLS ring buffer");
+    if (Method == NULL) {
+      return NULL;
+    }
+
+    if ((BIO_meth_set_write (Method, TlsRingBioWrite) != 1) ||
+        (BIO_meth_set_read (Method, TlsRingBioRead) != 1) ||
+        (BIO_meth_set_ctrl (Method, TlsRingBioCtrl) != 1) ||
+        (BIO_meth_set_create (Method, TlsRingBioCreate) != 1) ||
+        (BIO_meth_set_destroy (Method, TlsRingBioDestroy) != 1))
+    {
+      BIO_meth_free (Method);
+      return NULL;
+    }
+
+    mTlsRingBioMethod = Method;
+  }
+
+  Bio = BIO_new (mTlsRingBioMethod);
+  if (Bio == NULL) {
+    return NULL;
+  }
+
+  Ring         = (TLS_RING_BIO *)BIO_get_data (Bio);
+  Ring->Buffer = AllocatePool (Capacity);
+  if (Ring->Buffer == NULL) {
+    BIO_free (Bio);
+    return NULL;
+  }
+
+  Ring->Capacity = Capacity;
+  return Bio;
+}
+
+/**
+  Lend a caller buffer to a ring buffer BIO, or take it back.
+
+  While a buffer is lent, reads that have drained the ring continue from it
+  without copying it into the ring first.
+
+  @param[in]  Bio     A BIO created by TlsRingBioNew().
+  @param[in]  Buffer  The buffer to lend, or NULL to take the lent buffer back.
+                      Bytes of it that were not read yet are moved into the
+                      ring.
+  @param[in]  Size    Size of Buffer in bytes.
+
+  @retval  TRUE   The operation succeeded.
+  @retval  FALSE  Unread bytes could not be moved into the ring.
+
+**/
+BOOLEAN
+TlsRingBioLend (
+  IN BIO          *Bio,
+  IN CONST UINT8  *Buffer  OPTIONAL,
+  IN UINTN        Size
+  )
+{
+  TLS_RING_BIO  *Ring;
+  CONST UINT8   *Rest;
+  UINTN         RestSize;
+
+  Ring = (TLS_RING_BIO *)BIO_get_data (Bio);
+  if (Ring == NULL) {
+    return FALSE;
+  }
+
+  Rest     = (Ring->Lent == NULL) ? NULL : Ring->Lent + Ring->LentOffset;
+  RestSize = Ring->LentSize - Ring->LentOffset;
+
+  Ring->Lent       = Buffer;
+  Ring->LentSize   = (Buffer == NULL) ? 0 : Size;
+  Ring->LentOffset = 0;
+
+  if ((Buffer == NULL) && (RestSize > 0)) {
+    return (BOOLEAN)(BIO_write (Bio, Rest, (INT32)RestSize) == (INT32)RestSize);
+  }
+
+  return TRUE;
+}
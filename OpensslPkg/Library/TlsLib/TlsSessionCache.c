@@ -0,0 +1,403 @@
+/** @file
+  Client-side TLS session cache over OpenSSL.
+
+  HTTP boot opens several connections to the same server for the NBP, kernel
+  and initrd. Keeping the session (master secret or ticket) of the first
+  connection lets the following ones resume with an abbreviated handshake
+  instead of repeating the key exchange and certificate chain verification.
+
+  The cache hangs off the SSL_CTX created by TlsCtxNew() and is keyed by the
+  server name set with TlsSetVerifyHost(). Sessions are offered automatically
+  when TlsDoHandshake() starts a handshake.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalTlsLib.h"
+
+typedef struct {
+  CHAR8          *ServerName;
+  SSL_SESSION    *Session;
+  //
+  // Value of TLS_SESSION_CACHE.Clock when the entry was last stored or
+  // offered, used to pick the least recently used entry for eviction.
+  //
+  UINT64         LastUsed;
+} TLS_SESSION_CACHE_ENTRY;
+
+typedef struct {
+  UINTN                      MaxEntries;
+  UINT64                     Clock;
+  TLS_SESSION_CACHE_ENTRY    Entries[1];
+} TLS_SESSION_CACHE;
+
+//
+// SSL_CTX ex_data index of the session cache, allocated on first use.
+//
+STATIC INT32  mTlsSessionCacheIndex = -1;
+
+/**
+  Release the session held by a cache entry.
+
+  @param[in, out]  Entry  The cache entry to clear.
+
+**/
+STATIC
+VOID
+TlsSessionCacheClearEntry (
+  IN OUT TLS_SESSION_CACHE_ENTRY  *Entry
+  )
+{
+  if (Entry->Session != NULL) {
+    SSL_SESSION_free (Entry->Session);
+  }
+
+  if (Entry->ServerName != NULL) {
+    FreePool (Entry->ServerName);
+  }
+
+  ZeroMem (Entry, sizeof (*Entry));
+}
+
+/**
+  Free a session cache and all sessions it holds.
+
+  @param[in]  Cache  The cache to free. May be NULL.
+
+**/
+STATIC
+VOID
+TlsSessionCacheFree (
+  IN TLS_SESSION_CACHE  *Cache
+  )
+{
+  UINTN  Index;
+
+  if (Cache == NULL) {
+    return;
+  }
+
+  for (Index = 0; Index < Cache->MaxEntries; Index++) {
+    TlsSessionCacheClearEntry (&Cache->Entries[Index]);
+  }
+
+  FreePool (Cache);
+}
+
+/**
+  ex_data free callback, releases the cache when its SSL_CTX is freed.
+
+**/
+STATIC
+VOID
+TlsSessionCacheExFree (
+  VOID            *Parent,
+  VOID            *Ptr,
+  CRYPTO_EX_DATA  *ExData,
+  INT32           Index,
+  long            Argl,
+  VOID            *Argp
+  )
+{
+  TlsSessionCacheFree ((TLS_SESSION_CACHE *)Ptr);
+}
+
+/**
+  Get the session cache of the SSL_CTX a connection belongs to.
+
+  @param[in]  Ssl  The SSL connection.
+
+  @return  The session cache, or NULL if caching is not enabled.
+
+**/
+STATIC
+TLS_SESSION_CACHE *
+TlsSessionCacheGet (
+  IN CONST SSL  *Ssl
+  )
+{
+  if (mTlsSessionCacheIndex < 0) {
+    return NULL;
+  }
+
+  return (TLS_SESSION_CACHE *)SSL_CTX_get_ex_data (SSL_get_SSL_CTX (Ssl), mTlsSessionCacheIndex);
+}
+
+/**
+  Find the cache entry of a server name.
+
+  @param[in]  Cache       The session cache.
+  @param[in]  ServerName  The server name to look up.
+
+  @return  The entry, or NULL if the server name has no entry.
+
+**/
+STATIC
+TLS_SESSION_CACHE_ENTRY *
+TlsSessionCacheLookup (
+  IN TLS_SESSION_CACHE  *Cache,
+  IN CONST CHAR8        *ServerName
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Cache->MaxEntries; Index++) {
+    if ((Cache->Entries[Index].ServerName != NULL) &&
+        (AsciiStrCmp (Cache->Entries[Index].ServerName, ServerName) == 0))
+    {
+      return &Cache->Entries[Index];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  OpenSSL new session callback, stores a session once the server has sent it.
+
+  TLS 1.2 delivers the session at the end of the handshake; TLS 1.3 delivers
+  one per NewSessionTicket message. A later session for the same server
+  replaces the earlier one.
+
+  @param[in]  Ssl      The SSL connection the session belongs to.
+  @param[in]  Session  The new session.
+
+  @retval  1  The cache took ownership of the Session reference.
+  @retval  0  The session was not cached.
+
+**/
+STATIC
+INT32
+TlsSessionCacheNewCallback (
+  IN SSL          *Ssl,
+  IN SSL_SESSION  *Session
+  )
+{
+  TLS_SESSION_CACHE        *Cache;
+  TLS_SESSION_CACHE_ENTRY  *Entry;
+  CONST CHAR8              *ServerName;
+  CHAR8                    *NameCopy;
+  UINTN                    Index;
+
+  Cache      = TlsSessionCacheGet (Ssl);
+  ServerName = SSL_get_servername (Ssl, TLSEXT_NAMETYPE_host_name);
+  if ((Cache == NULL) || (ServerName == NULL) || !SSL_SESSION_is_resumable (Session)) {
+    return 0;
+  }
+
+  Entry = TlsSessionCacheLookup (Cache, ServerName);
+  if (Entry == NULL) {
+    //
+    // Take a free slot, otherwise evict the least recently used entry.
+    //
+    Entry = &Cache->Entries[0];
+    for (Index = 0; Index < Cache->MaxEntries; Index++) {
+      if (Cache->Entries[Index].ServerName == NULL) {
+        Entry = &Cache->Entries[Index];
+        break;
+      }
+
+      if (Cache->Entries[Index].LastUsed < Entry->LastUsed) {
+        Entry = &Cache->Entries[Index];
+      }
+    }
+
+    NameCopy = AllocateCopyPool (AsciiStrSize (ServerName), ServerName);
+    if (NameCopy == NULL) {
+      return 0;
+    }
+
+    TlsSessionCacheClearEntry (Entry);
+    Entry->ServerName = NameCopy;
+  } else if (Entry->Session != NULL) {
+    SSL_SESSION_free (Entry->Session);
+  }
+
+  Entry->Session  = Session;
+  Entry->LastUsed = ++Cache->Clock;
+
+  DEBUG ((
+    DEBUG_VERBOSE,
+    "%a:%a: cached TLS 0x%04x session for %a\n",
+    gEfiCallerBaseName,
+    __func__,
+    SSL_SESSION_get_protocol_version (Session),
+    ServerName
+    ));
+
+  return 1;
+}
+
+/**
+  Offer the cached session of the connection's server name, if there is one.
+
+  Called before the first handshake step of a client connection.
+
+  @param[in]  Ssl  The SSL connection.
+
+**/
+VOID
+TlsSessionCacheAttach (
+  IN SSL  *Ssl
+  )
+{
+  TLS_SESSION_CACHE        *Cache;
+  TLS_SESSION_CACHE_ENTRY  *Entry;
+  CONST CHAR8              *ServerName;
+
+  Cache      = TlsSessionCacheGet (Ssl);
+  ServerName = SSL_get_servername (Ssl, TLSEXT_NAMETYPE_host_name);
+  if ((Cache == NULL) || (ServerName == NULL)) {
+    return;
+  }
+
+  Entry = TlsSessionCacheLookup (Cache, ServerName);
+  if ((Entry == NULL) || (Entry->Session == NULL)) {
+    return;
+  }
+
+  if (SSL_set_session (Ssl, Entry->Session) == 1) {
+    Entry->LastUsed = ++Cache->Clock;
+  }
+}
+
+/**
+  Drop the cached session of the connection's server name.
+
+  Called when a handshake fails, so a session the server no longer accepts
+  is not offered again.
+
+  @param[in]  Ssl  The SSL connection.
+
+**/
+VOID
+TlsSessionCacheEvict (
+  IN SSL  *Ssl
+  )
+{
+  TLS_SESSION_CACHE        *Cache;
+  TLS_SESSION_CACHE_ENTRY  *Entry;
+  CONST CHAR8              *ServerName;
+
+  Cache      = TlsSessionCacheGet (Ssl);
+  ServerName = SSL_get_servername (Ssl, TLSEXT_NAMETYPE_host_name);
+  if ((Cache == NULL) || (ServerName == NULL)) {
+    return;
+  }
+
+  Entry = TlsSessionCacheLookup (Cache, ServerName);
+  if (Entry != NULL) {
+    TlsSessionCacheClearEntry (Entry);
+  }
+}
+
+/**
+  Enable, resize or disable the client session cache of a TLS context.
+
+  With the cache enabled, every TLS object created from TlsCtx by TlsNew()
+  stores the session (including a session ticket) it negotiated under the
+  server name set by TlsSetVerifyHost(), and offers it again when the next
+  connection to the same server name starts its handshake. Calling this
+  function again drops all cached sessions.
+
+  A connection has to be closed with TlsCloseNotify() before TlsFree() for
+  its session to stay resumable. TLS 1.2 sessions resume by session ID only,
+  because OpenSSL does not use TLS 1.2 tickets at the security level set by
+  TlsNew().
+
+  @param[in]  TlsCtx      Pointer to the SSL_CTX object.
+  @param[in]  MaxEntries  Number of server names to keep sessions for.
+                          0 disables the cache.
+
+  @retval  EFI_SUCCESS           The session cache was configured.
+  @retval  EFI_INVALID_PARAMETER TlsCtx is NULL.
+  @retval  EFI_OUT_OF_RESOURCES  Memory allocation failed.
+
+**/
+EFI_STATUS
+EFIAPI
+TlsCtxSetSessionCache (
+  IN VOID   *TlsCtx,
+  IN UINTN  MaxEntries
+  )
+{
+  SSL_CTX            *SslCtx;
+  TLS_SESSION_CACHE  *Cache;
+  UINTN              CacheSize;
+
+  SslCtx = (SSL_CTX *)TlsCtx;
+  if (SslCtx == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (mTlsSessionCacheIndex < 0) {
+    mTlsSessionCacheIndex = SSL_CTX_get_ex_new_index (0, NULL, NULL, NULL, TlsSessionCacheExFree);
+    if (mTlsSessionCacheIndex < 0) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  Cache = NULL;
+  if (MaxEntries > 0) {
+    if (EFI_ERROR (SafeUintnMult (MaxEntries - 1, sizeof (TLS_SESSION_CACHE_ENTRY), &CacheSize)) ||
+        EFI_ERROR (SafeUintnAdd (CacheSize, sizeof (TLS_SESSION_CACHE), &CacheSize)))
+    {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    Cache = AllocateZeroPool (CacheSize);
+    if (Cache == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    Cache->MaxEntries = MaxEntries;
+  }
+
+  TlsSessionCacheFree ((TLS_SESSION_CACHE *)SSL_CTX_get_ex_data (SslCtx, mTlsSessionCacheIndex));
+  SSL_CTX_set_ex_data (SslCtx, mTlsSessionCacheIndex, Cache);
+
+  if (Cache == NULL) {
+    SSL_CTX_set_session_cache_mode (SslCtx, SSL_SESS_CACHE_OFF);
+    SSL_CTX_sess_set_new_cb (SslCtx, NULL);
+    return EFI_SUCCESS;
+  }
+
+  //
+  // OpenSSL only hands client sessions to the callback in client cache mode.
+  // Its own internal store is keyed by session ID, which a client cannot look
+  // up by server name, so it is not used.
+  //
+  SSL_CTX_set_session_cache_mode (SslCtx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+  SSL_CTX_sess_set_new_cb (SslCtx, TlsSessionCacheNewCallback);
+  SSL_CTX_clear_options (SslCtx, SSL_OP_NO_TICKET);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Check whether the handshake of a TLS object resumed a cached session.
+
+  @param[in]  Tls  Pointer to the TLS object.
+
+  @retval  TRUE   The connection resumed an earlier session.
+  @retval  FALSE  The connection did a full handshake, has not completed the
+                  handshake yet, or Tls is NULL.
+
+**/
+BOOLEAN
+EFIAPI
+TlsSessionReused (
+  IN VOID  *Tls
+  )
+{
+  TLS_CONNECTION  *TlsConn;
+
+  TlsConn = (TLS_CONNECTION *)Tls;
+  if ((TlsConn == NULL) || (TlsConn->Ssl == NULL)) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)(SSL_session_reused (TlsConn->Ssl) == 1);
+}
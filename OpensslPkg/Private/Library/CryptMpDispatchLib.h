@@ -0,0 +1,72 @@
+/** @file
+  Starts BaseCryptLib work on the application processors.
+
+  BaseCryptLib.inf is linked both into DXE drivers, which can start the APs
+  through the MP services protocol, and into OneCryptoBin, which runs
+  without boot services. ParallelHash and the batch hash functions call this
+  library class, and the DSC picks DxeCryptMpDispatchLib for DXE drivers
+  and BaseCryptMpDispatchLibNull, which runs everything on the calling
+  processor, everywhere else.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef CRYPT_MP_DISPATCH_LIB_H_
+#define CRYPT_MP_DISPATCH_LIB_H_
+
+#include <Uefi.h>
+#include <Pi/PiMultiPhase.h>
+
+/**
+  Run a procedure on each AP.
+
+  Procedure may run on the APs concurrently with the caller, so it must not
+  use services that are not MP safe, such as memory allocation.
+
+  @param[in]  Procedure  Procedure to run on each AP.
+  @param[in]  Argument   Argument passed to Procedure.
+
+  @return  The number of APs that may still be running Procedure when this
+           function returns. The caller must not release Argument before each
+           of them has signalled that it is done.
+**/
+UINTN
+EFIAPI
+DispatchToAp (
+  IN EFI_AP_PROCEDURE  Procedure,
+  IN VOID              *Argument
+  );
+
+/**
+  Start a procedure on each AP and return without waiting for the APs.
+
+  Procedure must complete the work whichever processors run it, and however
+  many. If no AP can run Procedure, it runs once on the calling processor
+  before this function returns.
+
+  @param[in]   Procedure  Procedure to run on each AP.
+  @param[in]   Argument   Argument passed to Procedure.
+  @param[in]   WaitEvent  Event signalled once every AP has returned from
+                          Procedure, or NULL. Only DXE supports events.
+  @param[out]  Running    Number of APs that may still be running Procedure
+                          when this function returns. The caller must not
+                          release Argument before each of them has signalled
+                          that it is done.
+
+  @retval EFI_SUCCESS      Procedure was started, or has run on the calling
+                           processor.
+  @retval EFI_UNSUPPORTED  WaitEvent is not NULL and this phase has no events.
+                           Procedure was not run.
+**/
+EFI_STATUS
+EFIAPI
+DispatchToApAsync (
+  IN  EFI_AP_PROCEDURE  Procedure,
+  IN  VOID              *Argument,
+  IN  EFI_EVENT         WaitEvent  OPTIONAL,
+  OUT UINTN             *Running
+  );
+
+#endif // CRYPT_MP_DISPATCH_LIB_H_
@@ -11,4 +11,28 @@
 
 #include <openssl/opensslv.h>
 
+// MU_CHANGE [BEGIN]
+
+/**
+  Returns the capability words OpenSSL selects its assembly paths from.
+
+  @param[out]     Capability  Receives OPENSSL_ia32cap_P on IA32 and X64, or
+                              OPENSSL_armcap_P on AARCH64.
+  @param[in,out]  Count       On input, the number of entries Capability
+                              holds. On output, the number of capability
+                              words of this architecture.
+
+  @retval RETURN_SUCCESS           Capability holds the words.
+  @retval RETURN_BUFFER_TOO_SMALL  Count is too small and was updated.
+  @retval RETURN_UNSUPPORTED       This OpensslLib has no CPU specific code.
+**/
+RETURN_STATUS
+EFIAPI
+OpensslLibGetCpuCapability (
+  OUT    UINT32  *Capability,
+  IN OUT UINTN   *Count
+  );
+
+// MU_CHANGE [END]
+
 #endif
@@ -0,0 +1,634 @@
+/** @file
+  Host-based benchmark of the C runtime string and sort routines behind the
+  OpenSSL and MbedTLS BaseCryptLib instances.
+
+  Every case is run twice. The "-old" row times the implementation the
+  routine had before SysCall/CrtString.c and SysCall/CrtSort.c, copied here,
+  and the "-new" row times the BaseCryptLib routine:
+
+    crt-strlen    AsciiStrnLenS () bounded by MAX_STRING_SIZE, CrtStrnLen ()
+    crt-strcmp    AsciiStrCmp (), CrtStrCmp ()
+    crt-strchr    ScanMem8 () over AsciiStrSize (), CrtStrChr ()
+    crt-strcspn   Byte map loop, CrtStrCspn ()
+    crt-qsort-*   BaseSortLib QuickSortWorker (), CrtQuickSort ()
+
+  The strings are as long as algorithm names, property queries and
+  distinguished names. The sorts order UINTN elements, as OPENSSL_sk_sort ()
+  passes pointers, at the sizes of DER SET OF encodings, name tables and
+  certificate stores.
+
+  OpensslPkgHostUnitTest.dsc links this application with
+  BenchmarkHostBaseCryptLib.inf, which scans strings a word at a time like
+  the firmware instances. UnitTestHostBaseCryptLib.inf scans them a byte at
+  a time and would only time that fallback. The output uses the CSV format
+  of BaseCryptLibBenchmarkHost, so its --compare mode works on these results
+  too.
+
+  Usage:
+    CrtLibBenchmarkHost [--label Name] [-o File]
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+
+#define BENCHMARK_CSV_HEADER \
+  "label,name,size,iterations,status,ns_per_op,ops_per_sec,cycles_per_byte,allocs_per_op"
+
+//
+// Bound of the AsciiStrnLenS () based strlen(), as in CrtLibSupport.h.
+//
+#define MAX_STRING_SIZE  0x1000
+
+#define STRING_SIZE_MAX  256
+#define SORT_COUNT_MAX   4096
+
+//
+// Implemented by SysCall/CrtString.c and SysCall/CrtSort.c of BaseCryptLib.
+// Their declarations in CrtLibSupport.h come with macros that replace the C
+// library, so they are repeated here.
+//
+typedef
+int
+(*CRT_SORT_COMPARE)(
+  CONST VOID  *Element1,
+  CONST VOID  *Element2
+  );
+
+UINTN
+EFIAPI
+CrtStrnLen (
+  IN CONST CHAR8  *String,
+  IN UINTN        MaxLength
+  );
+
+INTN
+EFIAPI
+CrtStrCmp (
+  IN CONST CHAR8  *First,
+  IN CONST CHAR8  *Second
+  );
+
+CHAR8 *
+EFIAPI
+CrtStrChr (
+  IN CONST CHAR8  *String,
+  IN CHAR8        Char
+  );
+
+UINTN
+EFIAPI
+CrtStrCspn (
+  IN CONST CHAR8  *String,
+  IN CONST CHAR8  *Reject
+  );
+
+VOID
+EFIAPI
+CrtQuickSort (
+  IN OUT VOID              *Base,
+  IN     UINTN             Count,
+  IN     UINTN             Width,
+  IN     CRT_SORT_COMPARE  Compare
+  );
+
+typedef struct _CRT_BENCHMARK_CASE CRT_BENCHMARK_CASE;
+
+typedef
+VOID
+(*CRT_BENCHMARK_SETUP)(
+  IN CONST CRT_BENCHMARK_CASE  *Case
+  );
+
+typedef
+BOOLEAN
+(*CRT_BENCHMARK_RUN)(
+  IN CONST CRT_BENCHMARK_CASE  *Case
+  );
+
+struct _CRT_BENCHMARK_CASE {
+  CONST CHAR8            *Name;
+  UINTN                  Size;
+  UINTN                  Iterations;
+  CRT_BENCHMARK_SETUP    Setup;
+  CRT_BENCHMARK_RUN      Run;
+};
+
+//
+// The string cases search mString and compare it with mStringCopy. The sort
+// cases sort a fresh copy of mSortInput in mSortElements every iteration.
+//
+STATIC CHAR8  mString[STRING_SIZE_MAX + 1];
+STATIC CHAR8  mStringCopy[STRING_SIZE_MAX + 1];
+STATIC UINTN  mSortInput[SORT_COUNT_MAX];
+STATIC UINTN  mSortElements[SORT_COUNT_MAX];
+
+/**
+  Returns a monotonic wall clock timestamp in nanoseconds.
+**/
+STATIC
+UINT64
+BenchmarkNanoSeconds (
+  VOID
+  )
+{
+  struct timespec  Now;
+
+  timespec_get (&Now, TIME_UTC);
+  return (UINT64)Now.tv_sec * 1000000000ULL + (UINT64)Now.tv_nsec;
+}
+
+//
+// Implementations the routines had before CrtString.c and CrtSort.c.
+//
+
+/**
+  strcspn() as CrtWrapper.c implemented it, with a byte per map entry.
+**/
+STATIC
+UINTN
+BaselineStrCspn (
+  IN CONST CHAR8  *s1,
+  IN CONST CHAR8  *s2
+  )
+{
+  UINT8   Map[32];
+  UINT32  Index;
+  UINTN   Count;
+
+  for (Index = 0; Index < 32; Index++) {
+    Map[Index] = 0;
+  }
+
+  while (*s2) {
+    Map[*s2 >> 3] |= (1 << (*s2 & 7));
+    s2++;
+  }
+
+  Map[0] |= 1;
+
+  Count = 0;
+  while (!(Map[*s1 >> 3] & (1 << (*s1 & 7)))) {
+    Count++;
+    s1++;
+  }
+
+  return Count;
+}
+
+/**
+  qsort() worker that CrtWrapper.c duplicated from EDKII BaseSortLib.
+**/
+STATIC
+VOID
+BaselineQuickSortWorker (
+  IN OUT    VOID              *BufferToSort,
+  IN CONST  UINTN             Count,
+  IN CONST  UINTN             ElementSize,
+  IN        CRT_SORT_COMPARE  CompareFunction,
+  IN        VOID              *Buffer
+  )
+{
+  VOID   *Pivot;
+  UINTN  LoopCount;
+  UINTN  NextSwapLocation;
+
+  if ((Count < 2) || (ElementSize  < 1)) {
+    return;
+  }
+
+  NextSwapLocation = 0;
+
+  //
+  // Pick a pivot (we choose last element)
+  //
+  Pivot = ((UINT8 *)BufferToSort + ((Count - 1) * ElementSize));
+
+  //
+  // Now get the pivot such that all on "left" are below it
+  // and everything "right" are above it
+  //
+  for (LoopCount = 0; LoopCount < Count - 1; LoopCount++) {
+    if (CompareFunction ((VOID *)((UINT8 *)BufferToSort + ((LoopCount) * ElementSize)), Pivot) <= 0) {
+      CopyMem (Buffer, (UINT8 *)BufferToSort + (NextSwapLocation * ElementSize), ElementSize);
+      CopyMem ((UINT8 *)BufferToSort + (NextSwapLocation * ElementSize), (UINT8 *)BufferToSort + ((LoopCount) * ElementSize), ElementSize);
+      CopyMem ((UINT8 *)BufferToSort + ((LoopCount) * ElementSize), Buffer, ElementSize);
+      NextSwapLocation++;
+    }
+  }
+
+  //
+  // Swap pivot to its final position (NextSwapLocation)
+  //
+  CopyMem (Buffer, Pivot, ElementSize);
+  CopyMem (Pivot, (UINT8 *)BufferToSort + (NextSwapLocation * ElementSize), ElementSize);
+  CopyMem ((UINT8 *)BufferToSort + (NextSwapLocation * ElementSize), Buffer, ElementSize);
+
+  BaselineQuickSortWorker (BufferToSort, NextSwapLocation, ElementSize, CompareFunction, Buffer);
+  BaselineQuickSortWorker (
+    (UINT8 *)BufferToSort + (NextSwapLocation + 1) * ElementSize,
+    Count - NextSwapLocation - 1,
+    ElementSize,
+    CompareFunction,
+    Buffer
+    );
+}
+
+/**
+  qsort() as CrtWrapper.c implemented it, with a swap buffer from the heap.
+**/
+STATIC
+VOID
+BaselineQuickSort (
+  IN OUT VOID              *Base,
+  IN     UINTN             Count,
+  IN     UINTN             Width,
+  IN     CRT_SORT_COMPARE  Compare
+  )
+{
+  VOID  *Buffer;
+
+  Buffer = malloc (Width);
+  if (Buffer == NULL) {
+    return;
+  }
+
+  BaselineQuickSortWorker (Base, Count, Width, Compare, Buffer);
+  free (Buffer);
+}
+
+//
+// String cases. Size is the string length.
+//
+
+STATIC
+VOID
+SetupString (
+  IN CONST CRT_BENCHMARK_CASE  *Case
+  )
+{
+  UINTN  Index;
+
+  //
+  // Lowercase letters ending in the '/' the search cases look for.
+  //
+  for (Index = 0; Index < Case->Size - 1; Index++) {
+    mString[Index] = (CHAR8)('a' + Index % 26);
+  }
+
+  mString[Case->Size - 1] = '/';
+  mString[Case->Size]     = '\0';
+  CopyMem (mStringCopy, mString, Case->Size + 1);
+}
+
+STATIC
+BOOLEAN
+RunStrLenOld (
+  IN CONST CRT_BENCHMARK_CASE  *Case
+  )
+{
+  return AsciiStrnLenS (mString, MAX_STRING_SIZE) == Case->Size;
+}
+
+STATIC
+BOOLEAN
+RunStrLenNew (
+  IN CONST CRT_BENCHMARK_CASE  *Case
+  )
+{
+  return CrtStrnLen (mString, MAX_STRING_SIZE) == Case->Size;
+}
+
+STATIC
+BOOLEAN
+RunStrCmpOld (
+  IN CONST CRT_BENCHMARK_CASE  *Case
+  )
+{
+  return AsciiStrCmp (mString, mStringCopy) == 0;
+}
+
+STATIC
+BOOLEAN
+RunStrCmpNew (
+  IN CONST CRT_BENCHMARK_CASE  *Case
+  )
+{
+  return CrtStrCmp (mString, mStringCopy) == 0;
+}
+
+STATIC
+BOOLEAN
+RunStrChrOld (
+  IN CONST CRT_BENCHMARK_CASE  *Case
+  )
+{
+  return ScanMem8 (mString, AsciiStrSize (mString), '/') == mString + Case->Size - 1;
+}
+
+STATIC
+BOOLEAN
+RunStrChrNew (
+  IN CONST CRT_BENCHMARK_CASE  *Case
+  )
+{
+  return CrtStrChr (mString, '/') == mString + Case->Size - 1;
+}
+
+STATIC
+BOOLEAN
+RunStrCspnOld (
+  IN CONST CRT_BENCHMARK_CASE  *Case
+  )
+{
+  return BaselineStrCspn (mString, ":/") == Case->Size - 1;
+}
+
+STATIC
+BOOLEAN
+RunStrCspnNew (
+  IN CONST CRT_BENCHMARK_CASE  *Case
+  )
+{
+  return CrtStrCspn (mString, ":/") == Case->Size - 1;
+}
+
+//
+// Sort cases. Size is the element count.
+//
+
+STATIC
+int
+CompareUintn (
+  CONST VOID  *Element1,
+  CONST VOID  *Element2
+  )
+{
+  UINTN  Value1;
+  UINTN  Value2;
+
+  Value1 = *(CONST UINTN *)Element1;
+  Value2 = *(CONST UINTN *)Element2;
+  return (Value1 < Value2) ? -1 : (Value1 > Value2);
+}
+
+STATIC
+VOID
+SetupSortSorted (
+  IN CONST CRT_BENCHMARK_CASE  *Case
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Case->Size; Index++) {
+    mSortInput[Index] = Index;
+  }
+}
+
+STATIC
+VOID
+SetupSortReversed (
+  IN CONST CRT_BENCHMARK_CASE  *Case
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Case->Size; Index++) {
+    mSortInput[Index] = Case->Size - Index;
+  }
+}
+
+STATIC
+VOID
+SetupSortRandom (
+  IN CONST CRT_BENCHMARK_CASE  *Case
+  )
+{
+  UINTN   Index;
+  UINT32  State;
+
+  //
+  // Fixed xorshift sequence, so every run sorts the same permutation.
+  //
+  State = 0x2545F491;
+  for (Index = 0; Index < Case->Size; Index++) {
+    State            ^= State << 13;
+    State            ^= State >> 17;
+    State            ^= State << 5;
+    mSortInput[Index] = State;
+  }
+}
+
+/**
+  Checks that the sort cases left mSortElements in ascending order.
+**/
+STATIC
+BOOLEAN
+IsSorted (
+  IN UINTN  Count
+  )
+{
+  UINTN  Index;
+
+  for (Index = 1; Index < Count; Index++) {
+    if (mSortElements[Index - 1] > mSortElements[Index]) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+STATIC
+BOOLEAN
+RunSortOld (
+  IN CONST CRT_BENCHMARK_CASE  *Case
+  )
+{
+  CopyMem (mSortElements, mSortInput, Case->Size * sizeof (UINTN));
+  BaselineQuickSort (mSortElements, Case->Size, sizeof (UINTN), CompareUintn);
+  return mSortElements[0] <= mSortElements[Case->Size - 1];
+}
+
+STATIC
+BOOLEAN
+RunSortNew (
+  IN CONST CRT_BENCHMARK_CASE  *Case
+  )
+{
+  CopyMem (mSortElements, mSortInput, Case->Size * sizeof (UINTN));
+  CrtQuickSort (mSortElements, Case->Size, sizeof (UINTN), CompareUintn);
+  return mSortElements[0] <= mSortElements[Case->Size - 1];
+}
+
+#define STRING_CASES(Name, RunOld, RunNew)                      \
+  { Name "-old", 16,  1000000, SetupString, RunOld },           \
+  { Name "-new", 16,  1000000, SetupString, RunNew },           \
+  { Name "-old", 64,  1000000, SetupString, RunOld },           \
+  { Name "-new", 64,  1000000, SetupString, RunNew },           \
+  { Name "-old", 256, 200000,  SetupString, RunOld },           \
+  { Name "-new", 256, 200000,  SetupString, RunNew }
+
+//
+// The old sort takes its pivot from the end, so sorted and reversed input
+// cost it quadratic time. Its large cases run fewer iterations.
+//
+#define SORT_CASES(Name, Setup)                                 \
+  { Name "-old", 16,   200000, Setup, RunSortOld },             \
+  { Name "-new", 16,   200000, Setup, RunSortNew },             \
+  { Name "-old", 256,  2000,   Setup, RunSortOld },             \
+  { Name "-new", 256,  10000,  Setup, RunSortNew },             \
+  { Name "-old", 4096, 20,     Setup, RunSortOld },             \
+  { Name "-new", 4096, 500,    Setup, RunSortNew }
+
+STATIC CONST CRT_BENCHMARK_CASE  mCases[] = {
+  STRING_CASES ("crt-strlen",  RunStrLenOld,  RunStrLenNew),
+  STRING_CASES ("crt-strcmp",  RunStrCmpOld,  RunStrCmpNew),
+  STRING_CASES ("crt-strchr",  RunStrChrOld,  RunStrChrNew),
+  STRING_CASES ("crt-strcspn", RunStrCspnOld, RunStrCspnNew),
+  SORT_CASES ("crt-qsort-sorted",   SetupSortSorted),
+  SORT_CASES ("crt-qsort-reversed", SetupSortReversed),
+  SORT_CASES ("crt-qsort-random",   SetupSortRandom),
+};
+
+/**
+  Writes one CSV result row.
+**/
+STATIC
+VOID
+ReportResult (
+  IN FILE                      *Output,
+  IN CONST CHAR8               *Label,
+  IN CONST CRT_BENCHMARK_CASE  *Case,
+  IN CONST CHAR8               *Status,
+  IN UINT64                    Nanoseconds
+  )
+{
+  double  NsPerOp;
+
+  NsPerOp = (double)Nanoseconds / (double)Case->Iterations;
+  fprintf (
+    Output,
+    "%s,%s,%u,%u,%s,%.1f,%.1f,0,0.00\n",
+    Label,
+    Case->Name,
+    (unsigned)Case->Size,
+    (unsigned)Case->Iterations,
+    Status,
+    NsPerOp,
+    (NsPerOp > 0) ? 1e9 / NsPerOp : 0
+    );
+  fflush (Output);
+}
+
+/**
+  Runs one case.
+
+  The result of the first iteration is checked, and for the sorts the whole
+  order, so that a wrong routine fails instead of being timed.
+
+  @retval  TRUE   The case passed.
+  @retval  FALSE  The case failed.
+**/
+STATIC
+BOOLEAN
+RunCase (
+  IN FILE                      *Output,
+  IN CONST CHAR8               *Label,
+  IN CONST CRT_BENCHMARK_CASE  *Case
+  )
+{
+  UINTN    Index;
+  UINT64   Start;
+  BOOLEAN  Passed;
+
+  Case->Setup (Case);
+  Passed = Case->Run (Case);
+  if (Passed && ((Case->Run == RunSortOld) || (Case->Run == RunSortNew))) {
+    Passed = IsSorted (Case->Size);
+  }
+
+  if (!Passed) {
+    ReportResult (Output, Label, Case, "failed", 0);
+    return FALSE;
+  }
+
+  Start = BenchmarkNanoSeconds ();
+  for (Index = 0; Index < Case->Iterations; Index++) {
+    Passed &= Case->Run (Case);
+  }
+
+  ReportResult (Output, Label, Case, Passed ? "ok" : "failed", BenchmarkNanoSeconds () - Start);
+  return Passed;
+}
+
+/**
+  Prints the command line usage.
+
+  @param[in]  Program  Name the application was invoked with.
+**/
+STATIC
+VOID
+PrintUsage (
+  IN CONST CHAR8  *Program
+  )
+{
+  fprintf (stderr, "Usage:\n");
+  fprintf (stderr, "  %s [--label Name] [-o File]\n", Program);
+}
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  CONST CHAR8  *Label;
+  CONST CHAR8  *OutputPath;
+  FILE         *Output;
+  UINTN        Index;
+  BOOLEAN      Passed;
+
+  Label      = "default";
+  OutputPath = NULL;
+  for (Index = 1; Index < (UINTN)argc; Index++) {
+    if ((strcmp (argv[Index], "--label") == 0) && (Index + 1 < (UINTN)argc)) {
+      Label = argv[++Index];
+    } else if ((strcmp (argv[Index], "-o") == 0) && (Index + 1 < (UINTN)argc)) {
+      OutputPath = argv[++Index];
+    } else {
+      PrintUsage (argv[0]);
+      return 2;
+    }
+  }
+
+  Output = stdout;
+  if (OutputPath != NULL) {
+    Output = fopen (OutputPath, "w");
+    if (Output == NULL) {
+      fprintf (stderr, "Cannot open %s\n", OutputPath);
+      return 2;
+    }
+  }
+
+  fprintf (Output, "%s\n", BENCHMARK_CSV_HEADER);
+  Passed = TRUE;
+  for (Index = 0; Index < ARRAY_SIZE (mCases); Index++) {
+    Passed = RunCase (Output, Label, &mCases[Index]) && Passed;
+  }
+
+  if (Output != stdout) {
+    fclose (Output);
+  }
+
+  return Passed ? 0 : 1;
+}
@@ -0,0 +1,213 @@
+/** @file
+  Host-based unit tests for the TlsLib internals that need no connection.
+
+  TlsIsCompleteRecords () decides whether TlsReadInPlace () can lend the
+  caller's buffer to OpenSSL. It must only accept buffers that end exactly
+  at a record boundary, whatever record lengths the peer sends.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "../../Library/TlsLib/InternalTlsLib.h"
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "TlsLib Internal Unit Tests"
+#define UNIT_TEST_VERSION  "1.0"
+
+//
+// Largest record length the 16-bit length field can carry.
+//
+#define TLS_RECORD_MAX_LENGTH  0xFFFF
+
+/**
+  Writes a record header followed by Length payload bytes.
+
+  @param[out]  Buffer  Receives the record.
+  @param[in]   Length  Payload length to encode.
+
+  @return  The size of the record in bytes.
+**/
+STATIC
+UINTN
+WriteRecord (
+  OUT UINT8  *Buffer,
+  IN  UINTN  Length
+  )
+{
+  Buffer[0] = SSL3_RT_APPLICATION_DATA;
+  Buffer[1] = 0x03;
+  Buffer[2] = 0x03;
+  Buffer[3] = (UINT8)(Length >> 8);
+  Buffer[4] = (UINT8)Length;
+  SetMem (Buffer + SSL3_RT_HEADER_LENGTH, Length, 0xA5);
+  return SSL3_RT_HEADER_LENGTH + Length;
+}
+
+/**
+  Buffers that end on a record boundary are accepted.
+
+  @param[in]  Context  Unused.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestCompleteRecords (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8  Buffer[256];
+  UINTN  Size;
+
+  Size = WriteRecord (Buffer, 32);
+  UT_ASSERT_TRUE (TlsIsCompleteRecords (Buffer, Size));
+
+  //
+  // A record with no payload is only a header.
+  //
+  Size = WriteRecord (Buffer, 0);
+  UT_ASSERT_TRUE (TlsIsCompleteRecords (Buffer, Size));
+
+  Size  = WriteRecord (Buffer, 17);
+  Size += WriteRecord (Buffer + Size, 0);
+  Size += WriteRecord (Buffer + Size, 100);
+  UT_ASSERT_TRUE (TlsIsCompleteRecords (Buffer, Size));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Buffers that are empty or end inside a header or a payload are rejected.
+
+  @param[in]  Context  Unused.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestPartialRecords (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8  Buffer[256];
+  UINTN  Size;
+  UINTN  Cut;
+
+  Size = WriteRecord (Buffer, 32);
+  UT_ASSERT_FALSE (TlsIsCompleteRecords (Buffer, 0));
+  for (Cut = 1; Cut < Size; Cut++) {
+    UT_ASSERT_FALSE (TlsIsCompleteRecords (Buffer, Cut));
+  }
+
+  //
+  // A complete record followed by the start of the next one.
+  //
+  Size = WriteRecord (Buffer, 32);
+  WriteRecord (Buffer + Size, 32);
+  for (Cut = 1; Cut < SSL3_RT_HEADER_LENGTH + 32; Cut++) {
+    UT_ASSERT_FALSE (TlsIsCompleteRecords (Buffer, Size + Cut));
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Record lengths from the peer cannot move the scan past the buffer.
+
+  @param[in]  Context  Unused.
+
+  @retval  UNIT_TEST_PASSED                      The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED           An assertion failed.
+  @retval  UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  Out of memory.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestRecordLengthBounds (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8  *Buffer;
+  UINTN  Size;
+
+  Buffer = AllocatePool (2 * (SSL3_RT_HEADER_LENGTH + TLS_RECORD_MAX_LENGTH));
+  if (Buffer == NULL) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  Size = WriteRecord (Buffer, TLS_RECORD_MAX_LENGTH);
+  UT_ASSERT_TRUE (TlsIsCompleteRecords (Buffer, Size));
+  UT_ASSERT_FALSE (TlsIsCompleteRecords (Buffer, Size - 1));
+
+  //
+  // A small record, then a header claiming more than is left.
+  //
+  Size  = WriteRecord (Buffer, 8);
+  Size += WriteRecord (Buffer + Size, 64);
+  Buffer[Size - 64 - 2] = 0xFF;
+  Buffer[Size - 64 - 1] = 0xFF;
+  UT_ASSERT_FALSE (TlsIsCompleteRecords (Buffer, Size));
+
+  FreePool (Buffer);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initializes and runs the unit tests.
+
+  @retval  EFI_SUCCESS           All test suites ran.
+  @retval  EFI_OUT_OF_RESOURCES  A test suite could not be allocated.
+**/
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      RecordSuite;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  Status = CreateUnitTestSuite (&RecordSuite, Framework, "TLS Record Framing", "TlsLib.Record", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Done;
+  }
+
+  AddTestCase (RecordSuite, "Complete records are accepted", "Complete", TestCompleteRecords, NULL, NULL, NULL);
+  AddTestCase (RecordSuite, "Partial records are rejected", "Partial", TestPartialRecords, NULL, NULL, NULL);
+  AddTestCase (RecordSuite, "Record lengths stay within the buffer", "Bounds", TestRecordLengthBounds, NULL, NULL, NULL);
+
+  Status = RunAllTestSuites (Framework);
+
+Done:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UefiTestMain ();
+}